@@ -0,0 +1,338 @@
+/**
+ * File: allocator.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "allocator.h"
+
+/** Typen mit der strengsten Ausrichtung, die der Codec speichert. */
+typedef union _ARENA_ALIGN
+{
+    long l;
+    double d;
+    void *p;
+} ARENA_ALIGN;
+
+/** Ausrichtung aller Anforderungen der Arena. */
+#define ARENA_ALIGNMENT sizeof(ARENA_ALIGN)
+
+/** Rundet auf ein Vielfaches von ARENA_ALIGNMENT auf. */
+#define ARENA_ROUND(SIZE) \
+    (((SIZE) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT)
+
+/** Abstand der Daten vom Anfang eines Blocks. */
+#define ARENA_HEADER_SIZE ARENA_ROUND(sizeof(ARENA_CHUNK))
+
+/**
+ * Diese Funktion ist die Allokationsfunktion des Standardallokators.
+ *
+ * @param opaque Nicht verwendet
+ * @param size Anzahl Bytes
+ * @return Speicher oder NULL
+ */
+static void *default_alloc(void *opaque, size_t size);
+
+/**
+ * Diese Funktion ist die Freigabefunktion des Standardallokators.
+ *
+ * @param opaque Nicht verwendet
+ * @param p_memory Freizugebender Speicher
+ */
+static void default_free(void *opaque, void *p_memory);
+
+/**
+ * Diese Funktion vergibt Speicher aus der Arena und legt bei Bedarf einen
+ * neuen Block an.
+ *
+ * @param allocator Arena
+ * @param size Anzahl Bytes
+ * @return Mit 0 initialisierter Speicher
+ */
+static void *arena_alloc(ALLOCATOR *allocator, size_t size);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: allocator_init
+ *  ------------------------------------------------------------------------ */
+extern void allocator_init(ALLOCATOR *allocator)
+{
+    allocator_init_hooks(allocator, default_alloc, default_free, NULL);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: allocator_init_hooks
+ *  ------------------------------------------------------------------------ */
+extern void allocator_init_hooks(ALLOCATOR *allocator,
+                                 ALLOC_HOOK alloc_hook,
+                                 FREE_HOOK free_hook,
+                                 void *opaque)
+{
+    memset(allocator, 0, sizeof(ALLOCATOR));
+    allocator->alloc_hook = alloc_hook;
+    allocator->free_hook = free_hook;
+    allocator->opaque = opaque;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: allocator_init_arena
+ *  ------------------------------------------------------------------------ */
+extern void allocator_init_arena(ALLOCATOR *allocator, size_t chunk_size)
+{
+    memset(allocator, 0, sizeof(ALLOCATOR));
+    allocator->chunk_size = ARENA_ROUND((chunk_size > 0) ? chunk_size
+                                                         : ARENA_CHUNK_SIZE);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: allocator_is_arena
+ *  ------------------------------------------------------------------------ */
+extern BOOL allocator_is_arena(ALLOCATOR *allocator)
+{
+    return (allocator != NULL && allocator->alloc_hook == NULL) ? TRUE 
+                                                                : FALSE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: allocator_alloc
+ *  ------------------------------------------------------------------------ */
+extern void *allocator_alloc(ALLOCATOR *allocator, size_t size)
+{
+    void *p_memory;
+    
+    if (allocator == NULL)
+    {
+        p_memory = calloc(1, size);
+    }
+    else if (allocator->alloc_hook == NULL)
+    {
+        return arena_alloc(allocator, size);
+    }
+    else
+    {
+        p_memory = allocator->alloc_hook(allocator->opaque, size);
+        if (p_memory != NULL)
+        {
+            memset(p_memory, 0, size);
+        }
+    }
+    ENSURE_ENOUGH_MEMORY(p_memory, "allocator_alloc");
+    
+    return p_memory;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: allocator_realloc
+ *  ------------------------------------------------------------------------ */
+extern void *allocator_realloc(ALLOCATOR *allocator,
+                               void *p_memory,
+                               size_t old_size,
+                               size_t new_size)
+{
+    void *p_new_memory;
+    
+    if (allocator == NULL)
+    {
+        p_new_memory = realloc(p_memory, new_size);
+        ENSURE_ENOUGH_MEMORY(p_new_memory, "allocator_realloc");
+        return p_new_memory;
+    }
+    
+    /* In der Arena bleibt ein verkleinerter Speicher an seiner Stelle. */
+    if (allocator->alloc_hook == NULL && new_size <= old_size)
+    {
+        return p_memory;
+    }
+    
+    p_new_memory = allocator_alloc(allocator, new_size);
+    memcpy(p_new_memory, p_memory, (old_size < new_size) ? old_size 
+                                                         : new_size);
+    allocator_free(allocator, p_memory);
+    
+    return p_new_memory;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: allocator_free
+ *  ------------------------------------------------------------------------ */
+extern void allocator_free(ALLOCATOR *allocator, void *p_memory)
+{
+    if (allocator == NULL)
+    {
+        free(p_memory);
+    }
+    else if (allocator->free_hook != NULL && p_memory != NULL)
+    {
+        allocator->free_hook(allocator->opaque, p_memory);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: allocator_release
+ *  ------------------------------------------------------------------------ */
+extern void allocator_release(ALLOCATOR *allocator)
+{
+    ARENA_CHUNK *p_chunk;
+    ARENA_CHUNK *p_next;
+    
+    if (!allocator_is_arena(allocator) || allocator->p_chunks == NULL)
+    {
+        return;
+    }
+    
+    p_chunk = allocator->p_chunks->p_next;
+    while (p_chunk != NULL)
+    {
+        p_next = p_chunk->p_next;
+        free(p_chunk);
+        p_chunk = p_next;
+    }
+    allocator->p_chunks->p_next = NULL;
+    allocator->p_chunks->used = 0;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: allocator_mark
+ *  ------------------------------------------------------------------------ */
+extern void allocator_mark(ALLOCATOR *allocator, ARENA_MARK *mark)
+{
+    memset(mark, 0, sizeof(ARENA_MARK));
+    if (allocator_is_arena(allocator) && allocator->p_chunks != NULL)
+    {
+        mark->p_chunk = allocator->p_chunks;
+        mark->p_next = allocator->p_chunks->p_next;
+        mark->used = allocator->p_chunks->used;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: allocator_rewind
+ *  ------------------------------------------------------------------------ */
+extern void allocator_rewind(ALLOCATOR *allocator, ARENA_MARK *mark)
+{
+    ARENA_CHUNK *p_chunk;
+    ARENA_CHUNK *p_next;
+    
+    if (!allocator_is_arena(allocator))
+    {
+        return;
+    }
+    if (mark->p_chunk == NULL)
+    {
+        allocator_release(allocator);
+        return;
+    }
+    
+    /* Neuere Bloecke stehen vor dem gemerkten in der Liste. */
+    p_chunk = allocator->p_chunks;
+    while (p_chunk != mark->p_chunk)
+    {
+        p_next = p_chunk->p_next;
+        free(p_chunk);
+        p_chunk = p_next;
+    }
+    
+    /*
+     * Eigene Bloecke grosser Anforderungen haengen hinter dem aktuellen
+     * Block, die seit dem Merken angelegten also vor dessen Nachfolger.
+     */
+    p_chunk = mark->p_chunk->p_next;
+    while (p_chunk != mark->p_next)
+    {
+        p_next = p_chunk->p_next;
+        free(p_chunk);
+        p_chunk = p_next;
+    }
+    
+    mark->p_chunk->p_next = mark->p_next;
+    mark->p_chunk->used = mark->used;
+    allocator->p_chunks = mark->p_chunk;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: allocator_destroy
+ *  ------------------------------------------------------------------------ */
+extern void allocator_destroy(ALLOCATOR *allocator)
+{
+    allocator_release(allocator);
+    if (allocator_is_arena(allocator))
+    {
+        free(allocator->p_chunks);
+        allocator->p_chunks = NULL;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: default_alloc
+ *  ------------------------------------------------------------------------ */
+static void *default_alloc(void *opaque, size_t size)
+{
+    (void) opaque;
+    return malloc(size);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: default_free
+ *  ------------------------------------------------------------------------ */
+static void default_free(void *opaque, void *p_memory)
+{
+    (void) opaque;
+    free(p_memory);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: arena_alloc
+ *  ------------------------------------------------------------------------ */
+static void *arena_alloc(ALLOCATOR *allocator, size_t size)
+{
+    ARENA_CHUNK *p_chunk = allocator->p_chunks;
+    size_t chunk_size;
+    unsigned char *p_memory;
+    
+    size = ARENA_ROUND((size > 0) ? size : 1);
+    if (p_chunk == NULL || p_chunk->size - p_chunk->used < size)
+    {
+        chunk_size = (size > allocator->chunk_size) ? size
+                                                    : allocator->chunk_size;
+        p_chunk = malloc(ARENA_HEADER_SIZE + chunk_size);
+        ENSURE_ENOUGH_MEMORY(p_chunk, "arena_alloc");
+        p_chunk->size = chunk_size;
+        p_chunk->used = 0;
+        
+        /*
+         * Ein eigener Block fuer eine grosse Anforderung wird hinter dem
+         * aktuellen Block eingehaengt, damit dessen Rest nutzbar bleibt.
+         */
+        if (size > allocator->chunk_size && allocator->p_chunks != NULL)
+        {
+            p_chunk->p_next = allocator->p_chunks->p_next;
+            allocator->p_chunks->p_next = p_chunk;
+        }
+        else
+        {
+            p_chunk->p_next = allocator->p_chunks;
+            allocator->p_chunks = p_chunk;
+        }
+    }
+    
+    p_memory = (unsigned char *) p_chunk + ARENA_HEADER_SIZE + p_chunk->used;
+    p_chunk->used += size;
+    memset(p_memory, 0, size);
+    
+    return p_memory;
+}
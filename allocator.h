@@ -0,0 +1,209 @@
+/**
+ * File: allocator.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALLOCATOR_H
+
+#define	ALLOCATOR_H
+
+#include <stddef.h>
+#include "common.h"
+
+/** Groesse eines Arena-Blocks, wenn 0 angegeben wird. */
+#define ARENA_CHUNK_SIZE 65536
+
+/**
+ * Allokationsfunktion eines Aufrufers. Liefert size Byte oder NULL, wenn
+ * kein Speicher verfuegbar ist.
+ */
+typedef void *(*ALLOC_HOOK)(void *opaque, size_t size);
+
+/** Freigabefunktion eines Aufrufers fuer Speicher aus ALLOC_HOOK. */
+typedef void (*FREE_HOOK)(void *opaque, void *p_memory);
+
+/** Speicherblock einer Arena, die Daten folgen direkt dem Verwaltungsteil. */
+typedef struct _ARENA_CHUNK
+{
+    /**
+     * Naechster, frueher angelegter Block
+     */
+    struct _ARENA_CHUNK *p_next;
+    /**
+     * Nutzbare Bytes des Blocks
+     */
+    size_t size;
+    /**
+     * Bereits vergebene Bytes des Blocks
+     */
+    size_t used;
+} ARENA_CHUNK;
+
+/**
+ * Stand einer Arena, auf den allocator_rewind zuruecksetzt. Bei anderen
+ * Allokatoren ohne Bedeutung.
+ */
+typedef struct _ARENA_MARK
+{
+    /**
+     * Aktueller Block beim Merken, NULL bei einer leeren Arena
+     */
+    ARENA_CHUNK *p_chunk;
+    /**
+     * Nachfolger des aktuellen Blocks beim Merken
+     */
+    ARENA_CHUNK *p_next;
+    /**
+     * Vergebene Bytes des aktuellen Blocks beim Merken
+     */
+    size_t used;
+} ARENA_MARK;
+
+/**
+ * Allokator fuer den Speicher des Codecs. Entweder werden Funktionen des
+ * Aufrufers (Standard: malloc und free) verwendet, oder eine Arena vergibt
+ * Speicher fortlaufend aus grossen Bloecken. Einzelne Freigaben sind in der
+ * Arena ohne Wirkung, allocator_release gibt alles auf einmal frei.
+ */
+typedef struct _ALLOCATOR
+{
+    /**
+     * Allokationsfunktion, NULL fuer eine Arena
+     */
+    ALLOC_HOOK alloc_hook;
+    /**
+     * Freigabefunktion, NULL fuer eine Arena
+     */
+    FREE_HOOK free_hook;
+    /**
+     * Wird unveraendert an alloc_hook und free_hook uebergeben
+     */
+    void *opaque;
+    /**
+     * Bloecke der Arena, der aktuelle zuerst
+     */
+    ARENA_CHUNK *p_chunks;
+    /**
+     * Groesse neuer Arena-Bloecke
+     */
+    size_t chunk_size;
+} ALLOCATOR;
+
+/**
+ * Initialisiert einen Allokator mit malloc und free.
+ * 
+ * @param allocator Zu initialisierender Allokator
+ */
+extern void allocator_init(ALLOCATOR *allocator);
+
+/**
+ * Initialisiert einen Allokator mit den Funktionen eines Aufrufers.
+ * 
+ * @param allocator Zu initialisierender Allokator
+ * @param alloc_hook Allokationsfunktion
+ * @param free_hook Freigabefunktion
+ * @param opaque Zeiger fuer beide Funktionen, z.B. ein eigener Speicherpool
+ */
+extern void allocator_init_hooks(ALLOCATOR *allocator,
+                                 ALLOC_HOOK alloc_hook,
+                                 FREE_HOOK free_hook,
+                                 void *opaque);
+
+/**
+ * Initialisiert einen Allokator als Arena. Die Bloecke werden mit malloc
+ * angelegt, Anforderungen groesser als ein Block erhalten einen eigenen.
+ * 
+ * @param allocator Zu initialisierender Allokator
+ * @param chunk_size Groesse der Bloecke, 0 fuer ARENA_CHUNK_SIZE
+ */
+extern void allocator_init_arena(ALLOCATOR *allocator, size_t chunk_size);
+
+/**
+ * Prueft ob ein Allokator eine Arena ist.
+ * 
+ * @param allocator Allokator oder NULL
+ * @return TRUE fuer eine Arena
+ */
+extern BOOL allocator_is_arena(ALLOCATOR *allocator);
+
+/**
+ * Reserviert mit 0 initialisierten Speicher. Ist kein Speicher verfuegbar,
+ * wird das Programm wie bei ENSURE_ENOUGH_MEMORY beendet.
+ * 
+ * @param allocator Allokator, NULL fuer calloc
+ * @param size Anzahl Bytes
+ * @return Reservierter Speicher
+ */
+extern void *allocator_alloc(ALLOCATOR *allocator, size_t size);
+
+/**
+ * Veraendert die Groesse eines reservierten Speichers. Neu hinzugekommene
+ * Bytes sind nicht initialisiert.
+ * 
+ * @param allocator Allokator, NULL fuer realloc
+ * @param p_memory Speicher aus allocator_alloc
+ * @param old_size Bisherige Groesse
+ * @param new_size Neue Groesse
+ * @return Speicher mit der neuen Groesse
+ */
+extern void *allocator_realloc(ALLOCATOR *allocator,
+                               void *p_memory,
+                               size_t old_size,
+                               size_t new_size);
+
+/**
+ * Gibt einen reservierten Speicher frei. In einer Arena ohne Wirkung.
+ * 
+ * @param allocator Allokator, NULL fuer free
+ * @param p_memory Speicher aus allocator_alloc oder NULL
+ */
+extern void allocator_free(ALLOCATOR *allocator, void *p_memory);
+
+/**
+ * Gibt in einer Arena allen vergebenen Speicher auf einmal frei. Der
+ * zuletzt angelegte Block bleibt fuer die naechsten Anforderungen erhalten.
+ * Bei anderen Allokatoren ohne Wirkung.
+ * 
+ * @param allocator Allokator
+ */
+extern void allocator_release(ALLOCATOR *allocator);
+
+/**
+ * Merkt sich den Stand einer Arena, etwa vor dem Kodieren eines Blocks.
+ * 
+ * @param allocator Allokator
+ * @param mark Gemerkter Stand
+ */
+extern void allocator_mark(ALLOCATOR *allocator, ARENA_MARK *mark);
+
+/**
+ * Gibt in einer Arena allen seit allocator_mark vergebenen Speicher auf
+ * einmal frei, frueher vergebener Speicher bleibt gueltig. Bei anderen
+ * Allokatoren ohne Wirkung.
+ * 
+ * @param allocator Allokator
+ * @param mark Stand aus allocator_mark
+ */
+extern void allocator_rewind(ALLOCATOR *allocator, ARENA_MARK *mark);
+
+/**
+ * Gibt alle Bloecke einer Arena frei.
+ * 
+ * @param allocator Allokator
+ */
+extern void allocator_destroy(ALLOCATOR *allocator);
+
+#endif	/* ALLOCATOR_H */
@@ -0,0 +1,602 @@
+/**
+ * File: archive.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "common.h"
+#include "huffman.h"
+#include "huff_ctx.h"
+#include "huffman_internal.h"
+#include "byte_order.h"
+#include "codec_kernels.h"
+#include "async_io.h"
+#include "archive.h"
+
+/**
+ * Diese Funktion zaehlt die Zeichen aller Mitglieder und schreibt daraus die
+ * gemeinsame Codetabelle des Archivs. Waeren die Codes zu lang fuer die
+ * Kernel, wird keine Tabelle geschrieben.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_output_stream Ausgabestrom, positioniert hinter dem Archivheader
+ */
+static void write_shared_table(HUFF_CTX *ctx, FILE *p_output_stream);
+
+/**
+ * Diese Funktion liest den Archivheader, merkt sich die Position der
+ * gemeinsamen Codetabelle und liest das Verzeichnis.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, positioniert am Dateianfang
+ * @param p_entry_count Anzahl der Eintraege
+ * @return Neu allokiertes Verzeichnis, freizugeben mit free_archive_entries
+ */
+static ARCHIVE_ENTRY *read_archive(HUFF_CTX *ctx,
+                                   FILE *p_input_stream,
+                                   unsigned long *p_entry_count);
+
+/**
+ * Diese Funktion gibt ein mit read_archive gelesenes Verzeichnis frei.
+ * 
+ * @param p_entries Verzeichnis
+ * @param entry_count Anzahl der Eintraege
+ */
+static void free_archive_entries(ARCHIVE_ENTRY *p_entries,
+                                 unsigned long entry_count);
+
+/**
+ * Diese Funktion springt ein Mitglied ueber seine Position im Verzeichnis an
+ * und entpackt es nach Name + DECOMPRESS_EXT.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom des Archivs
+ * @param p_entry Eintrag des Mitglieds
+ */
+static void extract_member(HUFF_CTX *ctx,
+                           FILE *p_input_stream,
+                           ARCHIVE_ENTRY *p_entry);
+
+/**
+ * Diese Funktion bildet den im Archiv gespeicherten Namen einer Datei:
+ * relativ zur Wurzel des Archivs, ohne fuehrende /, ohne leere, . und ..
+ * Bestandteile.
+ * 
+ * @param filename Name der Datei auf der Kommandozeile
+ * @return Neu allokierter Name, leer wenn nichts uebrig bleibt
+ */
+static char *member_name(char *filename);
+
+/**
+ * Diese Funktion prueft ob ein gelesener Name innerhalb des Zielverzeichnisses
+ * bleibt: nicht leer, nicht absolut und ohne .. als Bestandteil.
+ * 
+ * @param name Name aus dem Verzeichnis des Archivs
+ * @return TRUE wenn das Mitglied unter diesem Namen entpackt werden darf
+ */
+static BOOL is_safe_member_name(char *name);
+
+/**
+ * Diese Funktion legt die fehlenden Verzeichnisse vor dem letzten / eines
+ * relativen Dateinamens an.
+ * 
+ * @param filename Name der zu schreibenden Datei
+ */
+static void create_parent_directories(char *filename);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: archive
+ *  ------------------------------------------------------------------------ */
+extern void archive(HUFF_CTX *ctx, char *archive_filename)
+{
+    unsigned char header[ARCHIVE_HEADER_SIZE];
+    unsigned char entry[ARCHIVE_ENTRY_SIZE];
+    unsigned long directory_start;
+    unsigned long i;
+    ARCHIVE_ENTRY *p_entries = calloc(ctx->member_count, sizeof(ARCHIVE_ENTRY));
+    FILE *p_output_stream = fopen(archive_filename, "wb");
+    
+    if (p_output_stream == NULL)
+    {
+        printf("Datei zum Schreiben konnte nicht geoeffnet werden.\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    ENSURE_ENOUGH_MEMORY(p_entries, "archive");
+    
+    /* Position und Groesse des Verzeichnisses folgen am Ende. */
+    memset(header, 0, ARCHIVE_HEADER_SIZE);
+    memcpy(header, ARCHIVE_MAGIC, 4);
+    header[4] = ARCHIVE_VERSION;
+    if (fwrite(header, sizeof(unsigned char), ARCHIVE_HEADER_SIZE,
+               p_output_stream) != ARCHIVE_HEADER_SIZE)
+    {
+        printf("Fehler beim schreiben des Headers.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    if (ctx->shared_mode)
+    {
+        write_shared_table(ctx, p_output_stream);
+    }
+    
+    /*
+     * Jedes Mitglied ist ein vollstaendiger Container in Bloecken, der ohne
+     * die anderen Mitglieder dekodiert werden kann.
+     */
+    for (i = 0; i < ctx->member_count; i++)
+    {
+        p_entries[i].name = member_name(ctx->member_filenames[i]);
+        if (*p_entries[i].name == '\0')
+        {
+            printf("Der Name %s kann nicht im Archiv gespeichert werden.\n",
+                   ctx->member_filenames[i]);
+            exit(EXIT_FAILURE);
+        }
+        if (strcmp(p_entries[i].name, ctx->member_filenames[i]) != 0)
+        {
+            printf("%s wird als %s gespeichert.\n", 
+                   ctx->member_filenames[i], p_entries[i].name);
+        }
+        p_entries[i].offset = (unsigned long) ftell(p_output_stream);
+        write_blocks(ctx, p_output_stream, ctx->member_filenames[i]);
+        p_entries[i].raw_length = ctx->read_char_count;
+        p_entries[i].packed_length = (unsigned long) ftell(p_output_stream)
+                                   - p_entries[i].offset;
+        
+        /* Jedes Mitglied ist fuer eine Arena ein eigener Auftrag. */
+        allocator_release(&ctx->allocator);
+        
+        if (ctx->debug_mode)
+        {
+            printf("\tMitglied %s: %lu Zeichen, %lu Byte\n", 
+                   p_entries[i].name, p_entries[i].raw_length,
+                   p_entries[i].packed_length);
+        }
+    }
+    
+    directory_start = (unsigned long) ftell(p_output_stream);
+    for (i = 0; i < ctx->member_count; i++)
+    {
+        if (strlen(p_entries[i].name) > 0xFFFF)
+        {
+            printf("Der Name %s ist zu lang.\n", p_entries[i].name);
+            exit(EXIT_FAILURE);
+        }
+        store_le(entry, p_entries[i].offset, 8);
+        store_le(entry + 8, p_entries[i].raw_length, 8);
+        store_le(entry + 16, p_entries[i].packed_length, 8);
+        store_le(entry + 24, strlen(p_entries[i].name), 2);
+        if (fwrite(entry, sizeof(unsigned char), ARCHIVE_ENTRY_SIZE,
+                   p_output_stream) != ARCHIVE_ENTRY_SIZE
+                || fwrite(p_entries[i].name, sizeof(char), 
+                          strlen(p_entries[i].name), p_output_stream) 
+                    != strlen(p_entries[i].name))
+        {
+            printf("Fehler beim schreiben des Verzeichnisses.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    
+    memset(header, 0, ARCHIVE_HEADER_SIZE);
+    memcpy(header, ARCHIVE_MAGIC, 4);
+    header[4] = ARCHIVE_VERSION;
+    header[5] = (ctx->shared_table_written) ? ARCHIVE_FLAG_SHARED_TABLE : 0;
+    store_le(header + 8, directory_start, 8);
+    store_le(header + 16, ctx->member_count, 8);
+    fseek(p_output_stream, 0, SEEK_SET);
+    if (fwrite(header, sizeof(unsigned char), ARCHIVE_HEADER_SIZE,
+               p_output_stream) != ARCHIVE_HEADER_SIZE)
+    {
+        printf("Fehler beim schreiben des Headers.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    fclose(p_output_stream);
+    free_archive_entries(p_entries, ctx->member_count);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: write_shared_table
+ *  ------------------------------------------------------------------------ */
+static void write_shared_table(HUFF_CTX *ctx, FILE *p_output_stream)
+{
+    unsigned long counts[256];
+    unsigned long read_length;
+    unsigned long total = 0;
+    unsigned long i, j;
+    BTREE *p_huffman_tree;
+    FILE *p_input_stream;
+    ASYNC_IO *p_reader;
+    unsigned char *p_input_buffer = malloc(KERNEL_CHUNK_SIZE);
+    
+    ENSURE_ENOUGH_MEMORY(p_input_buffer, "write_shared_table");
+    
+    memset(counts, 0, sizeof(counts));
+    for (i = 0; i < ctx->member_count; i++)
+    {
+        p_input_stream = fopen(ctx->member_filenames[i], "rb");
+        if (p_input_stream == NULL)
+        {
+            printf("Datei Einlesen fehlgeschlagen!\n");
+            fflush(stdout);
+            exit(EXIT_FAILURE);
+        }
+        
+        p_reader = async_io_open_reader(p_input_stream, (unsigned long) -1,
+                                        IO_MODE, ctx->io_depth);
+        while ((read_length = async_io_read(p_reader, p_input_buffer, 
+                                            KERNEL_CHUNK_SIZE)) > 0)
+        {
+            for (j = 0; j < read_length; j++)
+            {
+                counts[p_input_buffer[j]]++;
+            }
+            total += read_length;
+        }
+        async_io_close(p_reader);
+        fclose(p_input_stream);
+    }
+    free(p_input_buffer);
+    
+    /* Ohne Zeichen gibt es keine Tabelle. */
+    if (total == 0)
+    {
+        return;
+    }
+    
+    p_huffman_tree = create_block_codes(ctx, counts);
+    code_table_init(&ctx->shared_code_table, ctx->p_symbol_start,
+                    ctx->symbol_count);
+    if (ctx->shared_code_table.max_length <= KERNEL_MAX_CODE_LENGTH)
+    {
+        write_block_header(ctx, p_output_stream, BLOCK_TYPE_HUFFMAN, 0, 0,
+                           NULL);
+        for (i = 0; i < 256; i++)
+        {
+            ctx->shared_symbols[i] = (counts[i] > 0) ? TRUE : FALSE;
+        }
+        ctx->shared_table_written = TRUE;
+    }
+    
+    free_codes(ctx);
+    destroy_huffman_tree(p_huffman_tree);
+    allocator_free(&ctx->allocator, ctx->p_symbol_start);
+    ctx->p_symbol_start = NULL;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: extract
+ *  ------------------------------------------------------------------------ */
+extern void extract(HUFF_CTX *ctx, char *archive_filename)
+{
+    ARCHIVE_ENTRY *p_entries;
+    unsigned long entry_count;
+    unsigned long i, j;
+    char *p_name;
+    FILE *p_input_stream = fopen(archive_filename, "rb");
+    
+    if (p_input_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    
+    p_entries = read_archive(ctx, p_input_stream, &entry_count);
+    
+    /*
+     * Ein Archiv mit einem Namen ausserhalb des Zielverzeichnisses wird
+     * abgelehnt, bevor irgendetwas geschrieben wird.
+     */
+    for (i = 0; i < entry_count; i++)
+    {
+        if (!is_safe_member_name(p_entries[i].name))
+        {
+            printf("Das Mitglied %s liegt ausserhalb des Zielverzeichnisses "
+                   "und wird nicht entpackt.\n", p_entries[i].name);
+            exit(EXIT_FAILURE);
+        }
+    }
+    
+    /* Ohne Namen werden alle Mitglieder entpackt. */
+    if (ctx->member_count == 0)
+    {
+        for (i = 0; i < entry_count; i++)
+        {
+            extract_member(ctx, p_input_stream, p_entries + i);
+        }
+    }
+    
+    /* Die Namen werden wie beim Packen umgeformt. */
+    for (j = 0; j < ctx->member_count; j++)
+    {
+        p_name = member_name(ctx->member_filenames[j]);
+        for (i = 0; i < entry_count 
+                && strcmp(p_entries[i].name, p_name) != 0;
+             i++)
+        {
+        }
+        free(p_name);
+        if (i == entry_count)
+        {
+            printf("Das Archiv enthaelt kein Mitglied %s.\n", 
+                   ctx->member_filenames[j]);
+            exit(EXIT_FAILURE);
+        }
+        extract_member(ctx, p_input_stream, p_entries + i);
+    }
+    
+    free_archive_entries(p_entries, entry_count);
+    fclose(p_input_stream);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: extract_member
+ *  ------------------------------------------------------------------------ */
+static void extract_member(HUFF_CTX *ctx,
+                           FILE *p_input_stream,
+                           ARCHIVE_ENTRY *p_entry)
+{
+    char *out_filename = malloc(strlen(p_entry->name) 
+                                + strlen(DECOMPRESS_EXT) + 1);
+    
+    ENSURE_ENOUGH_MEMORY(out_filename, "extract_member");
+    strcpy(out_filename, p_entry->name);
+    strcat(out_filename, DECOMPRESS_EXT);
+    create_parent_directories(out_filename);
+    
+    fseek(p_input_stream, (long) p_entry->offset, SEEK_SET);
+    decompress_container(ctx, p_input_stream, out_filename);
+    allocator_release(&ctx->allocator);
+    if (ctx->read_char_count != p_entry->raw_length)
+    {
+        printf("Die komprimierte Datei ist beschaedigt.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    if (ctx->debug_mode)
+    {
+        printf("\tMitglied %s: %lu Zeichen nach %s\n", p_entry->name,
+               p_entry->raw_length, out_filename);
+    }
+    free(out_filename);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: member_name
+ *  ------------------------------------------------------------------------ */
+static char *member_name(char *filename)
+{
+    char *p_name = malloc(strlen(filename) + 1);
+    char *p_part = filename;
+    unsigned long part_length;
+    unsigned long name_length = 0;
+    
+    ENSURE_ENOUGH_MEMORY(p_name, "member_name");
+    while (*p_part != '\0')
+    {
+        part_length = strcspn(p_part, "/");
+        if (part_length > 0 
+                && !(part_length == 1 && p_part[0] == '.')
+                && !(part_length == 2 && p_part[0] == '.' && p_part[1] == '.'))
+        {
+            if (name_length > 0)
+            {
+                p_name[name_length++] = '/';
+            }
+            memcpy(p_name + name_length, p_part, part_length);
+            name_length += part_length;
+        }
+        p_part += part_length;
+        if (*p_part == '/')
+        {
+            p_part++;
+        }
+    }
+    p_name[name_length] = '\0';
+    
+    return p_name;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: is_safe_member_name
+ *  ------------------------------------------------------------------------ */
+static BOOL is_safe_member_name(char *name)
+{
+    char *p_part = name;
+    unsigned long part_length;
+    
+    if (*name == '\0' || *name == '/')
+    {
+        return FALSE;
+    }
+    
+    while (*p_part != '\0')
+    {
+        part_length = strcspn(p_part, "/");
+        if (part_length == 2 && p_part[0] == '.' && p_part[1] == '.')
+        {
+            return FALSE;
+        }
+        p_part += part_length;
+        if (*p_part == '/')
+        {
+            p_part++;
+        }
+    }
+    
+    return TRUE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: create_parent_directories
+ *  ------------------------------------------------------------------------ */
+static void create_parent_directories(char *filename)
+{
+    char *p_path = malloc(strlen(filename) + 1);
+    char *p_separator;
+    
+    ENSURE_ENOUGH_MEMORY(p_path, "create_parent_directories");
+    strcpy(p_path, filename);
+    
+    /*
+     * Vorhandene Verzeichnisse sind kein Fehler, schlaegt mkdir wirklich
+     * fehl, meldet das Oeffnen der Datei den Fehler.
+     */
+    for (p_separator = strchr(p_path, '/'); p_separator != NULL;
+         p_separator = strchr(p_separator + 1, '/'))
+    {
+        *p_separator = '\0';
+        mkdir(p_path, 0777);
+        *p_separator = '/';
+    }
+    free(p_path);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: list_archive
+ *  ------------------------------------------------------------------------ */
+extern void list_archive(HUFF_CTX *ctx, char *archive_filename)
+{
+    ARCHIVE_ENTRY *p_entries;
+    unsigned long entry_count;
+    unsigned long raw_total = 0;
+    unsigned long packed_total = 0;
+    unsigned long i;
+    FILE *p_input_stream = fopen(archive_filename, "rb");
+    
+    if (p_input_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    
+    p_entries = read_archive(ctx, p_input_stream, &entry_count);
+    fclose(p_input_stream);
+    
+    printf("%14s %14s  %s\n", "Zeichen", "Byte", "Name");
+    for (i = 0; i < entry_count; i++)
+    {
+        printf("%14lu %14lu  %s\n", p_entries[i].raw_length,
+               p_entries[i].packed_length, p_entries[i].name);
+        raw_total += p_entries[i].raw_length;
+        packed_total += p_entries[i].packed_length;
+    }
+    printf("%14lu %14lu  %lu Mitglieder%s\n", raw_total, packed_total,
+           entry_count, (ctx->shared_symbol_count > 0) 
+                        ? ", gemeinsame Codetabelle" : "");
+    
+    free_archive_entries(p_entries, entry_count);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: read_archive
+ *  ------------------------------------------------------------------------ */
+static ARCHIVE_ENTRY *read_archive(HUFF_CTX *ctx,
+                                   FILE *p_input_stream,
+                                   unsigned long *p_entry_count)
+{
+    unsigned char header[ARCHIVE_HEADER_SIZE];
+    unsigned char entry[ARCHIVE_ENTRY_SIZE];
+    unsigned long directory_start;
+    unsigned long name_length;
+    unsigned long i;
+    ARCHIVE_ENTRY *p_entries;
+    
+    if (fread(header, sizeof(unsigned char), ARCHIVE_HEADER_SIZE, 
+              p_input_stream) != ARCHIVE_HEADER_SIZE
+            || memcmp(header, ARCHIVE_MAGIC, 4) != 0)
+    {
+        printf("Die Datei ist kein Archiv.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (header[4] > ARCHIVE_VERSION 
+            || (header[5] & ~ARCHIVE_FLAG_SHARED_TABLE) != 0)
+    {
+        printf("Das Archiv hat Version %u mit Flags 0x%02x und wird von "
+               "dieser Version nicht unterstuetzt.\n", header[4], header[5]);
+        exit(EXIT_FAILURE);
+    }
+    directory_start = load_le(header + 8, 8);
+    *p_entry_count = load_le(header + 16, 8);
+    
+    /* Die gemeinsame Codetabelle wird erst von einem Mitglied gelesen. */
+    ctx->shared_symbol_count = 0;
+    ctx->shared_decode_valid = FALSE;
+    if ((header[5] & ARCHIVE_FLAG_SHARED_TABLE) != 0)
+    {
+        read_block_header(ctx, p_input_stream);
+        if (ctx->read_block.type != BLOCK_TYPE_HUFFMAN
+                || ctx->symbol_count == 0)
+        {
+            printf("Die komprimierte Datei ist beschaedigt.\n");
+            exit(EXIT_FAILURE);
+        }
+        ctx->shared_table_start = ftell(p_input_stream);
+        ctx->shared_symbol_count = ctx->symbol_count;
+    }
+    
+    p_entries = calloc(*p_entry_count + 1, sizeof(ARCHIVE_ENTRY));
+    ENSURE_ENOUGH_MEMORY(p_entries, "read_archive");
+    
+    fseek(p_input_stream, (long) directory_start, SEEK_SET);
+    for (i = 0; i < *p_entry_count; i++)
+    {
+        if (fread(entry, sizeof(unsigned char), ARCHIVE_ENTRY_SIZE, 
+                  p_input_stream) != ARCHIVE_ENTRY_SIZE)
+        {
+            printf("Die komprimierte Datei ist unvollstaendig.\n");
+            exit(EXIT_FAILURE);
+        }
+        p_entries[i].offset = load_le(entry, 8);
+        p_entries[i].raw_length = load_le(entry + 8, 8);
+        p_entries[i].packed_length = load_le(entry + 16, 8);
+        name_length = load_le(entry + 24, 2);
+        
+        p_entries[i].name = malloc(name_length + 1);
+        ENSURE_ENOUGH_MEMORY(p_entries[i].name, "read_archive");
+        if (fread(p_entries[i].name, sizeof(char), name_length, 
+                  p_input_stream) != name_length)
+        {
+            printf("Die komprimierte Datei ist unvollstaendig.\n");
+            exit(EXIT_FAILURE);
+        }
+        p_entries[i].name[name_length] = '\0';
+    }
+    
+    return p_entries;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: free_archive_entries
+ *  ------------------------------------------------------------------------ */
+static void free_archive_entries(ARCHIVE_ENTRY *p_entries,
+                                 unsigned long entry_count)
+{
+    unsigned long i;
+    
+    for (i = 0; i < entry_count; i++)
+    {
+        free(p_entries[i].name);
+    }
+    free(p_entries);
+}
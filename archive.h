@@ -0,0 +1,102 @@
+/**
+ * File: archive.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARCHIVE_H
+
+#define	ARCHIVE_H
+
+#include "common.h"
+#include "huffman.h"
+
+/** Kennung eines Archivs aus mehreren Dateien. */
+#define ARCHIVE_MAGIC "HUFA"
+
+/** Aktuelle Version des Archivformats. */
+#define ARCHIVE_VERSION 1
+
+/**
+ * Groesse des Archivheaders in Byte: Kennung, Version, Flags, 2 reservierte
+ * Bytes, Dateiposition des Verzeichnisses (8 Byte), Anzahl der Mitglieder
+ * (8 Byte). Danach folgen die gemeinsame Codetabelle als Blockheader vom Typ
+ * BLOCK_TYPE_HUFFMAN ohne Zeichen, die Mitglieder als Container und am Ende
+ * das Verzeichnis.
+ */
+#define ARCHIVE_HEADER_SIZE 24
+
+/** Flag: hinter dem Archivheader folgt die gemeinsame Codetabelle. */
+#define ARCHIVE_FLAG_SHARED_TABLE 0x01
+
+/**
+ * Groesse eines Verzeichniseintrags ohne Namen: Dateiposition des Containers
+ * (8 Byte), Anzahl Zeichen (8 Byte), Groesse des Containers (8 Byte), Laenge
+ * des Namens (2 Byte). Danach folgt der Name ohne abschliessende 0.
+ */
+#define ARCHIVE_ENTRY_SIZE 26
+
+/** Struktur eines Eintrags im Verzeichnis eines Archivs. */
+typedef struct _ARCHIVE_ENTRY
+{
+    /**
+     * Name des Mitglieds
+     */
+    char *name;
+    /**
+     * Dateiposition des Containers im Archiv
+     */
+    unsigned long offset;
+    /**
+     * Anzahl Zeichen des Mitglieds
+     */
+    unsigned long raw_length;
+    /**
+     * Groesse des Containers in Byte
+     */
+    unsigned long packed_length;
+} ARCHIVE_ENTRY;
+
+/**
+ * Diese Funktion packt die Dateien member_filenames in ein Archiv. Jede
+ * Datei wird als eigener Container in Bloecken komprimiert, am Ende steht
+ * ein Verzeichnis mit Name, Position und Groesse der Mitglieder. Mit
+ * shared_mode erhalten alle Mitglieder zusaetzlich eine gemeinsame
+ * Codetabelle, die kleine Dateien statt einer eigenen Tabelle verwenden.
+ * 
+ * @param ctx Codec-Kontext
+ * @param archive_filename Ausgabedatei fuer das Archiv
+ */
+extern void archive(HUFF_CTX *ctx, char *archive_filename);
+
+/**
+ * Diese Funktion entpackt die Mitglieder member_filenames eines Archivs,
+ * ohne member_filenames alle Mitglieder. Ueber das Verzeichnis wird jedes
+ * Mitglied direkt angesprungen und nach Name + DECOMPRESS_EXT geschrieben.
+ * 
+ * @param ctx Codec-Kontext
+ * @param archive_filename Archiv
+ */
+extern void extract(HUFF_CTX *ctx, char *archive_filename);
+
+/**
+ * Diese Funktion gibt das Verzeichnis eines Archivs aus.
+ * 
+ * @param ctx Codec-Kontext
+ * @param archive_filename Archiv
+ */
+extern void list_archive(HUFF_CTX *ctx, char *archive_filename);
+
+#endif	/* ARCHIVE_H */
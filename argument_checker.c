@@ -16,10 +16,13 @@
  *	along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "common.h"
+#include "huff_ctx.h"
+#include "async_io.h"
 #include "argument_checker.h"
 
 /**
@@ -33,16 +36,48 @@ static void check_for_unknown_parameter(char **argv);
 /** Diese Funktion gibt die Hilfe auf dem Bildschirm aus. */
 static void print_help();
 
+/**
+ * Diese Funktion erzeugt den Namen der Ausgabedatei aus dem Namen der
+ * Eingabedatei und der uebergebenen Dateiendung.
+ * 
+ * @param in_filename Name der Eingabedatei
+ * @param extension Anzuhaengende Dateiendung
+ * @return Neu allokierter Name der Ausgabedatei
+ */
+static char *build_out_filename(char *in_filename, char *extension);
+
+/**
+ * Diese Funktion liest eine positive Dezimalzahl aus einem Parameter.
+ * 
+ * @param text Parameter
+ * @param value Zeiger auf die Variable fuer das Ergebnis
+ * @return TRUE wenn der Parameter vollstaendig eine Zahl ist und in ein
+ *         unsigned long passt, sonst FALSE
+ */
+static BOOL parse_number(char *text, unsigned long *value);
+
+/**
+ * Diese Funktion liest einen Bereich im Format start:laenge aus einem 
+ * Parameter und setzt range_start und range_length.
+ * 
+ * @param ctx Codec-Kontext
+ * @param text Parameter
+ * @return TRUE wenn der Bereich gueltig ist, sonst FALSE
+ */
+static BOOL parse_range(HUFF_CTX *ctx, char *text);
+
 
 /** ---------------------------------------------------------------------------
  *  Funktion: check_arguments
  *  ------------------------------------------------------------------------ */
-extern void check_arguments(int argc,
+extern void check_arguments(HUFF_CTX *ctx,
+                              int argc,
                               char** argv,
                               char **in_filename,
                               char **out_filename)
 {
-    char **p_argv_start = argv;
+    int i;
+    BOOL job_mode = FALSE;
     
     /* Pruefen ob keine Parameter angegeben wurden. */
     if (argc < 2)
@@ -53,101 +88,457 @@ extern void check_arguments(int argc,
         exit(EXIT_FAILURE);
     }
     
-    /* Pruefen ob zu viele Parameter angegeben wurden. */
-    if (argc > 5)
-    {
-        printf("Sie haben zu viele Parameter angegeben!\n"
-                "Fuer eine Info ueber die verfuegbaren Parameter geben.\n");
-        print_help();
-        exit(EXIT_FAILURE);
-    }
-    
     argv++;
     check_for_unknown_parameter(argv);
     
     /* Anzeigen der Hilfe. */
-    if (argc == 2 && strcmp(*argv, "-h") == 0)
+    if (strcmp(*argv, "-h") == 0)
     {
         print_help();
         exit(EXIT_SUCCESS);
     }
     
     /* Pruefen ob eine Inputdatei angegeben wurde. */
-    if (argc == 2 && (strcmp(*argv, "-c") == 0 || strcmp(*argv, "-d") == 0))
-    {
-        printf("Geben Sie eine Input Datei an!\n");
-        print_help();
-        exit(EXIT_FAILURE);
-    } 
-    else if (argc == 3 && (strcmp(*argv, "-c") == 0 || strcmp(*argv, "-d") == 0) 
-            && (strcmp(*(argv + 1), "-debug") == 0))
+    if (argc == 2 || **(argv + 1) == '-')
     {
         printf("Geben Sie eine Input Datei an!\n");
         print_help();
         exit(EXIT_FAILURE);
     }
     
-    /* Pruefen ob Kompression erwuenscht. */
-    if (argc > 2 && strcmp(*argv, "-c") == 0)
+    ctx->archive_mode = (strcmp(*argv, "-a") == 0) ? TRUE : FALSE;
+    ctx->extract_mode = (strcmp(*argv, "-x") == 0) ? TRUE : FALSE;
+    ctx->list_mode = (strcmp(*argv, "-l") == 0) ? TRUE : FALSE;
+    
+    /* Die Mitglieder eines Archivs werden mit den Optionen von -c gepackt. */
+    ctx->compress_mode = (strcmp(*argv, "-c") == 0 || ctx->archive_mode) 
+                         ? TRUE : FALSE;
+    ctx->message_benchmark_mode = (strcmp(*argv, "-bm") == 0) ? TRUE : FALSE;
+    ctx->io_benchmark_mode = (strcmp(*argv, "-bio") == 0) ? TRUE : FALSE;
+    ctx->benchmark_mode = (strcmp(*argv, "-b") == 0 
+                           || ctx->message_benchmark_mode 
+                           || ctx->io_benchmark_mode) ? TRUE : FALSE;
+    ctx->train_mode = (strcmp(*argv, "-train") == 0) ? TRUE : FALSE;
+    ctx->test_mode = (strcmp(*argv, "-t") == 0) ? TRUE : FALSE;
+    ctx->decoder_type = DECODER_TABLE;
+    ctx->thread_count = 1;
+    
+    /* 0 = kein --sample angegeben, wird nach der Pruefung auf 100 gesetzt. */
+    ctx->sample_percent = 0;
+    *in_filename = *(argv + 1);
+    *out_filename = NULL;
+    ctx->member_filenames = malloc(argc * sizeof(char*));
+    ENSURE_ENOUGH_MEMORY(ctx->member_filenames, "check_arguments");
+    ctx->member_count = 0;
+    
+    /* Mit -j sind alle Dateinamen Eingaben, auch die vor dem -j. */
+    for (i = 3; i < argc; i++)
     {
-        compress_mode = TRUE;
-        *in_filename = *(argv + 1);
-
-        /* 
-         * Setzen des out_filename aus den Parametern.
-         * Wenn kein out_filename angegeben wurde, wird Speicher allokiert fuer
-         * den in_filename + Kompressionsdateinamen. Dies bildet dann den
-         * out_filename.
-         */
-        if (argc >= 4 && strcmp(*(argv + 2), "-debug") != 0)
+        if (strcmp(*(argv + i - 1), "-j") == 0)
         {
-            *out_filename = *(argv + 2);
-        }
-        else
-        {
-            *out_filename = malloc((strlen(*in_filename) 
-                    + strlen(COMPRESS_EXT)) * sizeof(char));
-            strcpy(*out_filename, *in_filename);
-            strcat(*out_filename, COMPRESS_EXT);
+            job_mode = TRUE;
         }
     }
     
-    /* Pruefen ob Dekompression erwuenscht. */
-    if (argc > 2 && strcmp(*argv, "-d") == 0)
+    /*
+     * Auswerten der optionalen Parameter. Der erste Parameter der nicht mit
+     * einem '-' beginnt wird als Name der Ausgabedatei verwendet.
+     */
+    for (i = 3; i < argc; i++)
     {
-        compress_mode = FALSE;
-        *in_filename = *(argv + 1);
-        
-        /* 
-         * Setzen des out_filename aus den Parametern.
-         * Wenn kein out_filename angegeben wurde, wird Speicher allokiert fuer
-         * den in_filename + Kompressionsdateinamen. Dies bildet dann den
-         * out_filename.
-         */
-        if (argc >= 4 && strcmp(*(argv + 2), "-debug") != 0)
+        if (strcmp(*(argv + i - 1), "-debug") == 0)
+        {
+            /*
+             * Aktivierung des globalen Debug Modus fuer globale Ausgaben.
+             */
+            printf("\n\n\t**********************************\n");
+            printf("\t** Debug Modus wurde aktiviert. **\n");
+            printf("\t**********************************\n\n");
+            fflush(stdout);
+            ctx->debug_mode = TRUE;
+        }
+        else if (strcmp(*(argv + i - 1), "--arena") == 0)
+        {
+            allocator_init_arena(&ctx->allocator, 0);
+        }
+        else if (strcmp(*(argv + i - 1), "--index") == 0 && ctx->compress_mode)
+        {
+            i++;
+            if (i >= argc || !parse_number(*(argv + i - 1), 
+                                           &ctx->seek_index_interval)
+                    || ctx->seek_index_interval == 0
+                    || ctx->seek_index_interval > (unsigned long) -1 / 1024)
+            {
+                printf("Geben Sie fuer --index ein Intervall in KB an!\n");
+                print_help();
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(*(argv + i - 1), "--block") == 0 && ctx->compress_mode)
+        {
+            i++;
+            if (i >= argc || !parse_number(*(argv + i - 1), &ctx->block_size)
+                    || ctx->block_size == 0 
+                    || ctx->block_size > MAX_BLOCK_SIZE)
+            {
+                printf("Geben Sie fuer --block eine Blockgroesse von 1 bis "
+                       "%lu KB an!\n", (unsigned long) MAX_BLOCK_SIZE);
+                print_help();
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(*(argv + i - 1), "--checksum") == 0 
+                && ctx->compress_mode)
         {
-            *out_filename = *(argv + 2);
+            ctx->checksum_mode = TRUE;
+        }
+        else if (strcmp(*(argv + i - 1), "--context") == 0 
+                && ctx->compress_mode)
+        {
+            ctx->context_mode = TRUE;
+        }
+        else if (strcmp(*(argv + i - 1), "--wide") == 0 && ctx->compress_mode)
+        {
+            ctx->wide_mode = TRUE;
+        }
+        else if (strcmp(*(argv + i - 1), "--rle") == 0 && ctx->compress_mode)
+        {
+            ctx->rle_mode = TRUE;
+        }
+        else if (strcmp(*(argv + i - 1), "--shared") == 0 && ctx->archive_mode)
+        {
+            ctx->shared_mode = TRUE;
+        }
+        else if (strcmp(*(argv + i - 1), "--estimate") == 0 
+                && ctx->compress_mode)
+        {
+            ctx->estimate_mode = TRUE;
+        }
+        else if (strcmp(*(argv + i - 1), "--sample") == 0 && ctx->compress_mode)
+        {
+            i++;
+            if (i >= argc 
+                    || !parse_number(*(argv + i - 1), &ctx->sample_percent)
+                    || ctx->sample_percent == 0 || ctx->sample_percent > 100)
+            {
+                printf("Geben Sie fuer --sample einen Anteil von 1 bis 100 "
+                       "Prozent an!\n");
+                print_help();
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(*(argv + i - 1), "--dict") == 0 && !ctx->train_mode
+                && (!ctx->benchmark_mode || ctx->message_benchmark_mode))
+        {
+            i++;
+            if (i >= argc)
+            {
+                printf("Geben Sie fuer --dict ein Woerterbuch an!\n");
+                print_help();
+                exit(EXIT_FAILURE);
+            }
+            ctx->dictionary_filename = *(argv + i - 1);
+        }
+        else if (strcmp(*(argv + i - 1), "--decoder") == 0 
+                && !ctx->compress_mode && !ctx->benchmark_mode)
+        {
+            i++;
+            if (i < argc && strcmp(*(argv + i - 1), "tree") == 0)
+            {
+                ctx->decoder_type = DECODER_TREE;
+            }
+            else if (i < argc && strcmp(*(argv + i - 1), "fsm") == 0)
+            {
+                ctx->decoder_type = DECODER_FSM;
+            }
+            else if (i < argc && strcmp(*(argv + i - 1), "table") == 0)
+            {
+                ctx->decoder_type = DECODER_TABLE;
+            }
+            else
+            {
+                printf("Geben Sie fuer --decoder tree, fsm oder table an!\n");
+                print_help();
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(*(argv + i - 1), "--range") == 0 && !ctx->compress_mode
+                && !ctx->benchmark_mode)
+        {
+            i++;
+            if (i >= argc || !parse_range(ctx, *(argv + i - 1)))
+            {
+                printf("Geben Sie fuer --range einen Bereich im Format "
+                        "start:laenge an!\n");
+                print_help();
+                exit(EXIT_FAILURE);
+            }
+            ctx->range_mode = TRUE;
+        }
+        else if (strcmp(*(argv + i - 1), "--threads") == 0 
+                && !ctx->compress_mode && !ctx->benchmark_mode)
+        {
+            i++;
+            if (i >= argc || !parse_number(*(argv + i - 1), &ctx->thread_count)
+                    || ctx->thread_count == 0)
+            {
+                printf("Geben Sie fuer --threads eine Anzahl an!\n");
+                print_help();
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(*(argv + i - 1), "--mmap") == 0 && !ctx->compress_mode
+                && !ctx->benchmark_mode && !ctx->test_mode)
+        {
+            ctx->mmap_mode = TRUE;
+        }
+        else if (strcmp(*(argv + i - 1), "--io") == 0 && !ctx->benchmark_mode)
+        {
+            i++;
+            if (i < argc && strcmp(*(argv + i - 1), "sync") == 0)
+            {
+                ctx->io_backend = IO_BACKEND_SYNC;
+            }
+            else if (i < argc && strcmp(*(argv + i - 1), "thread") == 0)
+            {
+                ctx->io_backend = IO_BACKEND_THREAD;
+            }
+            else if (i < argc && strcmp(*(argv + i - 1), "uring") == 0)
+            {
+                ctx->io_backend = IO_BACKEND_URING;
+            }
+            else
+            {
+                printf("Geben Sie fuer --io sync, thread oder uring an!\n");
+                print_help();
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(*(argv + i - 1), "--io-depth") == 0 
+                && !ctx->benchmark_mode)
+        {
+            i++;
+            if (i >= argc || !parse_number(*(argv + i - 1), &ctx->io_depth)
+                    || ctx->io_depth == 0 || ctx->io_depth > IO_MAX_DEPTH)
+            {
+                printf("Geben Sie fuer --io-depth eine Anzahl von 1 bis %d "
+                       "an!\n", IO_MAX_DEPTH);
+                print_help();
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(*(argv + i - 1), "--no-cache") == 0 
+                && !ctx->benchmark_mode)
+        {
+            ctx->no_cache_mode = TRUE;
+        }
+        else if (strcmp(*(argv + i - 1), "--mem-limit") == 0 
+                && !ctx->benchmark_mode)
+        {
+            i++;
+            if (i >= argc || !parse_number(*(argv + i - 1), &ctx->mem_limit)
+                    || ctx->mem_limit == 0 
+                    || ctx->mem_limit > (unsigned long) -1 / 1024)
+            {
+                printf("Geben Sie fuer --mem-limit eine Groesse in KB an!\n");
+                print_help();
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(*(argv + i - 1), "-j") == 0 && !ctx->archive_mode
+                && !ctx->extract_mode && !ctx->list_mode
+                && !ctx->benchmark_mode && !ctx->train_mode)
+        {
+            i++;
+            if (i >= argc || !parse_number(*(argv + i - 1), &ctx->job_count)
+                    || ctx->job_count == 0)
+            {
+                printf("Geben Sie fuer -j eine Anzahl Threads an!\n");
+                print_help();
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (**(argv + i - 1) != '-' 
+                && (ctx->archive_mode || ctx->extract_mode || job_mode))
+        {
+            ctx->member_filenames[ctx->member_count++] = *(argv + i - 1);
+        }
+        else if (**(argv + i - 1) != '-' && *out_filename == NULL 
+                && !ctx->list_mode)
+        {
+            *out_filename = *(argv + i - 1);
         }
         else
         {
-            *out_filename = malloc((strlen(*in_filename) 
-                    + strlen(DECOMPRESS_EXT)) * sizeof(char));
-            strcpy(*out_filename, *in_filename);
-            strcat(*out_filename, DECOMPRESS_EXT);
+            printf("Sie haben einen ungueltigen Parameter angegeben!\n");
+            print_help();
+            exit(EXIT_FAILURE);
         }
     }
     
+    /* Nachrichten mit Woerterbuch haben keine Bloecke und keinen Header. */
+    if (ctx->dictionary_filename != NULL 
+            && (ctx->block_size > 0 || ctx->seek_index_interval > 0 
+                || ctx->range_mode || ctx->context_mode || ctx->wide_mode 
+                || ctx->rle_mode))
+    {
+        printf("--dict kann nicht mit --block, --index, --context, --wide, "
+               "--rle oder --range kombiniert werden!\n");
+        print_help();
+        exit(EXIT_FAILURE);
+    }
+    
+    /* Archive haben eigene Mitglieder statt Bereichen oder Nachrichten. */
+    if (ctx->archive_mode && ctx->member_count == 0)
+    {
+        printf("Geben Sie die Dateien fuer das Archiv an!\n");
+        print_help();
+        exit(EXIT_FAILURE);
+    }
+    if ((ctx->archive_mode || ctx->extract_mode || ctx->list_mode)
+            && (ctx->dictionary_filename != NULL 
+                || ctx->seek_index_interval > 0 || ctx->estimate_mode 
+                || ctx->range_mode))
+    {
+        printf("Archive koennen nicht mit --dict, --index, --estimate oder "
+               "--range kombiniert werden!\n");
+        print_help();
+        exit(EXIT_FAILURE);
+    }
+    
+    /*
+     * Mehrere Dateien haben keinen gemeinsamen Bereich und kein Woerterbuch,
+     * die Schaetzungen stuenden ohne Dateinamen durcheinander.
+     */
+    if (ctx->job_count > 0 
+            && (ctx->range_mode || ctx->dictionary_filename != NULL
+                || ctx->estimate_mode))
+    {
+        printf("-j kann nicht mit --range, --dict oder --estimate kombiniert "
+               "werden!\n");
+        print_help();
+        exit(EXIT_FAILURE);
+    }
+    
+    /*
+     * Die abgebildete Ausgabe wird ganz im Seitencache beschrieben und ist
+     * durch die Speichergrenze nicht begrenzt.
+     */
+    if (ctx->mmap_mode && ctx->mem_limit > 0)
+    {
+        printf("--mmap kann nicht mit --mem-limit kombiniert werden!\n");
+        print_help();
+        exit(EXIT_FAILURE);
+    }
+    
+    /* Die Stichprobe beschleunigt nur die Schaetzung. */
+    if (ctx->sample_percent > 0 && !ctx->estimate_mode)
+    {
+        printf("--sample kann nur mit --estimate verwendet werden!\n");
+        print_help();
+        exit(EXIT_FAILURE);
+    }
+    if (ctx->sample_percent == 0)
+    {
+        ctx->sample_percent = 100;
+    }
+    if (ctx->estimate_mode && ctx->dictionary_filename != NULL)
+    {
+        printf("--estimate kann nicht mit --dict kombiniert werden!\n");
+        print_help();
+        exit(EXIT_FAILURE);
+    }
+    
+    /* Sprungpunkte gibt es nur in einem durchgehenden Huffman-Code. */
+    if ((ctx->block_size > 0 || ctx->context_mode || ctx->wide_mode 
+                || ctx->rle_mode) 
+            && ctx->seek_index_interval > 0)
+    {
+        printf("--block, --context, --wide und --rle koennen nicht mit "
+               "--index kombiniert werden!\n");
+        print_help();
+        exit(EXIT_FAILURE);
+    }
+    
     /*
-     * Aktivierung des globalen Debug Modus fuer globale Ausgaben.
+     * Kontextmodelle, 16-Bit-Zeichen und Laeufe gibt es nur in Bloecken, die
+     * Mitglieder eines Archivs werden immer in Bloecken geschrieben.
      */
-    if (strcmp(*(p_argv_start + argc - 1), "-debug") == 0)
+    if ((ctx->context_mode || ctx->wide_mode || ctx->rle_mode 
+                || ctx->archive_mode) 
+            && ctx->block_size == 0)
     {
-        printf("\n\n\t**********************************\n");
-        printf("\t** Debug Modus wurde aktiviert. **\n");
-        printf("\t**********************************\n\n");
-        fflush(stdout);
-        debug_mode = TRUE;
+        ctx->block_size = MODEL_BLOCK_SIZE;
     }
+    
+    /* 
+     * Wenn kein out_filename angegeben wurde, wird Speicher allokiert fuer
+     * den in_filename + Dateiendung. Dies bildet dann den out_filename.
+     */
+    if (*out_filename == NULL && !ctx->benchmark_mode && !ctx->test_mode 
+            && !ctx->estimate_mode && !ctx->archive_mode && !ctx->extract_mode 
+            && !ctx->list_mode && ctx->job_count == 0)
+    {
+        *out_filename = build_out_filename(*in_filename, 
+                                           (ctx->train_mode) ? DICTIONARY_EXT
+                                           : (ctx->compress_mode) ? COMPRESS_EXT
+                                                             : DECOMPRESS_EXT);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: build_out_filename
+ *  ------------------------------------------------------------------------ */
+static char *build_out_filename(char *in_filename, char *extension)
+{
+    char *out_filename = malloc((strlen(in_filename) + strlen(extension) + 1)
+                                * sizeof(char));
+    ENSURE_ENOUGH_MEMORY(out_filename, "build_out_filename");
+    
+    strcpy(out_filename, in_filename);
+    strcat(out_filename, extension);
+    
+    return out_filename;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: parse_number
+ *  ------------------------------------------------------------------------ */
+static BOOL parse_number(char *text, unsigned long *value)
+{
+    char *p_end = NULL;
+    
+    if (text == NULL || *text < '0' || *text > '9')
+    {
+        return FALSE;
+    }
+    
+    errno = 0;
+    *value = strtoul(text, &p_end, 10);
+    
+    /* Zu grosse Zahlen liefert strtoul als ULONG_MAX mit ERANGE. */
+    return (*p_end == '\0' && errno != ERANGE) ? TRUE : FALSE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: parse_range
+ *  ------------------------------------------------------------------------ */
+static BOOL parse_range(HUFF_CTX *ctx, char *text)
+{
+    char *p_colon = strchr(text, ':');
+    BOOL success = FALSE;
+    
+    if (p_colon != NULL)
+    {
+        /* Trennen von Start und Laenge und beide Zahlen einzeln pruefen. */
+        *p_colon = '\0';
+        success = parse_number(text, &ctx->range_start) 
+                && parse_number(p_colon + 1, &ctx->range_length)
+                && ctx->range_length > 0;
+        *p_colon = ':';
+    }
+    
+    return success;
 }
 
 /** ---------------------------------------------------------------------------
@@ -156,7 +547,12 @@ extern void check_arguments(int argc,
 static void check_for_unknown_parameter(char *argv[])
 {
     if (strcmp(*argv, "-c") != 0 && strcmp(*argv, "-d") != 0 
-            && strcmp(*argv, "-h") != 0)
+            && strcmp(*argv, "-b") != 0 && strcmp(*argv, "-bm") != 0
+            && strcmp(*argv, "-bio") != 0
+            && strcmp(*argv, "-h") != 0
+            && strcmp(*argv, "-train") != 0 && strcmp(*argv, "-t") != 0
+            && strcmp(*argv, "-a") != 0 && strcmp(*argv, "-x") != 0
+            && strcmp(*argv, "-l") != 0)
     {
         if (strcmp(*argv, "-debug") == 0)
         {
@@ -180,7 +576,91 @@ static void print_help()
     printf("Hilfe:\n"
                 "-h zum Aufrufen der Hilfe.\n"
                 "-c zum Komprimieren einer Datei: -c Eingabedatei "
-            "[Ausgabedatei] [-debug]\n"
+            "[Ausgabedatei] [--index KB] [--block KB] [--context] "
+            "[--wide] [--rle] [--checksum] [--dict datei] "
+            "[--estimate [--sample P]] [--io name] [--no-cache] "
+            "[--mem-limit KB] [-debug]\n"
                 "-d zum Dekomprimieren einer Datei: -d Eingabedatei "
-            "[Ausgabedatei] [-debug]\n");
+            "[Ausgabedatei] [--range start:laenge] [--decoder name] "
+            "[--threads n] [--mmap] [--dict datei] [--io name] "
+            "[--no-cache] [--mem-limit KB] [-debug]\n");
+    printf("-b zum Vergleich der Dekodierer: -b Eingabedatei [-debug]\n"
+            "-bm zum Messen der Kosten je Nachricht: -bm Eingabedatei "
+            "[--dict datei]\n"
+            "-bio zum Messen der Ein-/Ausgabe: -bio Eingabedatei\n");
+    printf("-t zum Pruefen einer Datei ohne Ausgabe: -t Eingabedatei "
+            "[--range start:laenge] [--decoder name] [--threads n] "
+            "[--dict datei] [-debug]\n"
+            "-train zum Erstellen eines Woerterbuchs: -train Korpus "
+            "[Woerterbuch]\n"
+            "-a zum Packen eines Archivs: -a Archiv Datei [Datei ...] "
+            "[--shared] [Optionen von -c]\n"
+            "-x zum Entpacken eines Archivs: -x Archiv [Mitglied ...] "
+            "[--mmap] [-debug]\n"
+            "-l zum Anzeigen eines Archivs: -l Archiv\n"
+            "-j zum Bearbeiten mehrerer Dateien: -c|-d|-t Datei|Verzeichnis "
+            "[...] -j n [Optionen]\n");
+    printf("\n"
+                "--index KB        Schreibt alle KB Kilobyte einen "
+            "Sprungpunkt in die Datei.\n"
+                "--checksum        Schreibt die CRC32C jedes Blocks in die "
+            "Datei.\n"
+                "--block KB        Komprimiert in Bloecken von KB Kilobyte, "
+            "nicht\n"
+                "                  komprimierbare Bloecke werden gespeichert "
+            "(hoechstens 1 GB).\n");
+    printf(     "--context         Kodiert Bloecke mit bis zu 16 Codetabellen "
+            "je nach vorherigem\n"
+                "                  Zeichen (Standard: --block 1024).\n"
+                "--wide            Kodiert Bloecke auch mit 16-Bit-Zeichen "
+            "(Little Endian),\n"
+                "                  z.B. fuer UTF-16 oder Messwerte "
+            "(Standard: --block 1024).\n");
+    printf(     "--rle             Kodiert Bloecke auch mit Laufzeichen fuer "
+            "lange Wiederholungen\n"
+                "                  (Standard: --block 1024).\n"
+                "--range start:len Dekomprimiert nur laenge Zeichen ab "
+            "Position start.\n"
+                "--decoder name    Waehlt den Dekodierer tree, fsm oder table "
+            "(Standard: table).\n"
+                "--threads n       Dekodiert mit n Threads (nur table).\n");
+    printf(     "--mmap            Dekodiert direkt in die in den Speicher "
+            "abgebildete Ausgabedatei.\n"
+                "--dict datei      Kodiert Nachrichten ohne Header mit dem "
+            "Woerterbuch aus -train,\n"
+                "                  jede Nachricht beginnt mit dessen "
+            "Kennung.\n");
+    printf(     "--estimate        Berechnet nur die Groesse der komprimierten "
+            "Datei.\n"
+                "--sample P        Rechnet die Groesse aus P Prozent der "
+            "Eingabe hoch.\n"
+                "--shared          Schreibt eine gemeinsame Codetabelle fuer "
+            "alle Mitglieder.\n"
+                "--arena           Legt Baeume und Codes in einer Arena an, "
+            "die nach jedem Block\n"
+                "                  und jeder Datei auf einmal freigegeben "
+            "wird.\n");
+    printf(     "-j n              Bearbeitet alle Dateien mit n Threads, "
+            "grosse Dateien werden\n"
+                "                  beim Komprimieren in Bloecke geteilt "
+            "(Standard: --block 1024).\n");
+    printf(     "--io name         Liest und schreibt grosse Dateien mit sync, "
+            "thread oder uring\n"
+                "                  (Standard: sync), uring ohne Unterstuetzung "
+            "im Kernel mit Threads.\n"
+                "--io-depth n      Anzahl gleichzeitiger Anfragen je Datei "
+            "(Standard: %d).\n", IO_DEFAULT_DEPTH);
+    printf(     "--no-cache        Verwirft gelesene und geschriebene Seiten "
+            "aus dem Seitencache,\n"
+                "                  z.B. beim Archivieren sehr grosser "
+            "Datenmengen.\n");
+    printf(     "--mem-limit KB    Begrenzt den Speicher auf KB Kilobyte, "
+            "Bloecke, Puffer und Threads\n"
+                "                  werden angepasst, die Speicherspitze "
+            "wird ausgegeben. Liegt sie\n"
+                "                  ueber der Grenze, endet das Programm mit "
+            "einem Fehler.\n");
+    printf("\n"
+            "Die Umgebungsvariable HUFFMAN_NO_BMI2 erzwingt die portablen "
+            "Kernel,\nHUFFMAN_NO_SSE42 die CRC32C ohne SSE4.2.\n");
 }
@@ -20,15 +20,19 @@
 
 #define	ARGUMENT_CHECKER_H
 
+#include "huffman.h"
+
 /**
  * Diese Funktion ueberprueft die angegebenen Parameter auf Richtigkeit.
  * 
+ * @param ctx Zu fuellender Codec-Kontext
  * @param argc Anzahl der Parameter
  * @param argv Parameterliste
  * @param in_filename Name der Eingabedatei
  * @param out_filename Name der Ausgabedatei
  */
-extern void check_arguments(int argc,
+extern void check_arguments(HUFF_CTX *ctx,
+                              int argc,
                               char **argv,
                               char **in_filename,
                               char **out_filename);
@@ -0,0 +1,1303 @@
+/**
+ * File: async_io.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+/*
+ * io_uring hat keine Funktionen in der C-Bibliothek, die Systemaufrufe
+ * werden ueber syscall() mit den Ringen aus <linux/io_uring.h> gemacht.
+ * Mit -DASYNC_IO_NO_URING wird immer das Verfahren mit Threads verwendet.
+ */
+#if defined(__linux__) && defined(__GNUC__) && !defined(ASYNC_IO_NO_URING)
+#define _GNU_SOURCE
+#define ASYNC_IO_HAVE_URING
+#endif
+
+/*
+ * Mit sync_file_range werden geschriebene Seiten ohne fsync der ganzen
+ * Datei auf die Platte gebracht, mincore zeigt die Seiten im Cache.
+ */
+#if defined(__linux__)
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#define ASYNC_IO_HAVE_LINUX
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef ASYNC_IO_HAVE_LINUX
+#include <sys/mman.h>
+#endif
+#ifdef ASYNC_IO_HAVE_URING
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#endif
+#include "common.h"
+#include "async_io.h"
+
+/** Puffer ohne Anfrage. */
+#define SLOT_FREE 0
+
+/** Anfrage wartet auf einen Thread. */
+#define SLOT_QUEUED 1
+
+/** Anfrage laeuft. */
+#define SLOT_RUNNING 2
+
+/** Anfrage ist abgeschlossen, aber noch nicht ausgewertet. */
+#define SLOT_DONE 3
+
+/** Anfrage ist ausgewertet, die Daten koennen verwendet werden. */
+#define SLOT_COMPLETE 4
+
+/** Hoechstens gestartete Threads des Verfahrens mit Threads. */
+#define IO_MAX_THREADS 16
+
+/** Zustand des Verfahrens mit Threads. */
+typedef struct _THREAD_BACKEND
+{
+    /**
+     * Gestartete Threads
+     */
+    pthread_t *threads;
+    /**
+     * Anzahl gestarteter Threads
+     */
+    unsigned int thread_count;
+    /**
+     * Schuetzt die Zustaende aller Puffer
+     */
+    pthread_mutex_t lock;
+    /**
+     * Signalisiert eine neue Anfrage
+     */
+    pthread_cond_t queued;
+    /**
+     * Signalisiert eine abgeschlossene Anfrage
+     */
+    pthread_cond_t done;
+    /**
+     * TRUE wenn die Threads enden sollen
+     */
+    BOOL stop;
+} THREAD_BACKEND;
+
+#ifdef ASYNC_IO_HAVE_URING
+/** Zustand des Verfahrens mit io_uring. */
+typedef struct _URING_BACKEND
+{
+    /**
+     * Dateideskriptor des Rings
+     */
+    int descriptor;
+    /**
+     * Abgebildeter Ring der Anfragen
+     */
+    unsigned char *p_sq_ring;
+    /**
+     * Groesse des Rings der Anfragen
+     */
+    size_t sq_ring_size;
+    /**
+     * Abgebildeter Ring der Ergebnisse
+     */
+    unsigned char *p_cq_ring;
+    /**
+     * Groesse des Rings der Ergebnisse
+     */
+    size_t cq_ring_size;
+    /**
+     * Abgebildete Anfragen
+     */
+    struct io_uring_sqe *sqes;
+    /**
+     * Groesse der Anfragen
+     */
+    size_t sqes_size;
+    /**
+     * Zeiger in den Ring der Anfragen
+     */
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    /**
+     * Zeiger in den Ring der Ergebnisse
+     */
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    struct io_uring_cqe *cqes;
+    /**
+     * Ein Puffereintrag je Anfrage fuer READV und WRITEV
+     */
+    struct iovec *iovecs;
+} URING_BACKEND;
+#endif
+
+/**
+ * Diese Funktion legt die Puffer an und richtet das Verfahren ein. Kann
+ * io_uring nicht eingerichtet werden, werden Threads verwendet, laesst sich
+ * kein Thread starten, wird mit fread und fwrite gearbeitet.
+ *
+ * @param io Leser oder Schreiber mit gesetztem backend und depth
+ */
+static void open_backend(ASYNC_IO *io);
+
+/**
+ * Diese Funktion stellt die Anfrage eines Puffers.
+ *
+ * @param io Leser oder Schreiber
+ * @param index Index des Puffers
+ */
+static void submit_slot(ASYNC_IO *io, unsigned int index);
+
+/**
+ * Diese Funktion wartet auf die Anfrage eines Puffers, ergaenzt kurze
+ * Ergebnisse und beendet das Programm bei einem Fehler. Danach ist der
+ * Puffer SLOT_COMPLETE.
+ *
+ * @param io Leser oder Schreiber
+ * @param index Index des Puffers
+ */
+static void wait_slot(ASYNC_IO *io, unsigned int index);
+
+/**
+ * Diese Funktion setzt den Zustand eines Puffers, den die Threads des
+ * Verfahrens mit Threads gleichzeitig lesen.
+ *
+ * @param io Leser oder Schreiber
+ * @param index Index des Puffers
+ * @param state Neuer Zustand
+ */
+static void set_slot_state(ASYNC_IO *io, unsigned int index, int state);
+
+/**
+ * Diese Funktion liest den Zustand eines Puffers, den die Threads des
+ * Verfahrens mit Threads gleichzeitig setzen.
+ *
+ * @param io Leser oder Schreiber
+ * @param index Index des Puffers
+ * @return Zustand des Puffers
+ */
+static int get_slot_state(ASYNC_IO *io, unsigned int index);
+
+/**
+ * Diese Funktion stellt fuer den aktuellen Puffer eines Schreibers die
+ * Anfrage und geht zum naechsten Puffer weiter.
+ *
+ * @param io Schreiber
+ */
+static void flush_current(ASYNC_IO *io);
+
+/**
+ * Diese Funktion uebertraegt den Rest einer Anfrage ab done mit pread bzw.
+ * pwrite.
+ *
+ * @param io Leser oder Schreiber
+ * @param slot Puffer der Anfrage
+ * @param done Bereits uebertragene Byte
+ * @return Insgesamt uebertragene Byte, -1 bei einem Fehler
+ */
+static long transfer(ASYNC_IO *io, IO_SLOT *slot, unsigned long done);
+
+/**
+ * Diese Funktion startet die Threads des Verfahrens mit Threads.
+ *
+ * @param io Leser oder Schreiber
+ * @return FALSE wenn kein Thread gestartet werden konnte
+ */
+static BOOL thread_init(ASYNC_IO *io);
+
+/**
+ * Diese Funktion ist der Einstiegspunkt der Threads. Jeder Thread nimmt
+ * die wartende Anfrage mit der kleinsten Position und fuehrt sie aus.
+ *
+ * @param p_arg Leser oder Schreiber
+ * @return NULL
+ */
+static void *run_thread(void *p_arg);
+
+/**
+ * Diese Funktion beendet die Threads und gibt ihren Zustand frei.
+ *
+ * @param io Leser oder Schreiber
+ */
+static void thread_destroy(ASYNC_IO *io);
+
+/**
+ * Diese Funktion stoesst das Schreiben eines Bereichs an, ohne darauf zu
+ * warten.
+ *
+ * @param descriptor Dateideskriptor
+ * @param offset Anfang des Bereichs
+ * @param length Laenge des Bereichs
+ */
+static void start_writeback(int descriptor,
+                            unsigned long offset,
+                            unsigned long length);
+
+/**
+ * Diese Funktion schreibt einen Bereich und wartet, bis er auf der Platte
+ * ist. Ohne sync_file_range wird die ganze Datei geschrieben.
+ *
+ * @param descriptor Dateideskriptor
+ * @param offset Anfang des Bereichs
+ * @param length Laenge des Bereichs, 0 bis zum Dateiende
+ */
+static void wait_writeback(int descriptor,
+                           unsigned long offset,
+                           unsigned long length);
+
+#ifdef ASYNC_IO_HAVE_URING
+/**
+ * Diese Funktion richtet den io_uring ein und bildet die Ringe ab.
+ *
+ * @param io Leser oder Schreiber
+ * @return FALSE wenn der Kernel io_uring nicht unterstuetzt
+ */
+static BOOL uring_init(ASYNC_IO *io);
+
+/**
+ * Diese Funktion uebernimmt alle vorliegenden Ergebnisse in die Puffer.
+ *
+ * @param io Leser oder Schreiber
+ */
+static void uring_reap(ASYNC_IO *io);
+
+/**
+ * Diese Funktion hebt die Abbildungen auf und schliesst den Ring.
+ *
+ * @param io Leser oder Schreiber
+ */
+static void uring_destroy(ASYNC_IO *io);
+#endif
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_open_reader
+ *  ------------------------------------------------------------------------ */
+extern ASYNC_IO *async_io_open_reader(FILE *stream,
+                                      unsigned long length,
+                                      unsigned int backend,
+                                      unsigned long depth)
+{
+    struct stat info;
+    unsigned long start;
+    unsigned long chunk_count;
+    unsigned int i;
+    ASYNC_IO *io = calloc(1, sizeof(ASYNC_IO));
+    ENSURE_ENOUGH_MEMORY(io, "async_io_open_reader");
+
+    io->stream = stream;
+    io->writing = FALSE;
+    io->backend = IO_BACKEND_SYNC;
+    io->cursor = (unsigned long) ftell(stream);
+    async_io_cache_init(&io->cache, stream, FALSE, 
+                        ((backend & IO_NO_CACHE) != 0) ? TRUE : FALSE);
+    backend &= ~IO_NO_CACHE;
+    if (backend == IO_BACKEND_SYNC)
+    {
+        return io;
+    }
+
+    /* Der Bereich endet spaetestens am Dateiende. */
+    io->descriptor = fileno(stream);
+    start = (unsigned long) ftell(stream);
+    if (fstat(io->descriptor, &info) != 0
+            || (unsigned long) info.st_size <= start)
+    {
+        return io;
+    }
+    if (length > (unsigned long) info.st_size - start)
+    {
+        length = (unsigned long) info.st_size - start;
+    }
+    if (length <= IO_CHUNK_SIZE)
+    {
+        return io;
+    }
+
+    chunk_count = (length + IO_CHUNK_SIZE - 1) / IO_CHUNK_SIZE;
+    io->backend = backend;
+    io->depth = (depth == 0) ? IO_DEFAULT_DEPTH
+              : (depth > IO_MAX_DEPTH) ? IO_MAX_DEPTH : (unsigned int) depth;
+    if (io->depth > chunk_count)
+    {
+        io->depth = (unsigned int) chunk_count;
+    }
+    io->next_offset = start;
+    io->end_offset = start + length;
+    open_backend(io);
+
+    /* Alle Puffer sofort anfordern, gelesen wird spaeter in Reihenfolge. */
+    for (i = 0; i < io->depth && io->backend != IO_BACKEND_SYNC; i++)
+    {
+        io->slots[i].offset = io->next_offset;
+        io->slots[i].length = (io->end_offset - io->next_offset
+                               < IO_CHUNK_SIZE)
+                            ? io->end_offset - io->next_offset
+                            : IO_CHUNK_SIZE;
+        io->next_offset += io->slots[i].length;
+        submit_slot(io, i);
+    }
+
+    return io;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_open_writer
+ *  ------------------------------------------------------------------------ */
+extern ASYNC_IO *async_io_open_writer(FILE *stream,
+                                      unsigned int backend,
+                                      unsigned long depth)
+{
+    ASYNC_IO *io = calloc(1, sizeof(ASYNC_IO));
+    ENSURE_ENOUGH_MEMORY(io, "async_io_open_writer");
+
+    io->stream = stream;
+    io->writing = TRUE;
+    io->cursor = (unsigned long) ftell(stream);
+    async_io_cache_init(&io->cache, stream, TRUE, 
+                        ((backend & IO_NO_CACHE) != 0) ? TRUE : FALSE);
+    io->backend = backend & ~IO_NO_CACHE;
+    if (io->backend == IO_BACKEND_SYNC)
+    {
+        return io;
+    }
+
+    /* Bereits gepufferte Daten des Stroms stehen vor den eigenen. */
+    if (fflush(stream) != 0)
+    {
+        printf("Fehler beim schreiben der Ausgabedatei.\n");
+        exit(EXIT_FAILURE);
+    }
+    io->descriptor = fileno(stream);
+    io->next_offset = (unsigned long) ftell(stream);
+    io->depth = (depth == 0) ? IO_DEFAULT_DEPTH
+              : (depth > IO_MAX_DEPTH) ? IO_MAX_DEPTH : (unsigned int) depth;
+    open_backend(io);
+
+    return io;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: open_backend
+ *  ------------------------------------------------------------------------ */
+static void open_backend(ASYNC_IO *io)
+{
+    unsigned int i;
+
+    io->slots = calloc(io->depth, sizeof(IO_SLOT));
+    ENSURE_ENOUGH_MEMORY(io->slots, "open_backend");
+    for (i = 0; i < io->depth; i++)
+    {
+        io->slots[i].p_data = malloc(IO_CHUNK_SIZE);
+        ENSURE_ENOUGH_MEMORY(io->slots[i].p_data, "open_backend");
+    }
+
+#ifdef ASYNC_IO_HAVE_URING
+    if (io->backend == IO_BACKEND_URING && uring_init(io))
+    {
+        return;
+    }
+#endif
+    io->backend = IO_BACKEND_THREAD;
+    if (thread_init(io))
+    {
+        return;
+    }
+
+    for (i = 0; i < io->depth; i++)
+    {
+        free(io->slots[i].p_data);
+    }
+    free(io->slots);
+    io->slots = NULL;
+    io->backend = IO_BACKEND_SYNC;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_read
+ *  ------------------------------------------------------------------------ */
+extern unsigned long async_io_read(ASYNC_IO *io,
+                                   unsigned char *p_buffer,
+                                   unsigned long length)
+{
+    unsigned long total = 0;
+    unsigned long available;
+    IO_SLOT *slot;
+    int state;
+
+    if (io->backend == IO_BACKEND_SYNC)
+    {
+        total = (unsigned long) fread(p_buffer, sizeof(unsigned char), length,
+                                      io->stream);
+        if (total < length && ferror(io->stream))
+        {
+            printf("Fehler beim Lesen der Datei.\n");
+            exit(EXIT_FAILURE);
+        }
+        length = total;
+    }
+
+    while (total < length)
+    {
+        slot = io->slots + io->current;
+        state = get_slot_state(io, io->current);
+        if (state == SLOT_FREE)
+        {
+            break;
+        }
+        if (state != SLOT_COMPLETE)
+        {
+            wait_slot(io, io->current);
+        }
+
+        /*
+         * Ein ausgelesener Puffer fordert sofort den naechsten noch nicht
+         * angeforderten Abschnitt an.
+         */
+        available = (unsigned long) slot->result - io->position;
+        if (available == 0)
+        {
+            set_slot_state(io, io->current, SLOT_FREE);
+            if (io->next_offset < io->end_offset)
+            {
+                slot->offset = io->next_offset;
+                slot->length = (io->end_offset - io->next_offset
+                                < IO_CHUNK_SIZE)
+                             ? io->end_offset - io->next_offset
+                             : IO_CHUNK_SIZE;
+                io->next_offset += slot->length;
+                submit_slot(io, io->current);
+            }
+            io->current = (io->current + 1) % io->depth;
+            io->position = 0;
+            continue;
+        }
+
+        if (available > length - total)
+        {
+            available = length - total;
+        }
+        memcpy(p_buffer + total, slot->p_data + io->position, available);
+        io->position += available;
+        total += available;
+    }
+
+    io->cursor += total;
+    async_io_cache_release(&io->cache, io->cursor);
+
+    return total;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_write
+ *  ------------------------------------------------------------------------ */
+extern void async_io_write(ASYNC_IO *io,
+                           unsigned char *p_buffer,
+                           unsigned long length)
+{
+    unsigned long take;
+    unsigned long in_flight = 
+            (unsigned long) (io->depth + 1) * IO_CHUNK_SIZE;
+    int state;
+
+    io->cursor += length;
+    if (io->backend == IO_BACKEND_SYNC)
+    {
+        if (length > 0
+                && fwrite(p_buffer, sizeof(unsigned char), length, io->stream)
+                    != length)
+        {
+            printf("Fehler beim schreiben der Ausgabedatei.\n");
+            exit(EXIT_FAILURE);
+        }
+        length = 0;
+    }
+
+    while (length > 0)
+    {
+        /* Ein Puffer wird erst nach seiner letzten Anfrage neu gefuellt. */
+        state = get_slot_state(io, io->current);
+        if (state != SLOT_FREE)
+        {
+            if (state != SLOT_COMPLETE)
+            {
+                wait_slot(io, io->current);
+            }
+            set_slot_state(io, io->current, SLOT_FREE);
+        }
+
+        take = IO_CHUNK_SIZE - io->position;
+        if (take > length)
+        {
+            take = length;
+        }
+        memcpy(io->slots[io->current].p_data + io->position, p_buffer, take);
+        io->position += take;
+        p_buffer += take;
+        length -= take;
+
+        if (io->position == IO_CHUNK_SIZE)
+        {
+            flush_current(io);
+        }
+    }
+
+    /*
+     * Ein Puffer wird erst nach dem Ende seiner Anfrage neu gefuellt, die
+     * Daten vor den Puffern und dem aktuellen Puffer liegen also schon im
+     * Seitencache und koennen verworfen werden.
+     */
+    if (io->cursor > in_flight)
+    {
+        async_io_cache_release(&io->cache, io->cursor - in_flight);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: flush_current
+ *  ------------------------------------------------------------------------ */
+static void flush_current(ASYNC_IO *io)
+{
+    IO_SLOT *slot = io->slots + io->current;
+
+    slot->offset = io->next_offset;
+    slot->length = io->position;
+    io->next_offset += io->position;
+    submit_slot(io, io->current);
+
+    io->current = (io->current + 1) % io->depth;
+    io->position = 0;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_close
+ *  ------------------------------------------------------------------------ */
+extern void async_io_close(ASYNC_IO *io)
+{
+    unsigned long end;
+    unsigned int i;
+    int state;
+
+    if (io->backend == IO_BACKEND_SYNC)
+    {
+        async_io_cache_finish(&io->cache);
+        free(io);
+        return;
+    }
+
+    if (io->writing && io->position > 0)
+    {
+        state = get_slot_state(io, io->current);
+        if (state != SLOT_FREE)
+        {
+            if (state != SLOT_COMPLETE)
+            {
+                wait_slot(io, io->current);
+            }
+            set_slot_state(io, io->current, SLOT_FREE);
+        }
+        flush_current(io);
+    }
+
+    /*
+     * Ein Leser steht hinter dem zuletzt gelesenen Byte, ein Schreiber
+     * hinter dem zuletzt geschriebenen.
+     */
+    end = io->next_offset;
+    if (!io->writing && get_slot_state(io, io->current) != SLOT_FREE)
+    {
+        end = io->slots[io->current].offset + io->position;
+    }
+
+    for (i = 0; i < io->depth; i++)
+    {
+        state = get_slot_state(io, i);
+        if (state != SLOT_FREE && state != SLOT_COMPLETE)
+        {
+            wait_slot(io, i);
+        }
+    }
+
+#ifdef ASYNC_IO_HAVE_URING
+    if (io->backend == IO_BACKEND_URING)
+    {
+        uring_destroy(io);
+    }
+#endif
+    if (io->backend == IO_BACKEND_THREAD)
+    {
+        thread_destroy(io);
+    }
+
+    if (fseek(io->stream, (long) end, SEEK_SET) != 0)
+    {
+        printf("Fehler beim Positionieren in der Datei.\n");
+        exit(EXIT_FAILURE);
+    }
+    async_io_cache_finish(&io->cache);
+
+    for (i = 0; i < io->depth; i++)
+    {
+        free(io->slots[i].p_data);
+    }
+    free(io->slots);
+    free(io);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: submit_slot
+ *  ------------------------------------------------------------------------ */
+static void submit_slot(ASYNC_IO *io, unsigned int index)
+{
+    IO_SLOT *slot = io->slots + index;
+    THREAD_BACKEND *threads;
+#ifdef ASYNC_IO_HAVE_URING
+    URING_BACKEND *ring;
+    struct io_uring_sqe *sqe;
+    unsigned int tail;
+    long submitted;
+#endif
+
+    io->in_flight++;
+    io->request_count++;
+    if (io->in_flight > io->peak_depth)
+    {
+        io->peak_depth = io->in_flight;
+    }
+    slot->result = 0;
+
+#ifdef ASYNC_IO_HAVE_URING
+    if (io->backend == IO_BACKEND_URING)
+    {
+        ring = (URING_BACKEND*) io->p_backend;
+        slot->state = SLOT_RUNNING;
+        ring->iovecs[index].iov_base = slot->p_data;
+        ring->iovecs[index].iov_len = slot->length;
+
+        tail = *ring->sq_tail;
+        sqe = ring->sqes + (tail & *ring->sq_mask);
+        memset(sqe, 0, sizeof(struct io_uring_sqe));
+        sqe->opcode = (io->writing) ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe->fd = io->descriptor;
+        sqe->addr = (unsigned long) (ring->iovecs + index);
+        sqe->len = 1;
+        sqe->off = slot->offset;
+        sqe->user_data = index;
+        ring->sq_array[tail & *ring->sq_mask] = tail & *ring->sq_mask;
+        __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        do
+        {
+            submitted = syscall(__NR_io_uring_enter, ring->descriptor, 1, 0,
+                                0, NULL, 0);
+        }
+        while (submitted < 0 && errno == EINTR);
+        if (submitted != 1)
+        {
+            printf("io_uring Anfrage fehlgeschlagen.\n");
+            exit(EXIT_FAILURE);
+        }
+        return;
+    }
+#endif
+
+    threads = (THREAD_BACKEND*) io->p_backend;
+    pthread_mutex_lock(&threads->lock);
+    slot->state = SLOT_QUEUED;
+    pthread_cond_signal(&threads->queued);
+    pthread_mutex_unlock(&threads->lock);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: wait_slot
+ *  ------------------------------------------------------------------------ */
+static void wait_slot(ASYNC_IO *io, unsigned int index)
+{
+    IO_SLOT *slot = io->slots + index;
+    THREAD_BACKEND *threads;
+#ifdef ASYNC_IO_HAVE_URING
+    URING_BACKEND *ring;
+
+    if (io->backend == IO_BACKEND_URING)
+    {
+        ring = (URING_BACKEND*) io->p_backend;
+        uring_reap(io);
+        while (slot->state != SLOT_DONE)
+        {
+            if (syscall(__NR_io_uring_enter, ring->descriptor, 0, 1,
+                        IORING_ENTER_GETEVENTS, NULL, 0) < 0
+                    && errno != EINTR)
+            {
+                printf("io_uring Anfrage fehlgeschlagen.\n");
+                exit(EXIT_FAILURE);
+            }
+            uring_reap(io);
+        }
+    }
+#endif
+    if (io->backend == IO_BACKEND_THREAD)
+    {
+        threads = (THREAD_BACKEND*) io->p_backend;
+        pthread_mutex_lock(&threads->lock);
+        while (slot->state != SLOT_DONE)
+        {
+            pthread_cond_wait(&threads->done, &threads->lock);
+        }
+        pthread_mutex_unlock(&threads->lock);
+    }
+    io->in_flight--;
+
+    /* Kurze Ergebnisse vor dem Dateiende werden synchron ergaenzt. */
+    if (slot->result >= 0 && (unsigned long) slot->result < slot->length)
+    {
+        slot->result = transfer(io, slot, (unsigned long) slot->result);
+    }
+    if (slot->result < 0
+            || (io->writing && (unsigned long) slot->result != slot->length))
+    {
+        printf((io->writing) ? "Fehler beim schreiben der Ausgabedatei.\n"
+                             : "Fehler beim Lesen der Datei.\n");
+        exit(EXIT_FAILURE);
+    }
+    set_slot_state(io, index, SLOT_COMPLETE);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: set_slot_state
+ *  ------------------------------------------------------------------------ */
+static void set_slot_state(ASYNC_IO *io, unsigned int index, int state)
+{
+    THREAD_BACKEND *threads;
+
+    if (io->backend == IO_BACKEND_THREAD)
+    {
+        threads = (THREAD_BACKEND*) io->p_backend;
+        pthread_mutex_lock(&threads->lock);
+        io->slots[index].state = state;
+        pthread_mutex_unlock(&threads->lock);
+    }
+    else
+    {
+        io->slots[index].state = state;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: get_slot_state
+ *  ------------------------------------------------------------------------ */
+static int get_slot_state(ASYNC_IO *io, unsigned int index)
+{
+    THREAD_BACKEND *threads;
+    int state;
+
+    if (io->backend != IO_BACKEND_THREAD)
+    {
+        return io->slots[index].state;
+    }
+
+    threads = (THREAD_BACKEND*) io->p_backend;
+    pthread_mutex_lock(&threads->lock);
+    state = io->slots[index].state;
+    pthread_mutex_unlock(&threads->lock);
+
+    return state;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: transfer
+ *  ------------------------------------------------------------------------ */
+static long transfer(ASYNC_IO *io, IO_SLOT *slot, unsigned long done)
+{
+    ssize_t count;
+
+    while (done < slot->length)
+    {
+        if (io->writing)
+        {
+            count = pwrite(io->descriptor, slot->p_data + done,
+                           slot->length - done, (off_t) (slot->offset + done));
+        }
+        else
+        {
+            count = pread(io->descriptor, slot->p_data + done,
+                          slot->length - done, (off_t) (slot->offset + done));
+        }
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count < 0)
+        {
+            return -1;
+        }
+        if (count == 0)
+        {
+            /* Dateiende beim Lesen. */
+            break;
+        }
+        done += (unsigned long) count;
+    }
+
+    return (long) done;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: thread_init
+ *  ------------------------------------------------------------------------ */
+static BOOL thread_init(ASYNC_IO *io)
+{
+    unsigned int count = (io->depth < IO_MAX_THREADS)
+                       ? io->depth : IO_MAX_THREADS;
+    THREAD_BACKEND *threads = calloc(1, sizeof(THREAD_BACKEND));
+    ENSURE_ENOUGH_MEMORY(threads, "thread_init");
+    threads->threads = calloc(count, sizeof(pthread_t));
+    ENSURE_ENOUGH_MEMORY(threads->threads, "thread_init");
+
+    pthread_mutex_init(&threads->lock, NULL);
+    pthread_cond_init(&threads->queued, NULL);
+    pthread_cond_init(&threads->done, NULL);
+    io->p_backend = threads;
+
+    /* Es reicht, wenn ein Teil der Threads startet. */
+    while (threads->thread_count < count
+            && pthread_create(threads->threads + threads->thread_count, NULL,
+                              run_thread, io) == 0)
+    {
+        threads->thread_count++;
+    }
+    if (threads->thread_count == 0)
+    {
+        thread_destroy(io);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: run_thread
+ *  ------------------------------------------------------------------------ */
+static void *run_thread(void *p_arg)
+{
+    ASYNC_IO *io = (ASYNC_IO*) p_arg;
+    THREAD_BACKEND *threads = (THREAD_BACKEND*) io->p_backend;
+    IO_SLOT *slot;
+    long result;
+    unsigned int i;
+
+    pthread_mutex_lock(&threads->lock);
+    for (;;)
+    {
+        /* Die Anfrage mit der kleinsten Position liegt am naechsten. */
+        slot = NULL;
+        for (i = 0; i < io->depth; i++)
+        {
+            if (io->slots[i].state == SLOT_QUEUED
+                    && (slot == NULL || io->slots[i].offset < slot->offset))
+            {
+                slot = io->slots + i;
+            }
+        }
+        if (slot == NULL && threads->stop)
+        {
+            break;
+        }
+        if (slot == NULL)
+        {
+            pthread_cond_wait(&threads->queued, &threads->lock);
+            continue;
+        }
+
+        slot->state = SLOT_RUNNING;
+        pthread_mutex_unlock(&threads->lock);
+        result = transfer(io, slot, 0);
+        pthread_mutex_lock(&threads->lock);
+        slot->result = result;
+        slot->state = SLOT_DONE;
+        pthread_cond_broadcast(&threads->done);
+    }
+    pthread_mutex_unlock(&threads->lock);
+
+    return NULL;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: thread_destroy
+ *  ------------------------------------------------------------------------ */
+static void thread_destroy(ASYNC_IO *io)
+{
+    THREAD_BACKEND *threads = (THREAD_BACKEND*) io->p_backend;
+    unsigned int i;
+
+    pthread_mutex_lock(&threads->lock);
+    threads->stop = TRUE;
+    pthread_cond_broadcast(&threads->queued);
+    pthread_mutex_unlock(&threads->lock);
+    for (i = 0; i < threads->thread_count; i++)
+    {
+        pthread_join(threads->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&threads->lock);
+    pthread_cond_destroy(&threads->queued);
+    pthread_cond_destroy(&threads->done);
+    free(threads->threads);
+    free(threads);
+    io->p_backend = NULL;
+}
+
+#ifdef ASYNC_IO_HAVE_URING
+/** ---------------------------------------------------------------------------
+ *  Funktion: uring_init
+ *  ------------------------------------------------------------------------ */
+static BOOL uring_init(ASYNC_IO *io)
+{
+    struct io_uring_params params;
+    URING_BACKEND *ring = calloc(1, sizeof(URING_BACKEND));
+    ENSURE_ENOUGH_MEMORY(ring, "uring_init");
+
+    memset(&params, 0, sizeof(params));
+    ring->descriptor = (int) syscall(__NR_io_uring_setup, io->depth, &params);
+    if (ring->descriptor < 0)
+    {
+        free(ring);
+        return FALSE;
+    }
+    io->p_backend = ring;
+
+    /*
+     * Beide Ringe und die Anfragen werden getrennt abgebildet, das
+     * funktioniert auch auf Kerneln ohne IORING_FEAT_SINGLE_MMAP.
+     */
+    ring->sq_ring_size = params.sq_off.array
+                       + params.sq_entries * sizeof(unsigned int);
+    ring->cq_ring_size = params.cq_off.cqes
+                       + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->p_sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, ring->descriptor, IORING_OFF_SQ_RING);
+    ring->p_cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, ring->descriptor, IORING_OFF_CQ_RING);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, ring->descriptor, IORING_OFF_SQES);
+    if (ring->p_sq_ring == MAP_FAILED || ring->p_cq_ring == MAP_FAILED
+            || ring->sqes == MAP_FAILED)
+    {
+        uring_destroy(io);
+        return FALSE;
+    }
+
+    ring->sq_tail = (unsigned int*) (ring->p_sq_ring + params.sq_off.tail);
+    ring->sq_mask = (unsigned int*) (ring->p_sq_ring
+                                     + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned int*) (ring->p_sq_ring + params.sq_off.array);
+    ring->cq_head = (unsigned int*) (ring->p_cq_ring + params.cq_off.head);
+    ring->cq_tail = (unsigned int*) (ring->p_cq_ring + params.cq_off.tail);
+    ring->cq_mask = (unsigned int*) (ring->p_cq_ring
+                                     + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*) (ring->p_cq_ring + params.cq_off.cqes);
+    ring->iovecs = calloc(io->depth, sizeof(struct iovec));
+    ENSURE_ENOUGH_MEMORY(ring->iovecs, "uring_init");
+
+    return TRUE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: uring_reap
+ *  ------------------------------------------------------------------------ */
+static void uring_reap(ASYNC_IO *io)
+{
+    URING_BACKEND *ring = (URING_BACKEND*) io->p_backend;
+    unsigned int head = *ring->cq_head;
+    unsigned int tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    struct io_uring_cqe *cqe;
+
+    while (head != tail)
+    {
+        cqe = ring->cqes + (head & *ring->cq_mask);
+        io->slots[cqe->user_data].result = (cqe->res < 0) ? -1 : cqe->res;
+        io->slots[cqe->user_data].state = SLOT_DONE;
+        head++;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: uring_destroy
+ *  ------------------------------------------------------------------------ */
+static void uring_destroy(ASYNC_IO *io)
+{
+    URING_BACKEND *ring = (URING_BACKEND*) io->p_backend;
+
+    if (ring->p_sq_ring != NULL && ring->p_sq_ring != MAP_FAILED)
+    {
+        munmap(ring->p_sq_ring, ring->sq_ring_size);
+    }
+    if (ring->p_cq_ring != NULL && ring->p_cq_ring != MAP_FAILED)
+    {
+        munmap(ring->p_cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sqes != NULL && (void*) ring->sqes != MAP_FAILED)
+    {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    close(ring->descriptor);
+    free(ring->iovecs);
+    free(ring);
+    io->p_backend = NULL;
+}
+#endif
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_uring_available
+ *  ------------------------------------------------------------------------ */
+extern BOOL async_io_uring_available(void)
+{
+#ifdef ASYNC_IO_HAVE_URING
+    struct io_uring_params params;
+    int descriptor;
+
+    memset(&params, 0, sizeof(params));
+    descriptor = (int) syscall(__NR_io_uring_setup, 1, &params);
+    if (descriptor >= 0)
+    {
+        close(descriptor);
+        return TRUE;
+    }
+#endif
+    return FALSE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_backend_name
+ *  ------------------------------------------------------------------------ */
+extern char *async_io_backend_name(unsigned int backend)
+{
+    if (backend == IO_BACKEND_URING)
+    {
+        return "uring";
+    }
+    if (backend == IO_BACKEND_THREAD)
+    {
+        return "thread";
+    }
+    return "sync";
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_seconds
+ *  ------------------------------------------------------------------------ */
+extern double async_io_seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_drop_cache
+ *  ------------------------------------------------------------------------ */
+extern void async_io_drop_cache(FILE *stream)
+{
+    fflush(stream);
+    fsync(fileno(stream));
+    posix_fadvise(fileno(stream), 0, 0, POSIX_FADV_DONTNEED);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_cache_init
+ *  ------------------------------------------------------------------------ */
+extern void async_io_cache_init(IO_CACHE *cache,
+                                FILE *stream,
+                                BOOL writing,
+                                BOOL enabled)
+{
+    long position = ftell(stream);
+
+    cache->stream = stream;
+    cache->descriptor = (enabled && position >= 0) ? fileno(stream) : -1;
+    cache->writing = writing;
+    cache->start = (position >= 0) ? (unsigned long) position : 0;
+    cache->flushed = cache->start;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_cache_release
+ *  ------------------------------------------------------------------------ */
+extern void async_io_cache_release(IO_CACHE *cache, unsigned long position)
+{
+    unsigned long end = position - position % IO_CACHE_WINDOW;
+
+    if (cache->descriptor < 0)
+    {
+        return;
+    }
+
+    if (!cache->writing)
+    {
+        if (end > cache->start)
+        {
+            posix_fadvise(cache->descriptor, (off_t) cache->start,
+                          (off_t) (end - cache->start), POSIX_FADV_DONTNEED);
+            cache->start = end;
+        }
+        return;
+    }
+
+    /*
+     * Das neue Fenster wird nur zum Schreiben angestossen. Das vorherige
+     * ist inzwischen meist auf der Platte, das Warten darauf haelt den
+     * Kodierer kaum auf.
+     */
+    if (end > cache->flushed)
+    {
+        start_writeback(cache->descriptor, cache->flushed, 
+                        end - cache->flushed);
+        cache->flushed = end;
+    }
+    end = (cache->flushed > IO_CACHE_WINDOW) 
+        ? cache->flushed - IO_CACHE_WINDOW : 0;
+    if (end > cache->start)
+    {
+        wait_writeback(cache->descriptor, cache->start, end - cache->start);
+        posix_fadvise(cache->descriptor, (off_t) cache->start,
+                      (off_t) (end - cache->start), POSIX_FADV_DONTNEED);
+        cache->start = end;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_cache_finish
+ *  ------------------------------------------------------------------------ */
+extern void async_io_cache_finish(IO_CACHE *cache)
+{
+    if (cache->descriptor < 0)
+    {
+        return;
+    }
+
+    /* Nur Seiten, die auf der Platte sind, lassen sich verwerfen. */
+    if (cache->writing)
+    {
+        fflush(cache->stream);
+        wait_writeback(cache->descriptor, cache->start, 0);
+    }
+    posix_fadvise(cache->descriptor, (off_t) cache->start, 0, 
+                  POSIX_FADV_DONTNEED);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: start_writeback
+ *  ------------------------------------------------------------------------ */
+static void start_writeback(int descriptor,
+                            unsigned long offset,
+                            unsigned long length)
+{
+#ifdef ASYNC_IO_HAVE_LINUX
+    sync_file_range(descriptor, (off_t) offset, (off_t) length,
+                    SYNC_FILE_RANGE_WRITE);
+#else
+    (void) descriptor;
+    (void) offset;
+    (void) length;
+#endif
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: wait_writeback
+ *  ------------------------------------------------------------------------ */
+static void wait_writeback(int descriptor,
+                           unsigned long offset,
+                           unsigned long length)
+{
+#ifdef ASYNC_IO_HAVE_LINUX
+    sync_file_range(descriptor, (off_t) offset, (off_t) length,
+                    SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE
+                    | SYNC_FILE_RANGE_WAIT_AFTER);
+#else
+    (void) offset;
+    (void) length;
+    fdatasync(descriptor);
+#endif
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: async_io_cached_bytes
+ *  ------------------------------------------------------------------------ */
+extern unsigned long async_io_cached_bytes(char *filename)
+{
+    unsigned long cached = 0;
+#ifdef ASYNC_IO_HAVE_LINUX
+    struct stat info;
+    unsigned long page_size = (unsigned long) sysconf(_SC_PAGESIZE);
+    unsigned long page_count;
+    unsigned long i;
+    unsigned char *p_pages;
+    void *p_map;
+    int descriptor = open(filename, O_RDONLY);
+
+    if (descriptor < 0)
+    {
+        return 0;
+    }
+
+    /* mincore liest die Seiten der Abbildung nicht ein. */
+    if (fstat(descriptor, &info) == 0 && info.st_size > 0)
+    {
+        p_map = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_SHARED,
+                     descriptor, 0);
+        if (p_map != MAP_FAILED)
+        {
+            page_count = ((unsigned long) info.st_size + page_size - 1) 
+                       / page_size;
+            p_pages = malloc(page_count);
+            ENSURE_ENOUGH_MEMORY(p_pages, "async_io_cached_bytes");
+            if (mincore(p_map, (size_t) info.st_size, p_pages) == 0)
+            {
+                for (i = 0; i < page_count; i++)
+                {
+                    if ((p_pages[i] & 1) != 0)
+                    {
+                        cached += page_size;
+                    }
+                }
+            }
+            free(p_pages);
+            munmap(p_map, (size_t) info.st_size);
+        }
+    }
+    close(descriptor);
+#else
+    (void) filename;
+#endif
+    return cached;
+}
@@ -0,0 +1,324 @@
+/**
+ * File: async_io.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASYNC_IO_H
+
+#define	ASYNC_IO_H
+
+#include <stdio.h>
+#include "common.h"
+
+/** Lesen und Schreiben mit fread und fwrite. */
+#define IO_BACKEND_SYNC 0
+
+/** Lesen und Schreiben mit pread und pwrite in eigenen Threads. */
+#define IO_BACKEND_THREAD 1
+
+/** Lesen und Schreiben mit io_uring, ohne Kernelunterstuetzung Threads. */
+#define IO_BACKEND_URING 2
+
+/**
+ * Flag zum Verfahren: die Seiten hinter dem Lese- bzw. Schreibzeiger werden
+ * aus dem Seitencache verworfen.
+ */
+#define IO_NO_CACHE 16
+
+/** Abstand in Byte, in dem ohne Seitencache verworfen wird. */
+#define IO_CACHE_WINDOW 8388608
+
+/** Standardanzahl gleichzeitig laufender Anfragen. */
+#define IO_DEFAULT_DEPTH 8
+
+/** Hoechstens gleichzeitig laufende Anfragen. */
+#define IO_MAX_DEPTH 64
+
+/** Groesse einer Anfrage in Byte. */
+#define IO_CHUNK_SIZE 262144
+
+/**
+ * Puffer einer Anfrage. Die Puffer werden reihum in Dateireihenfolge
+ * verwendet.
+ */
+typedef struct _IO_SLOT
+{
+    /**
+     * Daten der Anfrage (IO_CHUNK_SIZE Byte)
+     */
+    unsigned char *p_data;
+    /**
+     * Position der Anfrage in der Datei
+     */
+    unsigned long offset;
+    /**
+     * Angeforderte Anzahl Byte
+     */
+    unsigned long length;
+    /**
+     * Uebertragene Anzahl Byte, negativ bei einem Fehler
+     */
+    long result;
+    /**
+     * Zustand der Anfrage (frei, wartend, laufend, fertig)
+     */
+    int state;
+} IO_SLOT;
+
+/**
+ * Zustand des Verwerfens einer Datei aus dem Seitencache. Gelesene Seiten
+ * werden fensterweise hinter dem Lesezeiger verworfen. Geschriebene Seiten
+ * werden fensterweise zum Schreiben angestossen und ein Fenster spaeter,
+ * wenn sie auf der Platte sind, verworfen.
+ */
+typedef struct _IO_CACHE
+{
+    /**
+     * Strom der Datei
+     */
+    FILE *stream;
+    /**
+     * Dateideskriptor, -1 wenn der Seitencache normal verwendet wird
+     */
+    int descriptor;
+    /**
+     * TRUE fuer geschriebene Seiten
+     */
+    BOOL writing;
+    /**
+     * Anfang der noch nicht verworfenen Seiten
+     */
+    unsigned long start;
+    /**
+     * Ende der zum Schreiben angestossenen Seiten
+     */
+    unsigned long flushed;
+} IO_CACHE;
+
+/**
+ * Struktur einer geoeffneten Datei mit mehreren laufenden Anfragen. Ein
+ * Leser liest ab der aktuellen Position des FILE-Stroms voraus, ein
+ * Schreiber sammelt die Daten in Puffern und schreibt volle Puffer im
+ * Hintergrund. Beim Schliessen steht der FILE-Strom hinter den gelesenen
+ * bzw. geschriebenen Daten.
+ */
+typedef struct _ASYNC_IO
+{
+    /**
+     * Tatsaechlich verwendetes Verfahren (IO_BACKEND_*)
+     */
+    unsigned int backend;
+    /**
+     * TRUE fuer einen Schreiber
+     */
+    BOOL writing;
+    /**
+     * FILE-Strom der Datei
+     */
+    FILE *stream;
+    /**
+     * Dateideskriptor des FILE-Stroms
+     */
+    int descriptor;
+    /**
+     * Anzahl Puffer und damit hoechstens laufender Anfragen
+     */
+    unsigned int depth;
+    /**
+     * Puffer der Anfragen
+     */
+    IO_SLOT *slots;
+    /**
+     * Puffer, der gerade gelesen bzw. gefuellt wird
+     */
+    unsigned int current;
+    /**
+     * Gelesene bzw. gefuellte Byte des aktuellen Puffers
+     */
+    unsigned long position;
+    /**
+     * Position der naechsten Anfrage in der Datei
+     */
+    unsigned long next_offset;
+    /**
+     * Ende des zu lesenden Bereichs in der Datei
+     */
+    unsigned long end_offset;
+    /**
+     * Anzahl gerade laufender Anfragen
+     */
+    unsigned int in_flight;
+    /**
+     * Groesste Anzahl gleichzeitig laufender Anfragen
+     */
+    unsigned int peak_depth;
+    /**
+     * Anzahl gestellter Anfragen
+     */
+    unsigned long request_count;
+    /**
+     * Position hinter den bisher gelesenen bzw. geschriebenen Daten
+     */
+    unsigned long cursor;
+    /**
+     * Verwerfen aus dem Seitencache mit IO_NO_CACHE
+     */
+    IO_CACHE cache;
+    /**
+     * Zustand des Verfahrens (io_uring oder Threads)
+     */
+    void *p_backend;
+} ASYNC_IO;
+
+/**
+ * Oeffnet einen Leser fuer hoechstens length Byte ab der aktuellen Position
+ * des Stroms, (unsigned long) -1 liest bis zum Dateiende. Bereiche bis
+ * IO_CHUNK_SIZE Byte werden immer mit fread gelesen. Kann io_uring nicht
+ * eingerichtet werden, werden Threads verwendet.
+ *
+ * @param stream Zum Lesen geoeffneter Strom
+ * @param length Hoechstens zu lesende Byte
+ * @param backend Gewuenschtes Verfahren (IO_BACKEND_*), optional mit
+ *        IO_NO_CACHE
+ * @param depth Anzahl gleichzeitiger Anfragen (0 = IO_DEFAULT_DEPTH)
+ * @return Der Leser
+ */
+extern ASYNC_IO *async_io_open_reader(FILE *stream,
+                                      unsigned long length,
+                                      unsigned int backend,
+                                      unsigned long depth);
+
+/**
+ * Oeffnet einen Schreiber ab der aktuellen Position des Stroms. Bis zum
+ * async_io_close darf nur ueber den Schreiber geschrieben werden.
+ *
+ * @param stream Zum Schreiben geoeffneter Strom
+ * @param backend Gewuenschtes Verfahren (IO_BACKEND_*), optional mit
+ *        IO_NO_CACHE
+ * @param depth Anzahl gleichzeitiger Anfragen (0 = IO_DEFAULT_DEPTH)
+ * @return Der Schreiber
+ */
+extern ASYNC_IO *async_io_open_writer(FILE *stream,
+                                      unsigned int backend,
+                                      unsigned long depth);
+
+/**
+ * Liest wie fread bis zu length Byte. Bei einem Lesefehler wird das
+ * Programm beendet.
+ *
+ * @param io Leser
+ * @param p_buffer Ziel
+ * @param length Anzahl zu lesender Byte
+ * @return Anzahl gelesener Byte, nur am Ende kleiner als length
+ */
+extern unsigned long async_io_read(ASYNC_IO *io,
+                                   unsigned char *p_buffer,
+                                   unsigned long length);
+
+/**
+ * Schreibt length Byte. Die Daten werden kopiert, der Puffer kann sofort
+ * wieder verwendet werden. Bei einem Schreibfehler wird das Programm
+ * beendet.
+ *
+ * @param io Schreiber
+ * @param p_buffer Zu schreibende Daten
+ * @param length Anzahl Byte
+ */
+extern void async_io_write(ASYNC_IO *io,
+                           unsigned char *p_buffer,
+                           unsigned long length);
+
+/**
+ * Wartet auf alle laufenden Anfragen, setzt den Strom hinter die gelesenen
+ * bzw. geschriebenen Daten und gibt den Speicher frei. Mit IO_NO_CACHE
+ * werden die restlichen Seiten der Datei verworfen.
+ *
+ * @param io Leser oder Schreiber
+ */
+extern void async_io_close(ASYNC_IO *io);
+
+/**
+ * Prueft ob der Kernel io_uring unterstuetzt.
+ *
+ * @return TRUE wenn IO_BACKEND_URING ohne Threads arbeitet
+ */
+extern BOOL async_io_uring_available(void);
+
+/**
+ * Liefert den Namen eines Verfahrens.
+ *
+ * @param backend Verfahren (IO_BACKEND_*)
+ * @return Name fuer Ausgaben und die Kommandozeile
+ */
+extern char *async_io_backend_name(unsigned int backend);
+
+/**
+ * Liefert die seit einem festen Zeitpunkt vergangene Zeit. Anders als
+ * clock() zaehlt auch die Zeit, in der auf die Platte gewartet wird.
+ *
+ * @return Sekunden
+ */
+extern double async_io_seconds(void);
+
+/**
+ * Verwirft die zwischengespeicherten Seiten der Datei, damit die naechste
+ * Messung wieder von der Platte liest. Geaenderte Seiten werden vorher
+ * geschrieben.
+ *
+ * @param stream Strom der Datei
+ */
+extern void async_io_drop_cache(FILE *stream);
+
+/**
+ * Beginnt das Verwerfen einer Datei, die ohne ASYNC_IO direkt ueber den
+ * Strom gelesen oder geschrieben wird, ab der aktuellen Position.
+ *
+ * @param cache Zu initialisierender Zustand
+ * @param stream Strom der Datei
+ * @param writing TRUE wenn in die Datei geschrieben wird
+ * @param enabled FALSE um den Seitencache normal zu verwenden
+ */
+extern void async_io_cache_init(IO_CACHE *cache,
+                                FILE *stream,
+                                BOOL writing,
+                                BOOL enabled);
+
+/**
+ * Verwirft die ganzen Fenster vor position. Geschriebene Seiten werden
+ * zuerst zum Schreiben angestossen und erst ein Fenster spaeter verworfen.
+ *
+ * @param cache Zustand
+ * @param position Position hinter den gelesenen bzw. geschriebenen Daten
+ */
+extern void async_io_cache_release(IO_CACHE *cache, unsigned long position);
+
+/**
+ * Wartet auf das Schreiben und verwirft alle restlichen Seiten ab dem
+ * Anfang des Zustands bis zum Dateiende.
+ *
+ * @param cache Zustand
+ */
+extern void async_io_cache_finish(IO_CACHE *cache);
+
+/**
+ * Liefert die Anzahl Byte einer Datei, die im Seitencache liegen.
+ *
+ * @param filename Name der Datei
+ * @return Byte im Seitencache, 0 wenn das System es nicht liefert
+ */
+extern unsigned long async_io_cached_bytes(char *filename);
+
+#endif	/* ASYNC_IO_H */
@@ -0,0 +1,961 @@
+/**
+ * File: benchmark.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "common.h"
+#include "huffman.h"
+#include "huff_ctx.h"
+#include "huffman_internal.h"
+#include "codec_kernels.h"
+#include "checksum.h"
+#include "huff_buffer.h"
+#include "huff_stream.h"
+#include "huff_batch.h"
+#include "huff_dict.h"
+#include "async_io.h"
+#include "benchmark.h"
+
+/** Groesse einer Nachricht im Benchmark der Kosten je Nachricht. */
+#define BENCHMARK_MESSAGE_SIZE 1024
+
+/**
+ * Mindestanzahl Nachrichten je Wiederholung, damit auch kleine Dateien lange
+ * genug fuer die Aufloesung von clock() laufen.
+ */
+#define BENCHMARK_MESSAGE_MIN_COUNT 20000
+
+/** Anzahl der Wiederholungen je Messung im Benchmark der Ein-/Ausgabe. */
+#define BENCHMARK_IO_RUNS 3
+
+/** Endung der temporaeren Dateien im Benchmark der Ein-/Ausgabe. */
+#define BENCHMARK_IO_EXT ".bio"
+
+/** Nachrichten mit je einem neu angelegten Stream. */
+#define MESSAGE_STREAM_NEW 0
+
+/** Nachrichten mit einem wiederverwendeten Stream. */
+#define MESSAGE_STREAM_RESET 1
+
+/** Nachrichten mit huff_compress_buffer und huff_decompress_buffer. */
+#define MESSAGE_BUFFER 2
+
+/** Alle Nachrichten mit einem Aufruf von huff_compress_batch. */
+#define MESSAGE_BATCH 3
+
+/** Alle Nachrichten mit gemeinsamer Tabelle in einem Container. */
+#define MESSAGE_BATCH_SHARED 4
+
+/** Nachrichten ohne Header mit dem Woerterbuch. */
+#define MESSAGE_DICTIONARY 5
+
+/**
+ * Diese Funktion kodiert alle Nachrichten der Eingabe mehrfach mit einer
+ * Variante und schreibt jede Nachricht in ihren Platz in p_encoded.
+ * 
+ * @param ctx Codec-Kontext
+ * @param variant MESSAGE_STREAM_NEW, MESSAGE_STREAM_RESET, MESSAGE_BUFFER,
+ *        MESSAGE_BATCH, MESSAGE_BATCH_SHARED oder MESSAGE_DICTIONARY
+ * @param p_input Eingabe
+ * @param input_length Laenge der Eingabe
+ * @param p_encoded Kodierte Nachrichten, je slot_size Byte
+ * @param slot_size Platz je kodierter Nachricht
+ * @param p_encoded_lengths Laenge je kodierter Nachricht
+ * @return Zeit der schnellsten Wiederholung in Sekunden
+ */
+static double benchmark_message_encoder(HUFF_CTX *ctx,
+                                        unsigned int variant,
+                                        unsigned char *p_input,
+                                        unsigned long input_length,
+                                        unsigned char *p_encoded,
+                                        unsigned long slot_size,
+                                        unsigned long *p_encoded_lengths);
+
+/**
+ * Diese Funktion dekodiert alle mit benchmark_message_encoder kodierten
+ * Nachrichten mehrfach mit derselben Variante nach p_output.
+ * 
+ * @param ctx Codec-Kontext
+ * @param variant Variante wie beim Kodieren
+ * @param p_encoded Kodierte Nachrichten, je slot_size Byte
+ * @param slot_size Platz je kodierter Nachricht
+ * @param p_encoded_lengths Laenge je kodierter Nachricht
+ * @param p_output Ausgabe mit Platz fuer output_length Zeichen
+ * @param output_length Laenge der urspruenglichen Eingabe
+ * @return Zeit der schnellsten Wiederholung in Sekunden
+ */
+static double benchmark_message_decoder(HUFF_CTX *ctx,
+                                        unsigned int variant,
+                                        unsigned char *p_encoded,
+                                        unsigned long slot_size,
+                                        unsigned long *p_encoded_lengths,
+                                        unsigned char *p_output,
+                                        unsigned long output_length);
+
+/**
+ * Diese Funktion beschreibt die Nachrichten eines Puffers als Bereiche fuer
+ * die Batch-Funktionen. length und capacity jedes Bereichs sind die Laenge
+ * der Nachricht.
+ * 
+ * @param p_data Puffer mit den Nachrichten
+ * @param length Laenge aller Nachrichten zusammen
+ * @param stride Abstand der Nachrichten im Puffer
+ * @return Bereiche, je BENCHMARK_MESSAGE_SIZE Zeichen
+ */
+static HUFF_SLICE *create_message_slices(unsigned char *p_data,
+                                         unsigned long length,
+                                         unsigned long stride);
+
+/**
+ * Diese Funktion liest eine Datei mit einem Verfahren und einer Anzahl
+ * gleichzeitiger Anfragen. Vor jeder Wiederholung werden die Seiten der
+ * Datei verworfen.
+ * 
+ * @param in_filename Eingabedatei
+ * @param backend Verfahren (IO_BACKEND_*)
+ * @param depth Anzahl gleichzeitiger Anfragen
+ * @param p_peak_depth Groesste erreichte Anzahl laufender Anfragen
+ * @return Zeit der schnellsten Wiederholung in Sekunden
+ */
+static double benchmark_io_read(char *in_filename,
+                                unsigned int backend,
+                                unsigned long depth,
+                                unsigned int *p_peak_depth);
+
+/**
+ * Diese Funktion schreibt eine Datei mit einem Verfahren und einer Anzahl
+ * gleichzeitiger Anfragen. Gemessen wird bis nach dem fsync.
+ * 
+ * @param out_filename Ausgabedatei
+ * @param p_data Zu schreibende Daten
+ * @param length Laenge der Daten
+ * @param backend Verfahren (IO_BACKEND_*)
+ * @param depth Anzahl gleichzeitiger Anfragen
+ * @return Zeit der schnellsten Wiederholung in Sekunden
+ */
+static double benchmark_io_write(char *out_filename,
+                                 unsigned char *p_data,
+                                 unsigned long length,
+                                 unsigned int backend,
+                                 unsigned long depth);
+
+/**
+ * Diese Funktion misst Komprimieren und Dekomprimieren einer Datei mit
+ * einem Verfahren und prueft das Ergebnis. Danach wird ausgegeben, wie viel
+ * der drei Dateien noch im Seitencache liegt.
+ * 
+ * @param ctx Codec-Kontext mit den Optionen
+ * @param in_filename Eingabedatei
+ * @param p_input Inhalt der Eingabedatei
+ * @param input_length Laenge der Eingabedatei
+ * @param backend Verfahren (IO_BACKEND_*)
+ * @param no_cache TRUE um wie mit --no-cache zu messen
+ * @param temp_filename Name ohne Endung fuer die temporaeren Dateien
+ */
+static void benchmark_io_codec(HUFF_CTX *ctx,
+                               char *in_filename,
+                               unsigned char *p_input,
+                               unsigned long input_length,
+                               unsigned int backend,
+                               BOOL no_cache,
+                               char *temp_filename);
+
+/**
+ * Diese Funktion gibt den Durchsatz einer Messung in MB/s aus.
+ * 
+ * @param length Anzahl uebertragener Byte
+ * @param seconds Gemessene Zeit in Sekunden
+ */
+static void print_throughput(unsigned long length, double seconds);
+
+/**
+ * Diese Funktion gibt das Ergebnis einer Variante im Benchmark der Kosten je
+ * Nachricht aus.
+ * 
+ * @param name Name der Variante
+ * @param seconds Zeit der schnellsten Wiederholung in Sekunden
+ * @param input_length Laenge der Eingabe
+ * @param correct TRUE wenn die dekodierten Nachrichten der Eingabe gleichen
+ */
+static void print_message_result(char *name,
+                                 double seconds,
+                                 unsigned long input_length,
+                                 BOOL correct);
+
+/**
+ * Diese Funktion uebergibt eine ganze Nachricht an einen vorbereiteten
+ * Stream und schliesst ihn ab.
+ * 
+ * @param stream Stream
+ * @param compress TRUE fuer einen Kodierer, FALSE fuer einen Dekodierer
+ * @param p_src Nachricht
+ * @param src_len Laenge der Nachricht
+ * @param p_dst Ausgabe
+ * @param dst_cap Groesse der Ausgabe
+ * @return Laenge der Ausgabe oder HUFF_BUFFER_ERROR
+ */
+static unsigned long stream_message(HUFF_STREAM *stream,
+                                    BOOL compress,
+                                    unsigned char *p_src,
+                                    unsigned long src_len,
+                                    unsigned char *p_dst,
+                                    unsigned long dst_cap);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: benchmark_messages
+ *  ------------------------------------------------------------------------ */
+extern void benchmark_messages(HUFF_CTX *ctx, char *in_filename)
+{
+    static char *names[][2] = {
+        { "stream -c", "stream -d" },
+        { "reset -c", "reset -d" },
+        { "puffer -c", "puffer -d" },
+        { "batch -c", "batch -d" },
+        { "shared -c", "shared -d" },
+        { "dict -c", "dict -d" }
+    };
+    FILE *p_input_stream = fopen(in_filename, "rb");
+    unsigned char *p_input;
+    unsigned char *p_encoded;
+    unsigned char *p_output;
+    unsigned long *p_encoded_lengths;
+    unsigned long input_length;
+    unsigned long message_count;
+    unsigned long slot_size;
+    unsigned long encoded_length;
+    unsigned long message;
+    unsigned int variant;
+    unsigned int variant_count;
+    double seconds;
+    BOOL correct;
+    
+    if (p_input_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    p_input = read_payload(ctx, p_input_stream, (unsigned long) -1, 
+                           &input_length);
+    fclose(p_input_stream);
+    if (input_length == 0)
+    {
+        printf("Die Datei ist leer.\n");
+        free(p_input);
+        return;
+    }
+    
+    huff_buffer_init();
+    variant_count = MESSAGE_BATCH_SHARED + 1;
+    if (ctx->dictionary_filename != NULL)
+    {
+        load_dictionary(ctx);
+        variant_count = MESSAGE_DICTIONARY + 1;
+    }
+    
+    /*
+     * Jede kodierte Nachricht erhaelt einen festen Platz, der fuer einen
+     * Container mit Abschlussblock und fuer eine Nachricht mit Woerterbuch
+     * ausreicht. Der Container mit gemeinsamer Tabelle braucht zusaetzlich
+     * Platz fuer die Tabelle.
+     */
+    message_count = (input_length + BENCHMARK_MESSAGE_SIZE - 1) 
+                    / BENCHMARK_MESSAGE_SIZE;
+    slot_size = huff_compress_bound(BENCHMARK_MESSAGE_SIZE)
+                + BLOCK_HEADER_SIZE + CHECKSUM_SIZE;
+    if (ctx->dictionary_loaded
+            && slot_size < huff_dict_compress_bound(&ctx->dictionary,
+                                                    BENCHMARK_MESSAGE_SIZE))
+    {
+        slot_size = huff_dict_compress_bound(&ctx->dictionary, 
+                                             BENCHMARK_MESSAGE_SIZE);
+    }
+    p_encoded = malloc(message_count * slot_size + BLOCK_HEADER_SIZE
+                       + 256 * BLOCK_SYMBOL_SIZE);
+    ENSURE_ENOUGH_MEMORY(p_encoded, "benchmark_messages");
+    p_encoded_lengths = malloc(message_count * sizeof(unsigned long));
+    ENSURE_ENOUGH_MEMORY(p_encoded_lengths, "benchmark_messages");
+    p_output = malloc(input_length + KERNEL_OUTPUT_SLACK);
+    ENSURE_ENOUGH_MEMORY(p_output, "benchmark_messages");
+    
+    printf("\n------------ Benchmark Kosten je Nachricht ------------\n\n");
+    printf("\tNachrichten: %lu zu %d Byte, Kernel: %s\n\n", message_count,
+           BENCHMARK_MESSAGE_SIZE, kernel_name);
+    
+    for (variant = 0; variant < variant_count; variant++)
+    {
+        seconds = benchmark_message_encoder(ctx, variant, p_input,
+                                            input_length, p_encoded,
+                                            slot_size, p_encoded_lengths);
+        encoded_length = 0;
+        correct = TRUE;
+        for (message = 0; message < message_count; message++)
+        {
+            if (p_encoded_lengths[message] == HUFF_BUFFER_ERROR)
+            {
+                correct = FALSE;
+            }
+            encoded_length += p_encoded_lengths[message];
+        }
+        print_message_result(names[variant][0], seconds, input_length,
+                             correct);
+        
+        seconds = benchmark_message_decoder(ctx, variant, p_encoded,
+                                            slot_size, p_encoded_lengths,
+                                            p_output, input_length);
+        correct = (correct && memcmp(p_output, p_input, input_length) == 0)
+                  ? TRUE : FALSE;
+        print_message_result(names[variant][1], seconds, input_length,
+                             correct);
+        if (correct)
+        {
+            printf("\t%-12s %10lu Byte\n\n", "", encoded_length);
+        }
+        else
+        {
+            printf("\n");
+        }
+    }
+    
+    free(p_input);
+    free(p_encoded);
+    free(p_encoded_lengths);
+    free(p_output);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: benchmark_io
+ *  ------------------------------------------------------------------------ */
+extern void benchmark_io(HUFF_CTX *ctx, char *in_filename)
+{
+    static unsigned long depths[] = { 1, 2, 4, 8, 16, 32 };
+    FILE *p_input_stream = fopen(in_filename, "rb");
+    unsigned char *p_input;
+    unsigned long input_length;
+    char *temp_filename;
+    char *text_filename;
+    unsigned int backend;
+    unsigned int depth_index;
+    unsigned int peak_depth;
+    double seconds;
+    
+    if (p_input_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    p_input = read_payload(ctx, p_input_stream, (unsigned long) -1, 
+                           &input_length);
+    fclose(p_input_stream);
+    if (input_length <= IO_CHUNK_SIZE)
+    {
+        printf("Der Benchmark benoetigt eine Datei mit mehr als %d Byte.\n",
+               IO_CHUNK_SIZE);
+        free(p_input);
+        return;
+    }
+    
+    temp_filename = malloc(strlen(in_filename) + strlen(BENCHMARK_IO_EXT) 
+                           + strlen(DECOMPRESS_EXT) + 1);
+    ENSURE_ENOUGH_MEMORY(temp_filename, "benchmark_io");
+    text_filename = malloc(strlen(in_filename) + strlen(BENCHMARK_IO_EXT) 
+                           + strlen(DECOMPRESS_EXT) + 1);
+    ENSURE_ENOUGH_MEMORY(text_filename, "benchmark_io");
+    strcpy(temp_filename, in_filename);
+    strcat(temp_filename, BENCHMARK_IO_EXT);
+    strcpy(text_filename, temp_filename);
+    strcat(text_filename, DECOMPRESS_EXT);
+    
+    printf("\n------------ Benchmark Ein-/Ausgabe ------------\n\n");
+    printf("\tDatei: %lu Byte, Anfragen zu %d KB, io_uring: %s\n",
+           input_length, IO_CHUNK_SIZE / 1024,
+           (async_io_uring_available()) ? "ja" : "nein (uring mit Threads)");
+    printf("\tLesen ohne zwischengespeicherte Seiten, Schreiben bis nach "
+           "fsync.\n\n");
+    printf("\t%-9s %6s %10s %10s %9s\n", "Verfahren", "Tiefe", "Lesen", 
+           "Schreiben", "erreicht");
+    
+    /*
+     * Das synchrone Verfahren hat immer genau eine Anfrage, die anderen
+     * werden mit steigender Anzahl gleichzeitiger Anfragen gemessen.
+     */
+    for (backend = IO_BACKEND_SYNC; backend <= IO_BACKEND_URING; backend++)
+    {
+        for (depth_index = 0; 
+             depth_index < sizeof(depths) / sizeof(depths[0]); 
+             depth_index++)
+        {
+            printf("\t%-9s %6lu", async_io_backend_name(backend), 
+                   depths[depth_index]);
+            seconds = benchmark_io_read(in_filename, backend, 
+                                        depths[depth_index], &peak_depth);
+            print_throughput(input_length, seconds);
+            seconds = benchmark_io_write(text_filename, p_input, input_length,
+                                         backend, depths[depth_index]);
+            print_throughput(input_length, seconds);
+            printf(" %9u\n", (peak_depth == 0) ? 1 : peak_depth);
+            fflush(stdout);
+            
+            if (backend == IO_BACKEND_SYNC)
+            {
+                break;
+            }
+        }
+    }
+    
+    printf("\n\t%-9s %6s %6s %10s %10s %10s\n", "Verfahren", "Tiefe", 
+           "Cache", "-c", "-d", "im Cache");
+    for (backend = IO_BACKEND_SYNC; backend <= IO_BACKEND_URING; backend++)
+    {
+        benchmark_io_codec(ctx, in_filename, p_input, input_length, backend,
+                           FALSE, temp_filename);
+        benchmark_io_codec(ctx, in_filename, p_input, input_length, backend,
+                           TRUE, temp_filename);
+    }
+    printf("\n\tAngaben in MB/s, im Cache in MB nach -c und -d.\n");
+    
+    remove(text_filename);
+    free(temp_filename);
+    free(text_filename);
+    free(p_input);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: benchmark_io_read
+ *  ------------------------------------------------------------------------ */
+static double benchmark_io_read(char *in_filename,
+                                unsigned int backend,
+                                unsigned long depth,
+                                unsigned int *p_peak_depth)
+{
+    unsigned char *p_buffer = malloc(KERNEL_CHUNK_SIZE);
+    unsigned long read_length;
+    double start, seconds, best_seconds = -1;
+    unsigned int run;
+    ASYNC_IO *p_reader;
+    FILE *p_input_stream;
+    
+    ENSURE_ENOUGH_MEMORY(p_buffer, "benchmark_io_read");
+    *p_peak_depth = 0;
+    for (run = 0; run < BENCHMARK_IO_RUNS; run++)
+    {
+        p_input_stream = fopen(in_filename, "rb");
+        if (p_input_stream == NULL)
+        {
+            printf("Datei Einlesen fehlgeschlagen!\n");
+            fflush(stdout);
+            exit(EXIT_FAILURE);
+        }
+        async_io_drop_cache(p_input_stream);
+        
+        start = async_io_seconds();
+        p_reader = async_io_open_reader(p_input_stream, (unsigned long) -1,
+                                        backend, depth);
+        do
+        {
+            read_length = async_io_read(p_reader, p_buffer, 
+                                        KERNEL_CHUNK_SIZE);
+        }
+        while (read_length == KERNEL_CHUNK_SIZE);
+        if (p_reader->peak_depth > *p_peak_depth)
+        {
+            *p_peak_depth = p_reader->peak_depth;
+        }
+        async_io_close(p_reader);
+        seconds = async_io_seconds() - start;
+        fclose(p_input_stream);
+        
+        if (best_seconds < 0 || seconds < best_seconds) best_seconds = seconds;
+    }
+    free(p_buffer);
+    
+    return best_seconds;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: benchmark_io_write
+ *  ------------------------------------------------------------------------ */
+static double benchmark_io_write(char *out_filename,
+                                 unsigned char *p_data,
+                                 unsigned long length,
+                                 unsigned int backend,
+                                 unsigned long depth)
+{
+    unsigned long position;
+    unsigned long chunk_length;
+    double start, seconds, best_seconds = -1;
+    unsigned int run;
+    ASYNC_IO *p_writer;
+    FILE *p_output_stream;
+    
+    for (run = 0; run < BENCHMARK_IO_RUNS; run++)
+    {
+        p_output_stream = fopen(out_filename, "wb");
+        if (p_output_stream == NULL)
+        {
+            printf("Datei zum Schreiben konnte nicht geoeffnet werden.\n");
+            fflush(stdout);
+            exit(EXIT_FAILURE);
+        }
+        
+        /* Geschrieben wird in Abschnitten wie beim Kodieren. */
+        start = async_io_seconds();
+        p_writer = async_io_open_writer(p_output_stream, backend, depth);
+        for (position = 0; position < length; position += chunk_length)
+        {
+            chunk_length = (length - position < KERNEL_CHUNK_SIZE) 
+                         ? length - position : KERNEL_CHUNK_SIZE;
+            async_io_write(p_writer, p_data + position, chunk_length);
+        }
+        async_io_close(p_writer);
+        async_io_drop_cache(p_output_stream);
+        seconds = async_io_seconds() - start;
+        fclose(p_output_stream);
+        
+        if (best_seconds < 0 || seconds < best_seconds) best_seconds = seconds;
+    }
+    
+    return best_seconds;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: benchmark_io_codec
+ *  ------------------------------------------------------------------------ */
+static void benchmark_io_codec(HUFF_CTX *ctx,
+                               char *in_filename,
+                               unsigned char *p_input,
+                               unsigned long input_length,
+                               unsigned int backend,
+                               BOOL no_cache,
+                               char *temp_filename)
+{
+    HUFF_CTX run_ctx;
+    FILE *p_stream;
+    unsigned char *p_output;
+    unsigned long output_length;
+    char *code_filename = malloc(strlen(temp_filename) 
+                                 + strlen(COMPRESS_EXT) + 1);
+    char *text_filename = malloc(strlen(temp_filename) 
+                                 + strlen(DECOMPRESS_EXT) + 1);
+    unsigned long cached;
+    double start;
+    BOOL correct;
+    
+    ENSURE_ENOUGH_MEMORY(code_filename, "benchmark_io_codec");
+    ENSURE_ENOUGH_MEMORY(text_filename, "benchmark_io_codec");
+    strcpy(code_filename, temp_filename);
+    strcat(code_filename, COMPRESS_EXT);
+    strcpy(text_filename, temp_filename);
+    strcat(text_filename, DECOMPRESS_EXT);
+    printf("\t%-9s %6lu %6s", async_io_backend_name(backend), 
+           (backend == IO_BACKEND_SYNC) ? 1 : ctx->io_depth,
+           (no_cache) ? "aus" : "an");
+    
+    /* Die Eingabe kommt wie beim ersten Komprimieren von der Platte. */
+    p_stream = fopen(in_filename, "rb");
+    if (p_stream != NULL)
+    {
+        async_io_drop_cache(p_stream);
+        fclose(p_stream);
+    }
+    huff_ctx_init_from(&run_ctx, ctx);
+    run_ctx.io_backend = backend;
+    run_ctx.no_cache_mode = no_cache;
+    start = async_io_seconds();
+    compress(&run_ctx, in_filename, code_filename);
+    print_throughput(input_length, async_io_seconds() - start);
+    huff_ctx_destroy(&run_ctx);
+    
+    p_stream = fopen(code_filename, "rb");
+    if (p_stream != NULL)
+    {
+        async_io_drop_cache(p_stream);
+        fclose(p_stream);
+    }
+    huff_ctx_init_from(&run_ctx, ctx);
+    run_ctx.io_backend = backend;
+    run_ctx.no_cache_mode = no_cache;
+    start = async_io_seconds();
+    decompress(&run_ctx, code_filename, text_filename);
+    print_throughput(input_length, async_io_seconds() - start);
+    huff_ctx_destroy(&run_ctx);
+    
+    /* Vor der Pruefung, die die Ausgabe selbst wieder einliest. */
+    cached = async_io_cached_bytes(in_filename) 
+             + async_io_cached_bytes(code_filename)
+             + async_io_cached_bytes(text_filename);
+    printf(" %10.2f", (double) cached / (1024.0 * 1024.0));
+    
+    p_stream = fopen(text_filename, "rb");
+    if (p_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    p_output = read_payload(ctx, p_stream, (unsigned long) -1, &output_length);
+    fclose(p_stream);
+    correct = (output_length == input_length 
+               && memcmp(p_output, p_input, input_length) == 0) 
+              ? TRUE : FALSE;
+    printf("  %s\n", (correct) ? "OK" : "FEHLER");
+    fflush(stdout);
+    
+    remove(code_filename);
+    remove(text_filename);
+    free(p_output);
+    free(code_filename);
+    free(text_filename);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: print_throughput
+ *  ------------------------------------------------------------------------ */
+static void print_throughput(unsigned long length, double seconds)
+{
+    if (seconds > 0)
+    {
+        printf(" %10.2f", (double) length / seconds / (1024.0 * 1024.0));
+    }
+    else
+    {
+        printf(" %10s", "-");
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: benchmark_message_encoder
+ *  ------------------------------------------------------------------------ */
+static double benchmark_message_encoder(HUFF_CTX *ctx,
+                                        unsigned int variant,
+                                        unsigned char *p_input,
+                                        unsigned long input_length,
+                                        unsigned char *p_encoded,
+                                        unsigned long slot_size,
+                                        unsigned long *p_encoded_lengths)
+{
+    HUFF_STREAM stream;
+    HUFF_SLICE *p_inputs = NULL;
+    HUFF_SLICE *p_outputs = NULL;
+    unsigned long message_count = (input_length + BENCHMARK_MESSAGE_SIZE - 1)
+                                  / BENCHMARK_MESSAGE_SIZE;
+    unsigned long pass_count = BENCHMARK_MESSAGE_MIN_COUNT / message_count + 1;
+    unsigned long pass, message, length, shared_bound = 0;
+    unsigned char *p_message;
+    unsigned char *p_slot;
+    clock_t start;
+    double seconds, best_seconds = -1;
+    unsigned int run;
+    unsigned int thread_count = (unsigned int) ctx->thread_count;
+    
+    /* Der wiederverwendete Stream wird nur einmal angelegt. */
+    if (variant == MESSAGE_STREAM_RESET)
+    {
+        huff_stream_compress_init(&stream, BENCHMARK_MESSAGE_SIZE, FALSE);
+    }
+    
+    /* Die Batch-Varianten bekommen alle Nachrichten auf einmal. */
+    if (variant == MESSAGE_BATCH || variant == MESSAGE_BATCH_SHARED)
+    {
+        p_inputs = create_message_slices(p_input, input_length,
+                                         BENCHMARK_MESSAGE_SIZE);
+        p_outputs = create_message_slices(p_encoded, input_length, slot_size);
+        for (message = 0; message < message_count; message++)
+        {
+            p_outputs[message].capacity = slot_size;
+            p_encoded_lengths[message] = 0;
+        }
+        shared_bound = huff_batch_shared_bound(p_inputs, message_count);
+    }
+    
+    for (run = 0; run < BENCHMARK_RUNS; run++)
+    {
+        start = clock();
+        for (pass = 0; pass < pass_count; pass++)
+        {
+            if (variant == MESSAGE_BATCH)
+            {
+                huff_compress_batch(p_inputs, p_outputs, message_count,
+                                    thread_count);
+                continue;
+            }
+            else if (variant == MESSAGE_BATCH_SHARED)
+            {
+                length = huff_compress_batch_shared(p_inputs, message_count,
+                                                    p_encoded, shared_bound,
+                                                    thread_count);
+                p_encoded_lengths[0] = length;
+                continue;
+            }
+            
+            for (message = 0; message < message_count; message++)
+            {
+                p_message = p_input + message * BENCHMARK_MESSAGE_SIZE;
+                p_slot = p_encoded + message * slot_size;
+                length = input_length - message * BENCHMARK_MESSAGE_SIZE;
+                if (length > BENCHMARK_MESSAGE_SIZE)
+                {
+                    length = BENCHMARK_MESSAGE_SIZE;
+                }
+                
+                if (variant == MESSAGE_STREAM_NEW)
+                {
+                    huff_stream_compress_init(&stream, BENCHMARK_MESSAGE_SIZE,
+                                              FALSE);
+                    length = stream_message(&stream, TRUE, p_message, length,
+                                            p_slot, slot_size);
+                    huff_stream_destroy(&stream);
+                }
+                else if (variant == MESSAGE_STREAM_RESET)
+                {
+                    huff_stream_reset(&stream);
+                    length = stream_message(&stream, TRUE, p_message, length,
+                                            p_slot, slot_size);
+                }
+                else if (variant == MESSAGE_BUFFER)
+                {
+                    length = huff_compress_buffer(p_message, length, p_slot,
+                                                  slot_size);
+                }
+                else
+                {
+                    length = huff_dict_compress(&ctx->dictionary, p_message,
+                                                length, p_slot, slot_size);
+                }
+                p_encoded_lengths[message] = length;
+            }
+        }
+        seconds = (double) (clock() - start) / CLOCKS_PER_SEC / pass_count;
+        if (best_seconds < 0 || seconds < best_seconds) best_seconds = seconds;
+    }
+    
+    if (variant == MESSAGE_STREAM_RESET)
+    {
+        huff_stream_destroy(&stream);
+    }
+    if (variant == MESSAGE_BATCH)
+    {
+        for (message = 0; message < message_count; message++)
+        {
+            p_encoded_lengths[message] = p_outputs[message].length;
+        }
+    }
+    free(p_inputs);
+    free(p_outputs);
+    
+    return best_seconds;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: benchmark_message_decoder
+ *  ------------------------------------------------------------------------ */
+static double benchmark_message_decoder(HUFF_CTX *ctx,
+                                        unsigned int variant,
+                                        unsigned char *p_encoded,
+                                        unsigned long slot_size,
+                                        unsigned long *p_encoded_lengths,
+                                        unsigned char *p_output,
+                                        unsigned long output_length)
+{
+    HUFF_STREAM stream;
+    HUFF_SLICE *p_inputs = NULL;
+    HUFF_SLICE *p_outputs = NULL;
+    unsigned long message_count = (output_length + BENCHMARK_MESSAGE_SIZE - 1)
+                                  / BENCHMARK_MESSAGE_SIZE;
+    unsigned long pass_count = BENCHMARK_MESSAGE_MIN_COUNT / message_count + 1;
+    unsigned long pass, message, length, encoded_length;
+    unsigned char *p_message;
+    unsigned char *p_slot;
+    clock_t start;
+    double seconds, best_seconds = -1;
+    unsigned int run;
+    unsigned int thread_count = (unsigned int) ctx->thread_count;
+    
+    if (variant == MESSAGE_STREAM_RESET)
+    {
+        huff_stream_decompress_init(&stream);
+    }
+    
+    if (variant == MESSAGE_BATCH || variant == MESSAGE_BATCH_SHARED)
+    {
+        p_inputs = create_message_slices(p_encoded, output_length, slot_size);
+        p_outputs = create_message_slices(p_output, output_length,
+                                          BENCHMARK_MESSAGE_SIZE);
+        for (message = 0; message < message_count; message++)
+        {
+            p_inputs[message].length =
+                    (p_encoded_lengths[message] != HUFF_BUFFER_ERROR)
+                    ? p_encoded_lengths[message] : 0;
+        }
+    }
+    
+    for (run = 0; run < BENCHMARK_RUNS; run++)
+    {
+        memset(p_output, 0, output_length);
+        start = clock();
+        for (pass = 0; pass < pass_count; pass++)
+        {
+            if (variant == MESSAGE_BATCH)
+            {
+                huff_decompress_batch(p_inputs, p_outputs, message_count,
+                                      thread_count);
+                continue;
+            }
+            else if (variant == MESSAGE_BATCH_SHARED)
+            {
+                if (p_encoded_lengths[0] != HUFF_BUFFER_ERROR)
+                {
+                    huff_decompress_batch_shared(p_encoded,
+                                                 p_encoded_lengths[0],
+                                                 p_outputs, message_count,
+                                                 thread_count);
+                }
+                continue;
+            }
+            
+            for (message = 0; message < message_count; message++)
+            {
+                p_message = p_output + message * BENCHMARK_MESSAGE_SIZE;
+                p_slot = p_encoded + message * slot_size;
+                encoded_length = p_encoded_lengths[message];
+                length = output_length - message * BENCHMARK_MESSAGE_SIZE;
+                if (length > BENCHMARK_MESSAGE_SIZE)
+                {
+                    length = BENCHMARK_MESSAGE_SIZE;
+                }
+                if (encoded_length == HUFF_BUFFER_ERROR)
+                {
+                    continue;
+                }
+                
+                if (variant == MESSAGE_STREAM_NEW)
+                {
+                    huff_stream_decompress_init(&stream);
+                    stream_message(&stream, FALSE, p_slot, encoded_length,
+                                   p_message, length);
+                    huff_stream_destroy(&stream);
+                }
+                else if (variant == MESSAGE_STREAM_RESET)
+                {
+                    huff_stream_reset(&stream);
+                    stream_message(&stream, FALSE, p_slot, encoded_length,
+                                   p_message, length);
+                }
+                else if (variant == MESSAGE_BUFFER)
+                {
+                    huff_decompress_buffer(p_slot, encoded_length, p_message,
+                                           length);
+                }
+                else
+                {
+                    huff_dict_decompress(&ctx->dictionary, p_slot,
+                                         encoded_length, p_message, length);
+                }
+            }
+        }
+        seconds = (double) (clock() - start) / CLOCKS_PER_SEC / pass_count;
+        if (best_seconds < 0 || seconds < best_seconds) best_seconds = seconds;
+    }
+    
+    if (variant == MESSAGE_STREAM_RESET)
+    {
+        huff_stream_destroy(&stream);
+    }
+    free(p_inputs);
+    free(p_outputs);
+    
+    return best_seconds;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: create_message_slices
+ *  ------------------------------------------------------------------------ */
+static HUFF_SLICE *create_message_slices(unsigned char *p_data,
+                                         unsigned long length,
+                                         unsigned long stride)
+{
+    unsigned long message_count = (length + BENCHMARK_MESSAGE_SIZE - 1)
+                                  / BENCHMARK_MESSAGE_SIZE;
+    unsigned long message;
+    HUFF_SLICE *p_slices = calloc(message_count, sizeof(HUFF_SLICE));
+    ENSURE_ENOUGH_MEMORY(p_slices, "create_message_slices");
+    
+    for (message = 0; message < message_count; message++)
+    {
+        p_slices[message].p_data = p_data + message * stride;
+        p_slices[message].length = length - message * BENCHMARK_MESSAGE_SIZE;
+        if (p_slices[message].length > BENCHMARK_MESSAGE_SIZE)
+        {
+            p_slices[message].length = BENCHMARK_MESSAGE_SIZE;
+        }
+        p_slices[message].capacity = p_slices[message].length;
+    }
+    
+    return p_slices;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: print_message_result
+ *  ------------------------------------------------------------------------ */
+static void print_message_result(char *name,
+                                 double seconds,
+                                 unsigned long input_length,
+                                 BOOL correct)
+{
+    unsigned long message_count = (input_length + BENCHMARK_MESSAGE_SIZE - 1)
+                                  / BENCHMARK_MESSAGE_SIZE;
+    
+    if (seconds > 0)
+    {
+        printf("\t%-12s %10.3f us/Nachricht %10.2f MB/s  %s\n", name,
+               seconds * 1e6 / (double) message_count,
+               (double) input_length / seconds / (1024.0 * 1024.0),
+               (correct) ? "OK" : "FEHLER");
+    }
+    else
+    {
+        printf("\t%-12s %10.3f us/Nachricht %10s MB/s  %s\n", name, 0.0, "-",
+               (correct) ? "OK" : "FEHLER");
+    }
+    fflush(stdout);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: stream_message
+ *  ------------------------------------------------------------------------ */
+static unsigned long stream_message(HUFF_STREAM *stream,
+                                    BOOL compress,
+                                    unsigned char *p_src,
+                                    unsigned long src_len,
+                                    unsigned char *p_dst,
+                                    unsigned long dst_cap)
+{
+    int result;
+    
+    stream->next_in = p_src;
+    stream->avail_in = src_len;
+    stream->next_out = p_dst;
+    stream->avail_out = dst_cap;
+    result = (compress) ? huff_stream_compress_finish(stream)
+                        : huff_stream_decompress_finish(stream);
+    
+    return (result == HUFF_STREAM_END) ? stream->total_out : HUFF_BUFFER_ERROR;
+}
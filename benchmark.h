@@ -0,0 +1,54 @@
+/**
+ * File: benchmark.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARK_H
+
+#define	BENCHMARK_H
+
+#include "common.h"
+#include "huffman.h"
+
+/** Anzahl der Wiederholungen je Dekodierer im Benchmark. */
+#define BENCHMARK_RUNS 5
+
+/**
+ * Diese Funktion misst die festen Kosten je Nachricht. Die Eingabe wird in
+ * Nachrichten zu 1 KB geteilt, die einzeln mit einem je Nachricht neu
+ * angelegten Stream, einem mit huff_stream_reset wiederverwendeten Stream,
+ * der Puffer-API und mit --dict dem Woerterbuch kodiert und dekodiert
+ * werden. Ausgegeben wird die schnellste Wiederholung. Es wird keine Datei
+ * geschrieben.
+ * 
+ * @param ctx Codec-Kontext
+ * @param in_filename Eingabedatei
+ */
+extern void benchmark_messages(HUFF_CTX *ctx, char *in_filename);
+
+/**
+ * Diese Funktion misst den Durchsatz beim Lesen und Schreiben der Eingabe
+ * mit fread/fwrite, mit Threads und mit io_uring bei steigender Anzahl
+ * gleichzeitiger Anfragen, danach Komprimieren und Dekomprimieren mit jedem
+ * Verfahren. Die temporaeren Dateien neben der Eingabe werden wieder
+ * geloescht.
+ * 
+ * @param ctx Codec-Kontext
+ * @param in_filename Eingabedatei
+ */
+extern void benchmark_io(HUFF_CTX *ctx, char *in_filename);
+
+#endif	/* BENCHMARK_H */
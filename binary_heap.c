@@ -43,21 +43,33 @@ static void print_help(BINARY_HEAP* heap,
  */
 static void swap(void** p_x, void** p_y);
 
+/**
+ * Stellt die Heapstruktur nach einer Entnahme so wieder her wie bis zur
+ * Containerversion 1. Hat ein Element nur einen linken Sohn, wird mit dem
+ * gerade entnommenen Element hinter count verglichen und der Heap bleibt
+ * unter Umstaenden ungeordnet. Die daraus gebauten Baeume sind in alten
+ * Dateien gespeichert und muessen beim Lesen genau so entstehen.
+ * 
+ * @param heap Heap nach der Entnahme
+ */
+static void sift_down_legacy(BINARY_HEAP* heap);
+
 
 /** ---------------------------------------------------------------------------
  *  Funktion: heap_init
  * ------------------------------------------------------------------------- */
-extern BINARY_HEAP* heap_init(GET_VALUE get_value,
+extern BINARY_HEAP* heap_init(ALLOCATOR* allocator,
+                               GET_VALUE get_value,
                                PRINT_VALUE print_value,
                                DESTROY destroy)
 {
-    BINARY_HEAP* heap = calloc(1,sizeof(BINARY_HEAP));
-    
-    ENSURE_ENOUGH_MEMORY(heap, "heap_init");
+    BINARY_HEAP* heap = allocator_alloc(allocator, sizeof(BINARY_HEAP));
     
+    heap->allocator = allocator;
+    heap->legacy_order = FALSE;
     heap->count = 0;
     heap->size = MIN_HEAP_SIZE;
-    heap->start = calloc(MIN_HEAP_SIZE, sizeof(void*));
+    heap->start = allocator_alloc(allocator, MIN_HEAP_SIZE * sizeof(void*));
     
     heap->get_value = get_value;
     heap->print_value = print_value;
@@ -82,8 +94,8 @@ extern void heap_destroy(BINARY_HEAP* heap)
                 }
         }
     }
-    free(heap->start);
-    free(heap);
+    allocator_free(heap->allocator, heap->start);
+    allocator_free(heap->allocator, heap);
 }
 
 /** ---------------------------------------------------------------------------
@@ -100,10 +112,10 @@ extern void heap_insert(BINARY_HEAP* heap, void* p_element)
     if (heap->count + 1 > heap->size)
     {
         heap->size = heap->size * 2;
-        heap->start = realloc(heap->start, sizeof(void*) * heap->size);
+        heap->start = allocator_realloc(heap->allocator, heap->start,
+                                        sizeof(void*) * (heap->size / 2),
+                                        sizeof(void*) * heap->size);
         memset(heap->start + (heap->size / 2), 0, sizeof(void*));
-        
-        ENSURE_ENOUGH_MEMORY(heap->start, "heap_insert");
     }
     
     /* Heapcounter inkrementieren. */
@@ -132,7 +144,7 @@ extern void heap_insert(BINARY_HEAP* heap, void* p_element)
  * ------------------------------------------------------------------------- */
 extern BOOL heap_extract_min(BINARY_HEAP* heap,void** p_min_element)
 {
-    unsigned int current_element, left, right;
+    unsigned int current_element, smallest, right;
     BOOL success = FALSE;
     
     /* Wurzel des Heaps. */
@@ -152,41 +164,35 @@ extern BOOL heap_extract_min(BINARY_HEAP* heap,void** p_min_element)
         heap->count = heap->count - 1;
         success = TRUE;
 
-        /* Heapstruktur wiederherstellen. */
-        left = LEFT(current_element);
-        right = RIGHT(current_element);
-
-        while ( (left  <= heap->count || right <= heap->count) &&
-              (heap->get_value(heap->start[current_element-1]) > 
-                heap->get_value(heap->start[left-1]) ||
-               heap->get_value(heap->start[current_element-1]) > 
-                heap->get_value(heap->start[right-1])))
+        /*
+         * Heapstruktur wiederherstellen. Es werden nur Soehne innerhalb des
+         * Heaps verglichen, hinter count stehen bereits entnommene Elemente.
+         */
+        if (heap->legacy_order)
         {
-            left = LEFT(current_element);
-            right = RIGHT(current_element);
-
-            if (heap->get_value(heap->start[left-1]) 
-                    < heap->get_value(heap->start[right-1])) 
+            sift_down_legacy(heap);
+        }
+        else
+        {
+            while (LEFT(current_element) <= heap->count)
             {
-                swap(&heap->start[current_element-1], &heap->start[left-1]);
-
-                current_element = left;
-                left = LEFT(current_element);
+                smallest = LEFT(current_element);
                 right = RIGHT(current_element);
-            }
-            else if (right <= heap->count)
-            {
-                swap(&heap->start[current_element-1], &heap->start[right-1]);
+                if (right <= heap->count 
+                        && heap->get_value(heap->start[right-1]) 
+                            < heap->get_value(heap->start[smallest-1]))
+                {
+                    smallest = right;
+                }
 
-                current_element = right;
-                left = LEFT(current_element);
-                right = RIGHT(current_element);            
-            }
-            else
-            {
-                current_element = left;
-                left = LEFT(current_element);
-                right = RIGHT(current_element);            
+                if (heap->get_value(heap->start[current_element-1]) 
+                        <= heap->get_value(heap->start[smallest-1]))
+                {
+                    break;
+                }
+                swap(&heap->start[current_element-1], 
+                     &heap->start[smallest-1]);
+                current_element = smallest;
             }
         }
     }
@@ -197,14 +203,62 @@ extern BOOL heap_extract_min(BINARY_HEAP* heap,void** p_min_element)
     if (heap->size > 1 && heap->count <= heap->size / 2)
     {
         heap->size = heap->size / 2;
-        heap->start = realloc(heap->start, sizeof(void*) * heap->size);
-        
-        ENSURE_ENOUGH_MEMORY(heap->start, "heap_extract_min");     
+        heap->start = allocator_realloc(heap->allocator, heap->start,
+                                        sizeof(void*) * heap->size * 2,
+                                        sizeof(void*) * heap->size);
     }
     
     return success;
 }
 
+/** ---------------------------------------------------------------------------
+ * Funktion: sift_down_legacy
+ * ------------------------------------------------------------------------- */
+static void sift_down_legacy(BINARY_HEAP* heap)
+{
+    unsigned int current_element = 1;
+    unsigned int left = LEFT(current_element);
+    unsigned int right = RIGHT(current_element);
+
+    /*
+     * right ist hoechstens count + 1, dort steht das gerade entnommene
+     * Element. Weiter hinter count wird nicht gelesen.
+     */
+    while ( (left  <= heap->count || right <= heap->count) &&
+          (heap->get_value(heap->start[current_element-1]) > 
+            heap->get_value(heap->start[left-1]) ||
+           heap->get_value(heap->start[current_element-1]) > 
+            heap->get_value(heap->start[right-1])))
+    {
+        left = LEFT(current_element);
+        right = RIGHT(current_element);
+
+        if (heap->get_value(heap->start[left-1]) 
+                < heap->get_value(heap->start[right-1])) 
+        {
+            swap(&heap->start[current_element-1], &heap->start[left-1]);
+
+            current_element = left;
+            left = LEFT(current_element);
+            right = RIGHT(current_element);
+        }
+        else if (right <= heap->count)
+        {
+            swap(&heap->start[current_element-1], &heap->start[right-1]);
+
+            current_element = right;
+            left = LEFT(current_element);
+            right = RIGHT(current_element);            
+        }
+        else
+        {
+            current_element = left;
+            left = LEFT(current_element);
+            right = RIGHT(current_element);            
+        }
+    }
+}
+
 /** ---------------------------------------------------------------------------
  * Funktion: print_help
  * ------------------------------------------------------------------------- */
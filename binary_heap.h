@@ -40,7 +40,7 @@
 #include "btree.h"
 
 /** Funktion fuer die Rueckgabe des enthaltenen Wertes. */
-typedef int (*GET_VALUE) (void*);
+typedef unsigned long (*GET_VALUE) (void*);
 
 /** Ausgabe des enthaltenen Wertes. */
 typedef void (*PRINT_VALUE) (void*);
@@ -75,17 +75,27 @@ typedef struct _binary_heap
      * Template Funktion fuer die freigabe des Speichers der enthaltenen Objekte
      */    
     DESTROY       destroy;
+    /**
+     * Allokator fuer Heap und Elementfeld, NULL fuer calloc und free
+     */
+    ALLOCATOR*    allocator;
+    /**
+     * TRUE fuer die Entnahme der Containerversion 1 und des Altformats, deren
+     * Huffman-Baeume mit dieser Reihenfolge aufgebaut wurden
+     */
+    BOOL          legacy_order;
 } BINARY_HEAP;
 
 /**
  * Initialisiert den Heap und reserviert entsprechenden Speicher.
  * 
+ * @param Allokator fuer Heap und Elementfeld, NULL fuer calloc und free
  * @param Funktion fuer die Rueckgabe des Wertes der enth. Obj.
  * @param Funktion fuer die Ausgabe der enth. Obj.
  * @param Funktion fuer die Freigabe und Loeschung der enth. Obj.
  * @return Initialisierter Heap
  */
-extern BINARY_HEAP* heap_init(GET_VALUE, PRINT_VALUE, DESTROY);
+extern BINARY_HEAP* heap_init(ALLOCATOR*, GET_VALUE, PRINT_VALUE, DESTROY);
 
 /**
  * Loescht den Binaerheap und gibt den Speicher wieder frei.
@@ -21,19 +21,20 @@
 /** ---------------------------------------------------------------------------
  *  bit_buffer_init
  *  ------------------------------------------------------------------------ */
-extern void bit_buffer_init(FILE *file_handle)
+extern BIT_BUFFER *bit_buffer_init(ALLOCATOR *allocator, FILE *file_handle)
 {
+    BIT_BUFFER *bit_buffer;
+
     /*
      * Allokiere Speicher fuer Struktur
      */
-    bit_buffer = calloc(1,sizeof(BIT_BUFFER));
-    ENSURE_ENOUGH_MEMORY(bit_buffer, "init_bit_buffer");
+    bit_buffer = allocator_alloc(allocator, sizeof(BIT_BUFFER));
+    bit_buffer->allocator = allocator;
     
     /*
      * Allokiere Speicher fuer Buffer
      */
-    bit_buffer->start = calloc(BUFFER_SIZE, sizeof(char));
-    ENSURE_ENOUGH_MEMORY(bit_buffer->start, "init_bit_buffer");
+    bit_buffer->start = allocator_alloc(allocator, BUFFER_SIZE * sizeof(char));
     
     /*
      * Oeffne Datei zum schreiben
@@ -48,12 +49,15 @@ extern void bit_buffer_init(FILE *file_handle)
     
     bit_buffer->array_index = 0;
     bit_buffer->index = 0;
+    bit_buffer->bytes_flushed = 0;
+
+    return bit_buffer;
 }
 
 /** ---------------------------------------------------------------------------
  *  bit_buffer_add_bit
  *  ------------------------------------------------------------------------ */
-extern void bit_buffer_add_bit(BOOL bit)
+extern void bit_buffer_add_bit(BIT_BUFFER *bit_buffer, BOOL bit)
 {
     unsigned char bit_mask = 0;
     unsigned int i = 0;
@@ -92,7 +96,7 @@ extern void bit_buffer_add_bit(BOOL bit)
      */
     if (bit_buffer->array_index >= BUFFER_SIZE)
     {
-        bit_buffer_write_to_file(FALSE);
+        bit_buffer_write_to_file(bit_buffer, FALSE);
         bit_buffer->array_index = 0;
     }
 }
@@ -100,7 +104,8 @@ extern void bit_buffer_add_bit(BOOL bit)
 /** ---------------------------------------------------------------------------
  *  bit_buffer_add_binary_string
  *  ------------------------------------------------------------------------ */
-extern void bit_buffer_add_binary_string(char *bin_string)
+extern void bit_buffer_add_binary_string(BIT_BUFFER *bit_buffer,
+                                         char *bin_string)
 {
     char current_char;
     if (bin_string != NULL)
@@ -109,8 +114,8 @@ extern void bit_buffer_add_binary_string(char *bin_string)
         while(current_char != '\0')
         {
             /* Schreiben des jeweiligen Bits. */
-            if (current_char == '1') bit_buffer_add_bit(TRUE);
-            if (current_char == '0') bit_buffer_add_bit(FALSE);
+            if (current_char == '1') bit_buffer_add_bit(bit_buffer, TRUE);
+            if (current_char == '0') bit_buffer_add_bit(bit_buffer, FALSE);
             
             /* Pointer verschieben und Zeichen aktualisieren. */
             bin_string++;
@@ -122,7 +127,7 @@ extern void bit_buffer_add_binary_string(char *bin_string)
 /** ---------------------------------------------------------------------------
  *  bit_buffer_write_to_file
  *  ------------------------------------------------------------------------ */
-extern void bit_buffer_write_to_file(BOOL only_used)
+extern void bit_buffer_write_to_file(BIT_BUFFER *bit_buffer, BOOL only_used)
 {
     unsigned int i;
     size_t char_written = 0;
@@ -145,6 +150,7 @@ extern void bit_buffer_write_to_file(BOOL only_used)
                     printf("Konnte den Bit Buffer nicht rausschreiben.");
                     exit(EXIT_FAILURE);
                 }
+                bit_buffer->bytes_flushed += (unsigned long) char_written;
             }
         }
         else
@@ -157,6 +163,7 @@ extern void bit_buffer_write_to_file(BOOL only_used)
                 printf("Konnte den Bit Buffer nicht rausschreiben.");
                 exit(EXIT_FAILURE);            
             }
+            bit_buffer->bytes_flushed += (unsigned long) char_written;
         }
     }
     
@@ -173,20 +180,31 @@ extern void bit_buffer_write_to_file(BOOL only_used)
     }
 }
 
+/** ---------------------------------------------------------------------------
+ *  bit_buffer_get_position
+ *  ------------------------------------------------------------------------ */
+extern void bit_buffer_get_position(BIT_BUFFER *bit_buffer,
+                                    unsigned long *byte_offset,
+                                    unsigned int *bit_offset)
+{
+    *byte_offset = bit_buffer->bytes_flushed + bit_buffer->array_index;
+    *bit_offset = bit_buffer->index;
+}
+
 /** ---------------------------------------------------------------------------
  *  bit_buffer_destroy
  *  ------------------------------------------------------------------------ */
-extern void bit_buffer_destroy(void)
+extern void bit_buffer_destroy(BIT_BUFFER *bit_buffer)
 {
     if (bit_buffer != NULL)
     {
         /* Buffer freigeben. */
         if (bit_buffer->start != NULL)
         {
-            free(bit_buffer->start);
+            allocator_free(bit_buffer->allocator, bit_buffer->start);
         }
 
         /* Speicher fuer Struktur freigeben. */
-        free(bit_buffer);
+        allocator_free(bit_buffer->allocator, bit_buffer);
     }
 }
@@ -39,36 +39,44 @@ typedef struct _BIT_BUFFER
     
     /** Dateihandle fuer den Schreibzugriff. */
     FILE *file_handle;
+    
+    /** Anzahl bereits in die Datei geschriebener Bytes. */
+    unsigned long bytes_flushed;
+    
+    /** Allokator fuer Struktur und Buffer, NULL fuer calloc und free. */
+    ALLOCATOR *allocator;
 } BIT_BUFFER;
 
 /** Groessee des Buffers (Feldgroesse). */
 #define BUFFER_SIZE 10
 
-/** Variable fuer die Speicherung der BIT_BUFFER Struktur. */
-BIT_BUFFER *bit_buffer;
-
 /**
  * Initialisiert den Buffer und oeffnet die Datei zum schreiben.
  * 
+ * @param allocator Allokator fuer Struktur und Buffer, NULL fuer calloc
  * @param file_handle Dateinname der Ausgabedatei
+ * @return Der erzeugte Buffer
  */
-extern void bit_buffer_init(FILE *file_handle);
+extern BIT_BUFFER *bit_buffer_init(ALLOCATOR *allocator, FILE *file_handle);
 
 /**
  * Schreibt ein weiteres Bit in den Buffer. Wenn der Buffer voll ist, wird
  * dieser in die Datei geschrieben.
  * 
+ * @param bit_buffer Buffer
  * @param bit FALSE fuer 0 TRUE f�r 1
  */
-extern void bit_buffer_add_bit(BOOL bit);
+extern void bit_buffer_add_bit(BIT_BUFFER *bit_buffer, BOOL bit);
 
 /**
  * Fuegt eine gesamte Zeichenkette bestehend aus 0 & 1 in den Buffer ein.
  * Alle anderen Zeichen werden ignoriert.
  * 
+ * @param bit_buffer Buffer
  * @param bin_string binaercode in String Repr�sentation
  */
-extern void bit_buffer_add_binary_string(char *bin_string);
+extern void bit_buffer_add_binary_string(BIT_BUFFER *bit_buffer,
+                                         char *bin_string);
 
 /**
  * Schreibt den Buffer in die Datei. Wenn only_used = true dann wird nur
@@ -76,13 +84,28 @@ extern void bit_buffer_add_binary_string(char *bin_string);
  * nicht benutzten Bits im letzten char werden mit 0 aufgef�llt.
  * Wenn only_used = false dann wird der gesamte Buffer geschrieben.
  * 
+ * @param bit_buffer Buffer
  * @param only_used true fuer ganzen Buffer, false nur fuer benutzten Buff.
  */
-extern void bit_buffer_write_to_file(BOOL only_used);
+extern void bit_buffer_write_to_file(BIT_BUFFER *bit_buffer, BOOL only_used);
+
+/**
+ * Liefert die Position des naechsten zu schreibenden Bits, gezaehlt ab dem
+ * ersten Bit das seit bit_buffer_init geschrieben wurde.
+ * 
+ * @param bit_buffer Buffer
+ * @param byte_offset Byte in dem das naechste Bit gesetzt wird
+ * @param bit_offset Index des Bits innerhalb dieses Bytes (0 - 7)
+ */
+extern void bit_buffer_get_position(BIT_BUFFER *bit_buffer,
+                                    unsigned long *byte_offset,
+                                    unsigned int *bit_offset);
 
 /**
  * Gibt den Speicher fuer den Buffer wieder frei und schlie�t die Datei.
+ * 
+ * @param bit_buffer Freizugebender Buffer
  */
-extern void bit_buffer_destroy(void);
+extern void bit_buffer_destroy(BIT_BUFFER *bit_buffer);
 
 #endif	/* BIT_BUFFER_H */
@@ -62,20 +62,21 @@ static void print_pre_order(BTREE_NODE *node, PRINT_FCT print_data, int intent)
 /* ---------------------------------------------------------------------------
  * Funktion: btree_new
  * ------------------------------------------------------------------------ */
-extern BTREE *btree_new(void *data,
+extern BTREE *btree_new(ALLOCATOR *allocator,
+                        void *data,
                         DESTROY_FCT destroy_data, 
                         PRINT_FCT print_data)
 {
     BTREE_NODE *root_node;
     
     /* Speicher fuer Baum allokieren. */
-    BTREE *btree = calloc(1,sizeof(BTREE));
-    ENSURE_ENOUGH_MEMORY(btree, "btree_new");
+    BTREE *btree = allocator_alloc(allocator, sizeof(BTREE));
     
     /* Wurzelknoten erzeugen. */
-    root_node = btreenode_new(data);
+    root_node = btreenode_new(allocator, data);
     
     /* Komponenten Initialisieren. */
+    btree->allocator = allocator;
     btree->root = root_node;
     btree->destroy_data = destroy_data;
     btree->print_data = print_data;
@@ -98,7 +99,8 @@ extern BTREE *btree_clone(BTREE *tree)
         root_node = btree_get_root(tree);
 
         /* Erzeuge neunen Baum (Klon). */
-        clone_tree = btree_new(btreenode_get_data(root_node),
+        clone_tree = btree_new(tree->allocator,
+                               btreenode_get_data(root_node),
                                tree->destroy_data,
                                tree->print_data);    
 
@@ -106,10 +108,12 @@ extern BTREE *btree_clone(BTREE *tree)
         clone_root_node = btree_get_root(clone_tree);
         if (btreenode_get_left(root_node) != NULL)
             btreenode_set_left(clone_root_node,
-                               btreenode_clone(btreenode_get_left(root_node)));
+                               btreenode_clone(tree->allocator,
+                                               btreenode_get_left(root_node)));
         if (btreenode_get_right(root_node) != NULL)
             btreenode_set_right(clone_root_node,
-                                btreenode_clone(btreenode_get_right(root_node)));
+                                btreenode_clone(tree->allocator,
+                                        btreenode_get_right(root_node)));
     }
     
     return clone_tree;
@@ -123,15 +127,15 @@ extern void btree_destroy(BTREE **tree, BOOL destroy_data)
     if (tree != NULL && *tree != NULL)
     {
         /* Kinds knoten zerstoeren */
-        btreenode_destroy(&((*tree)->root), (destroy_data) 
-                ? (*tree)->destroy_data : NULL);
+        btreenode_destroy((*tree)->allocator, &((*tree)->root), 
+                          (destroy_data) ? (*tree)->destroy_data : NULL);
 
         /* Komponenten freigeben (evtl. nicht gewollt)*/
         /*if ((*tree)->destroy_data == NULL)  free(&((*tree)->destroy_data));*/
         /*if ((*tree)->print_data == NULL)    free(&((*tree)->print_data));*/
 
         /* Baum freigeben */
-        free(*tree);
+        allocator_free((*tree)->allocator, *tree);
         tree = NULL;
     }
 }
@@ -173,8 +177,8 @@ extern BTREE_NODE *btree_get_root(BTREE *tree)
 static unsigned int btree_get_depth_recursive(BTREE_NODE *node,
                                               unsigned int depth)
 {   
-    unsigned int depth_left = 0;
-    unsigned int depth_right = 0;
+    unsigned int depth_left = depth;
+    unsigned int depth_right = depth;
     
     if (btreenode_get_left(node) != NULL)
     {
@@ -188,7 +192,7 @@ static unsigned int btree_get_depth_recursive(BTREE_NODE *node,
                                                depth + 1);
     }
     
-    return (depth_left > depth_right) ? depth_left + depth : depth_left + depth;
+    return (depth_left > depth_right) ? depth_left : depth_right;
 }
 
 /* ---------------------------------------------------------------------------
@@ -213,7 +217,8 @@ extern BTREE *btree_merge(BTREE *left, BTREE *right, void *data)
         /* Erzeuge einen neuen Baum mit uebergebenem Datum und Funktionen des
          * linken Baumes.
          */
-        merged_tree = btree_new(data, left->destroy_data, left->print_data);
+        merged_tree = btree_new(left->allocator, data, left->destroy_data,
+                                left->print_data);
 
         /* Fuege beide Teilbaeume zu einer Wurzel hinzu um sie zu mergen. */
         merged_root_node = merged_tree->root;
@@ -38,6 +38,10 @@ typedef struct _BTREE {
      * Verweis auf das Wurzelelement
      */    
     BTREE_NODE  *root;
+    /**
+     * Allokator fuer Baum und Knoten, NULL fuer calloc und free
+     */
+    ALLOCATOR   *allocator;
 } BTREE;
 
 /* ===========================================================================
@@ -52,6 +56,7 @@ typedef struct _BTREE {
  * In beiden Parametern kann NULL uebergeben werden, so dass keine Funktionen
  * zum Ausgeben und Loeschen der Knotendaten gesetzt sind.
  * 
+ * @param allocator     Allokator fuer Baum und Knoten, NULL fuer calloc
  * @param data          Daten fuer die Wurzel des neuen Baums
  * @param destroy_data  Funktion, mit der die in den Knoten
  *                      enthaltenen Daten geloescht werden koennen oder NULL
@@ -60,7 +65,7 @@ typedef struct _BTREE {
  *                      koennen oder NULL
  * @return              der neu erzeugte Binaerbaum
  */
-extern BTREE *btree_new(void *data,
+extern BTREE *btree_new(ALLOCATOR *allocator, void *data,
                         DESTROY_FCT destroy_data, PRINT_FCT print_data);
 
 /**
@@ -121,8 +126,8 @@ extern int btree_get_max_depth(BTREE_NODE *node);
  * Erzeugt einen neuen Binaerbaum, dessen Wurzel die uebergebenen Daten 
  * erhaelt. Die neue Wurzel bekommt die Wurzel des Binaerbaums left als
  * linken Nachfolger und die Wurzel des Binaerbaums right als rechten 
- * Nachfolger. Der neue Baum erhaelt die Funktionen aus dem Baum, der als linker
- * Nachfolger angefuegt wird.
+ * Nachfolger. Der neue Baum erhaelt die Funktionen und den Allokator aus dem
+ * Baum, der als linker Nachfolger angefuegt wird.
  * 
  * Der Speicherbereich der beiden verbundenen B�ume, jedoch nicht ihrer Knoten 
  * wird freigegeben.
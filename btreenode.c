@@ -24,11 +24,10 @@
 /** ---------------------------------------------------------------------------
  *  Funktion: btreenode_new
  *  ------------------------------------------------------------------------ */
-extern BTREE_NODE *btreenode_new(void *data)
+extern BTREE_NODE *btreenode_new(ALLOCATOR *allocator, void *data)
 {
     /* Speicher fuer Knoten allokieren. */
-    BTREE_NODE *node = calloc(1,sizeof(BTREE_NODE));
-    ENSURE_ENOUGH_MEMORY(node, "btreenode_new");
+    BTREE_NODE *node = allocator_alloc(allocator, sizeof(BTREE_NODE));
     
     /* Komponenten Initialisieren. */
     node->data = data;
@@ -41,24 +40,27 @@ extern BTREE_NODE *btreenode_new(void *data)
 /** ---------------------------------------------------------------------------
  *  Funktion: btreenode_clone
  *  ------------------------------------------------------------------------ */
-extern BTREE_NODE *btreenode_clone(BTREE_NODE *input_node)
+extern BTREE_NODE *btreenode_clone(ALLOCATOR *allocator,
+                                   BTREE_NODE *input_node)
 {
     BTREE_NODE *node = NULL;
     
     if (input_node != NULL)
     {
         /* Neuen Wurzelknoten erzeugen. */
-        node = btreenode_new(input_node->data);
+        node = btreenode_new(allocator, input_node->data);
 
         /* Komponenten kopieren (Rekursive deep copy). */
         if (input_node->left != NULL)
         {
-            btreenode_set_left(node, btreenode_clone(input_node->left));
+            btreenode_set_left(node, btreenode_clone(allocator,
+                                                     input_node->left));
         }
             
         if (input_node->right != NULL)
         {
-            btreenode_set_right(node, btreenode_clone(input_node->right));
+            btreenode_set_right(node, btreenode_clone(allocator,
+                                                      input_node->right));
         }
     }
     
@@ -109,7 +111,9 @@ extern BOOL btreenode_equals(BTREE_NODE *node1, BTREE_NODE *node2)
 /** ---------------------------------------------------------------------------
  *  Funktion: btreenode_destroy
  *  ------------------------------------------------------------------------ */
-extern void btreenode_destroy(BTREE_NODE **node, DESTROY_FCT destroy_data)
+extern void btreenode_destroy(ALLOCATOR *allocator,
+                              BTREE_NODE **node,
+                              DESTROY_FCT destroy_data)
 {
 
     if (BOTH_NOT_NULL(node, *node))
@@ -117,12 +121,12 @@ extern void btreenode_destroy(BTREE_NODE **node, DESTROY_FCT destroy_data)
         /* Kindsknoten Zerstoeren */
         if (btreenode_get_left(*node) != NULL)
         {
-            btreenode_destroy(&((*node)->left), destroy_data);
+            btreenode_destroy(allocator, &((*node)->left), destroy_data);
         }
             
         if (btreenode_get_right(*node) != NULL)
         {
-            btreenode_destroy(&((*node)->right), destroy_data);
+            btreenode_destroy(allocator, &((*node)->right), destroy_data);
         }
             
         /* Wenn eine Funktionuebergeben wurde soll der Inhalt zerstoert werden. */
@@ -132,7 +136,7 @@ extern void btreenode_destroy(BTREE_NODE **node, DESTROY_FCT destroy_data)
         }
 
         /* Zerstoerung des Vaterelements nachdem die Kinder vernichtet wurden. */
-        free(*node);
+        allocator_free(allocator, *node);
         *node = NULL;
     }
 }
@@ -15,6 +15,7 @@
  * ======================================================================== */
 
 #include "common.h"
+#include "allocator.h"
 
 /* ========================================================================= *
  * Strukturen, Typdefinitionen
@@ -56,20 +57,22 @@ typedef void (*PRINT_FCT)(void *);
  * Erzeugt einen neuen Knoten mit den bergebenen Daten. Der neue Knoten hat 
  * keine Nachfolger.
  *
+ * @param allocator Allokator fuer den Knoten, NULL fuer calloc
  * @param data      Daten des neuen Knotens(*tree)->destroy_dat
  * @return          Der neu erzeugte Knoten
  */
-extern BTREE_NODE *btreenode_new(void *data);
+extern BTREE_NODE *btreenode_new(ALLOCATOR *allocator, void *data);
 
 /**
  * Erzeugt eine Kopie (deep copy) des Knotens und seiner direkten und 
  * indirekten Nachfolger. Die Daten in den Knoten werden nicht kopiert, 
  * sondern nur ihre Referenz in die neuen Knoten bernommen.
  * 
+ * @param allocator Allokator fuer die neuen Knoten, NULL fuer calloc
  * @param node  Knoten, ab dem der Binrbaum kopiert werden soll
  * @return      Die neu erzeugte Kopie des bergebenen Knotens
  */
-extern BTREE_NODE *btreenode_clone(BTREE_NODE *node);
+extern BTREE_NODE *btreenode_clone(ALLOCATOR *allocator, BTREE_NODE *node);
 
 /**
  * Liefert TRUE, wenn die beiden bergebenen Knoten dieselben Daten beinhalten
@@ -87,10 +90,13 @@ extern BOOL btreenode_equals(BTREE_NODE *node1, BTREE_NODE *node2);
  * mit der die Daten der Knoten gelscht werden. Die Daten werden nicht
  * gelscht, wenn in diesem Parameter NULL bergeben wird.
  *
+ * @param allocator     Allokator der Knoten, NULL fuer free
  * @param node          Der zu lschende Knoten
  * @param destroy_data  Funktion zum Lschen der Daten, NULL sonst
  */
-extern void btreenode_destroy(BTREE_NODE **node, DESTROY_FCT destroy_data);
+extern void btreenode_destroy(ALLOCATOR *allocator,
+                              BTREE_NODE **node,
+                              DESTROY_FCT destroy_data);
 
 /**
  * Liefert die Daten des Knotens.
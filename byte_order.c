@@ -0,0 +1,55 @@
+/**
+ * File: byte_order.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "byte_order.h"
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: store_le
+ *  ------------------------------------------------------------------------ */
+extern void store_le(unsigned char *p_buffer,
+                     unsigned long value,
+                     unsigned int byte_count)
+{
+    unsigned int i;
+
+    /*
+     * Immer nur um 8 Bit schieben: bei 32 Bit unsigned long werden die
+     * oberen Bytes so mit 0 gefuellt.
+     */
+    for (i = 0; i < byte_count; i++)
+    {
+        p_buffer[i] = (unsigned char) (value & 0xFF);
+        value >>= 8;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: load_le
+ *  ------------------------------------------------------------------------ */
+extern unsigned long load_le(unsigned char *p_buffer, unsigned int byte_count)
+{
+    unsigned long value = 0;
+
+    while (byte_count > 0)
+    {
+        byte_count--;
+        value = (value << 8) | p_buffer[byte_count];
+    }
+
+    return value;
+}
@@ -0,0 +1,44 @@
+/**
+ * File: byte_order.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BYTE_ORDER_H
+
+#define	BYTE_ORDER_H
+
+/**
+ * Schreibt einen Wert unabhaengig von der Bytereihenfolge des Rechners als
+ * Little-Endian mit byte_count Bytes.
+ *
+ * @param p_buffer Ziel mit mindestens byte_count Bytes
+ * @param value Zu schreibender Wert
+ * @param byte_count Anzahl Bytes (1 - 8)
+ */
+extern void store_le(unsigned char *p_buffer,
+                     unsigned long value,
+                     unsigned int byte_count);
+
+/**
+ * Liest einen als Little-Endian mit byte_count Bytes gespeicherten Wert.
+ *
+ * @param p_buffer Quelle mit mindestens byte_count Bytes
+ * @param byte_count Anzahl Bytes (1 - 8)
+ * @return Gelesener Wert
+ */
+extern unsigned long load_le(unsigned char *p_buffer, unsigned int byte_count);
+
+#endif	/* BYTE_ORDER_H */
@@ -0,0 +1,187 @@
+/**
+ * File: checksum.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "checksum.h"
+
+/** Polynom von CRC32C (Castagnoli) in umgekehrter Bitreihenfolge. */
+#define CRC32C_POLYNOMIAL 0x82f63b78UL
+
+/*
+ * Die SSE4.2-Variante wird nur mit GCC auf x86-64 uebersetzt und mit dem
+ * Attribut target("sse4.2") erzeugt, der Rest des Programms bleibt ohne
+ * SSE4.2 lauffaehig.
+ */
+#if defined(__GNUC__) && defined(__x86_64__) \
+    && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define CHECKSUM_HAVE_SSE42
+#define SSE42_TARGET __attribute__((target("sse4.2")))
+#endif
+
+/** Zur Laufzeit gewaehlte CRC32C-Funktion. */
+CRC32C_FUNCTION crc32c_update = crc32c_slicing8;
+
+/** Name der gewaehlten CRC32C-Funktion. */
+char *crc32c_name = "slicing-by-8";
+
+/**
+ * Tabellen fuer Slicing-by-8: crc_tables[k][n] ist die Pruefsumme des Bytes
+ * n gefolgt von k Nullbytes.
+ */
+static unsigned int crc_tables[8][256];
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: checksum_init
+ *  ------------------------------------------------------------------------ */
+extern void checksum_init(BOOL verbose)
+{
+    unsigned int n, k, bit;
+    unsigned long crc;
+
+    for (n = 0; n < 256; n++)
+    {
+        crc = n;
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+        }
+        crc_tables[0][n] = (unsigned int) crc;
+    }
+    for (k = 1; k < 8; k++)
+    {
+        for (n = 0; n < 256; n++)
+        {
+            crc = crc_tables[k - 1][n];
+            crc_tables[k][n] = (unsigned int) 
+                    ((crc >> 8) ^ crc_tables[0][crc & 0xff]);
+        }
+    }
+
+    crc32c_update = crc32c_slicing8;
+    crc32c_name = "slicing-by-8";
+
+#ifdef CHECKSUM_HAVE_SSE42
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2") 
+            && getenv("HUFFMAN_NO_SSE42") == NULL)
+    {
+        crc32c_update = crc32c_sse42;
+        crc32c_name = "sse4.2";
+    }
+#endif
+
+    if (verbose)
+    {
+        printf("\tCRC32C: %s\n", crc32c_name);
+        fflush(stdout);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: crc32c_slicing8
+ *  ------------------------------------------------------------------------ */
+extern unsigned long crc32c_slicing8(unsigned long crc,
+                                     unsigned char *p_data,
+                                     unsigned long length)
+{
+    unsigned long low, high;
+
+    crc = ~crc & 0xffffffffUL;
+
+    /*
+     * Die 8 Bytes werden byteweise zusammengesetzt, damit das Ergebnis nicht
+     * von der Byte-Reihenfolge des Prozessors abhaengt.
+     */
+    while (length >= 8)
+    {
+        low = crc ^ ((unsigned long) p_data[0] 
+                     | (unsigned long) p_data[1] << 8
+                     | (unsigned long) p_data[2] << 16 
+                     | (unsigned long) p_data[3] << 24);
+        high = (unsigned long) p_data[4] 
+               | (unsigned long) p_data[5] << 8
+               | (unsigned long) p_data[6] << 16 
+               | (unsigned long) p_data[7] << 24;
+        crc = crc_tables[7][low & 0xff] 
+              ^ crc_tables[6][(low >> 8) & 0xff]
+              ^ crc_tables[5][(low >> 16) & 0xff] 
+              ^ crc_tables[4][low >> 24]
+              ^ crc_tables[3][high & 0xff] 
+              ^ crc_tables[2][(high >> 8) & 0xff]
+              ^ crc_tables[1][(high >> 16) & 0xff] 
+              ^ crc_tables[0][high >> 24];
+        p_data += 8;
+        length -= 8;
+    }
+
+    while (length > 0)
+    {
+        crc = (crc >> 8) ^ crc_tables[0][(crc ^ *p_data++) & 0xff];
+        length--;
+    }
+
+    return ~crc & 0xffffffffUL;
+}
+
+#ifdef CHECKSUM_HAVE_SSE42
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: crc32c_sse42
+ *  ------------------------------------------------------------------------ */
+SSE42_TARGET
+extern unsigned long crc32c_sse42(unsigned long crc,
+                                  unsigned char *p_data,
+                                  unsigned long length)
+{
+    unsigned long word;
+
+    crc = ~crc & 0xffffffffUL;
+
+    while (length >= 8)
+    {
+        memcpy(&word, p_data, sizeof(word));
+        crc = __builtin_ia32_crc32di(crc, word);
+        p_data += 8;
+        length -= 8;
+    }
+
+    while (length > 0)
+    {
+        crc = __builtin_ia32_crc32qi((unsigned int) crc, *p_data++);
+        length--;
+    }
+
+    return ~crc & 0xffffffffUL;
+}
+
+#else
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: crc32c_sse42
+ *  ------------------------------------------------------------------------ */
+extern unsigned long crc32c_sse42(unsigned long crc,
+                                  unsigned char *p_data,
+                                  unsigned long length)
+{
+    return crc32c_slicing8(crc, p_data, length);
+}
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * File: checksum.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHECKSUM_H
+
+#define	CHECKSUM_H
+
+#include "common.h"
+
+/** Groesse einer gespeicherten Pruefsumme in Byte. */
+#define CHECKSUM_SIZE 4
+
+/**
+ * CRC32C-Funktion: fuehrt die Pruefsumme crc ueber length weitere Bytes
+ * fort. Die Pruefsumme einer leeren Eingabe ist 0.
+ */
+typedef unsigned long (*CRC32C_FUNCTION)(unsigned long crc,
+                                         unsigned char *p_data,
+                                         unsigned long length);
+
+/** Zur Laufzeit gewaehlte CRC32C-Funktion. */
+extern CRC32C_FUNCTION crc32c_update;
+
+/** Name der gewaehlten CRC32C-Funktion. */
+extern char *crc32c_name;
+
+/**
+ * Erzeugt die Tabellen fuer Slicing-by-8 und waehlt anhand von CPUID die
+ * CRC32-Instruktion von SSE4.2. Mit der Umgebungsvariable HUFFMAN_NO_SSE42
+ * wird immer Slicing-by-8 verwendet.
+ *
+ * @param verbose TRUE um die gewaehlte Funktion auszugeben
+ */
+extern void checksum_init(BOOL verbose);
+
+/** CRC32C mit acht Tabellen, verarbeitet 8 Bytes je Schleifendurchlauf. */
+extern unsigned long crc32c_slicing8(unsigned long crc,
+                                     unsigned char *p_data,
+                                     unsigned long length);
+
+/** CRC32C mit der CRC32-Instruktion, nur nach checksum_init. */
+extern unsigned long crc32c_sse42(unsigned long crc,
+                                  unsigned char *p_data,
+                                  unsigned long length);
+
+#endif	/* CHECKSUM_H */
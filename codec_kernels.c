@@ -0,0 +1,610 @@
+/**
+ * File: codec_kernels.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "codec_kernels.h"
+
+/*
+ * Die BMI2-Kernel werden nur mit GCC auf x86-64 uebersetzt. Dort werden sie
+ * mit dem Attribut target("bmi2") erzeugt, sodass der Compiler fuer variable
+ * Shifts SHLX/SHRX verwendet, und BZHI wird direkt aufgerufen.
+ */
+#if defined(__GNUC__) && defined(__x86_64__) \
+    && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define KERNELS_HAVE_BMI2
+#define BMI2_TARGET __attribute__((target("bmi2")))
+#endif
+
+/** Zur Laufzeit gewaehlter Kodierkernel. */
+ENCODE_KERNEL kernel_encode = encode_portable;
+
+/** Zur Laufzeit gewaehlter Dekodierkernel. */
+DECODE_KERNEL kernel_decode = decode_portable;
+
+/** Name der gewaehlten Kernel. */
+char *kernel_name = "portable";
+
+/**
+ * Diese Funktion nummeriert die inneren Knoten des Baums in
+ * Preorder-Reihenfolge und legt ihre Nachfolger in der Dekodiertabelle ab.
+ *
+ * @param node Aktueller Knoten
+ * @param table Dekodiertabelle
+ * @param p_node_count Anzahl bisher vergebener Knoten
+ * @param depth Tiefe des Knotens
+ * @return Nummer des Knotens oder kodiertes Blatt
+ */
+static int number_nodes(BTREE_NODE *node,
+                        DECODE_TABLE *table,
+                        unsigned int *p_node_count,
+                        unsigned int depth);
+
+/**
+ * Diese Funktion fuellt die Eintraege der Dekodiertabelle aus dem bereits
+ * aufgebauten Baum der inneren Knoten.
+ *
+ * @param table Dekodiertabelle
+ */
+static void fill_entries(DECODE_TABLE *table);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: kernels_bmi2_available
+ *  ------------------------------------------------------------------------ */
+extern BOOL kernels_bmi2_available(void)
+{
+#ifdef KERNELS_HAVE_BMI2
+    __builtin_cpu_init();
+    return (__builtin_cpu_supports("bmi2")) ? TRUE : FALSE;
+#else
+    return FALSE;
+#endif
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: kernels_init
+ *  ------------------------------------------------------------------------ */
+extern void kernels_init(BOOL verbose)
+{
+    kernel_encode = encode_portable;
+    kernel_decode = decode_portable;
+    kernel_name = "portable";
+
+    if (kernels_bmi2_available() && getenv("HUFFMAN_NO_BMI2") == NULL)
+    {
+        kernel_encode = encode_bmi2;
+        kernel_decode = decode_bmi2;
+        kernel_name = "bmi2";
+    }
+
+    if (verbose)
+    {
+        printf("\tKernel: %s\n", kernel_name);
+        fflush(stdout);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: code_table_init
+ *  ------------------------------------------------------------------------ */
+extern void code_table_init(CODE_TABLE *table,
+                            SYMBOL *p_symbols,
+                            unsigned int count)
+{
+    unsigned int i;
+    char *p_bit;
+    CODE_ENTRY *p_entry;
+
+    memset(table, 0, sizeof(CODE_TABLE));
+
+    for (i = 0; i < count; i++)
+    {
+        p_entry = &table->entries[p_symbols[i].symbol];
+        for (p_bit = p_symbols[i].code; p_bit != NULL && *p_bit != '\0';
+             p_bit++)
+        {
+            p_entry->bits = (p_entry->bits << 1) | (*p_bit == '1');
+            p_entry->length++;
+        }
+
+        if (p_entry->length > table->max_length)
+        {
+            table->max_length = p_entry->length;
+        }
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_table_init
+ *  ------------------------------------------------------------------------ */
+extern void decode_table_init(DECODE_TABLE *table, BTREE_NODE *root)
+{
+    unsigned int node_count = 0;
+
+    memset(table, 0, sizeof(DECODE_TABLE));
+
+    if (btreenode_is_leaf(root))
+    {
+        table->single = TRUE;
+        table->single_symbol = ((SYMBOL*) btreenode_get_data(root))->symbol;
+        return;
+    }
+
+    number_nodes(root, table, &node_count, 0);
+    fill_entries(table);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_table_from_codes
+ *  ------------------------------------------------------------------------ */
+extern void decode_table_from_codes(DECODE_TABLE *table,
+                                    CODE_TABLE *codes,
+                                    unsigned char single_symbol)
+{
+    unsigned int node_count = 1;
+    unsigned int symbol, bit, length;
+    int node;
+    short *p_child;
+
+    memset(table, 0, sizeof(DECODE_TABLE));
+    table->max_length = codes->max_length;
+
+    /* Nur ein Baum aus einem Blatt hat keinen Code mit mindestens 1 Bit. */
+    if (codes->max_length == 0)
+    {
+        table->single = TRUE;
+        table->single_symbol = single_symbol;
+        return;
+    }
+
+    /*
+     * Jeden Code (hoechstwertiges Bit zuerst) in den Baum einfuegen. Ein
+     * Nachfolger 0 ist noch nicht belegt, da die Wurzel nie Nachfolger ist.
+     */
+    for (symbol = 0; symbol < 256; symbol++)
+    {
+        length = codes->entries[symbol].length;
+        node = 0;
+        for (bit = 0; bit < length; bit++)
+        {
+            p_child = &table->children[node]
+                    [(codes->entries[symbol].bits >> (length - 1 - bit)) & 1];
+            if (bit + 1 == length)
+            {
+                *p_child = (short) -((int) symbol + 1);
+            }
+            else
+            {
+                if (*p_child == 0)
+                {
+                    *p_child = (short) node_count++;
+                }
+                node = *p_child;
+            }
+        }
+    }
+    fill_entries(table);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: fill_entries
+ *  ------------------------------------------------------------------------ */
+static void fill_entries(DECODE_TABLE *table)
+{
+    unsigned int index, bit;
+    int node;
+    DECODE_ENTRY *p_entry;
+
+    /*
+     * Fuer jeden Index die KERNEL_TABLE_BITS Bits (hoechstwertiges zuerst)
+     * durch den Baum verfolgen. Endet der Weg in einem Blatt, enthaelt der
+     * Eintrag Zeichen und Codelaenge, sonst den erreichten Knoten.
+     */
+    for (index = 0; index < KERNEL_TABLE_SIZE; index++)
+    {
+        p_entry = &table->entries[index];
+        node = 0;
+
+        for (bit = 0; bit < KERNEL_TABLE_BITS; bit++)
+        {
+            node = table->children[node]
+                    [(index >> (KERNEL_TABLE_BITS - 1 - bit)) & 1];
+            if (node < 0)
+            {
+                p_entry->symbol = (unsigned char) -(node + 1);
+                p_entry->length = (unsigned char) (bit + 1);
+                break;
+            }
+        }
+
+        if (node >= 0)
+        {
+            p_entry->node = (unsigned short) node;
+        }
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: number_nodes
+ *  ------------------------------------------------------------------------ */
+static int number_nodes(BTREE_NODE *node,
+                        DECODE_TABLE *table,
+                        unsigned int *p_node_count,
+                        unsigned int depth)
+{
+    int number;
+
+    if (btreenode_is_leaf(node))
+    {
+        if (depth > table->max_length)
+        {
+            table->max_length = depth;
+        }
+        return -((int) ((SYMBOL*) btreenode_get_data(node))->symbol + 1);
+    }
+
+    number = (int) (*p_node_count)++;
+    table->children[number][0] = (short) number_nodes(
+            btreenode_get_left(node), table, p_node_count, depth + 1);
+    table->children[number][1] = (short) number_nodes(
+            btreenode_get_right(node), table, p_node_count, depth + 1);
+
+    return number;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: encode_state_init
+ *  ------------------------------------------------------------------------ */
+extern void encode_state_init(ENCODE_STATE *state)
+{
+    state->bits = 0;
+    state->bit_count = 0;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: encode_state_flush
+ *  ------------------------------------------------------------------------ */
+extern unsigned long encode_state_flush(ENCODE_STATE *state,
+                                        unsigned char *p_output)
+{
+    unsigned long written = 0;
+
+    if (state->bit_count > 0)
+    {
+        *p_output = (unsigned char) (state->bits << (8 - state->bit_count));
+        written = 1;
+    }
+    encode_state_init(state);
+
+    return written;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_state_init
+ *  ------------------------------------------------------------------------ */
+extern void decode_state_init(DECODE_STATE *state,
+                              unsigned char *p_input,
+                              unsigned long input_length,
+                              unsigned int bit_offset)
+{
+    state->p_next = p_input;
+    state->p_end = p_input + input_length;
+    state->bits = 0;
+    state->bit_count = 0;
+
+    /*
+     * Beginnt der Code innerhalb eines Bytes, werden die davor liegenden
+     * Bits als bereits verbraucht betrachtet.
+     */
+    if (bit_offset > 0 && input_length > 0)
+    {
+        state->bits = *state->p_next++;
+        state->bit_count = 8 - bit_offset;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: encode_portable
+ *  ------------------------------------------------------------------------ */
+extern unsigned long encode_portable(CODE_TABLE *table,
+                                     ENCODE_STATE *state,
+                                     unsigned char *p_input,
+                                     unsigned long input_length,
+                                     unsigned char *p_output)
+{
+    unsigned char *p_input_end = p_input + input_length;
+    unsigned char *p_output_start = p_output;
+    unsigned long bits = state->bits;
+    unsigned int bit_count = state->bit_count;
+    CODE_ENTRY *p_entry;
+
+    while (p_input < p_input_end)
+    {
+        p_entry = &table->entries[*p_input++];
+        bits = (bits << p_entry->length) | p_entry->bits;
+        bit_count += p_entry->length;
+
+        /* Alle vollstaendigen Bytes schreiben. */
+        while (bit_count >= 8)
+        {
+            bit_count -= 8;
+            *p_output++ = (unsigned char) (bits >> bit_count);
+        }
+    }
+
+    state->bits = bits;
+    state->bit_count = bit_count;
+
+    return (unsigned long) (p_output - p_output_start);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_portable
+ *  ------------------------------------------------------------------------ */
+extern unsigned long decode_portable(DECODE_TABLE *table,
+                                     DECODE_STATE *state,
+                                     unsigned char *p_output,
+                                     unsigned long output_length)
+{
+    unsigned char *p_output_start = p_output;
+    unsigned char *p_output_end = p_output + output_length;
+    unsigned char *p_next = state->p_next;
+    unsigned long bits = state->bits;
+    unsigned int bit_count = state->bit_count;
+    unsigned int remaining;
+    unsigned long index;
+    DECODE_ENTRY *p_entry;
+    int node;
+    BOOL exhausted = FALSE;
+
+    if (table->single)
+    {
+        memset(p_output, table->single_symbol, output_length);
+        return output_length;
+    }
+
+    while (p_output < p_output_end && !exhausted)
+    {
+        /* Bitspeicher byteweise auffuellen. */
+        while (bit_count <= KERNEL_WORD_BITS - 8 && p_next < state->p_end)
+        {
+            bits = (bits << 8) | *p_next++;
+            bit_count += 8;
+        }
+
+        /*
+         * Am Ende der Eingabe fehlende Bits fuer den Tabellenzugriff mit 0
+         * auffuellen; der Eintrag wird nur genutzt wenn sein Code vollstaendig
+         * vorhanden ist.
+         */
+        if (bit_count >= KERNEL_TABLE_BITS)
+        {
+            index = bits >> (bit_count - KERNEL_TABLE_BITS);
+        }
+        else
+        {
+            index = bits << (KERNEL_TABLE_BITS - bit_count);
+        }
+        p_entry = &table->entries[index & (KERNEL_TABLE_SIZE - 1)];
+
+        if (p_entry->length > 0)
+        {
+            if (p_entry->length > bit_count)
+            {
+                exhausted = TRUE;
+            }
+            else
+            {
+                *p_output++ = p_entry->symbol;
+                bit_count -= p_entry->length;
+            }
+        }
+        else if (bit_count < KERNEL_TABLE_BITS)
+        {
+            exhausted = TRUE;
+        }
+        else
+        {
+            /*
+             * Langer Code: ab dem Knoten nach KERNEL_TABLE_BITS Bits
+             * bitweise im Baum weitergehen.
+             */
+            remaining = bit_count - KERNEL_TABLE_BITS;
+            node = p_entry->node;
+            while (node >= 0)
+            {
+                if (remaining == 0)
+                {
+                    exhausted = TRUE;
+                    break;
+                }
+                remaining--;
+                node = table->children[node][(bits >> remaining) & 1];
+            }
+
+            if (node < 0)
+            {
+                *p_output++ = (unsigned char) -(node + 1);
+                bit_count = remaining;
+            }
+        }
+    }
+
+    state->p_next = p_next;
+    state->bits = bits;
+    state->bit_count = bit_count;
+
+    return (unsigned long) (p_output - p_output_start);
+}
+
+#ifdef KERNELS_HAVE_BMI2
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: encode_bmi2
+ *  ------------------------------------------------------------------------ */
+BMI2_TARGET
+extern unsigned long encode_bmi2(CODE_TABLE *table,
+                                 ENCODE_STATE *state,
+                                 unsigned char *p_input,
+                                 unsigned long input_length,
+                                 unsigned char *p_output)
+{
+    unsigned char *p_input_end = p_input + input_length;
+    unsigned char *p_output_start = p_output;
+    unsigned long bits = state->bits;
+    unsigned long word;
+    unsigned int bit_count = state->bit_count;
+    CODE_ENTRY *p_entry;
+
+    /* Ein Baum aus einem Blatt erzeugt keine Bits. */
+    if (table->max_length == 0)
+    {
+        return 0;
+    }
+
+    /*
+     * Nach jedem Zeichen werden die offenen Bits linksbuendig als ein
+     * 8-Byte-Wort (Big Endian) geschrieben, der Zeiger aber nur um die
+     * vollstaendigen Bytes weitergeschoben. Das ersetzt die Schleife ueber
+     * die einzelnen Bytes.
+     */
+    while (p_input < p_input_end)
+    {
+        p_entry = &table->entries[*p_input++];
+        bits = (bits << p_entry->length) | p_entry->bits;
+        bit_count += p_entry->length;
+
+        word = __builtin_bswap64(bits << (KERNEL_WORD_BITS - bit_count));
+        memcpy(p_output, &word, sizeof(word));
+        p_output += bit_count >> 3;
+        bit_count &= 7;
+    }
+
+    state->bits = bits;
+    state->bit_count = bit_count;
+
+    return (unsigned long) (p_output - p_output_start);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_bmi2
+ *  ------------------------------------------------------------------------ */
+BMI2_TARGET
+extern unsigned long decode_bmi2(DECODE_TABLE *table,
+                                 DECODE_STATE *state,
+                                 unsigned char *p_output,
+                                 unsigned long output_length)
+{
+    unsigned char *p_output_start = p_output;
+    unsigned char *p_output_end = p_output + output_length;
+    unsigned char *p_next = state->p_next;
+    unsigned long bits = state->bits;
+    unsigned long word;
+    unsigned int bit_count = state->bit_count;
+    unsigned int refill_bits;
+    unsigned int min_bits = (table->max_length > KERNEL_TABLE_BITS)
+                          ? table->max_length : KERNEL_TABLE_BITS;
+    DECODE_ENTRY *p_entry;
+    int node;
+
+    if (table->single)
+    {
+        memset(p_output, table->single_symbol, output_length);
+        return output_length;
+    }
+
+    while (p_output < p_output_end && p_next + sizeof(word) <= state->p_end)
+    {
+        /*
+         * Verzweigungsfreies Auffuellen auf 56 - 63 Bits: es werden immer
+         * 8 Byte geladen und nur die fehlenden ganzen Bytes uebernommen.
+         */
+        memcpy(&word, p_next, sizeof(word));
+        word = __builtin_bswap64(word);
+        refill_bits = (63 - bit_count) & ~7U;
+        bits = (bits << refill_bits) | ((word >> 1) >> (63 - refill_bits));
+        bit_count += refill_bits;
+        p_next += refill_bits >> 3;
+
+        /*
+         * Solange jeder Code sicher vollstaendig im Bitspeicher liegt,
+         * ohne weitere Pruefungen dekodieren.
+         */
+        while (bit_count >= min_bits && p_output < p_output_end)
+        {
+            p_entry = &table->entries[__builtin_ia32_bzhi_di(
+                    bits >> (bit_count - KERNEL_TABLE_BITS),
+                    KERNEL_TABLE_BITS)];
+
+            if (p_entry->length > 0)
+            {
+                *p_output++ = p_entry->symbol;
+                bit_count -= p_entry->length;
+            }
+            else
+            {
+                bit_count -= KERNEL_TABLE_BITS;
+                node = p_entry->node;
+                while (node >= 0)
+                {
+                    bit_count--;
+                    node = table->children[node][(bits >> bit_count) & 1];
+                }
+                *p_output++ = (unsigned char) -(node + 1);
+            }
+        }
+    }
+
+    state->p_next = p_next;
+    state->bits = bits;
+    state->bit_count = bit_count;
+
+    /* Die letzten Bytes der Eingabe uebernimmt der portable Kernel. */
+    return (unsigned long) (p_output - p_output_start)
+            + decode_portable(table, state, p_output,
+                              (unsigned long) (p_output_end - p_output));
+}
+
+#else
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: encode_bmi2
+ *  ------------------------------------------------------------------------ */
+extern unsigned long encode_bmi2(CODE_TABLE *table,
+                                 ENCODE_STATE *state,
+                                 unsigned char *p_input,
+                                 unsigned long input_length,
+                                 unsigned char *p_output)
+{
+    return encode_portable(table, state, p_input, input_length, p_output);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_bmi2
+ *  ------------------------------------------------------------------------ */
+extern unsigned long decode_bmi2(DECODE_TABLE *table,
+                                 DECODE_STATE *state,
+                                 unsigned char *p_output,
+                                 unsigned long output_length)
+{
+    return decode_portable(table, state, p_output, output_length);
+}
+
+#endif
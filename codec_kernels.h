@@ -0,0 +1,284 @@
+/**
+ * File: codec_kernels.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CODEC_KERNELS_H
+
+#define	CODEC_KERNELS_H
+
+#include "common.h"
+#include "btreenode.h"
+#include "huffman.h"
+
+/** Anzahl Bits die der Dekodierer mit einem Tabellenzugriff aufloest. */
+#define KERNEL_TABLE_BITS 11
+
+/** Anzahl Eintraege der Dekodiertabelle. */
+#define KERNEL_TABLE_SIZE (1 << KERNEL_TABLE_BITS)
+
+/** Anzahl Bits des Bitspeichers der Kernel. */
+#define KERNEL_WORD_BITS (sizeof(unsigned long) * 8)
+
+/**
+ * Maximale Codelaenge, die die Kernel verarbeiten. Laengere Codes werden vom
+ * bit_buffer geschrieben und vom Baum-Dekodierer gelesen.
+ */
+#define KERNEL_MAX_CODE_LENGTH (KERNEL_WORD_BITS - 8)
+
+/** Zusaetzlicher Platz hinter Ausgabepuffern des Kodierers in Byte. */
+#define KERNEL_OUTPUT_SLACK 16
+
+/** Code eines Zeichens als Bitfolge. */
+typedef struct _CODE_ENTRY
+{
+    /**
+     * Bits des Codes, rechtsbuendig
+     */
+    unsigned long bits;
+    /**
+     * Anzahl der Bits
+     */
+    unsigned int length;
+} CODE_ENTRY;
+
+/** Codetabelle fuer den Kodierer mit einem Eintrag je moeglichem Zeichen. */
+typedef struct _CODE_TABLE
+{
+    /**
+     * Codes aller Zeichen, Laenge 0 fuer nicht vorkommende Zeichen
+     */
+    CODE_ENTRY entries[256];
+    /**
+     * Laengster Code der Tabelle
+     */
+    unsigned int max_length;
+} CODE_TABLE;
+
+/** Eintrag der Dekodiertabelle. */
+typedef struct _DECODE_ENTRY
+{
+    /**
+     * Dekodiertes Zeichen
+     */
+    unsigned char symbol;
+    /**
+     * Laenge des Codes, 0 wenn der Code laenger als KERNEL_TABLE_BITS ist
+     */
+    unsigned char length;
+    /**
+     * Knoten nach KERNEL_TABLE_BITS Bits fuer lange Codes
+     */
+    unsigned short node;
+} DECODE_ENTRY;
+
+/** Dekodiertabelle mit Baum fuer lange Codes. */
+typedef struct _DECODE_TABLE
+{
+    /**
+     * Eintraege, adressiert mit den naechsten KERNEL_TABLE_BITS Bits
+     */
+    DECODE_ENTRY entries[KERNEL_TABLE_SIZE];
+    /**
+     * Nachfolger der inneren Knoten: >= 0 innerer Knoten, sonst das Blatt
+     * mit dem Zeichen -(Nachfolger + 1)
+     */
+    short children[255][2];
+    /**
+     * Laengster Code des Baums
+     */
+    unsigned int max_length;
+    /**
+     * TRUE wenn der Baum nur aus einem Blatt besteht
+     */
+    BOOL single;
+    /**
+     * Zeichen des einzigen Blatts
+     */
+    unsigned char single_symbol;
+} DECODE_TABLE;
+
+/** Zustand des Kodierers zwischen zwei Aufrufen. */
+typedef struct _ENCODE_STATE
+{
+    /**
+     * Noch nicht geschriebene Bits, rechtsbuendig
+     */
+    unsigned long bits;
+    /**
+     * Anzahl noch nicht geschriebener Bits (0 - 7)
+     */
+    unsigned int bit_count;
+} ENCODE_STATE;
+
+/** Zustand des Dekodierers zwischen zwei Aufrufen. */
+typedef struct _DECODE_STATE
+{
+    /**
+     * Naechstes zu lesendes Byte
+     */
+    unsigned char *p_next;
+    /**
+     * Ende der Eingabe
+     */
+    unsigned char *p_end;
+    /**
+     * Gelesene aber nicht verbrauchte Bits, rechtsbuendig
+     */
+    unsigned long bits;
+    /**
+     * Anzahl gelesener aber nicht verbrauchter Bits
+     */
+    unsigned int bit_count;
+} DECODE_STATE;
+
+/**
+ * Kodierkernel: kodiert input_length Zeichen und schreibt alle vollstaendigen
+ * Bytes nach p_output. Der Ausgabepuffer muss
+ * input_length * max_length / 8 + KERNEL_OUTPUT_SLACK Byte gross sein.
+ * Die Rueckgabe ist die Anzahl geschriebener Bytes.
+ */
+typedef unsigned long (*ENCODE_KERNEL)(CODE_TABLE *table,
+                                       ENCODE_STATE *state,
+                                       unsigned char *p_input,
+                                       unsigned long input_length,
+                                       unsigned char *p_output);
+
+/**
+ * Dekodierkernel: dekodiert bis zu output_length Zeichen. Die Rueckgabe ist
+ * die Anzahl dekodierter Zeichen und ist nur kleiner als output_length,
+ * wenn die Eingabe nicht ausreicht.
+ */
+typedef unsigned long (*DECODE_KERNEL)(DECODE_TABLE *table,
+                                       DECODE_STATE *state,
+                                       unsigned char *p_output,
+                                       unsigned long output_length);
+
+/** Zur Laufzeit gewaehlter Kodierkernel. */
+extern ENCODE_KERNEL kernel_encode;
+
+/** Zur Laufzeit gewaehlter Dekodierkernel. */
+extern DECODE_KERNEL kernel_decode;
+
+/** Name der gewaehlten Kernel. */
+extern char *kernel_name;
+
+/**
+ * Waehlt anhand von CPUID die schnellsten Kernel fuer den Prozessor. Mit der
+ * Umgebungsvariable HUFFMAN_NO_BMI2 wird immer der portable Pfad gewaehlt.
+ *
+ * @param verbose TRUE um die gewaehlten Kernel auszugeben
+ */
+extern void kernels_init(BOOL verbose);
+
+/**
+ * Prueft ob der Prozessor BMI2 unterstuetzt und die BMI2-Kernel uebersetzt
+ * wurden.
+ *
+ * @return TRUE wenn die BMI2-Kernel verwendet werden koennen
+ */
+extern BOOL kernels_bmi2_available(void);
+
+/** Portabler Kodierkernel. */
+extern unsigned long encode_portable(CODE_TABLE *table,
+                                     ENCODE_STATE *state,
+                                     unsigned char *p_input,
+                                     unsigned long input_length,
+                                     unsigned char *p_output);
+
+/** Portabler Dekodierkernel. */
+extern unsigned long decode_portable(DECODE_TABLE *table,
+                                     DECODE_STATE *state,
+                                     unsigned char *p_output,
+                                     unsigned long output_length);
+
+/** Kodierkernel mit BZHI/SHLX/SHRX, nur nach kernels_bmi2_available. */
+extern unsigned long encode_bmi2(CODE_TABLE *table,
+                                 ENCODE_STATE *state,
+                                 unsigned char *p_input,
+                                 unsigned long input_length,
+                                 unsigned char *p_output);
+
+/** Dekodierkernel mit BZHI/SHLX/SHRX, nur nach kernels_bmi2_available. */
+extern unsigned long decode_bmi2(DECODE_TABLE *table,
+                                 DECODE_STATE *state,
+                                 unsigned char *p_output,
+                                 unsigned long output_length);
+
+/**
+ * Erzeugt die Codetabelle aus den Codes der symbol_map.
+ *
+ * @param table Zu fuellende Codetabelle
+ * @param p_symbols Erstes Symbol der symbol_map
+ * @param count Anzahl der Symbole
+ */
+extern void code_table_init(CODE_TABLE *table,
+                            SYMBOL *p_symbols,
+                            unsigned int count);
+
+/**
+ * Erzeugt die Dekodiertabelle aus dem Huffman-Baum.
+ *
+ * @param table Zu fuellende Dekodiertabelle
+ * @param root Wurzel des Huffman-Baums
+ */
+extern void decode_table_init(DECODE_TABLE *table, BTREE_NODE *root);
+
+/**
+ * Erzeugt die Dekodiertabelle aus den Codes einer Codetabelle, ohne einen
+ * Huffman-Baum anzulegen. Die Codes muessen einen vollstaendigen
+ * praefixfreien Code bilden.
+ *
+ * @param table Zu fuellende Dekodiertabelle
+ * @param codes Codetabelle
+ * @param single_symbol Zeichen eines Baums aus nur einem Blatt, wird nur bei
+ *        max_length 0 verwendet
+ */
+extern void decode_table_from_codes(DECODE_TABLE *table,
+                                    CODE_TABLE *codes,
+                                    unsigned char single_symbol);
+
+/**
+ * Initialisiert den Zustand des Kodierers.
+ *
+ * @param state Zustand
+ */
+extern void encode_state_init(ENCODE_STATE *state);
+
+/**
+ * Schreibt die restlichen Bits des Kodierers, mit 0 aufgefuellt.
+ *
+ * @param state Zustand
+ * @param p_output Ausgabe (mindestens 1 Byte)
+ * @return Anzahl geschriebener Bytes (0 oder 1)
+ */
+extern unsigned long encode_state_flush(ENCODE_STATE *state,
+                                        unsigned char *p_output);
+
+/**
+ * Initialisiert den Zustand des Dekodierers.
+ *
+ * @param state Zustand
+ * @param p_input Huffman-Code
+ * @param input_length Laenge des Huffman-Codes in Byte
+ * @param bit_offset Erstes Bit im ersten Byte (0 - 7)
+ */
+extern void decode_state_init(DECODE_STATE *state,
+                              unsigned char *p_input,
+                              unsigned long input_length,
+                              unsigned int bit_offset);
+
+#endif	/* CODEC_KERNELS_H */
@@ -21,6 +21,7 @@
 #define	COMMON_H
 #define COMPRESS_EXT ".hc"
 #define DECOMPRESS_EXT ".hd"
+#define DICTIONARY_EXT ".hcd"
 
 /**
  * Makro zur Pruefung, ob die Variable den Wert NULL hat: Ist die Bedingung
@@ -46,6 +47,14 @@ do {                                                    \
 /** Makro zur UEberpruefung ob zwei Zeiger beide gleich NULL sind. */
 #define BOTH_NULL(NODE1, NODE2) (NODE1 == NULL) && (NODE2 == NULL)
 
+/** Verfuegbare Dekodierer. */
+typedef enum
+{
+    DECODER_TREE,
+    DECODER_FSM,
+    DECODER_TABLE
+} DECODER_TYPE;
+
 /** Wahrheitswerte */
 typedef enum
 {
@@ -53,10 +62,14 @@ typedef enum
     TRUE
 } BOOL;
 
-/** Kompressionsmodus. */
-BOOL compress_mode;
+/** Blockgroesse in KB fuer --context, --wide und --rle ohne --block. */
+#define MODEL_BLOCK_SIZE 1024
 
-/** Debug Ausagben. **/
-BOOL debug_mode;
+/**
+ * Groesste Blockgroesse in KB fuer --block. Ein Block liegt beim Kodieren und
+ * Dekodieren vollstaendig im Speicher, 1 GB reicht fuer jeden sinnvollen
+ * Einsatz und haelt block_size * 1024 auch mit 32 Bit unter ULONG_MAX.
+ */
+#define MAX_BLOCK_SIZE 1048576
 
 #endif	/* COMMON_H */
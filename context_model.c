@@ -0,0 +1,583 @@
+/**
+ * File: context_model.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "common.h"
+#include "btree.h"
+#include "huffman.h"
+#include "codec_kernels.h"
+#include "context_model.h"
+
+/** Maximale Anzahl Durchlaeufe der Zuordnung der Kontexte. */
+#define CONTEXT_ITERATIONS 8
+
+/** Kosten einer zusaetzlichen Codetabelle in Bit (256 Codelaengen). */
+#define CONTEXT_TABLE_COST_BITS (256.0 * 8.0)
+
+/**
+ * Diese Funktion berechnet die Entropie einer Haeufigkeitsverteilung als
+ * Anzahl Bits fuer alle Zeichen.
+ *
+ * @param p_counts Haeufigkeit je Zeichen
+ * @return Anzahl Bits
+ */
+static double entropy_bits(unsigned long *p_counts);
+
+/**
+ * Diese Funktion berechnet die geschaetzten Kosten in Bit je Zeichen fuer
+ * eine Gruppe. Nicht vorkommende Zeichen erhalten hohe, aber endliche
+ * Kosten, damit jeder Kontext jeder Gruppe zugeordnet werden kann.
+ *
+ * @param p_counts Haeufigkeit je Zeichen der Gruppe
+ * @param p_costs Kosten je Zeichen
+ */
+static void symbol_costs(unsigned long *p_counts, double *p_costs);
+
+/**
+ * Diese Funktion berechnet die Groesse eines Kontexts in Bit, wenn er mit
+ * der Gruppe mit den uebergebenen Kosten kodiert wird.
+ *
+ * @param p_counts Haeufigkeit je Zeichen des Kontexts
+ * @param p_costs Kosten je Zeichen der Gruppe
+ * @return Anzahl Bits
+ */
+static double context_cost(unsigned long *p_counts, double *p_costs);
+
+/**
+ * Diese Funktion summiert die Haeufigkeiten aller Kontexte je Gruppe.
+ *
+ * @param p_counts Haeufigkeit je Kontext und Zeichen
+ * @param p_model Modell mit der Zuordnung der Kontexte
+ * @param p_table_counts Haeufigkeit je Gruppe und Zeichen
+ */
+static void sum_table_counts(unsigned long (*p_counts)[256],
+                             CONTEXT_MODEL *p_model,
+                             unsigned long (*p_table_counts)[256]);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: context_cluster
+ *  ------------------------------------------------------------------------ */
+extern void context_cluster(unsigned long (*p_counts)[256],
+                            unsigned int max_tables,
+                            CONTEXT_MODEL *p_model,
+                            unsigned long (*p_table_counts)[256])
+{
+    double costs[CONTEXT_MAX_TABLES][256];
+    unsigned long totals[CONTEXT_COUNT];
+    unsigned long merged[256];
+    double entropies[CONTEXT_MAX_TABLES];
+    BOOL seeded[CONTEXT_COUNT];
+    unsigned int context, symbol, table, other, best;
+    unsigned int best_table = 0, best_other = 0;
+    unsigned int active_count = 0;
+    unsigned int iteration;
+    double cost, best_cost;
+    BOOL changed = TRUE;
+
+    memset(p_model->context_map, 0, sizeof(p_model->context_map));
+    memset(seeded, 0, sizeof(seeded));
+    for (context = 0; context < CONTEXT_COUNT; context++)
+    {
+        totals[context] = 0;
+        for (symbol = 0; symbol < 256; symbol++)
+        {
+            totals[context] += p_counts[context][symbol];
+        }
+        if (totals[context] > 0)
+        {
+            active_count++;
+        }
+    }
+
+    /* Jede Gruppe beginnt mit einem der haeufigsten Kontexte. */
+    p_model->table_count = (active_count < max_tables) 
+                         ? active_count : max_tables;
+    if (p_model->table_count == 0)
+    {
+        p_model->table_count = 1;
+    }
+    for (table = 0; table < p_model->table_count && active_count > 0; 
+         table++)
+    {
+        best = 0;
+        for (context = 0; context < CONTEXT_COUNT; context++)
+        {
+            if (!seeded[context] && (seeded[best] 
+                    || totals[context] > totals[best]))
+            {
+                best = context;
+            }
+        }
+        seeded[best] = TRUE;
+        p_model->context_map[best] = (unsigned char) table;
+        memcpy(p_table_counts[table], p_counts[best], 
+               sizeof(p_table_counts[table]));
+    }
+
+    /*
+     * Jeden Kontext der Gruppe zuordnen, mit der er am wenigsten Bits
+     * kostet, und die Gruppen neu berechnen, bis sich nichts mehr aendert.
+     */
+    for (iteration = 0; iteration < CONTEXT_ITERATIONS && changed; 
+         iteration++)
+    {
+        for (table = 0; table < p_model->table_count; table++)
+        {
+            symbol_costs(p_table_counts[table], costs[table]);
+        }
+
+        changed = FALSE;
+        for (context = 0; context < CONTEXT_COUNT; context++)
+        {
+            if (totals[context] == 0)
+            {
+                continue;
+            }
+            best = p_model->context_map[context];
+            best_cost = context_cost(p_counts[context], costs[best]);
+            for (table = 0; table < p_model->table_count; table++)
+            {
+                cost = context_cost(p_counts[context], costs[table]);
+                if (cost < best_cost)
+                {
+                    best = table;
+                    best_cost = cost;
+                }
+            }
+            if (best != p_model->context_map[context] || iteration == 0)
+            {
+                changed = TRUE;
+                p_model->context_map[context] = (unsigned char) best;
+            }
+        }
+        sum_table_counts(p_counts, p_model, p_table_counts);
+    }
+
+    /*
+     * Gruppen zusammenlegen, solange die Ersparnis durch getrennte Tabellen
+     * kleiner ist als die Kosten einer Tabelle. Leere Gruppen werden dabei
+     * immer entfernt.
+     */
+    for (table = 0; table < p_model->table_count; table++)
+    {
+        entropies[table] = entropy_bits(p_table_counts[table]);
+    }
+    while (p_model->table_count > 1)
+    {
+        best_cost = CONTEXT_TABLE_COST_BITS;
+        for (table = 0; table < p_model->table_count; table++)
+        {
+            for (other = table + 1; other < p_model->table_count; other++)
+            {
+                for (symbol = 0; symbol < 256; symbol++)
+                {
+                    merged[symbol] = p_table_counts[table][symbol] 
+                                   + p_table_counts[other][symbol];
+                }
+                cost = entropy_bits(merged) - entropies[table]
+                       - entropies[other];
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_table = table;
+                    best_other = other;
+                }
+            }
+        }
+
+        if (best_cost >= CONTEXT_TABLE_COST_BITS)
+        {
+            break;
+        }
+
+        /* Gruppe best_other aufloesen, die letzte Gruppe rueckt nach. */
+        p_model->table_count--;
+        for (context = 0; context < CONTEXT_COUNT; context++)
+        {
+            if (p_model->context_map[context] == best_other)
+            {
+                p_model->context_map[context] = (unsigned char) best_table;
+            }
+            else if (p_model->context_map[context] == p_model->table_count)
+            {
+                p_model->context_map[context] = (unsigned char) best_other;
+            }
+        }
+        sum_table_counts(p_counts, p_model, p_table_counts);
+        entropies[best_table] = entropy_bits(p_table_counts[best_table]);
+        entropies[best_other] = entropies[p_model->table_count];
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: sum_table_counts
+ *  ------------------------------------------------------------------------ */
+static void sum_table_counts(unsigned long (*p_counts)[256],
+                             CONTEXT_MODEL *p_model,
+                             unsigned long (*p_table_counts)[256])
+{
+    unsigned int context, symbol;
+    unsigned long *p_table;
+
+    memset(p_table_counts, 0, 
+           CONTEXT_MAX_TABLES * sizeof(p_table_counts[0]));
+    for (context = 0; context < CONTEXT_COUNT; context++)
+    {
+        p_table = p_table_counts[p_model->context_map[context]];
+        for (symbol = 0; symbol < 256; symbol++)
+        {
+            p_table[symbol] += p_counts[context][symbol];
+        }
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: entropy_bits
+ *  ------------------------------------------------------------------------ */
+static double entropy_bits(unsigned long *p_counts)
+{
+    unsigned int symbol;
+    double total = 0.0;
+    double bits = 0.0;
+
+    for (symbol = 0; symbol < 256; symbol++)
+    {
+        total += (double) p_counts[symbol];
+    }
+    for (symbol = 0; symbol < 256; symbol++)
+    {
+        if (p_counts[symbol] > 0)
+        {
+            bits += (double) p_counts[symbol] 
+                    * log(total / (double) p_counts[symbol]);
+        }
+    }
+
+    return bits / log(2.0);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: symbol_costs
+ *  ------------------------------------------------------------------------ */
+static void symbol_costs(unsigned long *p_counts, double *p_costs)
+{
+    unsigned int symbol;
+    double total = 128.0;
+
+    for (symbol = 0; symbol < 256; symbol++)
+    {
+        total += (double) p_counts[symbol];
+    }
+    for (symbol = 0; symbol < 256; symbol++)
+    {
+        p_costs[symbol] = log(total / ((double) p_counts[symbol] + 0.5)) 
+                          / log(2.0);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: context_cost
+ *  ------------------------------------------------------------------------ */
+static double context_cost(unsigned long *p_counts, double *p_costs)
+{
+    unsigned int symbol;
+    double bits = 0.0;
+
+    for (symbol = 0; symbol < 256; symbol++)
+    {
+        if (p_counts[symbol] > 0)
+        {
+            bits += (double) p_counts[symbol] * p_costs[symbol];
+        }
+    }
+
+    return bits;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: context_code_table_init
+ *  ------------------------------------------------------------------------ */
+extern void context_code_table_init(CODE_TABLE *table,
+                                    unsigned char *p_lengths)
+{
+    unsigned int symbol, length, used = 0;
+    unsigned long code = 0;
+
+    memset(table, 0, sizeof(CODE_TABLE));
+
+    for (symbol = 0; symbol < 256; symbol++)
+    {
+        if (p_lengths[symbol] > 0)
+        {
+            used++;
+        }
+    }
+    if (used <= 1)
+    {
+        return;
+    }
+
+    /*
+     * Kanonische Codes: kuerzere Codes zuerst, bei gleicher Laenge in der
+     * Reihenfolge der Zeichen.
+     */
+    for (length = 1; length <= KERNEL_MAX_CODE_LENGTH; length++)
+    {
+        for (symbol = 0; symbol < 256; symbol++)
+        {
+            if (p_lengths[symbol] == length)
+            {
+                table->entries[symbol].bits = code++;
+                table->entries[symbol].length = length;
+                table->max_length = length;
+            }
+        }
+        code <<= 1;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: context_tree_new
+ *  ------------------------------------------------------------------------ */
+extern BTREE *context_tree_new(ALLOCATOR *allocator,
+                               unsigned char *p_lengths,
+                               SYMBOL *p_symbols)
+{
+    BTREE *level[512];
+    BTREE *inner[256];
+    BTREE *p_tree;
+    SYMBOL *p_inner_symbol;
+    unsigned int inner_count = 0;
+    unsigned int level_count;
+    unsigned int symbol, length, max_length = 0, i;
+
+    for (symbol = 0; symbol < 256; symbol++)
+    {
+        p_symbols[symbol].symbol = (unsigned char) symbol;
+        p_symbols[symbol].count = 0;
+        p_symbols[symbol].code = NULL;
+        if (p_lengths[symbol] > max_length)
+        {
+            max_length = p_lengths[symbol];
+        }
+    }
+    if (max_length == 0 || max_length > KERNEL_MAX_CODE_LENGTH)
+    {
+        return NULL;
+    }
+
+    /*
+     * Von der tiefsten Ebene aus je Ebene erst die Blaetter in Reihenfolge
+     * der Zeichen, dann die inneren Knoten der Ebene darunter paarweise
+     * zusammenfassen. So entstehen genau die kanonischen Codes.
+     */
+    for (length = max_length; length > 0; length--)
+    {
+        level_count = 0;
+        for (symbol = 0; symbol < 256; symbol++)
+        {
+            if (p_lengths[symbol] == length)
+            {
+                level[level_count++] = btree_new(allocator, p_symbols + symbol,
+                                                 NULL, NULL);
+            }
+        }
+        for (i = 0; i < inner_count; i++)
+        {
+            level[level_count++] = inner[i];
+        }
+
+        /* Ein einzelnes Zeichen wird ohne Bits kodiert. */
+        if (length == 1 && level_count == 1 && inner_count == 0)
+        {
+            return level[0];
+        }
+
+        if (level_count % 2 != 0 || level_count / 2 > 256)
+        {
+            for (i = 0; i < level_count; i++)
+            {
+                btree_destroy(&level[i], FALSE);
+            }
+            return NULL;
+        }
+
+        inner_count = level_count / 2;
+        for (i = 0; i < inner_count; i++)
+        {
+            p_inner_symbol = allocator_alloc(allocator, sizeof(SYMBOL));
+            inner[i] = btree_merge(level[2 * i], level[2 * i + 1],
+                                   p_inner_symbol);
+            allocator_free(allocator, level[2 * i]);
+            allocator_free(allocator, level[2 * i + 1]);
+        }
+    }
+
+    if (inner_count != 1)
+    {
+        for (i = 0; i < inner_count; i++)
+        {
+            btree_destroy(&inner[i], FALSE);
+        }
+        return NULL;
+    }
+
+    p_tree = inner[0];
+    return p_tree;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: context_encode
+ *  ------------------------------------------------------------------------ */
+extern unsigned long context_encode(CODE_TABLE *p_tables,
+                                    unsigned char *p_context_map,
+                                    ENCODE_STATE *state,
+                                    unsigned char *p_input,
+                                    unsigned long input_length,
+                                    unsigned char *p_output)
+{
+    unsigned char *p_input_end = p_input + input_length;
+    unsigned char *p_output_start = p_output;
+    unsigned long bits = state->bits;
+    unsigned int bit_count = state->bit_count;
+    unsigned int previous = 0;
+    CODE_ENTRY *p_entry;
+
+    while (p_input < p_input_end)
+    {
+        p_entry = &p_tables[p_context_map[previous]].entries[*p_input];
+        previous = *p_input++;
+        bits = (bits << p_entry->length) | p_entry->bits;
+        bit_count += p_entry->length;
+
+        /* Alle vollstaendigen Bytes schreiben. */
+        while (bit_count >= 8)
+        {
+            bit_count -= 8;
+            *p_output++ = (unsigned char) (bits >> bit_count);
+        }
+    }
+
+    state->bits = bits;
+    state->bit_count = bit_count;
+
+    return (unsigned long) (p_output - p_output_start);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: context_decode
+ *  ------------------------------------------------------------------------ */
+extern unsigned long context_decode(DECODE_TABLE *p_tables,
+                                    unsigned char *p_context_map,
+                                    DECODE_STATE *state,
+                                    unsigned char *p_output,
+                                    unsigned long output_length,
+                                    unsigned char *p_previous)
+{
+    unsigned char *p_output_start = p_output;
+    unsigned char *p_output_end = p_output + output_length;
+    unsigned char *p_next = state->p_next;
+    unsigned long bits = state->bits;
+    unsigned int bit_count = state->bit_count;
+    unsigned int previous = *p_previous;
+    unsigned int remaining;
+    unsigned long index;
+    DECODE_TABLE *table;
+    DECODE_ENTRY *p_entry;
+    int node;
+    BOOL exhausted = FALSE;
+
+    while (p_output < p_output_end && !exhausted)
+    {
+        table = &p_tables[p_context_map[previous]];
+        if (table->single)
+        {
+            *p_output++ = table->single_symbol;
+            previous = table->single_symbol;
+            continue;
+        }
+
+        /* Bitspeicher byteweise auffuellen. */
+        while (bit_count <= KERNEL_WORD_BITS - 8 && p_next < state->p_end)
+        {
+            bits = (bits << 8) | *p_next++;
+            bit_count += 8;
+        }
+
+        if (bit_count >= KERNEL_TABLE_BITS)
+        {
+            index = bits >> (bit_count - KERNEL_TABLE_BITS);
+        }
+        else
+        {
+            index = bits << (KERNEL_TABLE_BITS - bit_count);
+        }
+        p_entry = &table->entries[index & (KERNEL_TABLE_SIZE - 1)];
+
+        if (p_entry->length > 0)
+        {
+            if (p_entry->length > bit_count)
+            {
+                exhausted = TRUE;
+            }
+            else
+            {
+                *p_output++ = p_entry->symbol;
+                previous = p_entry->symbol;
+                bit_count -= p_entry->length;
+            }
+        }
+        else if (bit_count < KERNEL_TABLE_BITS)
+        {
+            exhausted = TRUE;
+        }
+        else
+        {
+            /* Langer Code: bitweise im Baum der Tabelle weitergehen. */
+            remaining = bit_count - KERNEL_TABLE_BITS;
+            node = p_entry->node;
+            while (node >= 0)
+            {
+                if (remaining == 0)
+                {
+                    exhausted = TRUE;
+                    break;
+                }
+                remaining--;
+                node = table->children[node][(bits >> remaining) & 1];
+            }
+
+            if (node < 0)
+            {
+                *p_output++ = (unsigned char) -(node + 1);
+                previous = (unsigned int) -(node + 1);
+                bit_count = remaining;
+            }
+        }
+    }
+
+    state->p_next = p_next;
+    state->bits = bits;
+    state->bit_count = bit_count;
+    *p_previous = (unsigned char) previous;
+
+    return (unsigned long) (p_output - p_output_start);
+}
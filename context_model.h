@@ -0,0 +1,141 @@
+/**
+ * File: context_model.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONTEXT_MODEL_H
+
+#define	CONTEXT_MODEL_H
+
+#include "common.h"
+#include "btree.h"
+#include "huffman.h"
+#include "codec_kernels.h"
+
+/** Maximale Anzahl Codetabellen eines Kontextblocks. */
+#define CONTEXT_MAX_TABLES 16
+
+/** Anzahl der Kontexte (ein Kontext je moeglichem vorherigen Byte). */
+#define CONTEXT_COUNT 256
+
+/**
+ * Groesse des Modells im Blockheader in Byte: Codetabelle je Kontext und
+ * 256 Codelaengen je Codetabelle.
+ */
+#define CONTEXT_MODEL_SIZE(table_count) (CONTEXT_COUNT + (table_count) * 256)
+
+/**
+ * Struktur eines Kontextmodells erster Ordnung. Jedes Zeichen wird mit der
+ * Codetabelle kodiert, die dem vorherigen Zeichen zugeordnet ist. Vor dem
+ * ersten Zeichen eines Blocks gilt der Kontext 0.
+ */
+typedef struct _CONTEXT_MODEL
+{
+    /**
+     * Codetabelle je vorherigem Zeichen
+     */
+    unsigned char context_map[CONTEXT_COUNT];
+    /**
+     * Anzahl der Codetabellen
+     */
+    unsigned int table_count;
+    /**
+     * Codelaengen je Tabelle und Zeichen, 0 fuer nicht vorkommende Zeichen
+     */
+    unsigned char lengths[CONTEXT_MAX_TABLES][256];
+} CONTEXT_MODEL;
+
+/**
+ * Fasst die Kontexte so zu hoechstens max_tables Gruppen zusammen, dass die
+ * geschaetzte Groesse des Codes zusammen mit den Tabellen moeglichst klein
+ * wird. Ausgangspunkt sind die haeufigsten Kontexte, die Zuordnung wird
+ * danach wie bei k-Means verbessert und Gruppen werden zusammengelegt,
+ * solange eine eigene Tabelle mehr kostet als sie einspart.
+ *
+ * @param p_counts Haeufigkeit je Kontext und Zeichen
+ * @param max_tables Maximale Anzahl Gruppen (1 - CONTEXT_MAX_TABLES)
+ * @param p_model Modell, dessen context_map und table_count gesetzt werden
+ * @param p_table_counts Haeufigkeit je Gruppe und Zeichen
+ */
+extern void context_cluster(unsigned long (*p_counts)[256],
+                            unsigned int max_tables,
+                            CONTEXT_MODEL *p_model,
+                            unsigned long (*p_table_counts)[256]);
+
+/**
+ * Erzeugt die kanonischen Codes einer Tabelle aus ihren Codelaengen. Eine
+ * Tabelle mit nur einem Zeichen kodiert dieses ohne Bits.
+ *
+ * @param table Zu fuellende Codetabelle
+ * @param p_lengths Codelaenge je Zeichen
+ */
+extern void context_code_table_init(CODE_TABLE *table,
+                                    unsigned char *p_lengths);
+
+/**
+ * Erzeugt aus den Codelaengen einer Tabelle den Huffman-Baum der
+ * kanonischen Codes.
+ *
+ * @param allocator Allokator fuer den Baum und die inneren Symbole
+ * @param p_lengths Codelaenge je Zeichen
+ * @param p_symbols Speicher fuer die 256 Symbole der Blaetter
+ * @return Der Huffman-Baum oder NULL, wenn die Laengen keinen
+ *         vollstaendigen Baum ergeben
+ */
+extern BTREE *context_tree_new(ALLOCATOR *allocator,
+                               unsigned char *p_lengths,
+                               SYMBOL *p_symbols);
+
+/**
+ * Kodiert input_length Zeichen mit den Codetabellen des Modells. Der
+ * Ausgabepuffer muss wie bei den Kodierkerneln bemessen sein.
+ *
+ * @param p_tables Codetabelle je Gruppe
+ * @param p_context_map Gruppe je vorherigem Zeichen
+ * @param state Zustand des Kodierers
+ * @param p_input Eingabe
+ * @param input_length Anzahl der Zeichen
+ * @param p_output Ausgabe
+ * @return Anzahl geschriebener Bytes
+ */
+extern unsigned long context_encode(CODE_TABLE *p_tables,
+                                    unsigned char *p_context_map,
+                                    ENCODE_STATE *state,
+                                    unsigned char *p_input,
+                                    unsigned long input_length,
+                                    unsigned char *p_output);
+
+/**
+ * Dekodiert bis zu output_length Zeichen mit den Dekodiertabellen des
+ * Modells. Der Kontext ist das zuletzt ausgegebene Zeichen und wird ueber
+ * p_previous zwischen zwei Aufrufen weitergegeben.
+ *
+ * @param p_tables Dekodiertabelle je Gruppe
+ * @param p_context_map Gruppe je vorherigem Zeichen
+ * @param state Zustand des Dekodierers
+ * @param p_output Ausgabe
+ * @param output_length Anzahl der zu dekodierenden Zeichen
+ * @param p_previous Vorheriges Zeichen, wird fortgeschrieben
+ * @return Anzahl dekodierter Zeichen
+ */
+extern unsigned long context_decode(DECODE_TABLE *p_tables,
+                                    unsigned char *p_context_map,
+                                    DECODE_STATE *state,
+                                    unsigned char *p_output,
+                                    unsigned long output_length,
+                                    unsigned char *p_previous);
+
+#endif	/* CONTEXT_MODEL_H */
@@ -0,0 +1,511 @@
+/**
+ * File: file_jobs.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "common.h"
+#include "huffman.h"
+#include "huff_ctx.h"
+#include "byte_order.h"
+#include "checksum.h"
+#include "huff_buffer.h"
+#include "work_pool.h"
+#include "mem_budget.h"
+#include "async_io.h"
+#include "file_jobs.h"
+
+typedef struct _FILE_JOB FILE_JOB;
+
+/** Teilaufgabe: ein Block einer grossen Datei. */
+typedef struct _BLOCK_JOB
+{
+    /**
+     * Datei des Blocks
+     */
+    FILE_JOB *file;
+    /**
+     * Index des Blocks in der Datei
+     */
+    unsigned long index;
+    /**
+     * Kodierter Block mit Header
+     */
+    unsigned char *p_block;
+    /**
+     * Laenge des kodierten Blocks
+     */
+    unsigned long block_length;
+} BLOCK_JOB;
+
+/** Aufgabe: eine Eingabedatei. */
+struct _FILE_JOB
+{
+    /**
+     * Kontext mit den Optionen aller Auftraege
+     */
+    HUFF_CTX *options;
+    /**
+     * Name der Eingabedatei
+     */
+    char *in_filename;
+    /**
+     * Name der Ausgabedatei, NULL fuer -t
+     */
+    char *out_filename;
+    /**
+     * Groesse der Eingabedatei in Byte
+     */
+    unsigned long length;
+    /**
+     * Eingabe einer in Bloecke geteilten Datei
+     */
+    unsigned char *p_input;
+    /**
+     * Groesse eines Blocks in Byte
+     */
+    unsigned long block_bytes;
+    /**
+     * Anzahl der Bloecke
+     */
+    unsigned long block_count;
+    /**
+     * Teilaufgabe je Block
+     */
+    BLOCK_JOB *blocks;
+    /**
+     * Anzahl noch nicht kodierter Bloecke
+     */
+    unsigned long open_blocks;
+    /**
+     * Schuetzt open_blocks
+     */
+    pthread_mutex_t lock;
+};
+
+/** Liste der Aufgaben aller Eingabedateien. */
+typedef struct _FILE_JOB_LIST
+{
+    /**
+     * Aufgaben
+     */
+    FILE_JOB *jobs;
+    /**
+     * Anzahl der Aufgaben
+     */
+    unsigned long count;
+    /**
+     * Groesse von jobs
+     */
+    unsigned long capacity;
+} FILE_JOB_LIST;
+
+/**
+ * Diese Funktion fuegt eine Datei oder alle passenden Dateien eines
+ * Verzeichnisses der Liste hinzu.
+ *
+ * @param ctx Codec-Kontext
+ * @param list Liste der Aufgaben
+ * @param path Datei oder Verzeichnis
+ * @param explicit TRUE wenn die Datei direkt angegeben wurde und nicht nach
+ *        ihrer Endung gefiltert wird
+ */
+static void add_input(HUFF_CTX *ctx,
+                      FILE_JOB_LIST *list,
+                      char *path,
+                      BOOL explicit);
+
+/**
+ * Diese Funktion prueft ob ein Dateiname mit einer Endung endet.
+ *
+ * @param filename Dateiname
+ * @param extension Endung
+ * @return TRUE wenn der Name mit der Endung endet
+ */
+static BOOL has_extension(char *filename, char *extension);
+
+/**
+ * Vergleichsfunktion fuer qsort: groessere Dateien zuerst.
+ *
+ * @param p_left Erste Aufgabe (FILE_JOB*)
+ * @param p_right Zweite Aufgabe (FILE_JOB*)
+ * @return < 0 wenn die erste Datei groesser ist
+ */
+static int compare_jobs(const void *p_left, const void *p_right);
+
+/**
+ * Aufgabe: bearbeitet eine Datei oder teilt sie in Bloecke.
+ *
+ * @param pool Pool
+ * @param worker Ausfuehrender Thread
+ * @param p_job Datei (FILE_JOB*)
+ */
+static void process_file(WORK_POOL *pool, unsigned int worker, void *p_job);
+
+/**
+ * Teilaufgabe: kodiert einen Block. Der Thread des letzten Blocks schreibt
+ * die Ausgabedatei.
+ *
+ * @param pool Pool
+ * @param worker Ausfuehrender Thread
+ * @param p_block Block (BLOCK_JOB*)
+ */
+static void encode_block(WORK_POOL *pool, unsigned int worker, void *p_block);
+
+/**
+ * Diese Funktion schreibt eine in Bloecke geteilte Datei als Container und
+ * gibt die Bloecke und die Eingabe frei.
+ *
+ * @param job Datei
+ */
+static void write_block_file(FILE_JOB *job);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: run_file_jobs
+ *  ------------------------------------------------------------------------ */
+extern void run_file_jobs(HUFF_CTX *ctx, char *in_filename)
+{
+    FILE_JOB_LIST list;
+    WORK_POOL pool;
+    unsigned long i, split_count = 0;
+
+    memset(&list, 0, sizeof(FILE_JOB_LIST));
+    add_input(ctx, &list, in_filename, TRUE);
+    for (i = 0; i < ctx->member_count; i++)
+    {
+        add_input(ctx, &list, ctx->member_filenames[i], TRUE);
+    }
+
+    if (list.count == 0)
+    {
+        printf("Es wurden keine passenden Dateien gefunden.\n");
+        return;
+    }
+
+    /*
+     * Die groessten Dateien beginnen zuerst, kleine Dateien aus den
+     * Warteschlangen beschaeftigter Threads stehlen die anderen.
+     */
+    qsort(list.jobs, list.count, sizeof(FILE_JOB), compare_jobs);
+
+    huff_buffer_init();
+    work_pool_init(&pool, (unsigned int) ctx->job_count);
+    for (i = 0; i < list.count; i++)
+    {
+        work_pool_submit(&pool, (unsigned int) (i % pool.worker_count),
+                         process_file, &list.jobs[i]);
+    }
+    work_pool_run(&pool);
+
+    for (i = 0; i < list.count; i++)
+    {
+        if (list.jobs[i].block_count > 0)
+        {
+            split_count++;
+        }
+        free(list.jobs[i].in_filename);
+        free(list.jobs[i].out_filename);
+    }
+
+    if (ctx->debug_mode)
+    {
+        printf("\n---------------- Dateien bearbeitet ----------------\n\n");
+        printf("\tDateien: %lu, davon in Bloecken: %lu\n", list.count,
+               split_count);
+        printf("\tThreads: %u, gestohlene Aufgaben: %lu\n\n",
+               pool.worker_count, pool.stolen);
+        fflush(stdout);
+    }
+
+    work_pool_destroy(&pool);
+    free(list.jobs);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: add_input
+ *  ------------------------------------------------------------------------ */
+static void add_input(HUFF_CTX *ctx,
+                      FILE_JOB_LIST *list,
+                      char *path,
+                      BOOL explicit)
+{
+    struct stat status;
+    DIR *p_directory;
+    struct dirent *p_entry;
+    FILE_JOB *job;
+    char *p_child;
+
+    if (stat(path, &status) != 0)
+    {
+        printf("Datei Einlesen fehlgeschlagen: %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    if (S_ISDIR(status.st_mode))
+    {
+        p_directory = opendir(path);
+        if (p_directory == NULL)
+        {
+            printf("Datei Einlesen fehlgeschlagen: %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+        while ((p_entry = readdir(p_directory)) != NULL)
+        {
+            if (strcmp(p_entry->d_name, ".") == 0
+                    || strcmp(p_entry->d_name, "..") == 0)
+            {
+                continue;
+            }
+            p_child = malloc(strlen(path) + strlen(p_entry->d_name) + 2);
+            ENSURE_ENOUGH_MEMORY(p_child, "add_input");
+            strcpy(p_child, path);
+            strcat(p_child, "/");
+            strcat(p_child, p_entry->d_name);
+            add_input(ctx, list, p_child, FALSE);
+            free(p_child);
+        }
+        closedir(p_directory);
+        return;
+    }
+
+    /*
+     * In Verzeichnissen werden nur die Dateien bearbeitet, die zum Modus
+     * passen; so wird auch die eigene Ausgabe eines frueheren Laufs nicht
+     * erneut komprimiert.
+     */
+    if (!S_ISREG(status.st_mode)
+            || (!explicit
+                && has_extension(path, COMPRESS_EXT) == ctx->compress_mode))
+    {
+        return;
+    }
+
+    if (list->count == list->capacity)
+    {
+        list->capacity += ALLOC_ELEMENTS;
+        list->jobs = realloc(list->jobs, list->capacity * sizeof(FILE_JOB));
+        ENSURE_ENOUGH_MEMORY(list->jobs, "add_input");
+    }
+    job = &list->jobs[list->count++];
+    memset(job, 0, sizeof(FILE_JOB));
+    job->options = ctx;
+    job->length = (unsigned long) status.st_size;
+    job->block_bytes = ((ctx->block_size > 0) ? ctx->block_size
+                                              : MODEL_BLOCK_SIZE) * 1024;
+
+    job->in_filename = malloc(strlen(path) + 1);
+    ENSURE_ENOUGH_MEMORY(job->in_filename, "add_input");
+    strcpy(job->in_filename, path);
+
+    if (!ctx->test_mode)
+    {
+        job->out_filename = malloc(strlen(path) + strlen(COMPRESS_EXT) + 1);
+        ENSURE_ENOUGH_MEMORY(job->out_filename, "add_input");
+        strcpy(job->out_filename, path);
+        strcat(job->out_filename, ctx->compress_mode ? COMPRESS_EXT
+                                                     : DECOMPRESS_EXT);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: has_extension
+ *  ------------------------------------------------------------------------ */
+static BOOL has_extension(char *filename, char *extension)
+{
+    size_t length = strlen(filename);
+    size_t extension_length = strlen(extension);
+
+    return (length >= extension_length
+            && strcmp(filename + length - extension_length, extension) == 0)
+           ? TRUE : FALSE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: compare_jobs
+ *  ------------------------------------------------------------------------ */
+static int compare_jobs(const void *p_left, const void *p_right)
+{
+    unsigned long left = ((FILE_JOB*) p_left)->length;
+    unsigned long right = ((FILE_JOB*) p_right)->length;
+
+    return (left > right) ? -1 : (left < right) ? 1 : 0;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: process_file
+ *  ------------------------------------------------------------------------ */
+static void process_file(WORK_POOL *pool, unsigned int worker, void *p_job)
+{
+    FILE_JOB *job = (FILE_JOB*) p_job;
+    HUFF_CTX *options = job->options;
+    HUFF_CTX ctx;
+    FILE *p_input_stream;
+    unsigned long i;
+
+    /*
+     * Nur einfache Bloecke lassen sich unabhaengig voneinander kodieren,
+     * alle anderen Dateien bearbeitet ein Thread wie ohne -j. Geteilte
+     * Dateien liegen mit ihren Bloecken ganz im Speicher und muessen
+     * zweimal in den Anteil von --mem-limit passen.
+     */
+    if (!options->compress_mode || options->context_mode || options->wide_mode
+            || options->rle_mode || options->seek_index_interval > 0
+            || job->length <= job->block_bytes
+            || !mem_budget_fits(options, 2 * job->length))
+    {
+        huff_ctx_init_from(&ctx, options);
+        if (options->compress_mode)
+        {
+            compress(&ctx, job->in_filename, job->out_filename);
+        }
+        else
+        {
+            decompress(&ctx, job->in_filename, job->out_filename);
+        }
+        huff_ctx_destroy(&ctx);
+        return;
+    }
+
+    p_input_stream = fopen(job->in_filename, "rb");
+    job->p_input = malloc(job->length);
+    ENSURE_ENOUGH_MEMORY(job->p_input, "process_file");
+    if (p_input_stream == NULL
+            || fread(job->p_input, sizeof(unsigned char), job->length,
+                     p_input_stream) != job->length)
+    {
+        printf("Datei Einlesen fehlgeschlagen: %s\n", job->in_filename);
+        exit(EXIT_FAILURE);
+    }
+    if (options->no_cache_mode)
+    {
+        async_io_drop_cache(p_input_stream);
+    }
+    fclose(p_input_stream);
+
+    /*
+     * Die Bloecke kommen in die eigene Warteschlange. Der Thread kodiert sie
+     * von hinten, andere Threads stehlen sie von vorne.
+     */
+    job->block_count = (job->length + job->block_bytes - 1) / job->block_bytes;
+    job->open_blocks = job->block_count;
+    job->blocks = calloc(job->block_count, sizeof(BLOCK_JOB));
+    ENSURE_ENOUGH_MEMORY(job->blocks, "process_file");
+    pthread_mutex_init(&job->lock, NULL);
+    for (i = 0; i < job->block_count; i++)
+    {
+        job->blocks[i].file = job;
+        job->blocks[i].index = i;
+        work_pool_submit(pool, worker, encode_block, &job->blocks[i]);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: encode_block
+ *  ------------------------------------------------------------------------ */
+static void encode_block(WORK_POOL *pool, unsigned int worker, void *p_block)
+{
+    BLOCK_JOB *block = (BLOCK_JOB*) p_block;
+    FILE_JOB *job = block->file;
+    unsigned long start = block->index * job->block_bytes;
+    unsigned long length = job->length - start;
+    unsigned long capacity;
+    BOOL last;
+
+    (void) pool;
+    (void) worker;
+
+    if (length > job->block_bytes)
+    {
+        length = job->block_bytes;
+    }
+
+    /* Ein gespeicherter Block ist immer gross genug. */
+    capacity = BLOCK_HEADER_SIZE + length + CHECKSUM_SIZE;
+    block->p_block = malloc(capacity);
+    ENSURE_ENOUGH_MEMORY(block->p_block, "encode_block");
+    block->block_length = huff_encode_block(job->p_input + start, length,
+                                            block->p_block, capacity,
+                                            job->options->checksum_mode);
+
+    pthread_mutex_lock(&job->lock);
+    last = (--job->open_blocks == 0) ? TRUE : FALSE;
+    pthread_mutex_unlock(&job->lock);
+
+    if (last)
+    {
+        write_block_file(job);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: write_block_file
+ *  ------------------------------------------------------------------------ */
+static void write_block_file(FILE_JOB *job)
+{
+    unsigned char header[CONTAINER_HEADER_SIZE];
+    FILE *p_output_stream = fopen(job->out_filename, "wb");
+    IO_CACHE output_cache;
+    unsigned long i;
+
+    if (p_output_stream == NULL)
+    {
+        printf("Datei zum Schreiben konnte nicht geoeffnet werden.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    store_container_header(header,
+                           job->options->checksum_mode
+                               ? CONTAINER_FLAG_CHECKSUM : 0,
+                           job->length, job->block_bytes);
+    if (fwrite(header, sizeof(unsigned char), CONTAINER_HEADER_SIZE,
+               p_output_stream) != CONTAINER_HEADER_SIZE)
+    {
+        printf("Fehler beim schreiben des Headers.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    async_io_cache_init(&output_cache, p_output_stream, TRUE, 
+                        job->options->no_cache_mode);
+    for (i = 0; i < job->block_count; i++)
+    {
+        if (fwrite(job->blocks[i].p_block, sizeof(unsigned char),
+                   job->blocks[i].block_length, p_output_stream)
+                != job->blocks[i].block_length)
+        {
+            printf("Fehler beim schreiben der Datei.\n");
+            exit(EXIT_FAILURE);
+        }
+        free(job->blocks[i].p_block);
+        async_io_cache_release(&output_cache, 
+                               (unsigned long) ftell(p_output_stream));
+    }
+    async_io_cache_finish(&output_cache);
+    fclose(p_output_stream);
+
+    free(job->blocks);
+    free(job->p_input);
+    job->blocks = NULL;
+    job->p_input = NULL;
+    pthread_mutex_destroy(&job->lock);
+}
@@ -0,0 +1,43 @@
+/**
+ * File: file_jobs.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILE_JOBS_H
+
+#define	FILE_JOBS_H
+
+#include "common.h"
+#include "huffman.h"
+
+/**
+ * Komprimiert, dekomprimiert oder prueft alle Eingabedateien mit
+ * ctx->job_count Threads. Eingaben sind in_filename und die Dateinamen in
+ * member_filenames; Verzeichnisse werden rekursiv durchlaufen, wobei beim
+ * Komprimieren Dateien mit COMPRESS_EXT uebersprungen und sonst nur solche
+ * bearbeitet werden. Jede Datei ist eine Aufgabe eines Pools mit
+ * Work-Stealing, die groessten zuerst. Grosse Dateien werden beim
+ * Komprimieren ohne --context, --wide, --rle und --index in Bloecke geteilt,
+ * deren Kodierung andere Threads als Teilaufgaben stehlen koennen.
+ * Ausgaben erhalten den Namen der Eingabe mit COMPRESS_EXT bzw.
+ * DECOMPRESS_EXT.
+ * 
+ * @param ctx Codec-Kontext mit den Optionen aller Auftraege
+ * @param in_filename Erste Eingabedatei oder erstes Verzeichnis
+ */
+extern void run_file_jobs(HUFF_CTX *ctx, char *in_filename);
+
+#endif	/* FILE_JOBS_H */
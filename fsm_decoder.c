@@ -0,0 +1,200 @@
+/**
+ * File: fsm_decoder.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "huffman.h"
+#include "fsm_decoder.h"
+
+/** Maximale Anzahl innerer Knoten eines Baums mit 256 Blaettern. */
+#define FSM_MAX_STATES 255
+
+/**
+ * Diese Funktion nummeriert die inneren Knoten in Preorder-Reihenfolge und
+ * legt fuer jeden Zustand die beiden Nachfolger ab. Ein Nachfolger >= 0 ist
+ * ein weiterer Zustand, ein Nachfolger < 0 ist das Blatt mit dem Zeichen
+ * -(Nachfolger + 1).
+ *
+ * @param node Aktueller Knoten
+ * @param p_children Nachfolger je Zustand
+ * @param p_state_count Anzahl bisher vergebener Zustaende
+ * @return Zustand oder kodiertes Blatt des Knotens
+ */
+static int number_states(BTREE_NODE *node,
+                         int (*p_children)[2],
+                         unsigned int *p_state_count);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: fsm_decoder_new
+ *  ------------------------------------------------------------------------ */
+extern FSM_DECODER *fsm_decoder_new(ALLOCATOR *allocator, BTREE_NODE *root)
+{
+    int children[FSM_MAX_STATES][2];
+    unsigned int state, byte, bit;
+    int node;
+    FSM_TRANSITION *p_transition;
+    FSM_DECODER *decoder = allocator_alloc(allocator, sizeof(FSM_DECODER));
+    
+    decoder->allocator = allocator;
+
+    /*
+     * Ein Baum aus nur einem Blatt hat keine Zustaende, jedes Zeichen wird
+     * dann ohne ein einziges Bit kodiert.
+     */
+    if (btreenode_is_leaf(root))
+    {
+        decoder->single_symbol = ((SYMBOL*) btreenode_get_data(root))->symbol;
+        return decoder;
+    }
+
+    number_states(root, children, &decoder->state_count);
+
+    decoder->transitions = allocator_alloc(allocator, 
+                                           decoder->state_count 
+                                           * FSM_TRANSITIONS
+                                           * sizeof(FSM_TRANSITION));
+
+    /*
+     * Fuer jeden Zustand und jedes Byte die 8 Bits (hoechstwertiges Bit
+     * zuerst, wie vom bit_buffer geschrieben) durch den Baum verfolgen.
+     */
+    for (state = 0; state < decoder->state_count; state++)
+    {
+        for (byte = 0; byte < FSM_TRANSITIONS; byte++)
+        {
+            p_transition = decoder->transitions
+                    + state * FSM_TRANSITIONS + byte;
+            node = (int) state;
+
+            for (bit = 0; bit < 8; bit++)
+            {
+                node = children[node][(byte >> (7 - bit)) & 1];
+                if (node < 0)
+                {
+                    p_transition->symbols[p_transition->symbol_count] =
+                            (unsigned char) -(node + 1);
+                    p_transition->symbol_count++;
+                    node = 0;
+                }
+            }
+            p_transition->next_state = (unsigned char) node;
+        }
+    }
+
+    return decoder;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: number_states
+ *  ------------------------------------------------------------------------ */
+static int number_states(BTREE_NODE *node,
+                         int (*p_children)[2],
+                         unsigned int *p_state_count)
+{
+    int state;
+
+    if (btreenode_is_leaf(node))
+    {
+        return -((int) ((SYMBOL*) btreenode_get_data(node))->symbol + 1);
+    }
+
+    state = (int) (*p_state_count)++;
+    p_children[state][0] = number_states(btreenode_get_left(node),
+                                         p_children, p_state_count);
+    p_children[state][1] = number_states(btreenode_get_right(node),
+                                         p_children, p_state_count);
+
+    return state;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: fsm_decoder_decode
+ *  ------------------------------------------------------------------------ */
+extern unsigned long fsm_decoder_decode(FSM_DECODER *decoder,
+                                        unsigned char *p_input,
+                                        unsigned long input_length,
+                                        unsigned char *p_output,
+                                        unsigned long output_length)
+{
+    unsigned char *p_input_end = p_input + input_length;
+    unsigned char *p_output_start = p_output;
+    unsigned char *p_output_end = p_output + output_length;
+    FSM_TRANSITION *p_transition;
+    unsigned int state = 0;
+
+    if (decoder->transitions == NULL)
+    {
+        memset(p_output, decoder->single_symbol, output_length);
+        return output_length;
+    }
+
+    /*
+     * Solange noch mindestens FSM_MAX_SYMBOLS Zeichen Platz haben, werden
+     * immer alle moeglichen Zeichen kopiert und nur der Zeiger um die
+     * tatsaechliche Anzahl weitergeschoben.
+     */
+    while (p_input < p_input_end
+            && (unsigned long) (p_output_end - p_output) >= FSM_MAX_SYMBOLS)
+    {
+        p_transition = decoder->transitions
+                + state * FSM_TRANSITIONS + *p_input++;
+        memcpy(p_output, p_transition->symbols, FSM_MAX_SYMBOLS);
+        p_output += p_transition->symbol_count;
+        state = p_transition->next_state;
+    }
+
+    /*
+     * Am Ende nur so viele Zeichen uebernehmen wie noch Platz haben, die
+     * restlichen Bits des letzten Bytes sind Fuellbits.
+     */
+    while (p_input < p_input_end && p_output < p_output_end)
+    {
+        p_transition = decoder->transitions
+                + state * FSM_TRANSITIONS + *p_input++;
+        if ((unsigned long) (p_output_end - p_output)
+                < p_transition->symbol_count)
+        {
+            memcpy(p_output, p_transition->symbols,
+                   (size_t) (p_output_end - p_output));
+            p_output = p_output_end;
+        }
+        else
+        {
+            memcpy(p_output, p_transition->symbols,
+                   p_transition->symbol_count);
+            p_output += p_transition->symbol_count;
+        }
+        state = p_transition->next_state;
+    }
+
+    return (unsigned long) (p_output - p_output_start);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: fsm_decoder_destroy
+ *  ------------------------------------------------------------------------ */
+extern void fsm_decoder_destroy(FSM_DECODER *decoder)
+{
+    if (decoder != NULL)
+    {
+        allocator_free(decoder->allocator, decoder->transitions);
+        allocator_free(decoder->allocator, decoder);
+    }
+}
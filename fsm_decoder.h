@@ -0,0 +1,115 @@
+/**
+ * File: fsm_decoder.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FSM_DECODER_H
+
+#define	FSM_DECODER_H
+
+#include "common.h"
+#include "allocator.h"
+#include "btreenode.h"
+
+/** Anzahl der Uebergaenge je Zustand (ein Uebergang je Eingabebyte). */
+#define FSM_TRANSITIONS 256
+
+/** Maximale Anzahl Zeichen die ein Eingabebyte erzeugen kann. */
+#define FSM_MAX_SYMBOLS 8
+
+/**
+ * Struktur eines Zustandsuebergangs. Beschreibt, welche Zeichen beim Lesen
+ * eines ganzen Bytes in einem Zustand ausgegeben werden und in welchem
+ * Zustand der Automat danach steht.
+ */
+typedef struct _FSM_TRANSITION
+{
+    /**
+     * Zustand nach dem Lesen des Bytes
+     */
+    unsigned char next_state;
+    /**
+     * Anzahl der ausgegebenen Zeichen
+     */
+    unsigned char symbol_count;
+    /**
+     * Ausgegebene Zeichen
+     */
+    unsigned char symbols[FSM_MAX_SYMBOLS];
+} FSM_TRANSITION;
+
+/**
+ * Struktur des Automaten. Jeder Zustand entspricht einem inneren Knoten des
+ * Huffman-Baums, Zustand 0 ist die Wurzel.
+ */
+typedef struct _FSM_DECODER
+{
+    /**
+     * Anzahl der Zustaende (innere Knoten)
+     */
+    unsigned int state_count;
+    /**
+     * Uebergangstabelle mit state_count * FSM_TRANSITIONS Eintraegen
+     */
+    FSM_TRANSITION *transitions;
+    /**
+     * Zeichen eines Baums der nur aus einem Blatt besteht
+     */
+    unsigned char single_symbol;
+    /**
+     * Allokator fuer Automat und Tabelle, NULL fuer calloc und free
+     */
+    ALLOCATOR *allocator;
+} FSM_DECODER;
+
+/**
+ * Erzeugt den Automaten aus dem uebergebenen Huffman-Baum. Fuer jeden
+ * inneren Knoten und jedes moegliche Eingabebyte werden die 8 Bits vorab
+ * durch den Baum verfolgt.
+ *
+ * @param allocator Allokator fuer Automat und Tabelle, NULL fuer calloc
+ * @param root Wurzel des Huffman-Baums
+ * @return Der erzeugte Automat
+ */
+extern FSM_DECODER *fsm_decoder_new(ALLOCATOR *allocator, BTREE_NODE *root);
+
+/**
+ * Dekodiert den uebergebenen Huffman-Code. Je Eingabebyte wird genau ein
+ * Tabelleneintrag gelesen. Die Dekodierung beginnt an einer Bytegrenze im
+ * Zustand der Wurzel und endet, wenn output_length Zeichen erzeugt wurden
+ * oder die Eingabe aufgebraucht ist.
+ *
+ * @param decoder Automat
+ * @param p_input Huffman-Code
+ * @param input_length Laenge des Huffman-Codes in Byte
+ * @param p_output Puffer fuer die dekodierten Zeichen
+ * @param output_length Anzahl der zu dekodierenden Zeichen
+ * @return Anzahl der dekodierten Zeichen
+ */
+extern unsigned long fsm_decoder_decode(FSM_DECODER *decoder,
+                                        unsigned char *p_input,
+                                        unsigned long input_length,
+                                        unsigned char *p_output,
+                                        unsigned long output_length);
+
+/**
+ * Gibt den Speicher des Automaten wieder frei.
+ *
+ * @param decoder Freizugebender Automat
+ */
+extern void fsm_decoder_destroy(FSM_DECODER *decoder);
+
+#endif	/* FSM_DECODER_H */
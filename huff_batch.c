@@ -0,0 +1,600 @@
+/**
+ * File: huff_batch.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "common.h"
+#include "huffman.h"
+#include "byte_order.h"
+#include "codec_kernels.h"
+#include "huff_buffer.h"
+#include "huff_batch.h"
+
+/** Jede Eingabe als eigenen Container komprimieren. */
+#define BATCH_TASK_COMPRESS 0
+
+/** Jede Eingabe als eigenen Container dekomprimieren. */
+#define BATCH_TASK_DECOMPRESS 1
+
+/** Haeufigkeiten aller Eingaben zaehlen. */
+#define BATCH_TASK_COUNT 2
+
+/** Laenge des Blocks je Eingabe mit der gemeinsamen Tabelle berechnen. */
+#define BATCH_TASK_MEASURE 3
+
+/** Block je Eingabe mit der gemeinsamen Tabelle kodieren. */
+#define BATCH_TASK_ENCODE 4
+
+/** Block je Eingabe mit der gemeinsamen Tabelle dekodieren. */
+#define BATCH_TASK_DECODE 5
+
+/** Gemeinsamer Auftrag aller Threads eines Batch-Aufrufs. */
+typedef struct _BATCH_JOB
+{
+    /**
+     * Aufgabe (BATCH_TASK_*)
+     */
+    unsigned int task;
+    /**
+     * Eingaben
+     */
+    HUFF_SLICE *p_inputs;
+    /**
+     * Ausgaben
+     */
+    HUFF_SLICE *p_outputs;
+    /**
+     * Anzahl der Eingaben
+     */
+    unsigned long count;
+    /**
+     * Erste noch nicht entnommene Eingabe
+     */
+    unsigned long next;
+    /**
+     * Schuetzt next
+     */
+    pthread_mutex_t lock;
+    /**
+     * Gemeinsame Codetabelle
+     */
+    CODE_TABLE *table;
+    /**
+     * TRUE wenn die gemeinsame Tabelle verwendet werden kann
+     */
+    BOOL table_valid;
+    /**
+     * Gemeinsame Dekodiertabelle
+     */
+    DECODE_TABLE *decode_table;
+    /**
+     * Container mit gemeinsamer Tabelle
+     */
+    unsigned char *p_container;
+    /**
+     * Position des Blocks je Eingabe im Container, count + 1 Eintraege
+     */
+    unsigned long *p_offsets;
+} BATCH_JOB;
+
+/** Zustand eines Threads eines Batch-Aufrufs. */
+typedef struct _BATCH_WORKER
+{
+    /**
+     * Gemeinsamer Auftrag
+     */
+    BATCH_JOB *job;
+    /**
+     * Von diesem Thread gezaehlte Haeufigkeiten
+     */
+    unsigned long counts[256];
+    /**
+     * TRUE wenn eine Eingabe nicht bearbeitet werden konnte
+     */
+    BOOL failed;
+} BATCH_WORKER;
+
+/**
+ * Diese Funktion bereitet einen Auftrag vor.
+ *
+ * @param job Auftrag
+ * @param task Aufgabe (BATCH_TASK_*)
+ * @param p_inputs Eingaben
+ * @param p_outputs Ausgaben
+ * @param count Anzahl der Eingaben
+ */
+static void init_job(BATCH_JOB *job,
+                     unsigned int task,
+                     HUFF_SLICE *p_inputs,
+                     HUFF_SLICE *p_outputs,
+                     unsigned long count);
+
+/**
+ * Diese Funktion fuehrt einen Auftrag mit bis zu thread_count Threads aus.
+ * Jeder Thread braucht mindestens BATCH_MIN_THREAD_BYTES Daten, der
+ * aufrufende Thread arbeitet selbst mit.
+ *
+ * @param job Auftrag
+ * @param total_bytes Gesamte Datenmenge des Auftrags
+ * @param thread_count Maximale Anzahl Threads
+ * @param p_counts Summe der gezaehlten Haeufigkeiten (256 Eintraege) oder
+ *        NULL
+ * @return FALSE wenn eine Eingabe nicht bearbeitet werden konnte
+ */
+static BOOL run_job(BATCH_JOB *job,
+                    unsigned long total_bytes,
+                    unsigned int thread_count,
+                    unsigned long *p_counts);
+
+/**
+ * Thread-Funktion: entnimmt solange Gruppen von BATCH_TAKE_COUNT Eingaben
+ * und bearbeitet sie, bis keine mehr uebrig sind.
+ *
+ * @param p_worker Zustand des Threads (BATCH_WORKER*)
+ * @return NULL
+ */
+static void *work_job(void *p_worker);
+
+/**
+ * Diese Funktion bearbeitet eine Eingabe eines Auftrags.
+ *
+ * @param worker Zustand des Threads
+ * @param index Index der Eingabe
+ * @return FALSE wenn die Eingabe nicht bearbeitet werden konnte
+ */
+static BOOL process_slice(BATCH_WORKER *worker, unsigned long index);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_compress_batch
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_compress_batch(HUFF_SLICE *p_inputs,
+                                         HUFF_SLICE *p_outputs,
+                                         unsigned long count,
+                                         unsigned int thread_count)
+{
+    BATCH_JOB job;
+    unsigned long total_bytes = 0;
+    unsigned long i;
+
+    for (i = 0; i < count; i++)
+    {
+        total_bytes += p_inputs[i].length;
+    }
+
+    init_job(&job, BATCH_TASK_COMPRESS, p_inputs, p_outputs, count);
+
+    return run_job(&job, total_bytes, thread_count, NULL)
+           ? count : HUFF_BUFFER_ERROR;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_batch_shared_bound
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_batch_shared_bound(HUFF_SLICE *p_inputs,
+                                             unsigned long count)
+{
+    unsigned long bound = CONTAINER_HEADER_SIZE + BLOCK_HEADER_SIZE
+                          + 256 * BLOCK_SYMBOL_SIZE;
+    unsigned long i;
+
+    /* Jede Eingabe wird hoechstens gespeichert. */
+    for (i = 0; i < count; i++)
+    {
+        bound += BLOCK_HEADER_SIZE + p_inputs[i].length;
+    }
+
+    return bound;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_compress_batch_shared
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_compress_batch_shared(HUFF_SLICE *p_inputs,
+                                                unsigned long count,
+                                                unsigned char *p_dst,
+                                                unsigned long dst_cap,
+                                                unsigned int thread_count)
+{
+    BATCH_JOB job;
+    CODE_TABLE table;
+    unsigned long counts[256];
+    unsigned long total_bytes = 0;
+    unsigned long block_size = 0;
+    unsigned long table_length, length, i;
+
+    if (dst_cap < CONTAINER_HEADER_SIZE)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        total_bytes += p_inputs[i].length;
+        if (p_inputs[i].length > block_size)
+        {
+            block_size = p_inputs[i].length;
+        }
+    }
+
+    /* Ein Durchlauf ueber alle Eingaben fuer eine gemeinsame Tabelle. */
+    init_job(&job, BATCH_TASK_COUNT, p_inputs, NULL, count);
+    memset(counts, 0, sizeof(counts));
+    run_job(&job, total_bytes, thread_count, counts);
+
+    table_length = huff_encode_table_block(counts,
+                                           p_dst + CONTAINER_HEADER_SIZE,
+                                           dst_cap - CONTAINER_HEADER_SIZE,
+                                           &table, &job.table_valid);
+    if (table_length == HUFF_BUFFER_ERROR)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    /*
+     * Erst wenn die Laenge aller Bloecke bekannt ist, liegt die Position
+     * jedes Blocks fest und die Eingaben koennen unabhaengig voneinander
+     * kodiert werden.
+     */
+    job.table = &table;
+    job.p_container = p_dst;
+    job.p_offsets = malloc((count + 1) * sizeof(unsigned long));
+    ENSURE_ENOUGH_MEMORY(job.p_offsets, "huff_compress_batch_shared");
+
+    job.task = BATCH_TASK_MEASURE;
+    job.next = 0;
+    run_job(&job, total_bytes, thread_count, NULL);
+
+    job.p_offsets[0] = CONTAINER_HEADER_SIZE + table_length;
+    for (i = 0; i < count; i++)
+    {
+        job.p_offsets[i + 1] += job.p_offsets[i];
+    }
+    length = job.p_offsets[count];
+
+    if (length > dst_cap)
+    {
+        free(job.p_offsets);
+        return HUFF_BUFFER_ERROR;
+    }
+
+    job.task = BATCH_TASK_ENCODE;
+    job.next = 0;
+    run_job(&job, total_bytes, thread_count, NULL);
+    free(job.p_offsets);
+
+    /*
+     * Die groesste Eingabe als Blockgroesse kennzeichnet den Container fuer
+     * decompress als Folge einzelner Bloecke.
+     */
+    store_container_header(p_dst, 0, total_bytes, block_size);
+
+    return length;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_decompress_batch
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_decompress_batch(HUFF_SLICE *p_inputs,
+                                           HUFF_SLICE *p_outputs,
+                                           unsigned long count,
+                                           unsigned int thread_count)
+{
+    BATCH_JOB job;
+    unsigned long total_bytes = 0;
+    unsigned long i;
+
+    for (i = 0; i < count; i++)
+    {
+        total_bytes += p_inputs[i].length;
+    }
+
+    init_job(&job, BATCH_TASK_DECOMPRESS, p_inputs, p_outputs, count);
+
+    return run_job(&job, total_bytes, thread_count, NULL)
+           ? count : HUFF_BUFFER_ERROR;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_decompress_batch_shared
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_decompress_batch_shared(unsigned char *p_src,
+                                                  unsigned long src_len,
+                                                  HUFF_SLICE *p_outputs,
+                                                  unsigned long count,
+                                                  unsigned int thread_count)
+{
+    BATCH_JOB job;
+    DECODE_TABLE decode_table;
+    unsigned long char_count = huff_decompressed_size(p_src, src_len);
+    unsigned long offset = CONTAINER_HEADER_SIZE;
+    unsigned long raw_count = 0;
+    unsigned long block_length, i;
+    BOOL correct;
+
+    if (char_count == HUFF_BUFFER_ERROR || p_src[5] != 0
+            || src_len - offset < BLOCK_HEADER_SIZE
+            || p_src[offset] != BLOCK_TYPE_HUFFMAN
+            || load_le(p_src + offset + 3, 8) != 0)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    init_job(&job, BATCH_TASK_DECODE, NULL, p_outputs, count);
+    job.decode_table = &decode_table;
+    job.p_container = p_src;
+
+    /* Der erste Block enthaelt nur die gemeinsame Tabelle. */
+    block_length = huff_block_size(p_src + offset, 0);
+    if (block_length == HUFF_BUFFER_ERROR || block_length > src_len - offset
+            || huff_decode_block(p_src + offset, 0, &decode_table,
+                                 &job.table_valid, NULL, 0)
+               == HUFF_BUFFER_ERROR)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+    offset += block_length;
+
+    /*
+     * Die Threads teilen sich die Dekodiertabelle. Sie bleibt unveraendert,
+     * solange nur Bloecke ohne eigene Tabelle folgen.
+     */
+    job.p_offsets = malloc((count + 1) * sizeof(unsigned long));
+    ENSURE_ENOUGH_MEMORY(job.p_offsets, "huff_decompress_batch_shared");
+    correct = TRUE;
+    for (i = 0; i < count && correct; i++)
+    {
+        job.p_offsets[i] = offset;
+        block_length = (src_len - offset < BLOCK_HEADER_SIZE)
+                       ? HUFF_BUFFER_ERROR : huff_block_size(p_src + offset, 0);
+        if (block_length == HUFF_BUFFER_ERROR
+                || block_length > src_len - offset
+                || p_src[offset] == BLOCK_TYPE_HUFFMAN)
+        {
+            correct = FALSE;
+        }
+        else
+        {
+            raw_count += load_le(p_src + offset + 3, 8);
+            offset += block_length;
+        }
+    }
+    job.p_offsets[count] = offset;
+
+    if (correct && offset == src_len && raw_count == char_count)
+    {
+        correct = run_job(&job, char_count, thread_count, NULL);
+    }
+    else
+    {
+        correct = FALSE;
+    }
+    free(job.p_offsets);
+
+    return correct ? count : HUFF_BUFFER_ERROR;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: init_job
+ *  ------------------------------------------------------------------------ */
+static void init_job(BATCH_JOB *job,
+                     unsigned int task,
+                     HUFF_SLICE *p_inputs,
+                     HUFF_SLICE *p_outputs,
+                     unsigned long count)
+{
+    memset(job, 0, sizeof(BATCH_JOB));
+    job->task = task;
+    job->p_inputs = p_inputs;
+    job->p_outputs = p_outputs;
+    job->count = count;
+    job->table_valid = FALSE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: run_job
+ *  ------------------------------------------------------------------------ */
+static BOOL run_job(BATCH_JOB *job,
+                    unsigned long total_bytes,
+                    unsigned int thread_count,
+                    unsigned long *p_counts)
+{
+    BATCH_WORKER *workers;
+    pthread_t *threads;
+    BOOL *p_started;
+    BOOL correct = TRUE;
+    unsigned int i, count, symbol;
+
+    /*
+     * Kleine Auftraege lohnen keinen Thread, und mehr Threads als Gruppen
+     * von Eingaben haetten nichts zu tun.
+     */
+    count = thread_count;
+    if (total_bytes / BATCH_MIN_THREAD_BYTES < count)
+    {
+        count = (unsigned int) (total_bytes / BATCH_MIN_THREAD_BYTES);
+    }
+    if ((job->count + BATCH_TAKE_COUNT - 1) / BATCH_TAKE_COUNT < count)
+    {
+        count = (unsigned int) ((job->count + BATCH_TAKE_COUNT - 1)
+                                / BATCH_TAKE_COUNT);
+    }
+    if (count == 0)
+    {
+        count = 1;
+    }
+
+    workers = calloc(count, sizeof(BATCH_WORKER));
+    threads = calloc(count, sizeof(pthread_t));
+    p_started = calloc(count, sizeof(BOOL));
+    ENSURE_ENOUGH_MEMORY(workers, "run_job");
+    ENSURE_ENOUGH_MEMORY(threads, "run_job");
+    ENSURE_ENOUGH_MEMORY(p_started, "run_job");
+
+    pthread_mutex_init(&job->lock, NULL);
+    for (i = 0; i < count; i++)
+    {
+        workers[i].job = job;
+    }
+
+    /*
+     * Der aufrufende Thread arbeitet selbst mit. Konnte ein Thread nicht
+     * gestartet werden, uebernehmen die uebrigen seine Eingaben.
+     */
+    for (i = 1; i < count; i++)
+    {
+        p_started[i] = (pthread_create(&threads[i], NULL, work_job,
+                                       &workers[i]) == 0) ? TRUE : FALSE;
+    }
+    work_job(&workers[0]);
+    for (i = 1; i < count; i++)
+    {
+        if (p_started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    pthread_mutex_destroy(&job->lock);
+
+    for (i = 0; i < count; i++)
+    {
+        if (workers[i].failed)
+        {
+            correct = FALSE;
+        }
+        if (p_counts != NULL)
+        {
+            for (symbol = 0; symbol < 256; symbol++)
+            {
+                p_counts[symbol] += workers[i].counts[symbol];
+            }
+        }
+    }
+
+    free(workers);
+    free(threads);
+    free(p_started);
+
+    return correct;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: work_job
+ *  ------------------------------------------------------------------------ */
+static void *work_job(void *p_worker)
+{
+    BATCH_WORKER *worker = (BATCH_WORKER*) p_worker;
+    BATCH_JOB *job = worker->job;
+    unsigned long first, last;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&job->lock);
+        first = job->next;
+        last = (job->count - first > BATCH_TAKE_COUNT)
+               ? first + BATCH_TAKE_COUNT : job->count;
+        job->next = last;
+        pthread_mutex_unlock(&job->lock);
+
+        if (first >= last)
+        {
+            break;
+        }
+        for (; first < last; first++)
+        {
+            if (!process_slice(worker, first))
+            {
+                worker->failed = TRUE;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: process_slice
+ *  ------------------------------------------------------------------------ */
+static BOOL process_slice(BATCH_WORKER *worker, unsigned long index)
+{
+    BATCH_JOB *job = worker->job;
+    HUFF_SLICE *p_input = (job->p_inputs != NULL)
+                          ? &job->p_inputs[index] : NULL;
+    HUFF_SLICE *p_output = (job->p_outputs != NULL)
+                           ? &job->p_outputs[index] : NULL;
+    unsigned long *p_offsets = job->p_offsets;
+    unsigned long i, length;
+    BOOL table_valid;
+    BOOL correct = TRUE;
+
+    if (job->task == BATCH_TASK_COMPRESS)
+    {
+        p_output->length = huff_compress_buffer(p_input->p_data,
+                                                p_input->length,
+                                                p_output->p_data,
+                                                p_output->capacity);
+        correct = (p_output->length != HUFF_BUFFER_ERROR) ? TRUE : FALSE;
+    }
+    else if (job->task == BATCH_TASK_DECOMPRESS)
+    {
+        p_output->length = huff_decompress_buffer(p_input->p_data,
+                                                  p_input->length,
+                                                  p_output->p_data,
+                                                  p_output->capacity);
+        correct = (p_output->length != HUFF_BUFFER_ERROR) ? TRUE : FALSE;
+    }
+    else if (job->task == BATCH_TASK_COUNT)
+    {
+        for (i = 0; i < p_input->length; i++)
+        {
+            worker->counts[p_input->p_data[i]]++;
+        }
+    }
+    else if (job->task == BATCH_TASK_MEASURE)
+    {
+        p_offsets[index + 1] = huff_repeat_block_size(job->table,
+                                                      job->table_valid,
+                                                      p_input->p_data,
+                                                      p_input->length);
+    }
+    else if (job->task == BATCH_TASK_ENCODE)
+    {
+        length = huff_encode_repeat_block(job->table, job->table_valid,
+                                          p_input->p_data, p_input->length,
+                                          job->p_container + p_offsets[index],
+                                          p_offsets[index + 1]
+                                          - p_offsets[index]);
+        correct = (length != HUFF_BUFFER_ERROR) ? TRUE : FALSE;
+    }
+    else
+    {
+        /* Jeder Thread braucht seine eigene Kopie des Flags. */
+        table_valid = job->table_valid;
+        p_output->length = huff_decode_block(job->p_container
+                                             + p_offsets[index], 0,
+                                             job->decode_table, &table_valid,
+                                             p_output->p_data,
+                                             p_output->capacity);
+        correct = (p_output->length != HUFF_BUFFER_ERROR) ? TRUE : FALSE;
+    }
+
+    return correct;
+}
@@ -0,0 +1,136 @@
+/**
+ * File: huff_batch.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HUFF_BATCH_H
+
+#define	HUFF_BATCH_H
+
+#include "common.h"
+
+/** Minimale Datenmenge je Thread eines Batch-Aufrufs in Byte. */
+#define BATCH_MIN_THREAD_BYTES 65536
+
+/** Anzahl Eingaben, die ein Thread auf einmal zur Bearbeitung entnimmt. */
+#define BATCH_TAKE_COUNT 64
+
+/** Ein- oder Ausgabebereich eines Batch-Aufrufs. */
+typedef struct _HUFF_SLICE
+{
+    /**
+     * Anfang des Bereichs
+     */
+    unsigned char *p_data;
+    /**
+     * Laenge der Eingabe bzw. nach dem Aufruf Anzahl geschriebener Byte oder
+     * HUFF_BUFFER_ERROR
+     */
+    unsigned long length;
+    /**
+     * Groesse des Ausgabepuffers, bei Eingaben ohne Bedeutung
+     */
+    unsigned long capacity;
+} HUFF_SLICE;
+
+/**
+ * Komprimiert viele unabhaengige Eingaben mit einem Aufruf. Jede Ausgabe ist
+ * ein eigener Container wie von huff_compress_buffer. Die Eingaben werden in
+ * Gruppen zu BATCH_TAKE_COUNT auf bis zu thread_count Threads verteilt.
+ * huff_buffer_init muss vorher aufgerufen worden sein.
+ * 
+ * @param p_inputs Eingaben
+ * @param p_outputs Ausgaben, capacity je Ausgabe wie bei huff_compress_buffer
+ * @param count Anzahl der Ein- und Ausgaben
+ * @param thread_count Maximale Anzahl Threads
+ * @return count oder HUFF_BUFFER_ERROR wenn eine Ausgabe zu klein ist, deren
+ *         length ist dann HUFF_BUFFER_ERROR
+ */
+extern unsigned long huff_compress_batch(HUFF_SLICE *p_inputs,
+                                         HUFF_SLICE *p_outputs,
+                                         unsigned long count,
+                                         unsigned int thread_count);
+
+/**
+ * Liefert die maximale Groesse, die huff_compress_batch_shared fuer die
+ * Eingaben schreibt.
+ * 
+ * @param p_inputs Eingaben
+ * @param count Anzahl der Eingaben
+ * @return Benoetigte Groesse des Ausgabepuffers in Byte
+ */
+extern unsigned long huff_batch_shared_bound(HUFF_SLICE *p_inputs,
+                                             unsigned long count);
+
+/**
+ * Komprimiert viele Eingaben mit einer gemeinsamen Codetabelle in einen
+ * Container. Die Haeufigkeiten aller Eingaben werden in einem Durchlauf
+ * gezaehlt und die Tabelle einmal erzeugt; der Container beginnt mit einem
+ * Huffman-Block ohne Zeichen, danach folgt je Eingabe genau ein Block vom
+ * Typ BLOCK_TYPE_REPEAT oder BLOCK_TYPE_STORED. huff_decompress_buffer
+ * liefert daraus alle Eingaben hintereinander.
+ * 
+ * @param p_inputs Eingaben
+ * @param count Anzahl der Eingaben
+ * @param p_dst Ausgabepuffer
+ * @param dst_cap Groesse des Ausgabepuffers, huff_batch_shared_bound reicht
+ *        immer aus
+ * @param thread_count Maximale Anzahl Threads
+ * @return Anzahl geschriebener Bytes oder HUFF_BUFFER_ERROR wenn der
+ *         Ausgabepuffer zu klein ist
+ */
+extern unsigned long huff_compress_batch_shared(HUFF_SLICE *p_inputs,
+                                                unsigned long count,
+                                                unsigned char *p_dst,
+                                                unsigned long dst_cap,
+                                                unsigned int thread_count);
+
+/**
+ * Dekomprimiert viele Container von huff_compress_batch mit einem Aufruf.
+ * 
+ * @param p_inputs Komprimierte Container
+ * @param p_outputs Ausgaben, capacity je Ausgabe wie bei
+ *        huff_decompress_buffer
+ * @param count Anzahl der Ein- und Ausgaben
+ * @param thread_count Maximale Anzahl Threads
+ * @return count oder HUFF_BUFFER_ERROR wenn eine Eingabe fehlerhaft oder
+ *         eine Ausgabe zu klein ist, deren length ist dann HUFF_BUFFER_ERROR
+ */
+extern unsigned long huff_decompress_batch(HUFF_SLICE *p_inputs,
+                                           HUFF_SLICE *p_outputs,
+                                           unsigned long count,
+                                           unsigned int thread_count);
+
+/**
+ * Dekomprimiert einen Container von huff_compress_batch_shared wieder in
+ * die einzelnen Eingaben.
+ * 
+ * @param p_src Komprimierter Container
+ * @param src_len Laenge des Containers in Byte
+ * @param p_outputs Ausgaben, capacity je Ausgabe
+ * @param count Anzahl der Ausgaben, muss der Anzahl der Eingaben beim
+ *        Komprimieren entsprechen
+ * @param thread_count Maximale Anzahl Threads
+ * @return count oder HUFF_BUFFER_ERROR wenn der Container fehlerhaft ist,
+ *         nicht count Eingaben enthaelt oder eine Ausgabe zu klein ist
+ */
+extern unsigned long huff_decompress_batch_shared(unsigned char *p_src,
+                                                  unsigned long src_len,
+                                                  HUFF_SLICE *p_outputs,
+                                                  unsigned long count,
+                                                  unsigned int thread_count);
+
+#endif	/* HUFF_BATCH_H */
@@ -0,0 +1,857 @@
+/**
+ * File: huff_buffer.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "common.h"
+#include "huffman.h"
+#include "byte_order.h"
+#include "checksum.h"
+#include "codec_kernels.h"
+#include "huff_buffer.h"
+
+/** Anzahl Zeichen die der Kodierer je Kernelaufruf verarbeitet. */
+#define BUFFER_CHUNK_SIZE 4096
+
+/**
+ * Groesse des Zwischenpuffers fuer die letzten Zeichen, deren Kodierung
+ * ueber das Ende des Ausgabepuffers hinaus schreiben koennte.
+ */
+#define BUFFER_SCRATCH_SIZE \
+    (BUFFER_CHUNK_SIZE * KERNEL_MAX_CODE_LENGTH / 8 + KERNEL_OUTPUT_SLACK)
+
+/** Maximale Anzahl Knoten eines Huffman-Baums mit 256 Blaettern. */
+#define BUFFER_MAX_NODES 511
+
+/**
+ * Struktur eines Huffman-Baums in Feldern. Die Blaetter stehen in der
+ * Reihenfolge der Symboltabelle vorne, jeder innere Knoten hinter seinen
+ * beiden Nachfolgern.
+ */
+typedef struct _BUFFER_TREE
+{
+    /**
+     * Haeufigkeit je Knoten
+     */
+    unsigned long counts[BUFFER_MAX_NODES];
+    /**
+     * Linker und rechter Nachfolger der inneren Knoten
+     */
+    unsigned short children[BUFFER_MAX_NODES][2];
+    /**
+     * Code je Knoten, rechtsbuendig
+     */
+    unsigned long bits[BUFFER_MAX_NODES];
+    /**
+     * Codelaenge je Knoten
+     */
+    unsigned int lengths[BUFFER_MAX_NODES];
+} BUFFER_TREE;
+
+/**
+ * Diese Funktion erzeugt die Codetabelle aus einer Symboltabelle. Der Baum
+ * wird mit demselben Heap-Verfahren wie create_huffman_tree aufgebaut, damit
+ * die Codes mit denen von compress und decompress uebereinstimmen.
+ *
+ * @param p_symbols Zeichen in der Reihenfolge der Symboltabelle
+ * @param p_counts Haeufigkeiten in der Reihenfolge der Symboltabelle
+ * @param symbol_count Anzahl der Symbole (1 - 256)
+ * @param table Zu fuellende Codetabelle
+ * @return FALSE wenn ein Code laenger als KERNEL_MAX_CODE_LENGTH ist
+ */
+static BOOL build_codes(unsigned char *p_symbols,
+                        unsigned long *p_counts,
+                        unsigned int symbol_count,
+                        CODE_TABLE *table);
+
+/**
+ * Diese Funktion fuegt einen Knoten in den Heap ein, wie heap_insert.
+ *
+ * @param p_heap Heap aus Knotennummern
+ * @param p_count Anzahl der Knoten im Heap
+ * @param p_counts Haeufigkeit je Knoten
+ * @param node Einzufuegender Knoten
+ */
+static void heap_push(unsigned short *p_heap,
+                      unsigned int *p_count,
+                      unsigned long *p_counts,
+                      unsigned short node);
+
+/**
+ * Diese Funktion entnimmt den Knoten mit der kleinsten Haeufigkeit, wie
+ * heap_extract_min.
+ *
+ * @param p_heap Heap aus Knotennummern
+ * @param p_count Anzahl der Knoten im Heap
+ * @param p_counts Haeufigkeit je Knoten
+ * @return Entnommener Knoten
+ */
+static unsigned short heap_pop(unsigned short *p_heap,
+                               unsigned int *p_count,
+                               unsigned long *p_counts);
+
+/**
+ * Diese Funktion kodiert die Eingabe mit dem Kodierkernel. Solange der
+ * restliche Ausgabepuffer fuer den ungeprueften Kernel reicht, wird direkt
+ * hineingeschrieben, sonst ueber einen Zwischenpuffer auf dem Stack.
+ *
+ * @param table Codetabelle
+ * @param p_src Eingabe
+ * @param src_len Laenge der Eingabe
+ * @param p_dst Ausgabe
+ * @param code_length Laenge des Huffman-Codes in Byte
+ */
+static void encode_payload(CODE_TABLE *table,
+                           unsigned char *p_src,
+                           unsigned long src_len,
+                           unsigned char *p_dst,
+                           unsigned long code_length);
+
+/**
+ * Diese Funktion berechnet die Laenge des Huffman-Codes einer Eingabe mit
+ * einer Codetabelle.
+ *
+ * @param table Codetabelle
+ * @param p_src Eingabe
+ * @param src_len Laenge der Eingabe
+ * @return Laenge des Huffman-Codes in Byte
+ */
+static unsigned long get_code_length(CODE_TABLE *table,
+                                     unsigned char *p_src,
+                                     unsigned long src_len);
+
+/**
+ * Diese Funktion liest eine Symboltabelle und erzeugt daraus die
+ * Dekodiertabelle.
+ *
+ * @param p_table Erster Eintrag der Symboltabelle
+ * @param symbol_count Anzahl der Eintraege
+ * @param decode_table Zu fuellende Dekodiertabelle
+ * @return FALSE wenn die Symboltabelle fehlerhaft ist
+ */
+static BOOL read_symbol_table(unsigned char *p_table,
+                              unsigned int symbol_count,
+                              DECODE_TABLE *decode_table);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_buffer_init
+ *  ------------------------------------------------------------------------ */
+extern void huff_buffer_init(void)
+{
+    kernels_init(FALSE);
+    checksum_init(FALSE);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_compress_bound
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_compress_bound(unsigned long src_len)
+{
+    /*
+     * Ein Huffman-Block wird nur geschrieben wenn er kleiner als die
+     * gespeicherte Eingabe ist.
+     */
+    return CONTAINER_HEADER_SIZE + BLOCK_HEADER_SIZE + src_len;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_compress_buffer
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_compress_buffer(unsigned char *p_src,
+                                          unsigned long src_len,
+                                          unsigned char *p_dst,
+                                          unsigned long dst_cap)
+{
+    unsigned long block_length;
+
+    if (dst_cap < CONTAINER_HEADER_SIZE)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    block_length = huff_encode_block(p_src, src_len,
+                                     p_dst + CONTAINER_HEADER_SIZE,
+                                     dst_cap - CONTAINER_HEADER_SIZE, FALSE);
+    if (block_length == HUFF_BUFFER_ERROR)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    store_container_header(p_dst, 0, src_len, 0);
+
+    return CONTAINER_HEADER_SIZE + block_length;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_decompressed_size
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_decompressed_size(unsigned char *p_src,
+                                            unsigned long src_len)
+{
+    unsigned char *p_next = p_src + CONTAINER_HEADER_SIZE;
+    unsigned long checksum_size, block_length, raw_length;
+    unsigned long char_count = 0;
+
+    if (src_len < CONTAINER_HEADER_SIZE
+            || memcmp(p_src, CONTAINER_MAGIC, 4) != 0
+            || p_src[4] != CONTAINER_VERSION)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    if ((p_src[5] & CONTAINER_FLAG_STREAM) == 0)
+    {
+        return load_le(p_src + 8, 8);
+    }
+
+    /*
+     * Ein Stream kennt seine Laenge erst am Ende, die Zeichen werden bis
+     * zum leeren Abschlussblock aufsummiert.
+     */
+    checksum_size = ((p_src[5] & CONTAINER_FLAG_CHECKSUM) != 0)
+                    ? CHECKSUM_SIZE : 0;
+    do
+    {
+        if ((unsigned long) (p_src + src_len - p_next) < BLOCK_HEADER_SIZE)
+        {
+            return HUFF_BUFFER_ERROR;
+        }
+        block_length = huff_block_size(p_next, checksum_size);
+        raw_length = load_le(p_next + 3, 8);
+        if (block_length == HUFF_BUFFER_ERROR
+                || block_length > (unsigned long) (p_src + src_len - p_next)
+                || raw_length >= HUFF_BUFFER_ERROR - char_count)
+        {
+            return HUFF_BUFFER_ERROR;
+        }
+        char_count += raw_length;
+        p_next += block_length;
+    } while (raw_length > 0);
+
+    return char_count;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_decompress_buffer
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_decompress_buffer(unsigned char *p_src,
+                                            unsigned long src_len,
+                                            unsigned char *p_dst,
+                                            unsigned long dst_cap)
+{
+    unsigned char *p_next = p_src + CONTAINER_HEADER_SIZE;
+    unsigned char *p_end = p_src + src_len;
+    unsigned long char_count = huff_decompressed_size(p_src, src_len);
+    unsigned long produced = 0;
+    unsigned long checksum_size, block_length, raw_length;
+    BOOL table_valid = FALSE;
+    DECODE_TABLE decode_table;
+
+    if (char_count == HUFF_BUFFER_ERROR || char_count > dst_cap
+            || (p_src[5] & ~(CONTAINER_FLAG_SEEK_INDEX
+                             | CONTAINER_FLAG_CHECKSUM
+                             | CONTAINER_FLAG_STREAM)) != 0)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+    checksum_size = ((p_src[5] & CONTAINER_FLAG_CHECKSUM) != 0)
+                    ? CHECKSUM_SIZE : 0;
+
+    while (produced < char_count)
+    {
+        if ((unsigned long) (p_end - p_next) < BLOCK_HEADER_SIZE)
+        {
+            return HUFF_BUFFER_ERROR;
+        }
+        block_length = huff_block_size(p_next, checksum_size);
+        if (block_length == HUFF_BUFFER_ERROR
+                || block_length > (unsigned long) (p_end - p_next))
+        {
+            return HUFF_BUFFER_ERROR;
+        }
+        raw_length = huff_decode_block(p_next, checksum_size, &decode_table,
+                                       &table_valid, p_dst + produced,
+                                       char_count - produced);
+        if (raw_length == HUFF_BUFFER_ERROR)
+        {
+            return HUFF_BUFFER_ERROR;
+        }
+        p_next += block_length;
+        produced += raw_length;
+    }
+
+    return char_count;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: store_container_header
+ *  ------------------------------------------------------------------------ */
+extern void store_container_header(unsigned char *p_dst,
+                                   unsigned int flags,
+                                   unsigned long length,
+                                   unsigned long block_size)
+{
+    memset(p_dst, 0, CONTAINER_HEADER_SIZE);
+    memcpy(p_dst, CONTAINER_MAGIC, 4);
+    p_dst[4] = CONTAINER_VERSION;
+    p_dst[5] = (unsigned char) flags;
+    store_le(p_dst + 8, length, 8);
+    store_le(p_dst + 16, block_size, 8);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_encode_block
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_encode_block(unsigned char *p_src,
+                                       unsigned long src_len,
+                                       unsigned char *p_dst,
+                                       unsigned long dst_cap,
+                                       BOOL checksum)
+{
+    unsigned long counts[256];
+    unsigned long table_counts[256];
+    unsigned char symbols[256];
+    unsigned int symbol_count = 0;
+    unsigned long i, bits = 0;
+    unsigned long code_length = src_len;
+    unsigned long table_length = 0;
+    unsigned long checksum_size = checksum ? CHECKSUM_SIZE : 0;
+    unsigned char *p_next = p_dst + BLOCK_HEADER_SIZE;
+    unsigned int type = BLOCK_TYPE_STORED;
+    CODE_TABLE table;
+
+    /*
+     * Die Symboltabelle fuehrt die Zeichen wie build_symbol_map in der
+     * Reihenfolge ihres ersten Auftretens.
+     */
+    memset(counts, 0, sizeof(counts));
+    for (i = 0; i < src_len; i++)
+    {
+        if (counts[p_src[i]]++ == 0)
+        {
+            symbols[symbol_count++] = p_src[i];
+        }
+    }
+
+    for (i = 0; i < symbol_count; i++)
+    {
+        table_counts[i] = counts[symbols[i]];
+    }
+
+    /*
+     * Eine leere Eingabe ergibt wie bei compress einen leeren Huffman-Block.
+     * Waere der Huffman-Code mit der Symboltabelle nicht kleiner als die
+     * Eingabe, wird sie wie von compress unveraendert gespeichert. Das gilt
+     * auch fuer Codes, die fuer die Kernel zu lang sind.
+     */
+    if (src_len == 0)
+    {
+        type = BLOCK_TYPE_HUFFMAN;
+    }
+    else if (build_codes(symbols, table_counts, symbol_count, &table))
+    {
+        for (i = 0; i < symbol_count; i++)
+        {
+            bits += table_counts[i] * table.entries[symbols[i]].length;
+        }
+        if ((bits + 7) / 8 + symbol_count * BLOCK_SYMBOL_SIZE < src_len)
+        {
+            type = BLOCK_TYPE_HUFFMAN;
+            code_length = (bits + 7) / 8;
+            table_length = symbol_count * BLOCK_SYMBOL_SIZE;
+        }
+    }
+
+    if (dst_cap < BLOCK_HEADER_SIZE + table_length + code_length
+                  + checksum_size)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    p_dst[0] = (unsigned char) type;
+    store_le(p_dst + 1, (type == BLOCK_TYPE_HUFFMAN) ? symbol_count : 0, 2);
+    store_le(p_dst + 3, src_len, 8);
+    store_le(p_dst + 11, code_length, 8);
+
+    if (type == BLOCK_TYPE_HUFFMAN)
+    {
+        for (i = 0; i < symbol_count; i++)
+        {
+            p_next[0] = symbols[i];
+            store_le(p_next + 1, table_counts[i], 8);
+            p_next += BLOCK_SYMBOL_SIZE;
+        }
+        if (src_len > 0)
+        {
+            encode_payload(&table, p_src, src_len, p_next, code_length);
+        }
+    }
+    else
+    {
+        memcpy(p_next, p_src, src_len);
+    }
+    p_next += code_length;
+
+    if (checksum)
+    {
+        store_le(p_next, crc32c_update(0, p_src, src_len), CHECKSUM_SIZE);
+    }
+
+    return BLOCK_HEADER_SIZE + table_length + code_length + checksum_size;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_encode_table_block
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_encode_table_block(unsigned long *p_counts,
+                                             unsigned char *p_dst,
+                                             unsigned long dst_cap,
+                                             CODE_TABLE *table,
+                                             BOOL *p_table_valid)
+{
+    unsigned long table_counts[256];
+    unsigned char symbols[256];
+    unsigned int symbol_count = 0;
+    unsigned int i;
+    unsigned char *p_next = p_dst + BLOCK_HEADER_SIZE;
+
+    /*
+     * Die Haeufigkeiten stammen meist aus mehreren Eingaben, eine
+     * Reihenfolge des ersten Auftretens gibt es dann nicht. Die Zeichen
+     * werden deshalb aufsteigend eingetragen.
+     */
+    for (i = 0; i < 256; i++)
+    {
+        if (p_counts[i] > 0)
+        {
+            symbols[symbol_count] = (unsigned char) i;
+            table_counts[symbol_count++] = p_counts[i];
+        }
+    }
+
+    *p_table_valid = (symbol_count > 0
+                      && build_codes(symbols, table_counts, symbol_count,
+                                     table)) ? TRUE : FALSE;
+    if (!*p_table_valid)
+    {
+        symbol_count = 0;
+    }
+
+    if (dst_cap < BLOCK_HEADER_SIZE + symbol_count * BLOCK_SYMBOL_SIZE)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    p_dst[0] = BLOCK_TYPE_HUFFMAN;
+    store_le(p_dst + 1, symbol_count, 2);
+    store_le(p_dst + 3, 0, 8);
+    store_le(p_dst + 11, 0, 8);
+    for (i = 0; i < symbol_count; i++)
+    {
+        p_next[0] = symbols[i];
+        store_le(p_next + 1, table_counts[i], 8);
+        p_next += BLOCK_SYMBOL_SIZE;
+    }
+
+    return BLOCK_HEADER_SIZE + symbol_count * BLOCK_SYMBOL_SIZE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_repeat_block_size
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_repeat_block_size(CODE_TABLE *table,
+                                            BOOL table_valid,
+                                            unsigned char *p_src,
+                                            unsigned long src_len)
+{
+    unsigned long code_length;
+
+    /* Eine leere Eingabe wird auch ohne gueltige Tabelle gespeichert. */
+    if (table_valid && src_len > 0)
+    {
+        code_length = get_code_length(table, p_src, src_len);
+        if (code_length < src_len)
+        {
+            return BLOCK_HEADER_SIZE + code_length;
+        }
+    }
+
+    return BLOCK_HEADER_SIZE + src_len;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_encode_repeat_block
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_encode_repeat_block(CODE_TABLE *table,
+                                              BOOL table_valid,
+                                              unsigned char *p_src,
+                                              unsigned long src_len,
+                                              unsigned char *p_dst,
+                                              unsigned long dst_cap)
+{
+    unsigned long code_length = src_len;
+    unsigned int type = BLOCK_TYPE_STORED;
+
+    if (table_valid && src_len > 0)
+    {
+        code_length = get_code_length(table, p_src, src_len);
+        if (code_length < src_len)
+        {
+            type = BLOCK_TYPE_REPEAT;
+        }
+        else
+        {
+            code_length = src_len;
+        }
+    }
+
+    if (dst_cap < BLOCK_HEADER_SIZE + code_length)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    p_dst[0] = (unsigned char) type;
+    store_le(p_dst + 1, 0, 2);
+    store_le(p_dst + 3, src_len, 8);
+    store_le(p_dst + 11, code_length, 8);
+    if (type == BLOCK_TYPE_REPEAT)
+    {
+        encode_payload(table, p_src, src_len, p_dst + BLOCK_HEADER_SIZE,
+                       code_length);
+    }
+    else
+    {
+        memcpy(p_dst + BLOCK_HEADER_SIZE, p_src, src_len);
+    }
+
+    return BLOCK_HEADER_SIZE + code_length;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_block_size
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_block_size(unsigned char *p_header,
+                                     unsigned long checksum_size)
+{
+    unsigned int type = p_header[0];
+    unsigned long symbol_count = load_le(p_header + 1, 2);
+    unsigned long raw_length = load_le(p_header + 3, 8);
+    unsigned long code_length = load_le(p_header + 11, 8);
+
+    /* Kontextmodell, 16-Bit-Alphabet und Laufzeichen fehlen hier. */
+    if (symbol_count > 256
+            || (type == BLOCK_TYPE_HUFFMAN && symbol_count == 0
+                && raw_length > 0)
+            || (type == BLOCK_TYPE_STORED && code_length != raw_length)
+            || ((type == BLOCK_TYPE_STORED || type == BLOCK_TYPE_REPEAT)
+                && symbol_count > 0)
+            || (type != BLOCK_TYPE_HUFFMAN && type != BLOCK_TYPE_STORED
+                && type != BLOCK_TYPE_REPEAT)
+            || code_length > HUFF_BUFFER_ERROR - BLOCK_HEADER_SIZE
+                             - 256 * BLOCK_SYMBOL_SIZE - CHECKSUM_SIZE)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    return BLOCK_HEADER_SIZE + symbol_count * BLOCK_SYMBOL_SIZE + code_length
+           + checksum_size;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_decode_block
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_decode_block(unsigned char *p_block,
+                                       unsigned long checksum_size,
+                                       DECODE_TABLE *decode_table,
+                                       BOOL *p_table_valid,
+                                       unsigned char *p_dst,
+                                       unsigned long dst_cap)
+{
+    unsigned int type = p_block[0];
+    unsigned int symbol_count = (unsigned int) load_le(p_block + 1, 2);
+    unsigned long raw_length = load_le(p_block + 3, 8);
+    unsigned long code_length = load_le(p_block + 11, 8);
+    unsigned char *p_next = p_block + BLOCK_HEADER_SIZE;
+    DECODE_STATE state;
+
+    if (raw_length > dst_cap)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    if (type == BLOCK_TYPE_HUFFMAN && symbol_count > 0)
+    {
+        if (!read_symbol_table(p_next, symbol_count, decode_table))
+        {
+            return HUFF_BUFFER_ERROR;
+        }
+        p_next += symbol_count * BLOCK_SYMBOL_SIZE;
+        *p_table_valid = TRUE;
+    }
+    else if (type == BLOCK_TYPE_REPEAT && !*p_table_valid)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    if (type == BLOCK_TYPE_STORED)
+    {
+        memcpy(p_dst, p_next, raw_length);
+    }
+    else if (raw_length > 0)
+    {
+        decode_state_init(&state, p_next, code_length, 0);
+        if (kernel_decode(decode_table, &state, p_dst, raw_length)
+                != raw_length)
+        {
+            return HUFF_BUFFER_ERROR;
+        }
+    }
+    p_next += code_length;
+
+    if (checksum_size > 0 && load_le(p_next, CHECKSUM_SIZE)
+            != crc32c_update(0, p_dst, raw_length))
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    return raw_length;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: build_codes
+ *  ------------------------------------------------------------------------ */
+static BOOL build_codes(unsigned char *p_symbols,
+                        unsigned long *p_counts,
+                        unsigned int symbol_count,
+                        CODE_TABLE *table)
+{
+    BUFFER_TREE tree;
+    unsigned short heap[256];
+    unsigned int heap_count = 0;
+    unsigned int node = 0;
+    unsigned int i, side;
+    unsigned short child;
+    CODE_ENTRY *p_entry;
+
+    for (i = 0; i < symbol_count; i++)
+    {
+        tree.counts[i] = p_counts[i];
+        heap_push(heap, &heap_count, tree.counts, (unsigned short) i);
+    }
+
+    /* Die beiden kleinsten Teilbaeume werden links und rechts vereint. */
+    for (node = symbol_count; heap_count > 1; node++)
+    {
+        tree.children[node][0] = heap_pop(heap, &heap_count, tree.counts);
+        tree.children[node][1] = heap_pop(heap, &heap_count, tree.counts);
+        tree.counts[node] = tree.counts[tree.children[node][0]]
+                            + tree.counts[tree.children[node][1]];
+        heap_push(heap, &heap_count, tree.counts, (unsigned short) node);
+    }
+
+    /*
+     * Die Wurzel ist der zuletzt erzeugte Knoten. Jeder innere Knoten steht
+     * hinter seinen Nachfolgern, die Codes werden also von hinten nach vorne
+     * weitergegeben: links eine 0, rechts eine 1.
+     */
+    tree.bits[node - 1] = 0;
+    tree.lengths[node - 1] = 0;
+    for (i = node - 1; i >= symbol_count && i < node; i--)
+    {
+        for (side = 0; side < 2; side++)
+        {
+            child = tree.children[i][side];
+            tree.bits[child] = (tree.bits[i] << 1) | side;
+            tree.lengths[child] = tree.lengths[i] + 1;
+        }
+    }
+
+    memset(table, 0, sizeof(CODE_TABLE));
+    for (i = 0; i < symbol_count; i++)
+    {
+        p_entry = &table->entries[p_symbols[i]];
+        p_entry->bits = tree.bits[i];
+        p_entry->length = tree.lengths[i];
+        if (p_entry->length > table->max_length)
+        {
+            table->max_length = p_entry->length;
+        }
+    }
+
+    return (table->max_length <= KERNEL_MAX_CODE_LENGTH) ? TRUE : FALSE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: heap_push
+ *  ------------------------------------------------------------------------ */
+static void heap_push(unsigned short *p_heap,
+                      unsigned int *p_count,
+                      unsigned long *p_counts,
+                      unsigned short node)
+{
+    unsigned int current = (*p_count)++;
+    unsigned int parent;
+
+    /*
+     * Wie in heap_insert wandert der Knoten nach oben, solange er echt
+     * kleiner als sein Vorgaenger ist.
+     */
+    p_heap[current] = node;
+    while (current > 0)
+    {
+        parent = (current + 1) / 2 - 1;
+        if (p_counts[p_heap[current]] >= p_counts[p_heap[parent]])
+        {
+            break;
+        }
+        p_heap[current] = p_heap[parent];
+        p_heap[parent] = node;
+        current = parent;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: heap_pop
+ *  ------------------------------------------------------------------------ */
+static unsigned short heap_pop(unsigned short *p_heap,
+                               unsigned int *p_count,
+                               unsigned long *p_counts)
+{
+    unsigned short minimum = p_heap[0];
+    unsigned short swap;
+    unsigned int current = 1, smallest;
+
+    p_heap[0] = p_heap[*p_count - 1];
+    p_heap[*p_count - 1] = minimum;
+    (*p_count)--;
+
+    while (current * 2 <= *p_count)
+    {
+        smallest = current * 2;
+        if (smallest + 1 <= *p_count
+                && p_counts[p_heap[smallest]] < p_counts[p_heap[smallest - 1]])
+        {
+            smallest++;
+        }
+        if (p_counts[p_heap[current - 1]] <= p_counts[p_heap[smallest - 1]])
+        {
+            break;
+        }
+        swap = p_heap[current - 1];
+        p_heap[current - 1] = p_heap[smallest - 1];
+        p_heap[smallest - 1] = swap;
+        current = smallest;
+    }
+
+    return minimum;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: encode_payload
+ *  ------------------------------------------------------------------------ */
+static void encode_payload(CODE_TABLE *table,
+                           unsigned char *p_src,
+                           unsigned long src_len,
+                           unsigned char *p_dst,
+                           unsigned long code_length)
+{
+    unsigned char scratch[BUFFER_SCRATCH_SIZE];
+    unsigned long position, chunk, length;
+    unsigned long written = 0;
+    ENCODE_STATE state;
+
+    encode_state_init(&state);
+    for (position = 0; position < src_len; position += chunk)
+    {
+        chunk = (src_len - position < BUFFER_CHUNK_SIZE)
+                ? src_len - position : BUFFER_CHUNK_SIZE;
+
+        /*
+         * Der Kernel schreibt bis zu KERNEL_OUTPUT_SLACK Byte hinter die
+         * kodierten Bytes, die folgende Aufrufe wieder ueberschreiben.
+         */
+        if (code_length - written
+                >= chunk * table->max_length / 8 + KERNEL_OUTPUT_SLACK)
+        {
+            written += kernel_encode(table, &state, p_src + position, chunk,
+                                     p_dst + written);
+        }
+        else
+        {
+            length = kernel_encode(table, &state, p_src + position, chunk,
+                                   scratch);
+            memcpy(p_dst + written, scratch, length);
+            written += length;
+        }
+    }
+    encode_state_flush(&state, p_dst + written);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: read_symbol_table
+ *  ------------------------------------------------------------------------ */
+static BOOL read_symbol_table(unsigned char *p_table,
+                              unsigned int symbol_count,
+                              DECODE_TABLE *decode_table)
+{
+    unsigned char symbols[256];
+    unsigned long counts[256];
+    BOOL seen[256];
+    CODE_TABLE code_table;
+    unsigned int i;
+
+    /* Doppelte Zeichen ergaeben keinen vollstaendigen Code. */
+    memset(seen, 0, sizeof(seen));
+    for (i = 0; i < symbol_count; i++)
+    {
+        symbols[i] = p_table[0];
+        counts[i] = load_le(p_table + 1, 8);
+        if (seen[symbols[i]])
+        {
+            return FALSE;
+        }
+        seen[symbols[i]] = TRUE;
+        p_table += BLOCK_SYMBOL_SIZE;
+    }
+
+    if (!build_codes(symbols, counts, symbol_count, &code_table))
+    {
+        return FALSE;
+    }
+    decode_table_from_codes(decode_table, &code_table, symbols[0]);
+
+    return TRUE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: get_code_length
+ *  ------------------------------------------------------------------------ */
+static unsigned long get_code_length(CODE_TABLE *table,
+                                     unsigned char *p_src,
+                                     unsigned long src_len)
+{
+    unsigned long bits = 0;
+    unsigned long i;
+
+    for (i = 0; i < src_len; i++)
+    {
+        bits += table->entries[p_src[i]].length;
+    }
+
+    return (bits + 7) / 8;
+}
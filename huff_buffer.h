@@ -0,0 +1,221 @@
+/**
+ * File: huff_buffer.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HUFF_BUFFER_H
+
+#define	HUFF_BUFFER_H
+
+#include "common.h"
+#include "codec_kernels.h"
+
+/** Rueckgabe der Pufferfunktionen bei einem Fehler. */
+#define HUFF_BUFFER_ERROR ((unsigned long) -1)
+
+/**
+ * Waehlt einmalig je Prozess die Kernel und erzeugt die Tabellen der
+ * Pruefsumme. Muss vor dem ersten Aufruf der Pufferfunktionen aufgerufen
+ * werden, danach lesen diese nur noch und koennen gleichzeitig aus mehreren
+ * Threads verwendet werden.
+ */
+extern void huff_buffer_init(void);
+
+/**
+ * Liefert die maximale Groesse, die huff_compress_buffer fuer eine Eingabe
+ * der Laenge src_len schreibt.
+ * 
+ * @param src_len Laenge der Eingabe in Byte
+ * @return Benoetigte Groesse des Ausgabepuffers in Byte
+ */
+extern unsigned long huff_compress_bound(unsigned long src_len);
+
+/**
+ * Komprimiert einen Puffer in einen Container mit einem Block, wie ihn
+ * compress ohne Optionen schreibt. Die Funktion oeffnet keine Dateien,
+ * allokiert keinen Speicher und verwendet keinen globalen Zustand; Baum,
+ * Code- und Dekodiertabelle liegen auf dem Stack.
+ * 
+ * @param p_src Eingabe
+ * @param src_len Laenge der Eingabe in Byte
+ * @param p_dst Ausgabepuffer
+ * @param dst_cap Groesse des Ausgabepuffers, huff_compress_bound(src_len)
+ *        reicht immer aus
+ * @return Anzahl geschriebener Bytes oder HUFF_BUFFER_ERROR wenn der
+ *         Ausgabepuffer zu klein ist
+ */
+extern unsigned long huff_compress_buffer(unsigned char *p_src,
+                                          unsigned long src_len,
+                                          unsigned char *p_dst,
+                                          unsigned long dst_cap);
+
+/**
+ * Liest die Anzahl Zeichen aus dem Containerheader eines komprimierten
+ * Puffers. Bei einem Stream werden dazu die Blockheader gelesen.
+ * 
+ * @param p_src Komprimierter Puffer
+ * @param src_len Laenge des komprimierten Puffers in Byte
+ * @return Anzahl Zeichen oder HUFF_BUFFER_ERROR wenn kein Container vorliegt
+ */
+extern unsigned long huff_decompressed_size(unsigned char *p_src,
+                                            unsigned long src_len);
+
+/**
+ * Dekomprimiert einen Container aus einem Puffer. Unterstuetzt werden
+ * Bloecke vom Typ BLOCK_TYPE_HUFFMAN, BLOCK_TYPE_STORED und
+ * BLOCK_TYPE_REPEAT, also alle Dateien die compress ohne --context, --wide,
+ * --rle und ohne Archiv schreibt, sowie Streams von huff_stream. Pruefsummen
+ * werden geprueft, ein Seek-Index wird ignoriert.
+ * 
+ * @param p_src Komprimierter Puffer
+ * @param src_len Laenge des komprimierten Puffers in Byte
+ * @param p_dst Ausgabepuffer
+ * @param dst_cap Groesse des Ausgabepuffers in Byte
+ * @return Anzahl dekomprimierter Zeichen oder HUFF_BUFFER_ERROR wenn die
+ *         Eingabe fehlerhaft oder nicht unterstuetzt ist oder der
+ *         Ausgabepuffer zu klein ist
+ */
+extern unsigned long huff_decompress_buffer(unsigned char *p_src,
+                                            unsigned long src_len,
+                                            unsigned char *p_dst,
+                                            unsigned long dst_cap);
+
+/**
+ * Schreibt einen Containerheader der aktuellen Version mit
+ * CONTAINER_HEADER_SIZE Byte: Kennung, Version, Flags, reservierte Bytes,
+ * Anzahl der Zeichen und Blockgroesse.
+ * 
+ * @param p_dst Ausgabepuffer mit mindestens CONTAINER_HEADER_SIZE Byte
+ * @param flags CONTAINER_FLAG_* des Containers
+ * @param length Anzahl der Zeichen im Container
+ * @param block_size Blockgroesse in Byte, 0 bei nur einem Block
+ */
+extern void store_container_header(unsigned char *p_dst,
+                                   unsigned int flags,
+                                   unsigned long length,
+                                   unsigned long block_size);
+
+/**
+ * Kodiert einen Puffer als einzelnen Block ohne Containerheader, als
+ * Huffman-Block oder, wenn dieser nicht kleiner ist, als gespeicherter
+ * Block. Eine leere Eingabe ergibt einen leeren Huffman-Block.
+ * 
+ * @param p_src Eingabe
+ * @param src_len Laenge der Eingabe in Byte
+ * @param p_dst Ausgabepuffer
+ * @param dst_cap Groesse des Ausgabepuffers, BLOCK_HEADER_SIZE + src_len
+ *        + CHECKSUM_SIZE reicht immer aus
+ * @param checksum TRUE um die CRC32C hinter den Block zu schreiben
+ * @return Laenge des Blocks oder HUFF_BUFFER_ERROR wenn der Ausgabepuffer zu
+ *         klein ist
+ */
+extern unsigned long huff_encode_block(unsigned char *p_src,
+                                       unsigned long src_len,
+                                       unsigned char *p_dst,
+                                       unsigned long dst_cap,
+                                       BOOL checksum);
+
+/**
+ * Schreibt einen Huffman-Block ohne Zeichen, der nur die Symboltabelle zu
+ * den uebergebenen Haeufigkeiten enthaelt, und erzeugt die zugehoerige
+ * Codetabelle. Folgende BLOCK_TYPE_REPEAT Bloecke verwenden diese Tabelle.
+ * Kommt kein Zeichen vor oder waeren Codes fuer die Kernel zu lang, bleibt
+ * die Symboltabelle leer und die Codetabelle ungueltig.
+ * 
+ * @param p_counts Haeufigkeit je Zeichen (256 Eintraege)
+ * @param p_dst Ausgabepuffer
+ * @param dst_cap Groesse des Ausgabepuffers, BLOCK_HEADER_SIZE
+ *        + 256 * BLOCK_SYMBOL_SIZE reicht immer aus
+ * @param table Zu fuellende Codetabelle
+ * @param p_table_valid Wird TRUE wenn die Codetabelle verwendet werden kann
+ * @return Laenge des Blocks oder HUFF_BUFFER_ERROR wenn der Ausgabepuffer zu
+ *         klein ist
+ */
+extern unsigned long huff_encode_table_block(unsigned long *p_counts,
+                                             unsigned char *p_dst,
+                                             unsigned long dst_cap,
+                                             CODE_TABLE *table,
+                                             BOOL *p_table_valid);
+
+/**
+ * Berechnet die Laenge des Blocks, den huff_encode_repeat_block fuer die
+ * Eingabe schreibt.
+ * 
+ * @param table Codetabelle von huff_encode_table_block
+ * @param table_valid TRUE wenn die Codetabelle verwendet werden kann
+ * @param p_src Eingabe, jedes Zeichen muss in der Codetabelle vorkommen
+ * @param src_len Laenge der Eingabe in Byte
+ * @return Laenge des Blocks in Byte
+ */
+extern unsigned long huff_repeat_block_size(CODE_TABLE *table,
+                                            BOOL table_valid,
+                                            unsigned char *p_src,
+                                            unsigned long src_len);
+
+/**
+ * Kodiert einen Puffer als einzelnen Block mit einer vorhandenen
+ * Codetabelle, als BLOCK_TYPE_REPEAT oder, wenn dieser nicht kleiner ist,
+ * als gespeicherter Block.
+ * 
+ * @param table Codetabelle von huff_encode_table_block
+ * @param table_valid TRUE wenn die Codetabelle verwendet werden kann
+ * @param p_src Eingabe, jedes Zeichen muss in der Codetabelle vorkommen
+ * @param src_len Laenge der Eingabe in Byte
+ * @param p_dst Ausgabepuffer
+ * @param dst_cap Groesse des Ausgabepuffers, huff_repeat_block_size reicht
+ *        immer aus
+ * @return Laenge des Blocks oder HUFF_BUFFER_ERROR wenn der Ausgabepuffer zu
+ *         klein ist
+ */
+extern unsigned long huff_encode_repeat_block(CODE_TABLE *table,
+                                              BOOL table_valid,
+                                              unsigned char *p_src,
+                                              unsigned long src_len,
+                                              unsigned char *p_dst,
+                                              unsigned long dst_cap);
+
+/**
+ * Prueft einen Blockheader und berechnet die Laenge des ganzen Blocks.
+ * 
+ * @param p_header Blockheader (BLOCK_HEADER_SIZE Byte)
+ * @param checksum_size Laenge der Pruefsumme hinter jedem Block
+ * @return Laenge des Blocks mit Header und Pruefsumme oder HUFF_BUFFER_ERROR
+ *         wenn der Header fehlerhaft oder der Blocktyp nicht unterstuetzt ist
+ */
+extern unsigned long huff_block_size(unsigned char *p_header,
+                                     unsigned long checksum_size);
+
+/**
+ * Dekodiert einen vollstaendigen Block, dessen Header huff_block_size
+ * bereits geprueft hat. Die Dekodiertabelle des letzten Huffman-Blocks wird
+ * fuer folgende BLOCK_TYPE_REPEAT Bloecke aufgehoben.
+ * 
+ * @param p_block Block ab dem Header
+ * @param checksum_size Laenge der Pruefsumme hinter jedem Block
+ * @param decode_table Dekodiertabelle des letzten Huffman-Blocks
+ * @param p_table_valid TRUE wenn decode_table gefuellt ist
+ * @param p_dst Ausgabepuffer
+ * @param dst_cap Groesse des Ausgabepuffers in Byte
+ * @return Anzahl dekodierter Zeichen oder HUFF_BUFFER_ERROR
+ */
+extern unsigned long huff_decode_block(unsigned char *p_block,
+                                       unsigned long checksum_size,
+                                       DECODE_TABLE *decode_table,
+                                       BOOL *p_table_valid,
+                                       unsigned char *p_dst,
+                                       unsigned long dst_cap);
+
+#endif	/* HUFF_BUFFER_H */
@@ -0,0 +1,117 @@
+/**
+ * File: huff_ctx.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "huff_ctx.h"
+#include "async_io.h"
+
+/**
+ * Diese Funktion setzt den Zustand eines Auftrags zurueck: Header,
+ * Lesezustand und Schaetzung. Die Optionen bleiben erhalten, die
+ * Symboltabelle wird freigegeben und eine Arena gibt ihren Speicher auf
+ * einmal frei. Viele kleine Nachrichten mit erhaltenen Puffern bearbeiten
+ * huff_stream_reset, huff_buffer und huff_dict.
+ * 
+ * @param ctx Kontext
+ */
+static void huff_ctx_reset(HUFF_CTX *ctx);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_ctx_init
+ *  ------------------------------------------------------------------------ */
+extern void huff_ctx_init(HUFF_CTX *ctx)
+{
+    memset(ctx, 0, sizeof(HUFF_CTX));
+
+    ctx->decoder_type = DECODER_TABLE;
+    ctx->thread_count = 1;
+    ctx->io_backend = IO_BACKEND_SYNC;
+    ctx->io_depth = IO_DEFAULT_DEPTH;
+    ctx->sample_percent = 100;
+    allocator_init(&ctx->allocator);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_ctx_destroy
+ *  ------------------------------------------------------------------------ */
+extern void huff_ctx_destroy(HUFF_CTX *ctx)
+{
+    free(ctx->member_filenames);
+    ctx->member_filenames = NULL;
+    ctx->member_count = 0;
+    allocator_destroy(&ctx->allocator);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_ctx_init_from
+ *  ------------------------------------------------------------------------ */
+extern void huff_ctx_init_from(HUFF_CTX *ctx, HUFF_CTX *options)
+{
+    memcpy(ctx, options, sizeof(HUFF_CTX));
+    ctx->member_filenames = NULL;
+    ctx->member_count = 0;
+    ctx->p_symbol_start = NULL;
+    
+    /* Hooks werden geteilt, die Bloecke einer Arena gehoeren einem Kontext. */
+    if (allocator_is_arena(&options->allocator))
+    {
+        allocator_init_arena(&ctx->allocator, options->allocator.chunk_size);
+    }
+    
+    huff_ctx_reset(ctx);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_ctx_reset
+ *  ------------------------------------------------------------------------ */
+static void huff_ctx_reset(HUFF_CTX *ctx)
+{
+    allocator_free(&ctx->allocator, ctx->p_symbol_start);
+    ctx->p_symbol_start = NULL;
+    ctx->p_symbol = NULL;
+    ctx->symbol_count = 0;
+    
+    ctx->read_char_count = 0;
+    memset(&ctx->read_block, 0, sizeof(BLOCK_HEADER));
+    ctx->read_block_size = 0;
+    ctx->read_flags = 0;
+    ctx->legacy_format = FALSE;
+    ctx->legacy_tree_order = FALSE;
+    ctx->container_start = 0;
+    
+    /* Der dekomprimierte Text gehoert dem Auftrag, nicht dem Kontext. */
+    ctx->p_decompressed_text = NULL;
+    ctx->p_decompressed_text_start = NULL;
+    ctx->read_bit_buffer = 0;
+    ctx->bit_buffer_index = 0;
+    
+    ctx->verified_checksums = 0;
+    ctx->estimated_header_size = 0;
+    ctx->estimated_payload_size = 0;
+    ctx->sampled_char_count = 0;
+    
+    ctx->shared_table_written = FALSE;
+    memset(ctx->shared_symbols, 0, sizeof(ctx->shared_symbols));
+    ctx->shared_table_start = 0;
+    ctx->shared_symbol_count = 0;
+    ctx->shared_decode_valid = FALSE;
+    
+    allocator_release(&ctx->allocator);
+}
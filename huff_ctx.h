@@ -0,0 +1,320 @@
+/**
+ * File: huff_ctx.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HUFF_CTX_H
+
+#define	HUFF_CTX_H
+
+#include "common.h"
+#include "huffman.h"
+#include "codec_kernels.h"
+#include "huff_dict.h"
+#include "allocator.h"
+
+/**
+ * Struktur des Codec-Kontexts. Enthaelt die Optionen eines Aufrufs und den
+ * gesamten Zustand, den Kompression und Dekompression zwischen den
+ * Funktionen weitergeben. Jeder Aufruf arbeitet nur auf seinem Kontext,
+ * mehrere Kontexte koennen gleichzeitig in verschiedenen Threads verwendet
+ * werden.
+ */
+struct _HUFF_CTX
+{
+    /**
+     * Kompressionsmodus
+     */
+    BOOL compress_mode;
+    /**
+     * Benchmark der Dekodierer statt Dekompression
+     */
+    BOOL benchmark_mode;
+    /**
+     * Benchmark der Kosten je Nachricht statt der Dekodierer
+     */
+    BOOL message_benchmark_mode;
+    /**
+     * Benchmark der Ein- und Ausgabe statt der Dekodierer
+     */
+    BOOL io_benchmark_mode;
+    /**
+     * Erstellen eines Woerterbuchs aus einem Beispielkorpus
+     */
+    BOOL train_mode;
+    /**
+     * Woerterbuch fuer Nachrichten ohne Header (NULL = kein Woerterbuch)
+     */
+    char *dictionary_filename;
+    /**
+     * Fuer die Dekompression verwendeter Dekodierer
+     */
+    DECODER_TYPE decoder_type;
+    /**
+     * Dekompression direkt in die in den Speicher abgebildete Ausgabedatei
+     */
+    BOOL mmap_mode;
+    /**
+     * Anzahl Threads fuer die Dekompression
+     */
+    unsigned long thread_count;
+    /**
+     * Anzahl Threads fuer mehrere Eingabedateien (0 = nur eine Datei)
+     */
+    unsigned long job_count;
+    /**
+     * Verfahren fuer das Lesen und Schreiben grosser Dateien (IO_BACKEND_*)
+     */
+    unsigned int io_backend;
+    /**
+     * Anzahl gleichzeitiger Anfragen je Datei
+     */
+    unsigned long io_depth;
+    /**
+     * Gelesene und geschriebene Seiten aus dem Seitencache verwerfen
+     */
+    BOOL no_cache_mode;
+    /**
+     * Speichergrenze in KB (0 = unbegrenzt)
+     */
+    unsigned long mem_limit;
+    /**
+     * Speicheranteil eines Aufrufs fuer Puffer in Byte (0 = unbegrenzt)
+     */
+    unsigned long mem_available;
+    /**
+     * Debug Ausgaben
+     */
+    BOOL debug_mode;
+    /**
+     * Intervall des Seek-Index in KB (0 = kein Seek-Index schreiben)
+     */
+    unsigned long seek_index_interval;
+    /**
+     * Blockgroesse in KB (0 = die gesamte Datei in einem Block)
+     */
+    unsigned long block_size;
+    /**
+     * Bloecke zusaetzlich mit einem Kontextmodell erster Ordnung kodieren
+     */
+    BOOL context_mode;
+    /**
+     * Bloecke zusaetzlich mit einem Alphabet aus 16-Bit-Zeichen kodieren
+     */
+    BOOL wide_mode;
+    /**
+     * Bloecke zusaetzlich mit Laufzeichen fuer lange Wiederholungen kodieren
+     */
+    BOOL rle_mode;
+    /**
+     * Pruefsumme je Block schreiben
+     */
+    BOOL checksum_mode;
+    /**
+     * Dekodieren und Pruefsummen pruefen, ohne eine Ausgabe zu schreiben
+     */
+    BOOL test_mode;
+    /**
+     * Archiv aus mehreren Dateien erstellen
+     */
+    BOOL archive_mode;
+    /**
+     * Mitglieder eines Archivs entpacken
+     */
+    BOOL extract_mode;
+    /**
+     * Verzeichnis eines Archivs ausgeben
+     */
+    BOOL list_mode;
+    /**
+     * Gemeinsame Codetabelle fuer alle Mitglieder eines Archivs schreiben
+     */
+    BOOL shared_mode;
+    /**
+     * Zu packende oder zu entpackende Mitglieder eines Archivs
+     */
+    char **member_filenames;
+    /**
+     * Anzahl der Eintraege in member_filenames
+     */
+    unsigned long member_count;
+    /**
+     * Nur die Groesse der komprimierten Datei berechnen, ohne sie zu schreiben
+     */
+    BOOL estimate_mode;
+    /**
+     * Anteil der Eingabe in Prozent, aus dem --estimate hochrechnet
+     */
+    unsigned long sample_percent;
+    /**
+     * Dekomprimierung nur eines Teilbereichs
+     */
+    BOOL range_mode;
+    /**
+     * Position des ersten zu dekomprimierenden Zeichens im Teilbereich
+     */
+    unsigned long range_start;
+    /**
+     * Anzahl der zu dekomprimierenden Zeichen im Teilbereich
+     */
+    unsigned long range_length;
+    /**
+     * Zeiger auf den Startpunkt des Speicherbereichs der symbol_map
+     */
+    SYMBOL *p_symbol_start;
+    /**
+     * Zeiger fuer das Durchlaufen des Speicherbereichs der symbol_map
+     */
+    SYMBOL *p_symbol;
+    /**
+     * Anzahl der Symbole in der symbol_map
+     */
+    unsigned int symbol_count;
+    /**
+     * Anzahl eingelesener Zeichen
+     */
+    unsigned long read_char_count;
+    /**
+     * Header des zuletzt gelesenen Blocks (nicht im Altformat)
+     */
+    BLOCK_HEADER read_block;
+    /**
+     * Blockgroesse des gelesenen Containers, 0 bei nur einem Block
+     */
+    unsigned long read_block_size;
+    /**
+     * Flags des gelesenen Containers
+     */
+    unsigned int read_flags;
+    /**
+     * Die gelesene Datei hat das Altformat ohne Containerheader
+     */
+    BOOL legacy_format;
+    /**
+     * Die Baeume der gelesenen Datei bzw. des Woerterbuchs wurden mit der
+     * Heapreihenfolge vor CONTAINER_VERSION_HEAP_ORDER aufgebaut
+     */
+    BOOL legacy_tree_order;
+    /**
+     * Zeiger fuer den dekomprimierten Text
+     */
+    unsigned char *p_decompressed_text;
+    /**
+     * Zeiger fuer den Startpunkt des dekomprimierten Text
+     */
+    unsigned char *p_decompressed_text_start;
+    /**
+     * Buffer fuer das eingelesene Bit
+     */
+    unsigned char read_bit_buffer;
+    /**
+     * Index des Bit Buffers
+     */
+    unsigned int bit_buffer_index;
+    /**
+     * Geladenes Woerterbuch
+     */
+    HUFF_DICT dictionary;
+    /**
+     * Das Woerterbuch wurde bereits geladen
+     */
+    BOOL dictionary_loaded;
+    /**
+     * Anzahl der bei der Dekomprimierung geprueften Pruefsummen
+     */
+    unsigned long verified_checksums;
+    /**
+     * Von --estimate gezaehlte Bytes der Header, Tabellen und Pruefsummen
+     */
+    unsigned long estimated_header_size;
+    /**
+     * Von --estimate gezaehlte Bytes des Huffman-Codes und gespeicherter Daten
+     */
+    unsigned long estimated_payload_size;
+    /**
+     * Anzahl der von --estimate ausgewerteten Zeichen
+     */
+    unsigned long sampled_char_count;
+    /**
+     * Dateiposition des gelesenen Containers, in Archiven hinter dem Anfang
+     */
+    long container_start;
+    /**
+     * Gemeinsame Codetabelle der Mitglieder beim Packen eines Archivs
+     */
+    CODE_TABLE shared_code_table;
+    /**
+     * TRUE je Zeichen mit einem Code in der gemeinsamen Codetabelle
+     */
+    BOOL shared_symbols[256];
+    /**
+     * Die gemeinsame Codetabelle steht im Archiv und wird verwendet
+     */
+    BOOL shared_table_written;
+    /**
+     * Dateiposition der gemeinsamen Symboltabelle beim Entpacken
+     */
+    long shared_table_start;
+    /**
+     * Anzahl Symbole der gemeinsamen Symboltabelle beim Entpacken (0 = keine)
+     */
+    unsigned int shared_symbol_count;
+    /**
+     * Dekodiertabelle der gemeinsamen Codetabelle, einmal je Archiv aufgebaut
+     */
+    DECODE_TABLE shared_decode_table;
+    /**
+     * shared_decode_table wurde bereits aufgebaut
+     */
+    BOOL shared_decode_valid;
+    /**
+     * Allokator fuer Baeume, Heaps, Codes, Bitpuffer, Symboltabellen und
+     * die Zaehler, Tabellen und Dekodierer eines Blocks. Standard ist
+     * malloc und free, mit allocator_init_hooks werden eigene Funktionen,
+     * mit allocator_init_arena eine Arena verwendet. Ein- und Ausgabepuffer,
+     * Nutzdaten und der dekomprimierte Text bleiben bei malloc, sie sind
+     * gross, wachsen ueber viele Bloecke oder gehen an den Aufrufer.
+     */
+    ALLOCATOR allocator;
+};
+
+/**
+ * Initialisiert einen Kontext mit den Standardwerten aller Optionen.
+ * 
+ * @param ctx Zu initialisierender Kontext
+ */
+extern void huff_ctx_init(HUFF_CTX *ctx);
+
+/**
+ * Gibt den vom Kontext verwalteten Speicher samt der Bloecke einer Arena
+ * wieder frei. Der Kontext selbst gehoert dem Aufrufer.
+ * 
+ * @param ctx Kontext
+ */
+extern void huff_ctx_destroy(HUFF_CTX *ctx);
+
+/**
+ * Initialisiert einen Kontext mit den Optionen eines anderen, etwa fuer
+ * einen Auftrag je Thread. Der Zustand eines Auftrags und die Mitglieder
+ * eines Archivs werden nicht uebernommen, eine Arena wird fuer den neuen
+ * Kontext mit derselben Blockgroesse neu angelegt.
+ * 
+ * @param ctx Zu initialisierender Kontext
+ * @param options Kontext mit den Optionen
+ */
+extern void huff_ctx_init_from(HUFF_CTX *ctx, HUFF_CTX *options);
+
+#endif	/* HUFF_CTX_H */
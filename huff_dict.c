@@ -0,0 +1,363 @@
+/**
+ * File: huff_dict.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "common.h"
+#include "huffman.h"
+#include "binary_heap.h"
+#include "byte_order.h"
+#include "checksum.h"
+#include "codec_kernels.h"
+#include "huff_buffer.h"
+#include "huff_dict.h"
+
+/** Maximale Anzahl Knoten eines Huffman-Baums mit 256 Blaettern. */
+#define DICT_MAX_NODES 511
+
+/**
+ * Diese Funktion baut aus der Symboltabelle des Woerterbuchs den
+ * Huffman-Baum mit dem BINARY_HEAP wie create_huffman_tree auf und erzeugt
+ * daraus die Codetabelle. So entstehen dieselben Codes wie beim Training.
+ *
+ * @param p_table Symboltabelle im Format BLOCK_SYMBOL_SIZE
+ * @param symbol_count Anzahl der Symbole (1 - 256)
+ * @param legacy_order TRUE fuer Woerterbuecher vor
+ *        DICTIONARY_VERSION_HEAP_ORDER
+ * @param table Zu fuellende Codetabelle
+ * @return FALSE bei doppelten Zeichen oder zu langen Codes
+ */
+static BOOL build_codes(unsigned char *p_table,
+                        unsigned int symbol_count,
+                        BOOL legacy_order,
+                        CODE_TABLE *table);
+
+/**
+ * Diese Funktion liefert die Haeufigkeit eines Knotens fuer den Heap.
+ *
+ * @param p_count Haeufigkeit des Knotens
+ * @return Haeufigkeit
+ */
+static unsigned long get_node_count(void *p_count);
+
+/**
+ * Diese Funktion prueft die Kennung einer Nachricht und liest die Anzahl
+ * der Zeichen.
+ *
+ * @param dict Woerterbuch
+ * @param p_src Kodierte Nachricht
+ * @param src_len Laenge der kodierten Nachricht in Byte
+ * @param p_position Position des Huffman-Codes
+ * @return Anzahl Zeichen oder HUFF_BUFFER_ERROR
+ */
+static unsigned long read_prefix(HUFF_DICT *dict,
+                                 unsigned char *p_src,
+                                 unsigned long src_len,
+                                 unsigned long *p_position);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_dict_init
+ *  ------------------------------------------------------------------------ */
+extern BOOL huff_dict_init(HUFF_DICT *dict,
+                           unsigned char *p_src,
+                           unsigned long src_len)
+{
+    unsigned int version;
+    unsigned int symbol_count;
+    unsigned long header_size;
+
+    if (src_len < DICTIONARY_LEGACY_HEADER_SIZE
+            || memcmp(p_src, DICTIONARY_MAGIC, 4) != 0
+            || p_src[4] > DICTIONARY_VERSION)
+    {
+        return FALSE;
+    }
+    version = p_src[4];
+    header_size = (version >= DICTIONARY_VERSION_ID)
+                  ? DICTIONARY_HEADER_SIZE : DICTIONARY_LEGACY_HEADER_SIZE;
+    symbol_count = (unsigned int) load_le(p_src + 6, 2);
+    if (symbol_count == 0 || symbol_count > 256
+            || src_len < header_size + symbol_count * BLOCK_SYMBOL_SIZE)
+    {
+        return FALSE;
+    }
+
+    if (!build_codes(p_src + header_size, symbol_count,
+                     (version < DICTIONARY_VERSION_HEAP_ORDER) ? TRUE : FALSE,
+                     &dict->code_table))
+    {
+        return FALSE;
+    }
+    decode_table_from_codes(&dict->decode_table, &dict->code_table,
+                            p_src[header_size]);
+
+    /* Eine gespeicherte Kennung muss zu den aufgebauten Codes passen. */
+    dict->id = huff_dict_code_id(&dict->code_table);
+    dict->tagged = (version >= DICTIONARY_VERSION_ID) ? TRUE : FALSE;
+    if (dict->tagged && load_le(p_src + 8, DICTIONARY_ID_SIZE) != dict->id)
+    {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_dict_code_id
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_dict_code_id(CODE_TABLE *table)
+{
+    unsigned char entry[9];
+    unsigned long crc = 0;
+    unsigned int i;
+
+    for (i = 0; i < 256; i++)
+    {
+        entry[0] = (unsigned char) table->entries[i].length;
+        store_le(entry + 1, table->entries[i].bits, 8);
+        crc = crc32c_update(crc, entry, sizeof(entry));
+    }
+
+    return crc;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_dict_compress_bound
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_dict_compress_bound(HUFF_DICT *dict,
+                                              unsigned long src_len)
+{
+    return ((dict->tagged) ? DICTIONARY_ID_SIZE : 0) + MESSAGE_LENGTH_MAX_SIZE
+           + src_len / 8 * dict->code_table.max_length
+           + dict->code_table.max_length + KERNEL_OUTPUT_SLACK;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_dict_compress
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_dict_compress(HUFF_DICT *dict,
+                                        unsigned char *p_src,
+                                        unsigned long src_len,
+                                        unsigned char *p_dst,
+                                        unsigned long dst_cap)
+{
+    ENCODE_STATE encode_state;
+    unsigned long dst_len = 0;
+    unsigned long value = src_len;
+
+    if (dst_cap < huff_dict_compress_bound(dict, src_len))
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    if (dict->tagged)
+    {
+        store_le(p_dst, dict->id, DICTIONARY_ID_SIZE);
+        dst_len = DICTIONARY_ID_SIZE;
+    }
+
+    /*
+     * Vor dem Huffman-Code steht nur die Anzahl der Zeichen, 7 Bit je Byte
+     * mit gesetztem hoechsten Bit fuer jedes weitere Byte.
+     */
+    while (value >= 0x80)
+    {
+        p_dst[dst_len++] = (unsigned char) (value | 0x80);
+        value >>= 7;
+    }
+    p_dst[dst_len++] = (unsigned char) value;
+
+    encode_state_init(&encode_state);
+    dst_len += kernel_encode(&dict->code_table, &encode_state, p_src, src_len,
+                             p_dst + dst_len);
+    dst_len += encode_state_flush(&encode_state, p_dst + dst_len);
+
+    return dst_len;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_dict_matches
+ *  ------------------------------------------------------------------------ */
+extern BOOL huff_dict_matches(HUFF_DICT *dict,
+                              unsigned char *p_src,
+                              unsigned long src_len)
+{
+    if (!dict->tagged)
+    {
+        return TRUE;
+    }
+
+    return (src_len >= DICTIONARY_ID_SIZE
+            && load_le(p_src, DICTIONARY_ID_SIZE) == dict->id) ? TRUE : FALSE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_dict_decompressed_size
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_dict_decompressed_size(HUFF_DICT *dict,
+                                                 unsigned char *p_src,
+                                                 unsigned long src_len)
+{
+    unsigned long position;
+
+    return read_prefix(dict, p_src, src_len, &position);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_dict_decompress
+ *  ------------------------------------------------------------------------ */
+extern unsigned long huff_dict_decompress(HUFF_DICT *dict,
+                                          unsigned char *p_src,
+                                          unsigned long src_len,
+                                          unsigned char *p_dst,
+                                          unsigned long dst_cap)
+{
+    DECODE_STATE decode_state;
+    unsigned long position;
+    unsigned long char_count = read_prefix(dict, p_src, src_len, &position);
+
+    if (char_count == HUFF_BUFFER_ERROR || char_count > dst_cap)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    decode_state_init(&decode_state, p_src + position, src_len - position, 0);
+    if (kernel_decode(&dict->decode_table, &decode_state, p_dst, char_count)
+            != char_count)
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+
+    return char_count;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: read_prefix
+ *  ------------------------------------------------------------------------ */
+static unsigned long read_prefix(HUFF_DICT *dict,
+                                 unsigned char *p_src,
+                                 unsigned long src_len,
+                                 unsigned long *p_position)
+{
+    unsigned long char_count = 0;
+    unsigned long position = 0;
+    unsigned int shift = 0;
+
+    if (!huff_dict_matches(dict, p_src, src_len))
+    {
+        return HUFF_BUFFER_ERROR;
+    }
+    if (dict->tagged)
+    {
+        position = DICTIONARY_ID_SIZE;
+    }
+
+    do
+    {
+        if (position >= src_len || shift >= sizeof(unsigned long) * 8)
+        {
+            return HUFF_BUFFER_ERROR;
+        }
+        char_count |= (unsigned long) (p_src[position] & 0x7f) << shift;
+        shift += 7;
+    }
+    while ((p_src[position++] & 0x80) != 0);
+
+    *p_position = position;
+    return char_count;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: build_codes
+ *  ------------------------------------------------------------------------ */
+static BOOL build_codes(unsigned char *p_table,
+                        unsigned int symbol_count,
+                        BOOL legacy_order,
+                        CODE_TABLE *table)
+{
+    unsigned long counts[DICT_MAX_NODES];
+    unsigned int children[DICT_MAX_NODES][2];
+    unsigned long bits[DICT_MAX_NODES];
+    unsigned int lengths[DICT_MAX_NODES];
+    BOOL seen[256];
+    unsigned long *p_first;
+    unsigned long *p_second;
+    unsigned int node, i, side;
+    CODE_ENTRY *p_entry;
+    BINARY_HEAP *p_heap = heap_init(NULL, get_node_count, NULL, NULL);
+
+    p_heap->legacy_order = legacy_order;
+    memset(seen, 0, sizeof(seen));
+    for (i = 0; i < symbol_count; i++)
+    {
+        if (seen[p_table[i * BLOCK_SYMBOL_SIZE]])
+        {
+            heap_destroy(p_heap);
+            return FALSE;
+        }
+        seen[p_table[i * BLOCK_SYMBOL_SIZE]] = TRUE;
+        counts[i] = load_le(p_table + i * BLOCK_SYMBOL_SIZE + 1, 8);
+        heap_insert(p_heap, counts + i);
+    }
+
+    /* Wie in create_huffman_tree wird der zuerst entnommene Baum links. */
+    for (node = symbol_count; p_heap->count > 1; node++)
+    {
+        heap_extract_min(p_heap, (void **) &p_first);
+        heap_extract_min(p_heap, (void **) &p_second);
+        children[node][0] = (unsigned int) (p_first - counts);
+        children[node][1] = (unsigned int) (p_second - counts);
+        counts[node] = *p_first + *p_second;
+        heap_insert(p_heap, counts + node);
+    }
+    heap_destroy(p_heap);
+
+    /* Jeder innere Knoten steht hinter seinen Nachfolgern. */
+    bits[node - 1] = 0;
+    lengths[node - 1] = 0;
+    for (i = node - 1; i >= symbol_count && i < node; i--)
+    {
+        for (side = 0; side < 2; side++)
+        {
+            bits[children[i][side]] = (bits[i] << 1) | side;
+            lengths[children[i][side]] = lengths[i] + 1;
+        }
+    }
+
+    memset(table, 0, sizeof(CODE_TABLE));
+    for (i = 0; i < symbol_count; i++)
+    {
+        p_entry = &table->entries[p_table[i * BLOCK_SYMBOL_SIZE]];
+        p_entry->bits = bits[i];
+        p_entry->length = lengths[i];
+        if (p_entry->length > table->max_length)
+        {
+            table->max_length = p_entry->length;
+        }
+    }
+
+    return (table->max_length <= KERNEL_MAX_CODE_LENGTH) ? TRUE : FALSE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: get_node_count
+ *  ------------------------------------------------------------------------ */
+static unsigned long get_node_count(void *p_count)
+{
+    return *(unsigned long *) p_count;
+}
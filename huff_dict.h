@@ -0,0 +1,157 @@
+/**
+ * File: huff_dict.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HUFF_DICT_H
+
+#define	HUFF_DICT_H
+
+#include "common.h"
+#include "codec_kernels.h"
+
+/** Groesse der Kennung des Woerterbuchs vor einer Nachricht in Byte. */
+#define DICTIONARY_ID_SIZE 4
+
+/** Maximale Anzahl Bytes der Zeichenanzahl vor einer Nachricht. */
+#define MESSAGE_LENGTH_MAX_SIZE 10
+
+/**
+ * Geladenes Woerterbuch. Die Tabellen werden einmal aufgebaut und danach
+ * fuer jede Nachricht nur gelesen, ein Woerterbuch kann also gleichzeitig
+ * aus mehreren Threads verwendet werden.
+ */
+typedef struct _HUFF_DICT
+{
+    /**
+     * Codetabelle fuer den Kodierer
+     */
+    CODE_TABLE code_table;
+    /**
+     * Dekodiertabelle fuer den Dekodierer
+     */
+    DECODE_TABLE decode_table;
+    /**
+     * Kennung: CRC32C der Codes aller Zeichen
+     */
+    unsigned long id;
+    /**
+     * TRUE wenn jede Nachricht mit der Kennung beginnt (ab
+     * DICTIONARY_VERSION_ID), aeltere Woerterbuecher schreiben Nachrichten
+     * ohne Kennung
+     */
+    BOOL tagged;
+} HUFF_DICT;
+
+/**
+ * Baut ein Woerterbuch aus dem Inhalt einer mit -train erstellten Datei
+ * auf. Bei Woerterbuechern mit Kennung wird diese mit den aufgebauten Codes
+ * verglichen. huff_buffer_init muss vorher aufgerufen worden sein.
+ *
+ * @param dict Zu fuellendes Woerterbuch
+ * @param p_src Inhalt der Woerterbuchdatei
+ * @param src_len Laenge in Byte
+ * @return FALSE wenn kein gueltiges Woerterbuch vorliegt
+ */
+extern BOOL huff_dict_init(HUFF_DICT *dict,
+                           unsigned char *p_src,
+                           unsigned long src_len);
+
+/**
+ * Berechnet die Kennung einer Codetabelle, wie sie -train in den Header des
+ * Woerterbuchs schreibt.
+ *
+ * @param table Codetabelle
+ * @return CRC32C ueber Laenge und Bits der Codes aller 256 Zeichen
+ */
+extern unsigned long huff_dict_code_id(CODE_TABLE *table);
+
+/**
+ * Liefert die Groesse des Ausgabepuffers, die huff_dict_compress fuer eine
+ * Nachricht der Laenge src_len benoetigt.
+ *
+ * @param dict Woerterbuch
+ * @param src_len Laenge der Nachricht in Byte
+ * @return Groesse in Byte
+ */
+extern unsigned long huff_dict_compress_bound(HUFF_DICT *dict,
+                                              unsigned long src_len);
+
+/**
+ * Kodiert eine Nachricht ohne Container: Kennung des Woerterbuchs, Anzahl
+ * der Zeichen (7 Bit je Byte) und Huffman-Code.
+ *
+ * @param dict Woerterbuch
+ * @param p_src Nachricht
+ * @param src_len Laenge der Nachricht in Byte
+ * @param p_dst Ausgabepuffer
+ * @param dst_cap Groesse des Ausgabepuffers, mindestens
+ *        huff_dict_compress_bound(dict, src_len)
+ * @return Laenge der Ausgabe oder HUFF_BUFFER_ERROR wenn der Ausgabepuffer
+ *         zu klein ist
+ */
+extern unsigned long huff_dict_compress(HUFF_DICT *dict,
+                                        unsigned char *p_src,
+                                        unsigned long src_len,
+                                        unsigned char *p_dst,
+                                        unsigned long dst_cap);
+
+/**
+ * Prueft ob eine Nachricht mit diesem Woerterbuch kodiert wurde. Nachrichten
+ * von Woerterbuechern ohne Kennung lassen sich nicht zuordnen und werden
+ * immer angenommen.
+ *
+ * @param dict Woerterbuch
+ * @param p_src Kodierte Nachricht
+ * @param src_len Laenge der kodierten Nachricht in Byte
+ * @return TRUE wenn die Kennung passt
+ */
+extern BOOL huff_dict_matches(HUFF_DICT *dict,
+                              unsigned char *p_src,
+                              unsigned long src_len);
+
+/**
+ * Liest die Anzahl Zeichen einer kodierten Nachricht.
+ *
+ * @param dict Woerterbuch
+ * @param p_src Kodierte Nachricht
+ * @param src_len Laenge der kodierten Nachricht in Byte
+ * @return Anzahl Zeichen oder HUFF_BUFFER_ERROR wenn die Kennung nicht
+ *         passt oder die Nachricht beschaedigt ist
+ */
+extern unsigned long huff_dict_decompressed_size(HUFF_DICT *dict,
+                                                 unsigned char *p_src,
+                                                 unsigned long src_len);
+
+/**
+ * Dekodiert eine mit huff_dict_compress kodierte Nachricht.
+ *
+ * @param dict Woerterbuch
+ * @param p_src Kodierte Nachricht
+ * @param src_len Laenge der kodierten Nachricht in Byte
+ * @param p_dst Ausgabepuffer
+ * @param dst_cap Groesse des Ausgabepuffers in Byte
+ * @return Anzahl dekodierter Zeichen oder HUFF_BUFFER_ERROR wenn die
+ *         Kennung nicht passt, die Nachricht beschaedigt ist oder der
+ *         Ausgabepuffer zu klein ist
+ */
+extern unsigned long huff_dict_decompress(HUFF_DICT *dict,
+                                          unsigned char *p_src,
+                                          unsigned long src_len,
+                                          unsigned char *p_dst,
+                                          unsigned long dst_cap);
+
+#endif	/* HUFF_DICT_H */
@@ -0,0 +1,645 @@
+/**
+ * File: huff_stream.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "huffman.h"
+#include "byte_order.h"
+#include "checksum.h"
+#include "huff_buffer.h"
+#include "huff_stream.h"
+
+/** Kodierer: nimmt Zeichen an. */
+#define STREAM_STATE_ENCODE 0
+
+/** Kodierer: letzter Block und Abschlussblock sind erzeugt. */
+#define STREAM_STATE_FLUSHED 1
+
+/** Dekodierer: liest den Containerheader. */
+#define STREAM_STATE_HEADER 2
+
+/** Dekodierer: liest einen Blockheader. */
+#define STREAM_STATE_BLOCK_HEADER 3
+
+/** Dekodierer: liest Symboltabelle, Code und Pruefsumme eines Blocks. */
+#define STREAM_STATE_BLOCK_DATA 4
+
+/** Dekodierer: Ende des Containers erreicht. */
+#define STREAM_STATE_DONE 5
+
+/** Dekodierer: fehlerhafte Eingabe. */
+#define STREAM_STATE_ERROR 6
+
+/** Platz fuer Header und Pruefsumme eines Blocks. */
+#define STREAM_BLOCK_OVERHEAD (BLOCK_HEADER_SIZE + CHECKSUM_SIZE)
+
+/**
+ * Diese Funktion schreibt den Containerheader des Kodierers als erste noch
+ * nicht ausgegebene Bytes.
+ *
+ * @param stream Stream
+ */
+static void start_container(HUFF_STREAM *stream);
+
+/**
+ * Diese Funktion kopiert noch nicht ausgegebene Bytes in die Ausgabe.
+ *
+ * @param stream Stream
+ */
+static void drain_pending(HUFF_STREAM *stream);
+
+/**
+ * Diese Funktion kodiert einen Block und haengt ihn an die noch nicht
+ * ausgegebenen Bytes an.
+ *
+ * @param stream Stream
+ * @param p_input Zeichen des Blocks
+ * @param input_length Anzahl Zeichen, 0 fuer den Abschlussblock
+ */
+static void encode_block(HUFF_STREAM *stream,
+                         unsigned char *p_input,
+                         unsigned long input_length);
+
+/**
+ * Diese Funktion liest die Eingabe in Bloecke und kodiert jeden vollen
+ * Block, solange die Ausgabe die vorherigen aufnimmt.
+ *
+ * @param stream Stream
+ */
+static void encode_input(HUFF_STREAM *stream);
+
+/**
+ * Diese Funktion ist der Zustandsautomat des Dekodierers.
+ *
+ * @param stream Stream
+ * @return HUFF_STREAM_OK, HUFF_STREAM_END oder HUFF_STREAM_ERROR
+ */
+static int decode_input(HUFF_STREAM *stream);
+
+/**
+ * Diese Funktion kopiert Eingabe in einen Puffer, bis er length Bytes
+ * enthaelt. block_fill zaehlt die bereits kopierten Bytes.
+ *
+ * @param stream Stream
+ * @param p_target Puffer
+ * @param length Benoetigte Anzahl Bytes
+ * @return TRUE wenn der Puffer vollstaendig ist
+ */
+static BOOL collect(HUFF_STREAM *stream,
+                    unsigned char *p_target,
+                    unsigned long length);
+
+/**
+ * Diese Funktion prueft den gelesenen Containerheader.
+ *
+ * @param stream Stream
+ * @return FALSE wenn der Header fehlerhaft oder nicht unterstuetzt ist
+ */
+static BOOL read_container_header(HUFF_STREAM *stream);
+
+/**
+ * Diese Funktion prueft einen Blockheader und setzt block_length.
+ *
+ * @param stream Stream
+ * @param p_header Blockheader
+ * @return FALSE wenn der Block fehlerhaft oder zu gross ist
+ */
+static BOOL start_block(HUFF_STREAM *stream, unsigned char *p_header);
+
+/**
+ * Diese Funktion dekodiert einen vollstaendigen Block direkt in die Ausgabe
+ * oder, wenn diese nicht reicht, in die noch nicht ausgegebenen Bytes.
+ *
+ * @param stream Stream
+ * @param p_block Block ab dem Header
+ * @return FALSE wenn der Block fehlerhaft ist
+ */
+static BOOL decode_block(HUFF_STREAM *stream, unsigned char *p_block);
+
+/**
+ * Diese Funktion vergroessert einen Puffer auf mindestens size Byte.
+ *
+ * @param pp_buffer Puffer
+ * @param p_capacity Groesse des Puffers
+ * @param size Benoetigte Groesse
+ */
+static void reserve(unsigned char **pp_buffer,
+                    unsigned long *p_capacity,
+                    unsigned long size);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_stream_compress_init
+ *  ------------------------------------------------------------------------ */
+extern void huff_stream_compress_init(HUFF_STREAM *stream,
+                                      unsigned long block_size,
+                                      BOOL checksum)
+{
+    memset(stream, 0, sizeof(HUFF_STREAM));
+    stream->state = STREAM_STATE_ENCODE;
+    stream->checksum = checksum;
+    stream->block_size = (block_size > 0) ? block_size
+                                          : HUFF_STREAM_BLOCK_SIZE;
+
+    /*
+     * Der Ausgabepuffer nimmt den Containerheader oder einen vollen Block
+     * auf, am Ende den letzten Block zusammen mit dem Abschlussblock.
+     */
+    stream->block_capacity = stream->block_size;
+    stream->p_block = malloc(stream->block_capacity);
+    ENSURE_ENOUGH_MEMORY(stream->p_block, "huff_stream_compress_init");
+    stream->pending_capacity = CONTAINER_HEADER_SIZE + stream->block_size
+                               + 2 * STREAM_BLOCK_OVERHEAD;
+    stream->p_pending = malloc(stream->pending_capacity);
+    ENSURE_ENOUGH_MEMORY(stream->p_pending, "huff_stream_compress_init");
+
+    start_container(stream);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_stream_compress_update
+ *  ------------------------------------------------------------------------ */
+extern int huff_stream_compress_update(HUFF_STREAM *stream)
+{
+    encode_input(stream);
+    return HUFF_STREAM_OK;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_stream_compress_finish
+ *  ------------------------------------------------------------------------ */
+extern int huff_stream_compress_finish(HUFF_STREAM *stream)
+{
+    if (stream->state == STREAM_STATE_ENCODE)
+    {
+        encode_input(stream);
+        if (stream->pending_start < stream->pending_end)
+        {
+            return HUFF_STREAM_OK;
+        }
+
+        /* Der angefangene Block und der Abschlussblock passen zusammen. */
+        if (stream->block_fill > 0)
+        {
+            encode_block(stream, stream->p_block, stream->block_fill);
+            stream->block_fill = 0;
+        }
+        encode_block(stream, stream->p_block, 0);
+        stream->state = STREAM_STATE_FLUSHED;
+    }
+
+    drain_pending(stream);
+    return (stream->pending_start < stream->pending_end) ? HUFF_STREAM_OK
+                                                         : HUFF_STREAM_END;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_stream_decompress_init
+ *  ------------------------------------------------------------------------ */
+extern void huff_stream_decompress_init(HUFF_STREAM *stream)
+{
+    memset(stream, 0, sizeof(HUFF_STREAM));
+    stream->state = STREAM_STATE_HEADER;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_stream_decompress_update
+ *  ------------------------------------------------------------------------ */
+extern int huff_stream_decompress_update(HUFF_STREAM *stream)
+{
+    return decode_input(stream);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_stream_decompress_finish
+ *  ------------------------------------------------------------------------ */
+extern int huff_stream_decompress_finish(HUFF_STREAM *stream)
+{
+    int result = decode_input(stream);
+
+    /*
+     * Ohne ausstehende Ausgabe meldet der Automat HUFF_STREAM_OK nur, wenn
+     * die Eingabe mitten im Container aufgebraucht ist.
+     */
+    if (result == HUFF_STREAM_OK
+            && stream->pending_start == stream->pending_end)
+    {
+        stream->state = STREAM_STATE_ERROR;
+        return HUFF_STREAM_ERROR;
+    }
+
+    return result;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_stream_reset
+ *  ------------------------------------------------------------------------ */
+extern void huff_stream_reset(HUFF_STREAM *stream)
+{
+    stream->next_in = NULL;
+    stream->avail_in = 0;
+    stream->total_in = 0;
+    stream->next_out = NULL;
+    stream->avail_out = 0;
+    stream->total_out = 0;
+    stream->block_fill = 0;
+    stream->block_length = 0;
+    stream->pending_start = 0;
+    stream->pending_end = 0;
+
+    /* Nur der Kodierer kennt die Zustaende vor STREAM_STATE_HEADER. */
+    if (stream->state <= STREAM_STATE_FLUSHED)
+    {
+        stream->state = STREAM_STATE_ENCODE;
+        start_container(stream);
+    }
+    else
+    {
+        stream->state = STREAM_STATE_HEADER;
+        stream->checksum = FALSE;
+        stream->block_size = 0;
+        stream->stream_format = FALSE;
+        stream->remaining_chars = 0;
+        stream->table_valid = FALSE;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: huff_stream_destroy
+ *  ------------------------------------------------------------------------ */
+extern void huff_stream_destroy(HUFF_STREAM *stream)
+{
+    free(stream->p_block);
+    free(stream->p_pending);
+    stream->p_block = NULL;
+    stream->p_pending = NULL;
+    stream->block_capacity = 0;
+    stream->pending_capacity = 0;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: start_container
+ *  ------------------------------------------------------------------------ */
+static void start_container(HUFF_STREAM *stream)
+{
+    store_container_header(stream->p_pending,
+                           CONTAINER_FLAG_STREAM
+                           | (stream->checksum ? CONTAINER_FLAG_CHECKSUM : 0),
+                           0, stream->block_size);
+    stream->pending_start = 0;
+    stream->pending_end = CONTAINER_HEADER_SIZE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: drain_pending
+ *  ------------------------------------------------------------------------ */
+static void drain_pending(HUFF_STREAM *stream)
+{
+    unsigned long length = stream->pending_end - stream->pending_start;
+
+    if (length > stream->avail_out)
+    {
+        length = stream->avail_out;
+    }
+    if (length > 0)
+    {
+        memcpy(stream->next_out, stream->p_pending + stream->pending_start,
+               length);
+        stream->next_out += length;
+        stream->avail_out -= length;
+        stream->total_out += length;
+        stream->pending_start += length;
+    }
+
+    if (stream->pending_start == stream->pending_end)
+    {
+        stream->pending_start = 0;
+        stream->pending_end = 0;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: encode_block
+ *  ------------------------------------------------------------------------ */
+static void encode_block(HUFF_STREAM *stream,
+                         unsigned char *p_input,
+                         unsigned long input_length)
+{
+    /* Die Groesse von p_pending reicht fuer jeden Aufruf aus. */
+    stream->pending_end += huff_encode_block(p_input, input_length,
+                                             stream->p_pending
+                                                 + stream->pending_end,
+                                             stream->pending_capacity
+                                                 - stream->pending_end,
+                                             stream->checksum);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: encode_input
+ *  ------------------------------------------------------------------------ */
+static void encode_input(HUFF_STREAM *stream)
+{
+    unsigned long length;
+
+    for (;;)
+    {
+        drain_pending(stream);
+        if (stream->pending_start < stream->pending_end)
+        {
+            return;
+        }
+
+        /* Volle Bloecke werden ohne Kopie direkt aus der Eingabe kodiert. */
+        if (stream->block_fill == 0 && stream->avail_in >= stream->block_size)
+        {
+            encode_block(stream, stream->next_in, stream->block_size);
+            stream->next_in += stream->block_size;
+            stream->avail_in -= stream->block_size;
+            stream->total_in += stream->block_size;
+            continue;
+        }
+
+        if (stream->avail_in == 0)
+        {
+            return;
+        }
+        length = stream->block_size - stream->block_fill;
+        if (length > stream->avail_in)
+        {
+            length = stream->avail_in;
+        }
+        memcpy(stream->p_block + stream->block_fill, stream->next_in, length);
+        stream->block_fill += length;
+        stream->next_in += length;
+        stream->avail_in -= length;
+        stream->total_in += length;
+
+        if (stream->block_fill == stream->block_size)
+        {
+            encode_block(stream, stream->p_block, stream->block_size);
+            stream->block_fill = 0;
+        }
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_input
+ *  ------------------------------------------------------------------------ */
+static int decode_input(HUFF_STREAM *stream)
+{
+    unsigned char *p_block;
+
+    for (;;)
+    {
+        drain_pending(stream);
+        if (stream->pending_start < stream->pending_end)
+        {
+            return HUFF_STREAM_OK;
+        }
+
+        if (stream->state == STREAM_STATE_HEADER)
+        {
+            if (!collect(stream, stream->header, CONTAINER_HEADER_SIZE))
+            {
+                return HUFF_STREAM_OK;
+            }
+            stream->block_fill = 0;
+            if (!read_container_header(stream))
+            {
+                stream->state = STREAM_STATE_ERROR;
+            }
+        }
+        else if (stream->state == STREAM_STATE_BLOCK_HEADER)
+        {
+            if (!stream->stream_format && stream->remaining_chars == 0)
+            {
+                stream->state = STREAM_STATE_DONE;
+                continue;
+            }
+
+            /* Liegt der ganze Block in der Eingabe, wird er dort dekodiert. */
+            if (stream->block_fill == 0
+                    && stream->avail_in >= BLOCK_HEADER_SIZE)
+            {
+                if (!start_block(stream, stream->next_in))
+                {
+                    stream->state = STREAM_STATE_ERROR;
+                    continue;
+                }
+                if (stream->avail_in >= stream->block_length)
+                {
+                    p_block = stream->next_in;
+                    stream->next_in += stream->block_length;
+                    stream->avail_in -= stream->block_length;
+                    stream->total_in += stream->block_length;
+                    if (!decode_block(stream, p_block))
+                    {
+                        stream->state = STREAM_STATE_ERROR;
+                    }
+                    continue;
+                }
+            }
+
+            if (!collect(stream, stream->header, BLOCK_HEADER_SIZE))
+            {
+                return HUFF_STREAM_OK;
+            }
+            if (!start_block(stream, stream->header))
+            {
+                stream->state = STREAM_STATE_ERROR;
+                continue;
+            }
+            reserve(&stream->p_block, &stream->block_capacity,
+                    stream->block_length);
+            memcpy(stream->p_block, stream->header, BLOCK_HEADER_SIZE);
+            stream->state = STREAM_STATE_BLOCK_DATA;
+        }
+        else if (stream->state == STREAM_STATE_BLOCK_DATA)
+        {
+            if (!collect(stream, stream->p_block, stream->block_length))
+            {
+                return HUFF_STREAM_OK;
+            }
+            stream->block_fill = 0;
+            if (!decode_block(stream, stream->p_block))
+            {
+                stream->state = STREAM_STATE_ERROR;
+            }
+        }
+        else if (stream->state == STREAM_STATE_DONE)
+        {
+            return HUFF_STREAM_END;
+        }
+        else
+        {
+            return HUFF_STREAM_ERROR;
+        }
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: collect
+ *  ------------------------------------------------------------------------ */
+static BOOL collect(HUFF_STREAM *stream,
+                    unsigned char *p_target,
+                    unsigned long length)
+{
+    unsigned long count = length - stream->block_fill;
+
+    if (count > stream->avail_in)
+    {
+        count = stream->avail_in;
+    }
+    if (count > 0)
+    {
+        memcpy(p_target + stream->block_fill, stream->next_in, count);
+        stream->block_fill += count;
+        stream->next_in += count;
+        stream->avail_in -= count;
+        stream->total_in += count;
+    }
+
+    return (stream->block_fill == length) ? TRUE : FALSE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: read_container_header
+ *  ------------------------------------------------------------------------ */
+static BOOL read_container_header(HUFF_STREAM *stream)
+{
+    unsigned char flags = stream->header[5];
+
+    if (memcmp(stream->header, CONTAINER_MAGIC, 4) != 0
+            || stream->header[4] != CONTAINER_VERSION
+            || (flags & ~(CONTAINER_FLAG_SEEK_INDEX | CONTAINER_FLAG_CHECKSUM
+                          | CONTAINER_FLAG_STREAM)) != 0)
+    {
+        return FALSE;
+    }
+
+    stream->checksum = ((flags & CONTAINER_FLAG_CHECKSUM) != 0) ? TRUE
+                                                                 : FALSE;
+    stream->stream_format = ((flags & CONTAINER_FLAG_STREAM) != 0) ? TRUE
+                                                                   : FALSE;
+    stream->remaining_chars = load_le(stream->header + 8, 8);
+    stream->block_size = load_le(stream->header + 16, 8);
+    if (stream->block_size == 0
+            || stream->block_size > HUFF_STREAM_MAX_BLOCK_SIZE)
+    {
+        stream->block_size = HUFF_STREAM_MAX_BLOCK_SIZE;
+    }
+    stream->state = STREAM_STATE_BLOCK_HEADER;
+
+    return TRUE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: start_block
+ *  ------------------------------------------------------------------------ */
+static BOOL start_block(HUFF_STREAM *stream, unsigned char *p_header)
+{
+    unsigned long raw_length = load_le(p_header + 3, 8);
+
+    stream->block_length = huff_block_size(p_header, stream->checksum
+                                                     ? CHECKSUM_SIZE : 0);
+
+    /*
+     * Ein Huffman-Block ist hoechstens so gross wie die Zeichen mit Header,
+     * Symboltabelle und Pruefsumme. Damit bleibt der Puffer begrenzt.
+     */
+    if (stream->block_length == HUFF_BUFFER_ERROR
+            || raw_length > stream->block_size
+            || stream->block_length > stream->block_size
+                                      + STREAM_BLOCK_OVERHEAD
+                                      + 256 * BLOCK_SYMBOL_SIZE
+            || (!stream->stream_format
+                && raw_length > stream->remaining_chars))
+    {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_block
+ *  ------------------------------------------------------------------------ */
+static BOOL decode_block(HUFF_STREAM *stream, unsigned char *p_block)
+{
+    unsigned long raw_length = load_le(p_block + 3, 8);
+    unsigned long checksum_size = stream->checksum ? CHECKSUM_SIZE : 0;
+    unsigned long decoded;
+
+    if (stream->avail_out >= raw_length)
+    {
+        decoded = huff_decode_block(p_block, checksum_size,
+                                    &stream->decode_table,
+                                    &stream->table_valid, stream->next_out,
+                                    raw_length);
+        if (decoded != HUFF_BUFFER_ERROR)
+        {
+            stream->next_out += decoded;
+            stream->avail_out -= decoded;
+            stream->total_out += decoded;
+        }
+    }
+    else
+    {
+        reserve(&stream->p_pending, &stream->pending_capacity, raw_length);
+        decoded = huff_decode_block(p_block, checksum_size,
+                                    &stream->decode_table,
+                                    &stream->table_valid, stream->p_pending,
+                                    raw_length);
+        stream->pending_start = 0;
+        stream->pending_end = (decoded != HUFF_BUFFER_ERROR) ? decoded : 0;
+    }
+
+    if (decoded == HUFF_BUFFER_ERROR)
+    {
+        return FALSE;
+    }
+
+    /* Im Stream endet der Container mit dem Block ohne Zeichen. */
+    if (stream->stream_format && raw_length == 0)
+    {
+        stream->state = STREAM_STATE_DONE;
+    }
+    else
+    {
+        stream->remaining_chars -= stream->stream_format ? 0 : raw_length;
+        stream->state = STREAM_STATE_BLOCK_HEADER;
+    }
+
+    return TRUE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: reserve
+ *  ------------------------------------------------------------------------ */
+static void reserve(unsigned char **pp_buffer,
+                    unsigned long *p_capacity,
+                    unsigned long size)
+{
+    if (size > *p_capacity || *pp_buffer == NULL)
+    {
+        *pp_buffer = realloc(*pp_buffer, (size > 0) ? size : 1);
+        ENSURE_ENOUGH_MEMORY(*pp_buffer, "reserve");
+        *p_capacity = size;
+    }
+}
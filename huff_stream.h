@@ -0,0 +1,225 @@
+/**
+ * File: huff_stream.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HUFF_STREAM_H
+
+#define	HUFF_STREAM_H
+
+#include "common.h"
+#include "huffman.h"
+#include "codec_kernels.h"
+
+/** Rueckgabe: Eingabe verarbeitet oder Ausgabepuffer voll. */
+#define HUFF_STREAM_OK 0
+
+/** Rueckgabe: Stream vollstaendig geschrieben bzw. gelesen. */
+#define HUFF_STREAM_END 1
+
+/** Rueckgabe: Eingabe fehlerhaft oder unvollstaendig. */
+#define HUFF_STREAM_ERROR -1
+
+/** Blockgroesse des Kodierers, wenn 0 angegeben wird. */
+#define HUFF_STREAM_BLOCK_SIZE 65536UL
+
+/**
+ * Groesster Block, den der Dekodierer puffert. Groessere Bloecke werden als
+ * fehlerhaft abgelehnt, auch wenn der Header eine groessere Blockgroesse
+ * angibt.
+ */
+#define HUFF_STREAM_MAX_BLOCK_SIZE 16777216UL
+
+/**
+ * Zustand eines Streams zum schrittweisen Komprimieren oder Dekomprimieren.
+ * Wie bei zlib setzt der Aufrufer vor jedem Aufruf next_in, avail_in,
+ * next_out und avail_out, die Funktionen schieben sie weiter. Intern wird
+ * hoechstens ein Block gepuffert.
+ */
+typedef struct _HUFF_STREAM
+{
+    /**
+     * Naechstes Eingabebyte
+     */
+    unsigned char *next_in;
+    /**
+     * Anzahl verfuegbarer Eingabebytes
+     */
+    unsigned long avail_in;
+    /**
+     * Bisher gelesene Eingabebytes
+     */
+    unsigned long total_in;
+    /**
+     * Naechstes Ausgabebyte
+     */
+    unsigned char *next_out;
+    /**
+     * Freier Platz in der Ausgabe
+     */
+    unsigned long avail_out;
+    /**
+     * Bisher geschriebene Ausgabebytes
+     */
+    unsigned long total_out;
+    /**
+     * Interner Zustand (STREAM_STATE_* in huff_stream.c)
+     */
+    int state;
+    /**
+     * TRUE wenn jeder Block eine CRC32C erhaelt
+     */
+    BOOL checksum;
+    /**
+     * Maximale Anzahl Zeichen eines Blocks
+     */
+    unsigned long block_size;
+    /**
+     * Puffer fuer die Zeichen (Kodierer) bzw. den Block (Dekodierer)
+     */
+    unsigned char *p_block;
+    /**
+     * Groesse von p_block
+     */
+    unsigned long block_capacity;
+    /**
+     * Gefuellte Bytes in p_block bzw. header
+     */
+    unsigned long block_fill;
+    /**
+     * Laenge des aktuellen Blocks im Dekodierer
+     */
+    unsigned long block_length;
+    /**
+     * Noch nicht ausgegebene Bytes (Kodierer: Bloecke, Dekodierer: Zeichen)
+     */
+    unsigned char *p_pending;
+    /**
+     * Groesse von p_pending
+     */
+    unsigned long pending_capacity;
+    /**
+     * Erstes noch nicht ausgegebenes Byte in p_pending
+     */
+    unsigned long pending_start;
+    /**
+     * Ende der Daten in p_pending
+     */
+    unsigned long pending_end;
+    /**
+     * Containerheader und Blockheader des Dekodierers
+     */
+    unsigned char header[CONTAINER_HEADER_SIZE];
+    /**
+     * TRUE wenn der Container ein Stream mit Abschlussblock ist
+     */
+    BOOL stream_format;
+    /**
+     * Noch zu lesende Zeichen eines Containers ohne Abschlussblock
+     */
+    unsigned long remaining_chars;
+    /**
+     * Dekodiertabelle des letzten Huffman-Blocks
+     */
+    DECODE_TABLE decode_table;
+    /**
+     * TRUE wenn decode_table gefuellt ist
+     */
+    BOOL table_valid;
+} HUFF_STREAM;
+
+/**
+ * Bereitet einen Stream zum Komprimieren vor. Der Containerheader wird mit
+ * dem ersten Aufruf von huff_stream_compress_update ausgegeben, vorher muss
+ * einmalig huff_buffer_init aufgerufen worden sein.
+ * 
+ * @param stream Zu initialisierender Stream
+ * @param block_size Zeichen je Block, 0 fuer HUFF_STREAM_BLOCK_SIZE
+ * @param checksum TRUE um hinter jeden Block die CRC32C zu schreiben
+ */
+extern void huff_stream_compress_init(HUFF_STREAM *stream,
+                                      unsigned long block_size,
+                                      BOOL checksum);
+
+/**
+ * Liest so viel Eingabe wie moeglich und schreibt jeden vollen Block, soweit
+ * die Ausgabe reicht. Ein angefangener Block bleibt bis zum naechsten Aufruf
+ * gepuffert.
+ * 
+ * @param stream Stream
+ * @return HUFF_STREAM_OK
+ */
+extern int huff_stream_compress_update(HUFF_STREAM *stream);
+
+/**
+ * Verarbeitet die restliche Eingabe und schreibt den letzten Block sowie den
+ * Abschlussblock. Reicht die Ausgabe nicht, muss die Funktion mit neuem
+ * Ausgabepuffer erneut aufgerufen werden.
+ * 
+ * @param stream Stream
+ * @return HUFF_STREAM_END wenn alles geschrieben ist, sonst HUFF_STREAM_OK
+ */
+extern int huff_stream_compress_finish(HUFF_STREAM *stream);
+
+/**
+ * Bereitet einen Stream zum Dekomprimieren vor. Gelesen werden Streams von
+ * huff_stream_compress_* und Container, die huff_decompress_buffer versteht.
+ * Vorher muss einmalig huff_buffer_init aufgerufen worden sein.
+ * 
+ * @param stream Zu initialisierender Stream
+ */
+extern void huff_stream_decompress_init(HUFF_STREAM *stream);
+
+/**
+ * Liest so viel Eingabe wie moeglich und gibt jeden vollstaendig gelesenen
+ * Block aus, soweit die Ausgabe reicht. Eingabe hinter dem Ende des
+ * Containers wird nicht gelesen.
+ * 
+ * @param stream Stream
+ * @return HUFF_STREAM_END am Ende des Containers, HUFF_STREAM_ERROR bei
+ *         fehlerhafter Eingabe, sonst HUFF_STREAM_OK
+ */
+extern int huff_stream_decompress_update(HUFF_STREAM *stream);
+
+/**
+ * Wie huff_stream_decompress_update, nachdem die gesamte Eingabe uebergeben
+ * wurde. Endet die Eingabe vor dem Ende des Containers, ist das ein Fehler.
+ * 
+ * @param stream Stream
+ * @return HUFF_STREAM_END wenn alles ausgegeben ist, HUFF_STREAM_OK wenn die
+ *         Ausgabe nicht reicht, sonst HUFF_STREAM_ERROR
+ */
+extern int huff_stream_decompress_finish(HUFF_STREAM *stream);
+
+/**
+ * Setzt einen Stream fuer die naechste Nachricht in derselben Richtung
+ * zurueck. Blockgroesse und Pruefsummen des Kodierers bleiben erhalten, die
+ * Puffer werden nicht neu allokiert. So entfallen bei vielen kleinen
+ * Nachrichten die Allokationen von init und destroy.
+ * 
+ * @param stream Mit huff_stream_compress_init oder
+ *        huff_stream_decompress_init vorbereiteter Stream
+ */
+extern void huff_stream_reset(HUFF_STREAM *stream);
+
+/**
+ * Gibt die Puffer eines Streams wieder frei.
+ * 
+ * @param stream Stream
+ */
+extern void huff_stream_destroy(HUFF_STREAM *stream);
+
+#endif	/* HUFF_STREAM_H */
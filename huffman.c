@@ -19,20 +19,76 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "common.h"
 #include "huffman.h"
+#include "huff_ctx.h"
 #include "bit_buffer.h"
+#include "byte_order.h"
+#include "fsm_decoder.h"
+#include "codec_kernels.h"
+#include "mapped_file.h"
+#include "parallel_decoder.h"
+#include "checksum.h"
+#include "context_model.h"
+#include "wide_huffman.h"
+#include "rle.h"
+#include "huff_buffer.h"
+#include "huff_dict.h"
+#include "async_io.h"
+#include "mem_budget.h"
+#include "huffman_internal.h"
+#include "benchmark.h"
+
+/**
+ * Mindestanzahl der Abschnitte oder Bloecke, die --sample auswertet. Bei
+ * wenigen grossen Bloecken waere die Stichprobe sonst ein einzelner Block.
+ */
+#define SAMPLE_MIN_CHUNKS 8
+
+/**
+ * Mehrkosten in Prozent, bis zu denen ein Block mit der Codetabelle des
+ * vorherigen Blocks statt mit einer eigenen kodiert wird.
+ */
+#define REPEAT_TABLE_THRESHOLD 2
+
+/** Flags fuer den Containerheader einer neu geschriebenen Datei. */
+#define WRITE_FLAGS \
+    (((ctx->checksum_mode) ? CONTAINER_FLAG_CHECKSUM : 0) \
+        | ((ctx->shared_table_written) ? CONTAINER_FLAG_SHARED_TABLE : 0))
+
+/** Groesse der Pruefsumme hinter jedem Block der gelesenen Datei. */
+#define READ_CHECKSUM_SIZE \
+    (((ctx->read_flags & CONTAINER_FLAG_CHECKSUM) != 0) ? CHECKSUM_SIZE : 0)
+
+/**
+ * Anzahl Bytes des Huffman-Codes ab dem Header. Im Altformat ist die Laenge
+ * unbekannt, es wird bis zum Dateiende gelesen.
+ */
+#define CODE_LENGTH_LIMIT \
+    ((ctx->legacy_format) ? (unsigned long) -1 : ctx->read_block.code_length)
+
+/**
+ * TRUE wenn die gelesene Datei aus einzelnen Bloecken besteht, die nicht als
+ * ein durchgehender Huffman-Code dekodiert werden koennen.
+ */
+#define IS_BLOCK_FILE \
+    (!ctx->legacy_format \
+        && (ctx->read_block_size > 0 \
+            || ctx->read_block.type != BLOCK_TYPE_HUFFMAN))
 
 /**
  * Diese Funktion traversiert den Baum und erzeugt dabei die Kodierungen der 
  * einzelnen Zeichen.
  * 
+ * @param ctx Codec-Kontext
  * @param root Wurzel des Binaerbaums
  * @param p_current_bit Momentaner Code
  * @param p_start_bit Start des Codes
  * @param depth Momentane Tiefe im Binaerbaum
  */
-static void create_code_table(BTREE_NODE *root,
+static void create_code_table(HUFF_CTX *ctx,
+                              BTREE_NODE *root,
                                 char *p_current_bit,
                                 char *p_start_bit,
                                 unsigned int depth);
@@ -49,16 +105,33 @@ static void print_symbol(SYMBOL *symbol);
  * erstellt aus den enthaltenen Zeichen eine symbolmap.
  * Diese wird anschliessend mit Quicksort sortiert.
  * 
+ * @param ctx Codec-Kontext
  * @param in_filename Dateiname der Eingabedatei
  */
-static void build_symbol_map(char *in_filename);
+static void build_symbol_map(HUFF_CTX *ctx, char *in_filename);
+
+/**
+ * Diese Funktion liefert wie getc das naechste Zeichen der Eingabe, liest
+ * die Eingabe aber in Abschnitten von KERNEL_CHUNK_SIZE Zeichen.
+ * 
+ * @param p_reader Leser der Eingabedatei
+ * @param p_buffer Puffer fuer KERNEL_CHUNK_SIZE Zeichen
+ * @param p_position Naechstes Zeichen im Puffer
+ * @param p_length Anzahl der Zeichen im Puffer
+ * @return Das Zeichen oder EOF am Dateiende
+ */
+static int read_symbol(ASYNC_IO *p_reader,
+                       unsigned char *p_buffer,
+                       unsigned long *p_position,
+                       unsigned long *p_length);
 
 /**
  * Diese Funktion erzeugt den Wald aus den gesammelten Haeufigkeiten.
  * 
+ * @param ctx Codec-Kontext
  * @return Binaerheap mit allen Teilbaeumen
  */
-static BINARY_HEAP *create_tree_heap(void);
+static BINARY_HEAP *create_tree_heap(HUFF_CTX *ctx);
 
 /**
  * Diese Funktion erzeugt den optimierten Huffman Codebaum aus dem uebergebenen 
@@ -72,146 +145,852 @@ static BTREE* create_huffman_tree(BINARY_HEAP *p_tree_heap);
 
 /**
  * Diese Funktion gibt fuer Testzwecke die erstellte symbol_map aus.
+ * 
+ * @param ctx Codec-Kontext
  */
-static void print_symbol_map(void);
+static void print_symbol_map(HUFF_CTX *ctx);
 
 /**
  * Diese Funktion gibt Informationen uber den allokierten Speicher aus.
+ * 
+ * @param ctx Codec-Kontext
  */
-static void print_memory_info(void);
+static void print_memory_info(HUFF_CTX *ctx);
 
 /**
  * Diese Funktion gibt die Code Tabelle fuer die jeweiligen Zeichen aus.
+ * 
+ * @param ctx Codec-Kontext
  */
-static void print_code_table(void);
+static void print_code_table(HUFF_CTX *ctx);
 
 /**
  * Diese Funktion erstellt aus einem uebergebenen Binaerbaum den 
- * dekompressierten Text.
+ * dekompressierten Text in p_decompressed_text_start. Die ersten skip_count
+ * Zeichen ab der aktuellen Position im Eingabestrom werden dekodiert aber
+ * verworfen.
  * 
+ * @param ctx Codec-Kontext
  * @param p_input_stream Eingabestrom der zu dekompressierenden Datei
  * @param root Wurzel des Binaerbaums
+ * @param skip_count Anzahl zu ueberspringender Zeichen
+ * @param char_count Anzahl zu dekomprimierender Zeichen
  */
-static void create_decompressed_text(FILE *p_input_stream, BTREE_NODE *root);
+static void create_decompressed_text(HUFF_CTX *ctx,
+                                     FILE *p_input_stream,
+                                     BTREE_NODE *root,
+                                     unsigned long skip_count,
+                                     unsigned long char_count);
 
 /**
  * Diese Funktion liest nach und nach Bits aus der Eingabedatei und
- * durchlaeuft hierbei rekursiv den Binaerbaum. Wurde ein passendes Symbol
- * gefunden, wird dieses in den Ausgabetext geschrieben.
+ * durchlaeuft hierbei den Binaerbaum bis ein Blatt erreicht wurde.
  * 
+ * @param ctx Codec-Kontext
  * @param p_input_stream Eingabestrom der zu dekompressierenden Datei
  * @param root Wurzel des Binaerbaums oder Teilbaums
+ * @return Das gefundene Zeichen
+ */
+static unsigned char get_symbol_from_tree(HUFF_CTX *ctx,
+                                          FILE *p_input_stream,
+                                          BTREE_NODE *root);
+
+/**
+ * Diese Funktion dekomprimiert den Text mit dem zur Laufzeit gewaehlten
+ * Dekodierkernel nach p_output. Es werden nur so viele Bytes gelesen, wie fuer 
+ * skip_count + char_count Zeichen hoechstens benoetigt werden.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, positioniert auf dem ersten Byte
+ * @param p_decode_table Dekodiertabelle
+ * @param bit_offset Erstes Bit im ersten Byte
+ * @param skip_count Anzahl zu ueberspringender Zeichen
+ * @param char_count Anzahl zu dekomprimierender Zeichen
+ * @param p_output Puffer fuer die dekomprimierten Zeichen
+ */
+static void decode_with_kernel(HUFF_CTX *ctx,
+                               FILE *p_input_stream,
+                               DECODE_TABLE *p_decode_table,
+                               unsigned int bit_offset,
+                               unsigned long skip_count,
+                               unsigned long char_count,
+                               unsigned char *p_output);
+
+/**
+ * Diese Funktion dekomprimiert den Text abschnittsweise mit dem zur Laufzeit
+ * gewaehlten Dekodierkernel in den Puffer p_decompressed_text_start von
+ * KERNEL_CHUNK_SIZE Zeichen und schreibt jeden Abschnitt sofort. Je
+ * Abschnitt wird nur der dafuer hoechstens benoetigte Teil des Codes
+ * gelesen, der Speicher haengt damit nicht von der Dateigroesse ab.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, positioniert auf dem ersten Byte
+ * @param p_decode_table Dekodiertabelle
+ * @param bit_offset Erstes Bit im ersten Byte
+ * @param skip_count Anzahl zu ueberspringender Zeichen
+ * @param char_count Anzahl zu dekomprimierender Zeichen
+ * @param p_writer Schreiber der Ausgabedatei, NULL im Testmodus
+ * @return CRC32C der dekomprimierten Zeichen
+ */
+static unsigned long stream_with_kernel(HUFF_CTX *ctx,
+                                        FILE *p_input_stream,
+                                        DECODE_TABLE *p_decode_table,
+                                        unsigned int bit_offset,
+                                        unsigned long skip_count,
+                                        unsigned long char_count,
+                                        ASYNC_IO *p_writer);
+
+/**
+ * Diese Funktion kodiert die Eingabedatei mit dem zur Laufzeit gewaehlten
+ * Kodierkernel und merkt sich dabei die Sprungpunkte.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom der zu komprimierenden Datei
+ * @param p_output_stream Ausgabestrom fuer den komprimierten Text
+ * @param p_code_table Codetabelle
+ * @param p_seek_points Speicher fuer die Sprungpunkte oder NULL
+ * @param interval Abstand der Sprungpunkte in Zeichen
+ * @param p_checksum CRC32C der gelesenen Zeichen, wird fortgefuehrt
+ * @return Anzahl der Sprungpunkte
+ */
+static unsigned int encode_with_kernel(HUFF_CTX *ctx,
+                                       FILE *p_input_stream,
+                                       FILE *p_output_stream,
+                                       CODE_TABLE *p_code_table,
+                                       SEEK_POINT *p_seek_points,
+                                       unsigned long interval,
+                                       unsigned long *p_checksum);
+
+/**
+ * Diese Funktion kodiert die Eingabedatei bitweise ueber den bit_buffer. Sie
+ * wird fuer Codes verwendet, die laenger als KERNEL_MAX_CODE_LENGTH sind.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom der zu komprimierenden Datei
+ * @param p_output_stream Ausgabestrom fuer den komprimierten Text
+ * @param p_seek_points Speicher fuer die Sprungpunkte oder NULL
+ * @param interval Abstand der Sprungpunkte in Zeichen
+ * @param p_checksum CRC32C der gelesenen Zeichen, wird fortgefuehrt
+ * @return Anzahl der Sprungpunkte
+ */
+static unsigned int encode_with_bit_buffer(HUFF_CTX *ctx,
+                                           FILE *p_input_stream,
+                                           FILE *p_output_stream,
+                                           SEEK_POINT *p_seek_points,
+                                           unsigned long interval,
+                                           unsigned long *p_checksum);
+
+/**
+ * Diese Funktion misst die schnellste von BENCHMARK_RUNS Dekodierungen des
+ * gesamten Huffman-Codes mit einem Dekodierkernel.
+ * 
+ * @param ctx Codec-Kontext
+ * @param kernel Dekodierkernel
+ * @param p_decode_table Dekodiertabelle
+ * @param p_payload Huffman-Code
+ * @param payload_length Laenge des Huffman-Codes
+ * @param p_output Ausgabepuffer fuer read_char_count Zeichen
+ * @return Zeit in Sekunden
+ */
+static double benchmark_decode_kernel(HUFF_CTX *ctx,
+                                      DECODE_KERNEL kernel,
+                                      DECODE_TABLE *p_decode_table,
+                                      unsigned char *p_payload,
+                                      unsigned long payload_length,
+                                      unsigned char *p_output);
+
+/**
+ * Diese Funktion misst die schnellste von BENCHMARK_RUNS Kodierungen des
+ * gesamten Textes mit einem Kodierkernel.
+ * 
+ * @param ctx Codec-Kontext
+ * @param kernel Kodierkernel
+ * @param p_code_table Codetabelle
+ * @param p_text Zu kodierender Text mit read_char_count Zeichen
+ * @param p_output Ausgabepuffer
+ * @param p_length Anzahl der kodierten Bytes
+ * @return Zeit in Sekunden
+ */
+static double benchmark_encode_kernel(HUFF_CTX *ctx,
+                                      ENCODE_KERNEL kernel,
+                                      CODE_TABLE *p_code_table,
+                                      unsigned char *p_text,
+                                      unsigned char *p_output,
+                                      unsigned long *p_length);
+
+/**
+ * Diese Funktion gibt das Ergebnis eines Dekodierers im Benchmark aus.
+ * 
+ * @param ctx Codec-Kontext
+ * @param name Name des Dekodierers
+ * @param seconds Zeit der schnellsten Wiederholung in Sekunden
+ * @param correct TRUE wenn das Ergebnis mit dem Baum-Dekodierer uebereinstimmt
+ */
+static void print_benchmark_result(HUFF_CTX *ctx,
+                                   char *name,
+                                   double seconds,
+                                   BOOL correct);
+
+/**
+ * Diese Funktion sucht im Seek-Index am Ende der Datei den letzten 
+ * Sprungpunkt vor der uebergebenen Position. Es wird nur der benoetigte
+ * Eintrag gelesen.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom der zu dekompressierenden Datei
+ * @param position Position des gesuchten Zeichens
+ * @param p_seek_point Gefundener Sprungpunkt
+ * @param p_seek_position Position des Zeichens am Sprungpunkt
+ * @return TRUE wenn ein Seek-Index vorhanden ist, sonst FALSE
  */
-static void get_symbol_from_tree(FILE *p_input_stream, BTREE_NODE *root);
+static BOOL find_seek_point(HUFF_CTX *ctx,
+                            FILE *p_input_stream,
+                            unsigned long position,
+                            SEEK_POINT *p_seek_point,
+                            unsigned long *p_seek_position);
+
+/**
+ * Diese Funktion setzt den Eingabestrom auf den uebergebenen Sprungpunkt, 
+ * sodass das naechste gelesene Bit das erste Bit des Sprungpunkts ist.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom der zu dekompressierenden Datei
+ * @param data_start Dateiposition des ersten Bytes nach dem Header
+ * @param p_seek_point Anzuspringender Sprungpunkt
+ */
+static void seek_to_point(HUFF_CTX *ctx,
+                          FILE *p_input_stream,
+                          long data_start,
+                          SEEK_POINT *p_seek_point);
 
 /**
  * Diese Funktion liest die fuer die Dekomprimierung notwendigen Daten aus 
- * dem Header.
+ * dem Header. Beginnt die Datei nicht mit CONTAINER_MAGIC, wird sie im
+ * Altformat gelesen.
  * 
+ * @param ctx Codec-Kontext
  * @param p_input_stream Eingabestrom der zu dekompressierenden Datei
  */
-static void read_header(FILE *p_input_stream);
+static void read_header(HUFF_CTX *ctx, FILE *p_input_stream);
+
+/**
+ * Diese Funktion dekodiert einen durchgehenden Huffman-Code (Altformat oder
+ * Container mit nur einem Huffman-Block) mit dem gewaehlten Dekodierer.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, steht am Anfang des Huffman-Codes
+ * @param first Erstes zu dekodierendes Zeichen
+ * @param char_count Anzahl der zu dekodierenden Zeichen
+ * @param streaming TRUE wenn nur ein Abschnitt der Ausgabe in den Speicher
+ *        passt, dann wird immer der Tabellenkernel verwendet
+ * @param p_writer Schreiber der Ausgabedatei beim abschnittsweisen Dekodieren
+ */
+static void decompress_stream(HUFF_CTX *ctx,
+                              FILE *p_input_stream,
+                              unsigned long first,
+                              unsigned long char_count,
+                              BOOL streaming,
+                              ASYNC_IO *p_writer);
+
+/**
+ * Diese Funktion dekodiert die Bloecke eines Containers. Bloecke vor dem
+ * gewuenschten Bereich werden uebersprungen, gespeicherte Bloecke direkt in
+ * die Ausgabe gelesen.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, steht hinter dem ersten Blockheader
+ * @param first Erstes zu dekodierendes Zeichen
+ * @param char_count Anzahl der zu dekodierenden Zeichen
+ * @param streaming TRUE wenn nur ein Block der Ausgabe in den Speicher passt
+ * @param p_writer Schreiber der Ausgabedatei beim blockweisen Dekodieren
+ */
+static void decompress_blocks(HUFF_CTX *ctx,
+                              FILE *p_input_stream,
+                              unsigned long first,
+                              unsigned long char_count,
+                              BOOL streaming,
+                              ASYNC_IO *p_writer);
+
+/**
+ * Diese Funktion liest die Zeichen eines gespeicherten Blocks. Beim
+ * blockweisen Dekodieren wird in Abschnitten von KERNEL_CHUNK_SIZE Zeichen
+ * gelesen und jeder Abschnitt sofort geschrieben.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, steht auf dem ersten Zeichen
+ * @param length Anzahl der Zeichen
+ * @param p_output Puffer fuer die Zeichen
+ * @param streaming TRUE wenn nur ein Abschnitt in den Puffer passt
+ * @param p_writer Schreiber der Ausgabedatei oder NULL
+ * @return CRC32C der Zeichen, 0 ohne Pruefsummen in der Datei
+ */
+static unsigned long read_stored(HUFF_CTX *ctx,
+                                 FILE *p_input_stream,
+                                 unsigned long length,
+                                 unsigned char *p_output,
+                                 BOOL streaming,
+                                 ASYNC_IO *p_writer);
+
+/**
+ * Diese Funktion liest eine Symboltabelle und baut daraus die
+ * Dekodiertabelle fuer den Tabellenkernel auf.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom
+ * @param table_start Dateiposition der Symboltabelle
+ * @param table_symbol_count Anzahl der Symbole der Tabelle
+ * @param p_decode_table Zu fuellende Dekodiertabelle
+ */
+static void load_decode_table(HUFF_CTX *ctx,
+                              FILE *p_input_stream,
+                              long table_start,
+                              unsigned int table_symbol_count,
+                              DECODE_TABLE *p_decode_table);
+
+/**
+ * Diese Funktion gibt die Symbole der inneren Knoten eines Baums frei.
+ * 
+ * @param allocator Allokator des Baums
+ * @param node Aktueller Knoten
+ */
+static void free_inner_symbols(ALLOCATOR *allocator, BTREE_NODE *node);
+
+/**
+ * Diese Funktion liest den Header des Altformats mit nativen unsigned int
+ * Werten.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, positioniert am Dateianfang
+ */
+static void read_legacy_header(HUFF_CTX *ctx, FILE *p_input_stream);
+
+/**
+ * Diese Funktion summiert die Zeichen aller Bloecke eines Streams bis zum
+ * Abschlussblock ohne Zeichen. Danach steht der Eingabestrom wieder hinter
+ * dem Header des ersten Blocks.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom
+ * @return Anzahl Zeichen des Streams
+ */
+static unsigned long count_stream_chars(HUFF_CTX *ctx, FILE *p_input_stream);
+
+/**
+ * Diese Funktion wertet einen gelesenen Blockheader aus und setzt
+ * read_block und symbol_count.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_header Blockheader mit BLOCK_HEADER_SIZE Bytes
+ */
+static void parse_block_header(HUFF_CTX *ctx, unsigned char *p_header);
+
+/**
+ * Diese Funktion liest die Symboltabelle eines Blocks mit einem einzigen
+ * fread und baut daraus die symbol_map auf.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, positioniert hinter dem Blockheader
+ * @param entry_size Groesse eines Eintrags (BLOCK_SYMBOL_SIZE oder Altformat)
+ */
+static void read_symbol_table(HUFF_CTX *ctx,
+                              FILE *p_input_stream,
+                              unsigned int entry_size);
 
 /**
  * Diese Funktion schreibt die komprimierte Datei.
  * 
+ * @param ctx Codec-Kontext
  * @param out_filename Name der Ausgabedatei
  * @param in_filename Name der Eingabedatei
+ * @param stored TRUE wenn die Eingabe unkomprimiert gespeichert wird
+ */
+static void write_compressed_file(HUFF_CTX *ctx,
+                                  char *out_filename,
+                                  char *in_filename,
+                                  BOOL stored);
+
+/**
+ * Diese Funktion zaehlt die Zeichen eines Blocks je vorherigem Zeichen,
+ * fasst die Kontexte zu Gruppen zusammen und erzeugt je Gruppe mit
+ * create_block_codes die Codelaengen und die kanonische Codetabelle. Die
+ * symbol_map ist danach leer.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input Zeichen des Blocks
+ * @param input_length Anzahl der Zeichen
+ * @param p_counts Speicher fuer die Haeufigkeiten je Kontext
+ * @param p_model Zu fuellendes Modell
+ * @param p_tables Codetabelle je Gruppe
+ * @return Laenge von Modell und Huffman-Code in Byte oder 
+ *         (unsigned long) -1, wenn ein Code zu lang fuer die Kernel ist
+ */
+static unsigned long build_context_model(HUFF_CTX *ctx,
+                                         unsigned char *p_input,
+                                         unsigned long input_length,
+                                         unsigned long (*p_counts)[256],
+                                         CONTEXT_MODEL *p_model,
+                                         CODE_TABLE *p_tables);
+
+/**
+ * Diese Funktion liest das Modell eines Kontextblocks und dekodiert dessen
+ * Huffman-Code nach p_output.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, positioniert hinter dem Blockheader
+ * @param table_count Anzahl der Codetabellen
+ * @param skip_count Anzahl zu ueberspringender Zeichen
+ * @param char_count Anzahl zu dekomprimierender Zeichen
+ * @param p_output Puffer fuer die dekomprimierten Zeichen
+ */
+static void decode_context_block(HUFF_CTX *ctx,
+                                 FILE *p_input_stream,
+                                 unsigned int table_count,
+                                 unsigned long skip_count,
+                                 unsigned long char_count,
+                                 unsigned char *p_output);
+
+/**
+ * Diese Funktion schreibt die Codelaengen eines Blocks mit 16-Bit-Zeichen
+ * oder mit Laufzeichen im Format von BLOCK_TYPE_WIDE.
+ * 
+ * @param p_output_stream Ausgabestrom fuer die komprimierte Datei
+ * @param p_lengths Codelaenge je Zeichen
+ * @param used Anzahl der vorkommenden Zeichen
+ */
+static void write_wide_table(FILE *p_output_stream,
+                             unsigned char *p_lengths,
+                             unsigned long used);
+
+/**
+ * Diese Funktion liest die Codelaengen eines Blocks mit 16-Bit-Zeichen und
+ * dekodiert dessen Huffman-Code nach p_output. Bereiche duerfen mitten in
+ * einem Zeichen beginnen und enden.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, positioniert hinter dem Blockheader
+ * @param skip_count Anzahl zu ueberspringender Bytes
+ * @param char_count Anzahl zu dekomprimierender Bytes
+ * @param p_output Puffer fuer die dekomprimierten Bytes
+ */
+static void decode_wide_block(HUFF_CTX *ctx,
+                              FILE *p_input_stream,
+                              unsigned long skip_count,
+                              unsigned long char_count,
+                              unsigned char *p_output);
+
+/**
+ * Diese Funktion liest die Codelaengen im Format von BLOCK_TYPE_WIDE und
+ * erzeugt daraus den Dekodierer.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, positioniert hinter dem Blockheader
+ * @param symbol_limit Anzahl der Zeichen des Alphabets
+ * @return Der Dekodierer, freizugeben mit free
+ */
+static WIDE_DECODER *load_wide_decoder(HUFF_CTX *ctx,
+                                       FILE *p_input_stream,
+                                       unsigned long symbol_limit);
+
+/**
+ * Diese Funktion liest die Codelaengen eines Blocks mit Laufzeichen und
+ * dekodiert dessen Huffman-Code nach p_output.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, positioniert hinter dem Blockheader
+ * @param skip_count Anzahl zu ueberspringender Zeichen
+ * @param char_count Anzahl zu dekomprimierender Zeichen
+ * @param p_output Puffer fuer die dekomprimierten Zeichen
+ */
+static void decode_rle_block(HUFF_CTX *ctx,
+                             FILE *p_input_stream,
+                             unsigned long skip_count,
+                             unsigned long char_count,
+                             unsigned char *p_output);
+
+/**
+ * Diese Funktion berechnet die Groesse der Tabellen zwischen dem gelesenen
+ * Blockheader und den Blockdaten.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom
+ * @param table_start Dateiposition hinter dem Blockheader
+ * @return Groesse in Byte
+ */
+static long block_table_size(HUFF_CTX *ctx,
+                             FILE *p_input_stream,
+                             long table_start);
+
+/**
+ * Diese Funktion berechnet die Groesse des Huffman-Codes aus den Codes der
+ * symbol_map, ohne die Eingabe zu kodieren.
+ * 
+ * @param ctx Codec-Kontext
+ * @return Laenge des Huffman-Codes in Byte
+ */
+static unsigned long estimate_code_length(HUFF_CTX *ctx);
+
+/**
+ * Diese Funktion berechnet die Groesse des Huffman-Codes eines Blocks mit
+ * einer bereits geschriebenen Codetabelle.
+ * 
+ * @param p_code_table Codetabelle eines vorherigen Blocks
+ * @param p_symbols TRUE je Zeichen mit einem Code in der Tabelle
+ * @param p_counts Haeufigkeit je Zeichen des Blocks
+ * @return Laenge in Byte oder (unsigned long) -1, wenn ein Zeichen des
+ *         Blocks keinen Code hat
+ */
+static unsigned long estimate_repeat_length(CODE_TABLE *p_code_table,
+                                            BOOL *p_symbols,
+                                            unsigned long *p_counts);
+
+/**
+ * Diese Funktion kopiert die Eingabedatei unveraendert in die Ausgabe, im
+ * checksum_mode gefolgt von ihrer Pruefsumme.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_output_stream Ausgabestrom fuer die komprimierte Datei
+ * @param in_filename Name der Eingabedatei
  */
-static void write_compressed_file(char *out_filename, char *in_filename);
+static void write_stored_data(HUFF_CTX *ctx,
+                              FILE *p_output_stream,
+                              char *in_filename);
 
 /**
  * Diese Funktion schreibt die dekomprimierte Datei.
  * 
+ * @param ctx Codec-Kontext
  * @param out_filename Name der Ausgabedatei
+ * @param char_count Anzahl der dekomprimierten Zeichen
  */
-static void write_decompressed_file(char *out_filename);
+static void write_decompressed_file(HUFF_CTX *ctx,
+                                    char *out_filename,
+                                    unsigned long char_count);
 
 /**
  * Diese Funktion schreibt den komprimierten Text in die Ausgabedatei.
  * 
+ * @param ctx Codec-Kontext
  * @param p_output_stream Ausgabestrom fuer den komprimierten Text
  * @param in_filename Name der Eingabedatei
  */
-static void write_huffman_code(FILE *p_output_stream, char *in_filename);
+static void write_huffman_code(HUFF_CTX *ctx,
+                               FILE *p_output_stream,
+                               char *in_filename);
+
+/**
+ * Diese Funktion schreibt den Containerheader.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_output_stream Ausgabestrom fuer die komprimierte Datei
+ * @param flags Flags des Containers (CONTAINER_FLAG_*)
+ * @param block_bytes Blockgroesse in Byte, 0 fuer nur einen Block
+ */
+static void write_header(HUFF_CTX *ctx,
+                         FILE *p_output_stream,
+                         unsigned int flags,
+                         unsigned long block_bytes);
+
+/**
+ * Diese Funktion traegt die Laenge des Huffman-Codes nachtraeglich in den
+ * Blockheader ein. Der Ausgabestrom steht danach wieder am Dateiende.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_output_stream Ausgabestrom fuer die komprimierte Datei
+ * @param block_start Dateiposition des Blockheaders
+ */
+static void write_code_length(HUFF_CTX *ctx,
+                              FILE *p_output_stream,
+                              long block_start);
+
+/**
+ * Diese Funktion schreibt eine Pruefsumme im Format des Containers.
+ * 
+ * @param p_output_stream Ausgabestrom
+ * @param checksum CRC32C der unkomprimierten Zeichen
+ */
+static void write_checksum(FILE *p_output_stream, unsigned long checksum);
+
+/**
+ * Diese Funktion liest die Pruefsumme eines Blocks und vergleicht sie mit
+ * der CRC32C der dekodierten Zeichen. Bei einem Unterschied wird das
+ * Programm beendet.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom
+ * @param position Dateiposition der Pruefsumme
+ * @param actual CRC32C der dekodierten Zeichen des gesamten Blocks
+ * @param block_number Nummer des Blocks fuer die Fehlermeldung
+ */
+static void verify_checksum(HUFF_CTX *ctx,
+                            FILE *p_input_stream,
+                            long position,
+                            unsigned long actual,
+                            unsigned long block_number);
+
+/**
+ * Diese Funktion schreibt die Symboltabelle der symbol_map mit einem
+ * einzigen fwrite.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_output_stream Ausgabestrom
+ */
+static void write_symbol_table(HUFF_CTX *ctx, FILE *p_output_stream);
+
+/**
+ * Diese Funktion traegt die symbol_map im Format BLOCK_SYMBOL_SIZE in einen
+ * Puffer ein.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_entry Puffer fuer symbol_count Eintraege
+ */
+static void fill_symbol_table(HUFF_CTX *ctx, unsigned char *p_entry);
+
+/**
+ * Diese Funktion komprimiert eine Nachricht mit dem Woerterbuch. Die
+ * Ausgabe enthaelt nur die Kennung des Woerterbuchs, die Anzahl der Zeichen
+ * und den Huffman-Code.
+ * 
+ * @param ctx Codec-Kontext
+ * @param in_filename Eingabedatei
+ * @param out_filename Ausgabedatei
+ */
+static void compress_message(HUFF_CTX *ctx,
+                             char *in_filename,
+                             char *out_filename);
+
+/**
+ * Diese Funktion dekomprimiert eine mit dem Woerterbuch komprimierte
+ * Nachricht. Container und Nachrichten eines anderen Woerterbuchs werden
+ * abgelehnt.
+ * 
+ * @param ctx Codec-Kontext
+ * @param in_filename Eingabedatei
+ * @param out_filename Ausgabedatei
+ */
+static void decompress_message(HUFF_CTX *ctx,
+                               char *in_filename,
+                               char *out_filename);
 
 /**
- * Diese Funktion schreibt die fuer die Dekomprimierung notwendigen 
- * Daten in den Header.
+ * Diese Funktion schreibt den Seek-Index an das Ende der komprimierten Datei.
+ * Der Index besteht aus den Sprungpunkten, dem Intervall in Byte, der Anzahl
+ * der Sprungpunkte und der Kennung SEEK_INDEX_MAGIC. Aeltere Versionen 
+ * ignorieren die Daten hinter dem Huffman-Code.
  * 
+ * @param ctx Codec-Kontext
  * @param p_output_stream Ausgabestrom fuer die komprimierte Datei
+ * @param p_seek_points Sprungpunkte
+ * @param seek_point_count Anzahl der Sprungpunkte
+ * @param interval Abstand der Sprungpunkte in Zeichen
+ */
+static void write_seek_index(HUFF_CTX *ctx,
+                             FILE *p_output_stream,
+                             SEEK_POINT *p_seek_points,
+                             unsigned int seek_point_count,
+                             unsigned long interval);
+
+/**
+ * Diese Funktion zaehlt fuer --estimate die Zeichen der Eingabe und setzt
+ * estimated_header_size und estimated_payload_size fuer einen einzigen
+ * Huffman-Block oder gespeicherten Block ohne den Containerheader.
+ * 
+ * @param ctx Codec-Kontext
+ * @param in_filename Name der Eingabedatei
+ */
+static void estimate_stream(HUFF_CTX *ctx, char *in_filename);
+
+/**
+ * Diese Funktion prueft ob ein Abschnitt der Eingabe zur Stichprobe von
+ * --sample gehoert. Von je 100 Abschnitten werden sample_percent
+ * gleichmaessig verteilt ausgewertet, der erste Abschnitt immer.
+ * 
+ * @param ctx Codec-Kontext
+ * @param chunk Nummer des Abschnitts
+ * @return TRUE wenn der Abschnitt ausgewertet wird
+ */
+static BOOL is_sampled(HUFF_CTX *ctx, unsigned long chunk);
+
+/**
+ * Diese Funktion erhoeht sample_percent so weit, dass von den Abschnitten
+ * der Eingabe mindestens SAMPLE_MIN_CHUNKS ausgewertet werden.
+ * 
+ * @param ctx Codec-Kontext mit read_char_count
+ * @param chunk_size Groesse eines Abschnitts oder Blocks in Byte
+ */
+static void apply_sample_minimum(HUFF_CTX *ctx, unsigned long chunk_size);
+
+/**
+ * Diese Funktion rechnet eine an sampled_char_count Zeichen gezaehlte
+ * Groesse auf read_char_count Zeichen hoch.
+ * 
+ * @param ctx Codec-Kontext
+ * @param size Gezaehlte Groesse
+ * @return Hochgerechnete Groesse
  */
-static void write_header(FILE *p_output_stream);
+static unsigned long scale_to_input(HUFF_CTX *ctx, unsigned long size);
 
 /** ---------------------------------------------------------------------------
  *  Funktion: compress
  *  ------------------------------------------------------------------------ */
-extern void compress(char *in_filename, char *out_filename)
+extern void compress(HUFF_CTX *ctx, char *in_filename, char *out_filename)
 {
     BINARY_HEAP *p_tree_heap;
     BTREE *p_huffman_tree;
     char *p_code = NULL;
+    BOOL stored;
+    
+    /* Nachrichten mit Woerterbuch haben keinen Header und keinen Baum. */
+    if (ctx->dictionary_filename != NULL)
+    {
+        compress_message(ctx, in_filename, out_filename);
+        return;
+    }
+    
+    /* Im Blockmodus erhaelt jeder Block eine eigene Symboltabelle. */
+    if (ctx->block_size > 0)
+    {
+        write_compressed_file(ctx, out_filename, in_filename, FALSE);
+        allocator_release(&ctx->allocator);
+        return;
+    }
     
-    build_symbol_map(in_filename);
+    build_symbol_map(ctx, in_filename);
 
-    if (debug_mode)
+    if (ctx->debug_mode)
     {
         printf("\n---------------- Symbolmap erstellt ----------------\n\n");
-        print_symbol_map();
+        print_symbol_map(ctx);
+    }
+    
+    /* Eine leere Datei besteht nur aus den Headern. */
+    if (ctx->symbol_count == 0)
+    {
+        write_compressed_file(ctx, out_filename, in_filename, FALSE);
+        allocator_free(&ctx->allocator, ctx->p_symbol_start);
+        ctx->p_symbol_start = NULL;
+        allocator_release(&ctx->allocator);
+        return;
     }
     
-    p_tree_heap = create_tree_heap();
-    if (debug_mode)
+    p_tree_heap = create_tree_heap(ctx);
+    if (ctx->debug_mode)
     {
         printf("\n---------------- TreeHeap erstellt ----------------\n\n");
         heap_print(p_tree_heap);
     }
 
     p_huffman_tree = create_huffman_tree(p_tree_heap);
-    if (debug_mode)
+    if (ctx->debug_mode)
     {
         printf("\n---------------- Huffman-Tree erstellt ----------------\n\n");
         btree_print(p_huffman_tree);
     }
 
-    p_code = calloc((unsigned int)
-                  btree_get_max_depth(btree_get_root(p_huffman_tree)),
-                  sizeof(unsigned char));
-    ENSURE_ENOUGH_MEMORY(p_code, "compress");
+    p_code = allocator_alloc(&ctx->allocator, (size_t) btree_get_max_depth(
+                                 btree_get_root(p_huffman_tree)));
     
-    create_code_table(btree_get_root(p_huffman_tree), p_code, p_code, 1);
-    if (debug_mode)
+    create_code_table(ctx, btree_get_root(p_huffman_tree), p_code, p_code, 1);
+    if (ctx->debug_mode)
     {
-        print_code_table();
+        print_code_table(ctx);
     }
     
-    write_compressed_file(out_filename,in_filename);
-    if (debug_mode) 
+    /*
+     * Waere der Huffman-Code mit der Symboltabelle nicht kleiner als die
+     * Eingabe, wird die Eingabe unveraendert gespeichert.
+     */
+    stored = (estimate_code_length(ctx) + ctx->symbol_count * BLOCK_SYMBOL_SIZE
+              >= ctx->read_char_count) ? TRUE : FALSE;
+    if (ctx->debug_mode && stored)
+    {
+        printf("\tDie Eingabe ist nicht komprimierbar und wird "
+               "gespeichert.\n");
+    }
+    
+    write_compressed_file(ctx, out_filename, in_filename, stored);
+    if (ctx->debug_mode) 
     {
-        print_memory_info();
+        print_memory_info(ctx);
         printf("\n---------------- .hc-Datei geschrieben ----------------\n\n");
     }
     
     /**
      * Speicherfreigabe
      */
-    free(p_code);
+    allocator_free(&ctx->allocator, p_code);
     p_code = NULL;
     
-    btree_destroy(&p_huffman_tree, FALSE);
-    
     heap_destroy(p_tree_heap);
     p_tree_heap = NULL;
+    
+    free_codes(ctx);
+    destroy_huffman_tree(p_huffman_tree);
+    allocator_free(&ctx->allocator, ctx->p_symbol_start);
+    ctx->p_symbol_start = NULL;
+    allocator_release(&ctx->allocator);
 }
 
 /** ---------------------------------------------------------------------------
- *  Funktion: decompress
+ *  Funktion: estimate
  *  ------------------------------------------------------------------------ */
-extern void decompress(char *in_filename, char *out_filename)
+extern void estimate(HUFF_CTX *ctx, char *in_filename)
 {
-    FILE *p_input_stream = fopen(in_filename,"rb");
-    BINARY_HEAP* p_tree_heap;
-    BTREE* p_huffman_tree;
+    unsigned long total_size;
+    
+    ctx->estimated_header_size = 0;
+    ctx->estimated_payload_size = 0;
+    ctx->sampled_char_count = 0;
+    
+    if (ctx->block_size > 0)
+    {
+        write_blocks(ctx, NULL, in_filename);
+        
+        /* Nicht ausgewertete Bloecke sind im Mittel wie die ausgewerteten. */
+        ctx->estimated_header_size = 
+                scale_to_input(ctx, ctx->estimated_header_size);
+        ctx->estimated_payload_size = 
+                scale_to_input(ctx, ctx->estimated_payload_size);
+    }
+    else
+    {
+        estimate_stream(ctx, in_filename);
+    }
+    allocator_release(&ctx->allocator);
+    ctx->estimated_header_size += CONTAINER_HEADER_SIZE;
+    total_size = ctx->estimated_header_size + ctx->estimated_payload_size;
+    
+    if (ctx->sampled_char_count < ctx->read_char_count)
+    {
+        printf("Geschaetzte Groesse aus %lu von %lu Zeichen: ca. %lu Byte",
+               ctx->sampled_char_count, ctx->read_char_count, total_size);
+    }
+    else
+    {
+        printf("Komprimierte Groesse fuer %lu Zeichen: %lu Byte",
+               ctx->read_char_count, total_size);
+    }
+    if (ctx->read_char_count > 0)
+    {
+        printf(" (%.1f%%)", 100.0 * total_size / ctx->read_char_count);
+    }
+    printf("\n\tHeader und Tabellen: %lu Byte\n\tDaten: %lu Byte\n",
+           ctx->estimated_header_size, ctx->estimated_payload_size);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: estimate_stream
+ *  ------------------------------------------------------------------------ */
+static void estimate_stream(HUFF_CTX *ctx, char *in_filename)
+{
+    unsigned long counts[256];
+    unsigned long interval = ctx->seek_index_interval * 1024;
+    unsigned long read_length;
+    unsigned long code_length = 0;
+    unsigned long chunk = 0;
+    unsigned long i;
+    BTREE *p_huffman_tree;
+    unsigned char *p_input_buffer = malloc(KERNEL_CHUNK_SIZE);
+    FILE *p_input_stream = fopen(in_filename, "rb");
     
     if (p_input_stream == NULL)
     {
@@ -219,407 +998,2979 @@ extern void decompress(char *in_filename, char *out_filename)
         fflush(stdout);
         exit(EXIT_FAILURE);
     }
+    ENSURE_ENOUGH_MEMORY(p_input_buffer, "estimate_stream");
     
-    read_header(p_input_stream);
+    fseek(p_input_stream, 0, SEEK_END);
+    ctx->read_char_count = (unsigned long) ftell(p_input_stream);
+    fseek(p_input_stream, 0, SEEK_SET);
+    apply_sample_minimum(ctx, KERNEL_CHUNK_SIZE);
     
-    p_tree_heap = create_tree_heap();
-    if (debug_mode)
+    /* Abschnitte ausserhalb der Stichprobe werden nicht gelesen. */
+    memset(counts, 0, sizeof(counts));
+    while (chunk * KERNEL_CHUNK_SIZE < ctx->read_char_count)
     {
-        printf("\n---------------- TreeHeap erstellt ----------------\n\n");
-        heap_print(p_tree_heap);
+        if (is_sampled(ctx, chunk))
+        {
+            read_length = (unsigned long) fread(p_input_buffer, 
+                                                sizeof(unsigned char),
+                                                KERNEL_CHUNK_SIZE,
+                                                p_input_stream);
+            for (i = 0; i < read_length; i++)
+            {
+                counts[p_input_buffer[i]]++;
+            }
+            ctx->sampled_char_count += read_length;
+        }
+        else
+        {
+            fseek(p_input_stream, KERNEL_CHUNK_SIZE, SEEK_CUR);
+        }
+        chunk++;
     }
+    fclose(p_input_stream);
+    free(p_input_buffer);
     
-    p_huffman_tree = create_huffman_tree(p_tree_heap);
-    if (debug_mode)
+    /* Eine leere Datei besteht nur aus den Headern eines Huffman-Blocks. */
+    ctx->symbol_count = 0;
+    if (ctx->sampled_char_count > 0)
     {
-        printf("\n---------------- Huffman-Tree erstellt ----------------\n\n");
-        btree_print(p_huffman_tree);
+        p_huffman_tree = create_block_codes(ctx, counts);
+        code_length = scale_to_input(ctx, estimate_code_length(ctx));
+        free_codes(ctx);
+        destroy_huffman_tree(p_huffman_tree);
+        allocator_free(&ctx->allocator, ctx->p_symbol_start);
+        ctx->p_symbol_start = NULL;
     }
     
-    create_decompressed_text(p_input_stream, btree_get_root(p_huffman_tree));
-    if (debug_mode)
+    /* Wie in compress wird eine nicht komprimierbare Eingabe gespeichert. */
+    ctx->estimated_header_size = BLOCK_HEADER_SIZE 
+                          + ((ctx->checksum_mode) ? CHECKSUM_SIZE : 0);
+    if (ctx->read_char_count > 0 
+            && code_length + ctx->symbol_count * BLOCK_SYMBOL_SIZE 
+                >= ctx->read_char_count)
     {
-        printf("\n----------- Dekomprimierter Text erstellt ------------\n\n");
-        printf("%s\n", (char*) p_decompressed_text_start);
-        printf("\n------------- .hc.hd-Datei geschrieben -------------\n\n");
+        ctx->estimated_payload_size = ctx->read_char_count;
+    }
+    else
+    {
+        ctx->estimated_header_size += ctx->symbol_count * BLOCK_SYMBOL_SIZE;
+        ctx->estimated_payload_size = code_length;
+        if (interval > 0)
+        {
+            ctx->estimated_header_size += (ctx->read_char_count + interval - 1) 
+                                   / interval * CONTAINER_SEEK_POINT_SIZE
+                                   + CONTAINER_SEEK_TRAILER_SIZE;
+        }
     }
+}
 
-    fclose(p_input_stream);
-    
-    write_decompressed_file(out_filename);
-    
-    /**
-     * Speicherfreigabe
-     */
-    btree_destroy(&p_huffman_tree, FALSE);
-    p_huffman_tree = NULL;
-    
-    heap_destroy(p_tree_heap);
-    p_tree_heap = NULL;    
+/** ---------------------------------------------------------------------------
+ *  Funktion: is_sampled
+ *  ------------------------------------------------------------------------ */
+static BOOL is_sampled(HUFF_CTX *ctx, unsigned long chunk)
+{
+    return ((chunk * ctx->sample_percent) % 100 < ctx->sample_percent) 
+           ? TRUE : FALSE;
 }
 
 /** ---------------------------------------------------------------------------
- *  Funktion: get_count_from_tree
+ *  Funktion: apply_sample_minimum
  *  ------------------------------------------------------------------------ */
-static unsigned int get_count_from_tree(BTREE* tree)
+static void apply_sample_minimum(HUFF_CTX *ctx, unsigned long chunk_size)
 {
-    BTREE_NODE* root = btree_get_root(tree);
-    SYMBOL* symbol = btreenode_get_data(root);
+    unsigned long chunk_count = (ctx->read_char_count + chunk_size - 1) 
+                                / chunk_size;
+    unsigned long percent;
     
-    return symbol->count;
+    if (ctx->sample_percent >= 100 || chunk_count <= SAMPLE_MIN_CHUNKS)
+    {
+        ctx->sample_percent = 100;
+        return;
+    }
+    percent = (100 * SAMPLE_MIN_CHUNKS + chunk_count - 1) / chunk_count;
+    if (ctx->sample_percent < percent)
+    {
+        ctx->sample_percent = percent;
+    }
 }
 
 /** ---------------------------------------------------------------------------
- *  Funktion: create_code_table
+ *  Funktion: scale_to_input
  *  ------------------------------------------------------------------------ */
-static void create_code_table(BTREE_NODE *root,
-                                char *p_current_bit,
-                                char *p_start_bit,
-                                unsigned int depth)
+static unsigned long scale_to_input(HUFF_CTX *ctx, unsigned long size)
 {
-    if (btreenode_is_leaf(root))
-    {
-        /*
-         * Es liegt ein Blatt vor terminiere die Zeichenkette des Codes.
-         */
-        *p_current_bit = '\0';
-        
-        p_symbol = p_symbol_start;
-        while (p_symbol->symbol != ((SYMBOL*)btreenode_get_data(root))->symbol)
-        {
-            p_symbol++;
-        }
-        
-        p_symbol->code = calloc(1,strlen(p_start_bit) + 1);
-        strcpy(p_symbol->code, p_start_bit);
-    }
-    else
+    if (ctx->sampled_char_count == 0 
+            || ctx->sampled_char_count >= ctx->read_char_count)
     {
-        /*
-         * Kein Blatt? Dann Baum weiter traversieren.
-         */
-        if (btreenode_get_left(root) != NULL)
-        {
-            *p_current_bit = '0';
-            create_code_table(btreenode_get_left(root),
-                              p_current_bit  + 1,
-                              p_start_bit,
-                              depth + 1);
-        }
-        if (btreenode_get_right(root) != NULL) 
-        {
-            *p_current_bit = '1';
-            create_code_table(btreenode_get_right(root),
-                              p_current_bit  + 1,
-                              p_start_bit,
-                              depth + 1);
-        }
+        return size;
     }
+    return (unsigned long) ((double) size * ctx->read_char_count 
+                            / ctx->sampled_char_count + 0.5);
 }
 
 /** ---------------------------------------------------------------------------
- *  Funktion: create_decompressed_text
+ *  Funktion: decompress
  *  ------------------------------------------------------------------------ */
-static void create_decompressed_text(FILE *p_input_stream, BTREE_NODE *root)
+extern void decompress(HUFF_CTX *ctx, char *in_filename, char *out_filename)
 {
-    unsigned int i;
-    
-    p_decompressed_text_start = calloc(read_char_count + 1, 
-                                       sizeof(unsigned char));
-    p_decompressed_text = p_decompressed_text_start;
+    FILE *p_input_stream = fopen(in_filename,"rb");
     
-    bit_buffer_index = 0;
+    if (p_input_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
     
-    for (i = 0; i < read_char_count; i++)
+    if (ctx->dictionary_filename != NULL)
     {
-        get_symbol_from_tree(p_input_stream, root);
+        fclose(p_input_stream);
+        decompress_message(ctx, in_filename, out_filename);
+        return;
     }
-    *p_decompressed_text = '\0';
+    
+    decompress_container(ctx, p_input_stream, out_filename);
+    fclose(p_input_stream);
+    
+    /* Eine Arena gibt Baeume und Tabellen einmal je Auftrag frei. */
+    allocator_release(&ctx->allocator);
 }
 
 /** ---------------------------------------------------------------------------
- *  Funktion: get_next_bit
+ *  Funktion: decompress_container
  *  ------------------------------------------------------------------------ */
-static int get_next_bit(FILE *p_input_stream)
+extern void decompress_container(HUFF_CTX *ctx,
+                                 FILE *p_input_stream,
+                                 char *out_filename)
 {
-    unsigned int i;
-    size_t read_byte;
-    unsigned char current_byte;
-    unsigned char checkmask = 1;
+    MAPPED_FILE *p_mapped_file = NULL;
+    unsigned long first = 0;
+    unsigned long char_count;
+    unsigned long output_size;
+    BOOL streaming;
+    ASYNC_IO *p_writer = NULL;
+    FILE *p_output_stream = NULL;
     
-    /*
-     * Lesen eines Bytes wenn notwendig.
-     */
-    if (bit_buffer_index == 0)
+    read_header(ctx, p_input_stream);
+    char_count = ctx->read_char_count;
+    ctx->bit_buffer_index = 0;
+    
+    /* Mitglieder mit gemeinsamer Codetabelle sind nur im Archiv lesbar. */
+    if ((ctx->read_flags & CONTAINER_FLAG_SHARED_TABLE) != 0 
+            && ctx->shared_symbol_count == 0)
     {
-        read_byte = (unsigned int) fread(&read_bit_buffer, 
-                                         sizeof(unsigned char), 
-                                         1, 
-                                         p_input_stream);
-        /*
-         * Wenn nichts mehr gelesen wurde -1 zurueckgeben.
-         */
-        if (read_byte != 1) 
+        printf("Die Datei ist ein Mitglied eines Archivs und kann nur mit "
+               "-x entpackt werden.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    if (ctx->range_mode)
+    {
+        if (ctx->range_start > ctx->read_char_count 
+                || ctx->range_length > ctx->read_char_count - ctx->range_start)
         {
-            return -1;
+            printf("Der Bereich liegt ausserhalb der Datei (%lu Zeichen).\n",
+                   ctx->read_char_count);
+            exit(EXIT_FAILURE);
         }
+        first = ctx->range_start;
+        char_count = ctx->range_length;
     }
     
     /*
-     * Nun das jeweilige Bit an das Ende verschieben (z.B. 10000000 -> 00000001)
-     * und mit 1 verunden. Sollte an der jeweiligen Stelle eine 0 stehen, wird
-     * aus der 1 mit der verundet wurde eine 0 -> false.
-     */
-    current_byte = read_bit_buffer;
-    
-    /*
-     * Wenn der Bitshift mal nicht funktioniert DIY ;-)
+     * Im Testmodus wird nichts geschrieben, die Bloecke werden nacheinander
+     * in denselben Puffer von einer Blockgroesse dekodiert. Passt die
+     * Ausgabe mit dem Code nicht in --mem-limit, wird ebenso jeder Block
+     * und ein durchgehender Huffman-Code in Abschnitten dekodiert und sofort
+     * geschrieben.
      */
-    for (i = 0; i < (7 - bit_buffer_index); i++) 
+    output_size = char_count;
+    ctx->verified_checksums = 0;
+    streaming = (!ctx->mmap_mode && !mem_budget_fits(ctx, 2 * char_count))
+              ? TRUE : FALSE;
+    if (streaming && IS_BLOCK_FILE 
+            && !mem_budget_fits(ctx, 2 * ctx->read_block_size))
     {
-        current_byte /= 2;
+        printf("Die Bloecke der Datei (%lu KB) passen nicht in "
+               "--mem-limit.\n", ctx->read_block_size / 1024);
+        exit(EXIT_FAILURE);
+    }
+    if ((ctx->test_mode || streaming) && IS_BLOCK_FILE 
+            && ctx->read_block_size > 0 && ctx->read_block_size < char_count)
+    {
+        output_size = ctx->read_block_size;
+    }
+    else if (streaming)
+    {
+        output_size = KERNEL_CHUNK_SIZE;
+    }
+    if (streaming && ctx->debug_mode)
+    {
+        printf("\tAusgabe in Abschnitten von %lu Zeichen\n", output_size);
     }
-    
-    checkmask = current_byte & checkmask;
     
     /*
-     * Aktualisieren des bit_buffer_index.
+     * Im mmap-Modus dekodieren alle Dekodierer direkt in die auf ihre
+     * endgueltige Groesse gebrachte Ausgabedatei.
      */
-    bit_buffer_index = (bit_buffer_index + 1) % 8;
-    
-    return (int) checkmask;
-}
-
-/** ---------------------------------------------------------------------------
- *  Funktion: get_symbol_from_tree
- *  ------------------------------------------------------------------------ */
-static void get_symbol_from_tree(FILE* p_input_stream, BTREE_NODE *root)
-{
-    int read_bit;
-
-    if (btreenode_is_leaf(root))
+    if (ctx->mmap_mode)
     {
-        *p_decompressed_text = ((SYMBOL*)btreenode_get_data(root))->symbol;
-        p_decompressed_text++;
+        p_mapped_file = mapped_file_create(out_filename, char_count,
+                                           ctx->no_cache_mode);
+        ctx->p_decompressed_text_start = p_mapped_file->data;
     }
     else
     {
-        read_bit = get_next_bit(p_input_stream);
-        if (read_bit && btreenode_get_right(root) != NULL)
+        ctx->p_decompressed_text_start = calloc(output_size + 1,
+                                           sizeof(unsigned char));
+        ENSURE_ENOUGH_MEMORY(ctx->p_decompressed_text_start, "decompress");
+    }
+    
+    if (streaming && !ctx->test_mode)
+    {
+        p_output_stream = fopen(out_filename, "wb");
+        if (p_output_stream == NULL)
+        {
+            printf("Datei zum Schreiben konnte nicht geoeffnet werden.\n");
+            fflush(stdout);
+            exit(EXIT_FAILURE);
+        }
+        p_writer = async_io_open_writer(p_output_stream, IO_MODE,
+                                        ctx->io_depth);
+    }
+    
+    /* Eine leere Datei hat keinen Baum und nichts zu dekodieren. */
+    if (char_count > 0)
+    {
+        if (IS_BLOCK_FILE)
+        {
+            decompress_blocks(ctx, p_input_stream, first, char_count, 
+                              streaming, p_writer);
+        }
+        else
         {
-            get_symbol_from_tree(p_input_stream, btreenode_get_right(root));
+            decompress_stream(ctx, p_input_stream, first, char_count, 
+                              streaming, p_writer);
         }
-        else if (!read_bit && btreenode_get_left(root) != NULL)
+    }
+    
+    if (ctx->debug_mode && !ctx->test_mode && !streaming)
+    {
+        printf("\n----------- Dekomprimierter Text erstellt ------------\n\n");
+        fwrite(ctx->p_decompressed_text_start, sizeof(unsigned char), 
+               char_count, stdout);
+        printf("\n");
+        printf("\n------------- .hc.hd-Datei geschrieben -------------\n\n");
+    }
+    
+    if (ctx->test_mode)
+    {
+        printf("Test erfolgreich: %lu Zeichen dekodiert, %lu Pruefsummen "
+               "geprueft.\n", char_count, ctx->verified_checksums);
+        if ((ctx->read_flags & CONTAINER_FLAG_CHECKSUM) == 0)
         {
-            get_symbol_from_tree(p_input_stream, btreenode_get_left(root));
+            printf("Die Datei enthaelt keine Pruefsummen.\n");
         }
+        free(ctx->p_decompressed_text_start);
+    }
+    else if (ctx->mmap_mode)
+    {
+        mapped_file_close(p_mapped_file);
+    }
+    else if (streaming)
+    {
+        async_io_close(p_writer);
+        fclose(p_output_stream);
+        free(ctx->p_decompressed_text_start);
+    }
+    else
+    {
+        write_decompressed_file(ctx, out_filename, char_count);
+        free(ctx->p_decompressed_text_start);
     }
+    ctx->p_decompressed_text_start = NULL;
+    allocator_free(&ctx->allocator, ctx->p_symbol_start);
+    ctx->p_symbol_start = NULL;
 }
 
 /** ---------------------------------------------------------------------------
- *  Funktion: create_huffman_tree
+ *  Funktion: decompress_stream
  *  ------------------------------------------------------------------------ */
-static BTREE* create_huffman_tree(BINARY_HEAP* p_tree_heap)
+static void decompress_stream(HUFF_CTX *ctx,
+                              FILE *p_input_stream,
+                              unsigned long first,
+                              unsigned long char_count,
+                              BOOL streaming,
+                              ASYNC_IO *p_writer)
 {
-    BTREE* p_new_tree = NULL;
-    BTREE* p_tree1 = NULL;
-    BTREE* p_tree2 = NULL;
-    SYMBOL* p_symbol = NULL;
+    BINARY_HEAP* p_tree_heap;
+    BTREE* p_huffman_tree;
+    SEEK_POINT seek_point;
+    unsigned long seek_position = 0;
+    unsigned long checksum = 0;
+    unsigned long payload_length;
+    unsigned char *p_payload;
+    FSM_DECODER *p_fsm_decoder;
+    DECODE_TABLE decode_table;
+    long data_start = ftell(p_input_stream);
     
-    while (p_tree_heap->count > 1)
+    p_tree_heap = create_tree_heap(ctx);
+    if (ctx->debug_mode)
     {
-        /*
-         * Extrahiere die 2 Teilbaeume mit der kleinsten Haeufigkeit.
-         */
-        heap_extract_min(p_tree_heap, (void**)&p_tree1);
-        heap_extract_min(p_tree_heap, (void**)&p_tree2);
-        
-        p_symbol = calloc(1,sizeof(SYMBOL));
-        
-        ENSURE_ENOUGH_MEMORY(p_symbol, "create_huffman_tree");
-        
-        p_symbol->symbol = 0;
-        p_symbol->count = (unsigned int) (p_tree_heap->get_value(p_tree1) 
-                                + p_tree_heap->get_value(p_tree2));
-        
-        p_new_tree = btree_merge(p_tree1, p_tree2, p_symbol);
+        printf("\n---------------- TreeHeap erstellt ----------------\n\n");
+        heap_print(p_tree_heap);
+    }
+    
+    p_huffman_tree = create_huffman_tree(p_tree_heap);
+    if (ctx->debug_mode)
+    {
+        printf("\n---------------- Huffman-Tree erstellt ----------------\n\n");
+        btree_print(p_huffman_tree);
+    }
+    
+    /*
+     * Bei einem Teilbereich wird, wenn moeglich, der naechste Sprungpunkt
+     * vor dem Bereich angesprungen und nur der Rest bis zum Bereichsanfang
+     * dekodiert.
+     */
+    seek_point.byte_offset = 0;
+    seek_point.bit_offset = 0;
+    if (first > 0)
+    {
+        if (!find_seek_point(ctx, p_input_stream, first,
+                             &seek_point, &seek_position))
+        {
+            seek_point.byte_offset = 0;
+            seek_point.bit_offset = 0;
+            seek_position = 0;
+        }
         
-        heap_insert(p_tree_heap, p_new_tree);
+        if (ctx->debug_mode)
+        {
+            printf("\tSprungpunkt: Zeichen %lu\n", seek_position);
+        }
     }
     
+    decode_table_init(&decode_table, btree_get_root(p_huffman_tree));
+    
     /*
-     * Wenn alles Erfolgreich ist, dann gebe den finalen Codebaum zurueck.
+     * Passt die Ausgabe nicht in die Speichergrenze, dekodiert immer der
+     * Tabellenkernel, nur er kann nach jedem Abschnitt neu aufsetzen.
      */
-    return (heap_extract_min(p_tree_heap,(void**) & p_new_tree)) 
-            ? p_new_tree : NULL;
-}
-
-/** ---------------------------------------------------------------------------
- *  Funktion: create_tree_heap
- *  ------------------------------------------------------------------------ */
-static BINARY_HEAP* create_tree_heap(void)
-{
-    unsigned int i;
-    BTREE* p_tree;
-    BINARY_HEAP* p_tree_heap = heap_init((GET_VALUE)get_count_from_tree,
-                                         (PRINT_VALUE)btree_print, NULL);
+    if (streaming && decode_table.max_length > KERNEL_MAX_CODE_LENGTH)
+    {
+        printf("Die Codes sind fuer --mem-limit zu lang.\n");
+        exit(EXIT_FAILURE);
+    }
     
-    for (i = 0; i < symbol_count; i++)
+    if (streaming)
+    {
+        fseek(p_input_stream, data_start + (long) seek_point.byte_offset,
+              SEEK_SET);
+        checksum = stream_with_kernel(ctx, p_input_stream, &decode_table,
+                                      seek_point.bit_offset, 
+                                      first - seek_position, char_count,
+                                      p_writer);
+    }
+    else if (ctx->decoder_type == DECODER_TREE 
+            || decode_table.max_length > KERNEL_MAX_CODE_LENGTH)
+    {
+        seek_to_point(ctx, p_input_stream, data_start, &seek_point);
+        create_decompressed_text(ctx, p_input_stream, 
+                                 btree_get_root(p_huffman_tree),
+                                 first - seek_position, char_count);
+    }
+    else if (ctx->decoder_type == DECODER_TABLE && ctx->thread_count > 1 
+            && !ctx->range_mode && mem_budget_fits(ctx, 3 * char_count))
     {
         /*
-         * Erzeugen der einzelen Baeume aus den Haeufigkeiten.
+         * Der Huffman-Code hat keine Blockgrenzen, die Threads beginnen
+         * spekulativ und werden ueber die Zeichengrenzen synchronisiert.
+         * Ihre Abschnitte liegen neben der Ausgabe im Speicher, passt das
+         * nicht in --mem-limit, dekodiert ein Thread.
          */
-        p_tree = btree_new(p_symbol_start+i, NULL, (PRINT_FCT) print_symbol);
-
+        p_payload = read_payload(ctx, p_input_stream, CODE_LENGTH_LIMIT,
+                                 &payload_length);
+        if (parallel_decode(&decode_table, p_payload, payload_length,
+                            ctx->p_decompressed_text_start, char_count,
+                            (unsigned int) ctx->thread_count,
+                            ctx->debug_mode) != char_count)
+        {
+            printf("Die komprimierte Datei ist unvollstaendig.\n");
+            exit(EXIT_FAILURE);
+        }
+        free(p_payload);
+    }
+    else if (ctx->decoder_type == DECODER_TABLE || ctx->range_mode)
+    {
+        fseek(p_input_stream, data_start + (long) seek_point.byte_offset,
+              SEEK_SET);
+        decode_with_kernel(ctx, p_input_stream, &decode_table,
+                           seek_point.bit_offset, first - seek_position,
+                           char_count, ctx->p_decompressed_text_start);
+    }
+    else
+    {
         /*
-         * Einfuegen in den HEAP.
+         * Der Automat liest den gesamten Huffman-Code aus dem Speicher und
+         * verarbeitet je Byte genau einen Tabelleneintrag.
          */
-        heap_insert(p_tree_heap, p_tree);
+        p_payload = read_payload(ctx, p_input_stream, CODE_LENGTH_LIMIT,
+                                 &payload_length);
+        p_fsm_decoder = fsm_decoder_new(&ctx->allocator, 
+                                        btree_get_root(p_huffman_tree));
+        
+        if (fsm_decoder_decode(p_fsm_decoder, p_payload, payload_length,
+                               ctx->p_decompressed_text_start, char_count)
+                != char_count)
+        {
+            printf("Die komprimierte Datei ist unvollstaendig.\n");
+            exit(EXIT_FAILURE);
+        }
+        
+        fsm_decoder_destroy(p_fsm_decoder);
+        free(p_payload);
     }
-    return p_tree_heap;
+    
+    /* Die Pruefsumme deckt nur die gesamte Datei ab. */
+    if (READ_CHECKSUM_SIZE > 0 && first == 0 
+            && char_count == ctx->read_char_count)
+    {
+        if (!streaming)
+        {
+            checksum = crc32c_update(0, ctx->p_decompressed_text_start, 
+                                     char_count);
+        }
+        verify_checksum(ctx, p_input_stream, 
+                        data_start + (long) ctx->read_block.code_length,
+                        checksum, 0);
+    }
+    
+    /**
+     * Speicherfreigabe
+     */
+    heap_destroy(p_tree_heap);
+    p_tree_heap = NULL;    
+    
+    destroy_huffman_tree(p_huffman_tree);
+    p_huffman_tree = NULL;
 }
 
 /** ---------------------------------------------------------------------------
- *  Funktion: build_symbol_map
+ *  Funktion: decompress_blocks
  *  ------------------------------------------------------------------------ */
-static void build_symbol_map(char *in_filename)
+static void decompress_blocks(HUFF_CTX *ctx,
+                              FILE *p_input_stream,
+                              unsigned long first,
+                              unsigned long char_count,
+                              BOOL streaming,
+                              ASYNC_IO *p_writer)
 {
-    int symbol;
-    unsigned int i;
-    BOOL symbol_found;    
-    BOOL debug_mode_extra = FALSE;
-    FILE *p_input_stream = fopen(in_filename, "rb");
+    unsigned char *p_output = ctx->p_decompressed_text_start;
+    unsigned long checksum = 0;
+    unsigned long position = 0;
+    unsigned long last = first + char_count;
+    unsigned long skip_count, take_count;
+    long table_start = ctx->container_start + CONTAINER_HEADER_SIZE 
+                     + BLOCK_HEADER_SIZE;
+    long data_start;
+    long huffman_table_start = 0;
+    unsigned int huffman_symbol_count = 0;
+    unsigned long block_number = 0;
+    DECODE_TABLE decode_table;
+    DECODE_TABLE *p_decode_table = &decode_table;
+    BOOL table_valid = FALSE;
+    BOOL first_block = TRUE;
+    IO_CACHE input_cache;
+    ARENA_MARK block_mark;
     
-    symbol_count = 0;
-    read_char_count = 0;
+    /* Die Bloecke werden direkt gelesen, nicht ueber ASYNC_IO. */
+    async_io_cache_init(&input_cache, p_input_stream, FALSE, 
+                        ctx->no_cache_mode);
     
-    if (p_input_stream != NULL)
+    /* Die Symboltabellen werden erst gelesen, wenn ein Block sie braucht. */
+    allocator_free(&ctx->allocator, ctx->p_symbol_start);
+    ctx->p_symbol_start = NULL;
+    
+    /* Mitglieder eines Archivs beginnen mit der gemeinsamen Codetabelle. */
+    if ((ctx->read_flags & CONTAINER_FLAG_SHARED_TABLE) != 0)
+    {
+        huffman_table_start = ctx->shared_table_start;
+        huffman_symbol_count = ctx->shared_symbol_count;
+    }
+    
+    /*
+     * Die Dekodiertabellen liegen nicht im Allokator, eine Arena haelt nur
+     * die Baeume und Tabellen des aktuellen Blocks.
+     */
+    allocator_mark(&ctx->allocator, &block_mark);
+    while (position < last)
     {
-        p_symbol_start = calloc(ALLOC_ELEMENTS, sizeof(SYMBOL));
-        p_symbol = p_symbol_start;
+        /* Der Header des ersten Blocks wurde mit dem Dateiheader gelesen. */
+        if (!first_block)
+        {
+            read_block_header(ctx, p_input_stream);
+            table_start = ftell(p_input_stream);
+        }
+        first_block = FALSE;
+        data_start = table_start + block_table_size(ctx, p_input_stream, 
+                                                    table_start);
         
-        if (p_symbol_start == NULL)
+        /*
+         * Bloecke ohne Zeichen, etwa die gemeinsame Tabelle eines Batches
+         * von huff_compress_batch_shared, liegen nie im Bereich und werden
+         * nur uebersprungen.
+         */
+        if (ctx->read_block.raw_length > ctx->read_char_count - position
+                || (ctx->read_block_size > 0 
+                    && ctx->read_block.raw_length > ctx->read_block_size)
+                || (streaming && ctx->read_block_size == 0
+                    && ctx->read_block.type != BLOCK_TYPE_STORED)
+                || (ctx->read_block.type == BLOCK_TYPE_REPEAT 
+                    && huffman_symbol_count == 0))
         {
-            printf("Nicht genuegend Speicher vorhanden.\n");
-            fflush(stdout);
+            printf("Die komprimierte Datei ist beschaedigt.\n");
             exit(EXIT_FAILURE);
         }
         
-        /* 
+        /*
+         * Die Position der letzten Symboltabelle merken. Aufgebaut wird die
+         * Dekodiertabelle erst fuer einen Block im Bereich und danach von
+         * allen folgenden BLOCK_TYPE_REPEAT Bloecken wiederverwendet.
+         */
+        if (ctx->read_block.type == BLOCK_TYPE_HUFFMAN)
+        {
+            huffman_table_start = table_start;
+            huffman_symbol_count = ctx->symbol_count;
+            table_valid = FALSE;
+        }
+        
+        /*
+         * Bloecke vor dem Bereich werden anhand ihrer Laenge uebersprungen,
+         * ohne die Symboltabelle auszuwerten.
+         */
+        if (position + ctx->read_block.raw_length > first)
+        {
+            skip_count = (first > position) ? first - position : 0;
+            take_count = ctx->read_block.raw_length - skip_count;
+            if (take_count > last - position - skip_count)
+            {
+                take_count = last - position - skip_count;
+            }
+            
+            if (ctx->read_block.type == BLOCK_TYPE_STORED)
+            {
+                /* Gespeicherte Bloecke direkt in die Ausgabe lesen. */
+                fseek(p_input_stream, data_start + (long) skip_count, 
+                      SEEK_SET);
+                checksum = read_stored(ctx, p_input_stream, take_count, 
+                                       p_output, streaming, p_writer);
+            }
+            else if (ctx->read_block.type == BLOCK_TYPE_CONTEXT)
+            {
+                fseek(p_input_stream, table_start, SEEK_SET);
+                decode_context_block(ctx, p_input_stream, ctx->symbol_count, 
+                                     skip_count, take_count, p_output);
+            }
+            else if (ctx->read_block.type == BLOCK_TYPE_WIDE)
+            {
+                fseek(p_input_stream, table_start, SEEK_SET);
+                decode_wide_block(ctx, p_input_stream, skip_count, take_count, 
+                                  p_output);
+            }
+            else if (ctx->read_block.type == BLOCK_TYPE_RLE)
+            {
+                fseek(p_input_stream, table_start, SEEK_SET);
+                decode_rle_block(ctx, p_input_stream, skip_count, take_count, 
+                                 p_output);
+            }
+            else
+            {
+                /* Die gemeinsame Codetabelle wird nur einmal aufgebaut. */
+                p_decode_table = &decode_table;
+                if (huffman_table_start == ctx->shared_table_start
+                        && (ctx->read_flags & CONTAINER_FLAG_SHARED_TABLE) != 0)
+                {
+                    p_decode_table = &ctx->shared_decode_table;
+                    table_valid = ctx->shared_decode_valid;
+                    ctx->shared_decode_valid = TRUE;
+                }
+                if (!table_valid)
+                {
+                    load_decode_table(ctx, p_input_stream, huffman_table_start,
+                                      huffman_symbol_count, p_decode_table);
+                    table_valid = TRUE;
+                }
+                fseek(p_input_stream, data_start, SEEK_SET);
+                decode_with_kernel(ctx, p_input_stream, p_decode_table, 0, 
+                                   skip_count, take_count, p_output);
+            }
+            
+            /* Nur vollstaendig dekodierte Bloecke werden geprueft. */
+            if (READ_CHECKSUM_SIZE > 0 && skip_count == 0 
+                    && take_count == ctx->read_block.raw_length)
+            {
+                if (ctx->read_block.type != BLOCK_TYPE_STORED)
+                {
+                    checksum = crc32c_update(0, p_output, take_count);
+                }
+                verify_checksum(ctx, p_input_stream, 
+                                data_start + (long) ctx->read_block.code_length,
+                                checksum, block_number);
+            }
+            
+            /* Gespeicherte Bloecke hat read_stored bereits geschrieben. */
+            if (p_writer != NULL 
+                    && ctx->read_block.type != BLOCK_TYPE_STORED)
+            {
+                async_io_write(p_writer, p_output, take_count);
+            }
+            else if (!ctx->test_mode && !streaming)
+            {
+                p_output += take_count;
+            }
+        }
+        
+        if (ctx->debug_mode)
+        {
+            printf("\tBlock: Typ %u, %lu Zeichen, %lu Byte\n",
+                   ctx->read_block.type, ctx->read_block.raw_length,
+                   ctx->read_block.code_length);
+        }
+        
+        fseek(p_input_stream, data_start + (long) ctx->read_block.code_length
+                                  + READ_CHECKSUM_SIZE, SEEK_SET);
+        async_io_cache_release(&input_cache, 
+                               (unsigned long) ftell(p_input_stream));
+        position += ctx->read_block.raw_length;
+        block_number++;
+        allocator_rewind(&ctx->allocator, &block_mark);
+    }
+    async_io_cache_finish(&input_cache);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: read_stored
+ *  ------------------------------------------------------------------------ */
+static unsigned long read_stored(HUFF_CTX *ctx,
+                                 FILE *p_input_stream,
+                                 unsigned long length,
+                                 unsigned char *p_output,
+                                 BOOL streaming,
+                                 ASYNC_IO *p_writer)
+{
+    unsigned long checksum = 0;
+    unsigned long chunk_length;
+    
+    while (length > 0)
+    {
+        chunk_length = (streaming && length > KERNEL_CHUNK_SIZE) 
+                     ? KERNEL_CHUNK_SIZE : length;
+        if (fread(p_output, sizeof(unsigned char), chunk_length,
+                  p_input_stream) != chunk_length)
+        {
+            printf("Die komprimierte Datei ist unvollstaendig.\n");
+            exit(EXIT_FAILURE);
+        }
+        
+        if (READ_CHECKSUM_SIZE > 0)
+        {
+            checksum = crc32c_update(checksum, p_output, chunk_length);
+        }
+        if (p_writer != NULL)
+        {
+            async_io_write(p_writer, p_output, chunk_length);
+        }
+        length -= chunk_length;
+    }
+    
+    return checksum;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: block_table_size
+ *  ------------------------------------------------------------------------ */
+static long block_table_size(HUFF_CTX *ctx,
+                             FILE *p_input_stream,
+                             long table_start)
+{
+    unsigned char bytes[4];
+    unsigned long used;
+    
+    if (ctx->read_block.type == BLOCK_TYPE_HUFFMAN)
+    {
+        return (long) (ctx->symbol_count * BLOCK_SYMBOL_SIZE);
+    }
+    if (ctx->read_block.type == BLOCK_TYPE_CONTEXT)
+    {
+        return (long) CONTEXT_MODEL_SIZE(ctx->symbol_count);
+    }
+    if (ctx->read_block.type != BLOCK_TYPE_WIDE 
+            && ctx->read_block.type != BLOCK_TYPE_RLE)
+    {
+        return 0;
+    }
+    
+    /* Die Anzahl der Codelaengen steht am Anfang der Tabelle. */
+    fseek(p_input_stream, table_start, SEEK_SET);
+    if (fread(bytes, sizeof(unsigned char), 4, p_input_stream) != 4)
+    {
+        printf("Die komprimierte Datei ist unvollstaendig.\n");
+        exit(EXIT_FAILURE);
+    }
+    used = load_le(bytes, 4);
+    if (used == 0 || used > WIDE_SYMBOL_COUNT
+            || (ctx->read_block.type == BLOCK_TYPE_RLE 
+                && used > RLE_SYMBOL_COUNT))
+    {
+        printf("Die komprimierte Datei ist beschaedigt.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    return (long) (4 + used * WIDE_ENTRY_SIZE);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_wide_block
+ *  ------------------------------------------------------------------------ */
+static void decode_wide_block(HUFF_CTX *ctx,
+                              FILE *p_input_stream,
+                              unsigned long skip_count,
+                              unsigned long char_count,
+                              unsigned char *p_output)
+{
+    WIDE_DECODER *p_decoder = load_wide_decoder(ctx, p_input_stream, 
+                                                WIDE_SYMBOL_COUNT);
+    DECODE_STATE decode_state;
+    unsigned char *p_payload;
+    unsigned char *p_skip_buffer;
+    unsigned char pair[2];
+    unsigned long payload_length;
+    unsigned long chunk_length;
+    
+    p_payload = read_payload(ctx, p_input_stream, 
+                             ctx->read_block.code_length, &payload_length);
+    decode_state_init(&decode_state, p_payload, payload_length, 0);
+    
+    /* Ganze Zeichen vor dem Bereich ueberspringen. */
+    if (skip_count >= 2)
+    {
+        p_skip_buffer = malloc(KERNEL_CHUNK_SIZE);
+        ENSURE_ENOUGH_MEMORY(p_skip_buffer, "decode_wide_block");
+        
+        while (skip_count >= 2)
+        {
+            chunk_length = (skip_count / 2 < KERNEL_CHUNK_SIZE / 2) 
+                         ? skip_count / 2 : KERNEL_CHUNK_SIZE / 2;
+            if (wide_decode(p_decoder, &decode_state, p_skip_buffer,
+                            chunk_length) != chunk_length)
+            {
+                printf("Die komprimierte Datei ist unvollstaendig.\n");
+                exit(EXIT_FAILURE);
+            }
+            skip_count -= 2 * chunk_length;
+        }
+        free(p_skip_buffer);
+    }
+    
+    /* Ein Bereich kann mit dem oberen Byte eines Zeichens beginnen ... */
+    if (skip_count == 1 && char_count > 0)
+    {
+        if (wide_decode(p_decoder, &decode_state, pair, 1) != 1)
+        {
+            printf("Die komprimierte Datei ist unvollstaendig.\n");
+            exit(EXIT_FAILURE);
+        }
+        *p_output++ = pair[1];
+        char_count--;
+    }
+    
+    if (wide_decode(p_decoder, &decode_state, p_output, char_count / 2) 
+            != char_count / 2)
+    {
+        printf("Die komprimierte Datei ist unvollstaendig.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    /* ... und mit dem unteren Byte eines Zeichens enden. */
+    if (char_count % 2 != 0)
+    {
+        if (wide_decode(p_decoder, &decode_state, pair, 1) != 1)
+        {
+            printf("Die komprimierte Datei ist unvollstaendig.\n");
+            exit(EXIT_FAILURE);
+        }
+        p_output[char_count - 1] = pair[0];
+    }
+    
+    free(p_payload);
+    allocator_free(&ctx->allocator, p_decoder);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: load_wide_decoder
+ *  ------------------------------------------------------------------------ */
+static WIDE_DECODER *load_wide_decoder(HUFF_CTX *ctx,
+                                       FILE *p_input_stream,
+                                       unsigned long symbol_limit)
+{
+    WIDE_DECODER *p_decoder = allocator_alloc(&ctx->allocator, 
+                                              sizeof(WIDE_DECODER));
+    unsigned char *p_lengths = allocator_alloc(&ctx->allocator, 
+                                               WIDE_SYMBOL_COUNT);
+    unsigned char *p_table;
+    unsigned long used;
+    unsigned long symbol;
+    unsigned long previous = 0;
+    unsigned long i;
+    BOOL valid = TRUE;
+    
+    /* Die Anzahl wurde von block_table_size bereits geprueft. */
+    used = (unsigned long) block_table_size(ctx, p_input_stream, 
+                                            ftell(p_input_stream)) - 4;
+    p_table = malloc(used);
+    ENSURE_ENOUGH_MEMORY(p_table, "load_wide_decoder");
+    if (fread(p_table, sizeof(unsigned char), used, p_input_stream) != used)
+    {
+        printf("Die komprimierte Datei ist unvollstaendig.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    /* Die Zeichen muessen aufsteigend und ohne Wiederholung vorliegen. */
+    for (i = 0; i < used; i += WIDE_ENTRY_SIZE)
+    {
+        symbol = load_le(p_table + i, 2);
+        if ((i > 0 && symbol <= previous) || symbol >= symbol_limit
+                || p_table[i + 2] == 0)
+        {
+            valid = FALSE;
+        }
+        p_lengths[symbol] = p_table[i + 2];
+        previous = symbol;
+    }
+    free(p_table);
+    
+    if (!valid || !wide_decoder_init(p_decoder, p_lengths))
+    {
+        printf("Die komprimierte Datei ist beschaedigt.\n");
+        exit(EXIT_FAILURE);
+    }
+    allocator_free(&ctx->allocator, p_lengths);
+    
+    return p_decoder;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_rle_block
+ *  ------------------------------------------------------------------------ */
+static void decode_rle_block(HUFF_CTX *ctx,
+                             FILE *p_input_stream,
+                             unsigned long skip_count,
+                             unsigned long char_count,
+                             unsigned char *p_output)
+{
+    WIDE_DECODER *p_decoder = load_wide_decoder(ctx, p_input_stream, 
+                                                RLE_SYMBOL_COUNT);
+    DECODE_STATE decode_state;
+    RLE_STATE rle_state;
+    unsigned char *p_payload;
+    unsigned char *p_skip_buffer;
+    unsigned long payload_length;
+    unsigned long chunk_length;
+    
+    p_payload = read_payload(ctx, p_input_stream, 
+                             ctx->read_block.code_length, &payload_length);
+    decode_state_init(&decode_state, p_payload, payload_length, 0);
+    rle_state_init(&rle_state);
+    
+    /* Ein Lauf kann ueber den Anfang des Bereichs hinausreichen. */
+    if (skip_count > 0)
+    {
+        p_skip_buffer = malloc(KERNEL_CHUNK_SIZE);
+        ENSURE_ENOUGH_MEMORY(p_skip_buffer, "decode_rle_block");
+        
+        while (skip_count > 0)
+        {
+            chunk_length = (skip_count < KERNEL_CHUNK_SIZE) 
+                         ? skip_count : KERNEL_CHUNK_SIZE;
+            if (rle_decode(p_decoder, &decode_state, &rle_state, 
+                           p_skip_buffer, chunk_length) != chunk_length)
+            {
+                printf("Die komprimierte Datei ist unvollstaendig.\n");
+                exit(EXIT_FAILURE);
+            }
+            skip_count -= chunk_length;
+        }
+        free(p_skip_buffer);
+    }
+    
+    if (rle_decode(p_decoder, &decode_state, &rle_state, p_output,
+                   char_count) != char_count)
+    {
+        printf("Die komprimierte Datei ist unvollstaendig.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    free(p_payload);
+    allocator_free(&ctx->allocator, p_decoder);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_context_block
+ *  ------------------------------------------------------------------------ */
+static void decode_context_block(HUFF_CTX *ctx,
+                                 FILE *p_input_stream,
+                                 unsigned int table_count,
+                                 unsigned long skip_count,
+                                 unsigned long char_count,
+                                 unsigned char *p_output)
+{
+    CONTEXT_MODEL model;
+    SYMBOL symbols[256];
+    DECODE_STATE decode_state;
+    DECODE_TABLE *p_tables = allocator_alloc(&ctx->allocator, table_count 
+                                             * sizeof(DECODE_TABLE));
+    BTREE *p_huffman_tree;
+    unsigned char *p_payload;
+    unsigned char *p_skip_buffer;
+    unsigned char previous = 0;
+    unsigned long payload_length;
+    unsigned long chunk_length;
+    unsigned int i;
+    
+    if (fread(model.context_map, sizeof(unsigned char), CONTEXT_COUNT,
+              p_input_stream) != CONTEXT_COUNT
+            || fread(model.lengths, sizeof(unsigned char), table_count * 256,
+                     p_input_stream) != table_count * 256)
+    {
+        printf("Die komprimierte Datei ist unvollstaendig.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    for (i = 0; i < CONTEXT_COUNT; i++)
+    {
+        if (model.context_map[i] >= table_count)
+        {
+            printf("Die komprimierte Datei ist beschaedigt.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    
+    /* Aus den Codelaengen die Baeume der kanonischen Codes erzeugen. */
+    for (i = 0; i < table_count; i++)
+    {
+        p_huffman_tree = context_tree_new(&ctx->allocator, model.lengths[i],
+                                          symbols);
+        if (p_huffman_tree == NULL)
+        {
+            printf("Die komprimierte Datei ist beschaedigt.\n");
+            exit(EXIT_FAILURE);
+        }
+        decode_table_init(&p_tables[i], btree_get_root(p_huffman_tree));
+        destroy_huffman_tree(p_huffman_tree);
+    }
+    
+    p_payload = read_payload(ctx, p_input_stream, 
+                             ctx->read_block.code_length, &payload_length);
+    decode_state_init(&decode_state, p_payload, payload_length, 0);
+    
+    /* Uebersprungene Zeichen bestimmen den Kontext der folgenden. */
+    if (skip_count > 0)
+    {
+        p_skip_buffer = malloc(KERNEL_CHUNK_SIZE);
+        ENSURE_ENOUGH_MEMORY(p_skip_buffer, "decode_context_block");
+        
+        while (skip_count > 0)
+        {
+            chunk_length = (skip_count < KERNEL_CHUNK_SIZE) 
+                         ? skip_count : KERNEL_CHUNK_SIZE;
+            if (context_decode(p_tables, model.context_map, &decode_state,
+                               p_skip_buffer, chunk_length, &previous) 
+                    != chunk_length)
+            {
+                printf("Die komprimierte Datei ist unvollstaendig.\n");
+                exit(EXIT_FAILURE);
+            }
+            skip_count -= chunk_length;
+        }
+        free(p_skip_buffer);
+    }
+    
+    if (context_decode(p_tables, model.context_map, &decode_state, p_output,
+                       char_count, &previous) != char_count)
+    {
+        printf("Die komprimierte Datei ist unvollstaendig.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    free(p_payload);
+    allocator_free(&ctx->allocator, p_tables);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: load_decode_table
+ *  ------------------------------------------------------------------------ */
+static void load_decode_table(HUFF_CTX *ctx,
+                              FILE *p_input_stream,
+                              long table_start,
+                              unsigned int table_symbol_count,
+                              DECODE_TABLE *p_decode_table)
+{
+    BINARY_HEAP* p_tree_heap;
+    BTREE* p_huffman_tree;
+    
+    fseek(p_input_stream, table_start, SEEK_SET);
+    ctx->symbol_count = table_symbol_count;
+    read_symbol_table(ctx, p_input_stream, BLOCK_SYMBOL_SIZE);
+    
+    p_tree_heap = create_tree_heap(ctx);
+    p_huffman_tree = create_huffman_tree(p_tree_heap);
+    decode_table_init(p_decode_table, btree_get_root(p_huffman_tree));
+    if (p_decode_table->max_length > KERNEL_MAX_CODE_LENGTH)
+    {
+        printf("Die komprimierte Datei ist beschaedigt.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    heap_destroy(p_tree_heap);
+    destroy_huffman_tree(p_huffman_tree);
+    allocator_free(&ctx->allocator, ctx->p_symbol_start);
+    ctx->p_symbol_start = NULL;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: destroy_huffman_tree
+ *  ------------------------------------------------------------------------ */
+extern void destroy_huffman_tree(BTREE *p_huffman_tree)
+{
+    if (p_huffman_tree == NULL)
+    {
+        return;
+    }
+    
+    /*
+     * In einer Arena gibt der Auftrag den Baum mit allem anderen frei, hier
+     * wuerde die Freigabe auch Speicher anderer Baeume treffen.
+     */
+    if (allocator_is_arena(p_huffman_tree->allocator))
+    {
+        return;
+    }
+    
+    free_inner_symbols(p_huffman_tree->allocator, 
+                       btree_get_root(p_huffman_tree));
+    btree_destroy(&p_huffman_tree, FALSE);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: free_inner_symbols
+ *  ------------------------------------------------------------------------ */
+static void free_inner_symbols(ALLOCATOR *allocator, BTREE_NODE *node)
+{
+    if (node == NULL || btreenode_is_leaf(node))
+    {
+        return;
+    }
+    
+    free_inner_symbols(allocator, btreenode_get_left(node));
+    free_inner_symbols(allocator, btreenode_get_right(node));
+    allocator_free(allocator, btreenode_get_data(node));
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: train
+ *  ------------------------------------------------------------------------ */
+extern void train(HUFF_CTX *ctx, char *in_filename, char *out_filename)
+{
+    unsigned long counts[256];
+    unsigned char header[DICTIONARY_HEADER_SIZE];
+    unsigned char *p_buffer = malloc(KERNEL_CHUNK_SIZE);
+    unsigned long read_length;
+    unsigned long bits = 0;
+    unsigned long i;
+    CODE_TABLE code_table;
+    BTREE *p_huffman_tree;
+    FILE *p_input_stream = fopen(in_filename, "rb");
+    FILE *p_output_stream;
+    
+    if (p_input_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    ENSURE_ENOUGH_MEMORY(p_buffer, "train");
+    
+    /*
+     * Jedes Zeichen erhaelt mindestens die Haeufigkeit 1, damit auch
+     * Nachrichten mit Zeichen ausserhalb des Korpus kodiert werden koennen.
+     */
+    for (i = 0; i < 256; i++)
+    {
+        counts[i] = 1;
+    }
+    ctx->read_char_count = 0;
+    do
+    {
+        read_length = (unsigned long) fread(p_buffer, sizeof(unsigned char),
+                                            KERNEL_CHUNK_SIZE, p_input_stream);
+        for (i = 0; i < read_length; i++)
+        {
+            counts[p_buffer[i]]++;
+        }
+        ctx->read_char_count += read_length;
+    }
+    while (read_length == KERNEL_CHUNK_SIZE);
+    fclose(p_input_stream);
+    free(p_buffer);
+    
+    /*
+     * Die Kernel verarbeiten nur Codes bis KERNEL_MAX_CODE_LENGTH Bits. Bei
+     * sehr ungleichen Haeufigkeiten werden diese halbiert, bis alle Codes
+     * kurz genug sind.
+     */
+    p_huffman_tree = create_block_codes(ctx, counts);
+    code_table_init(&code_table, ctx->p_symbol_start, ctx->symbol_count);
+    while (code_table.max_length > KERNEL_MAX_CODE_LENGTH)
+    {
+        free_codes(ctx);
+        destroy_huffman_tree(p_huffman_tree);
+        allocator_free(&ctx->allocator, ctx->p_symbol_start);
+        for (i = 0; i < 256; i++)
+        {
+            counts[i] = counts[i] / 2 + 1;
+        }
+        p_huffman_tree = create_block_codes(ctx, counts);
+        code_table_init(&code_table, ctx->p_symbol_start, ctx->symbol_count);
+    }
+    
+    for (i = 0; i < 256; i++)
+    {
+        bits += (counts[i] - 1) * code_table.entries[i].length;
+    }
+    
+    p_output_stream = fopen(out_filename, "wb");
+    if (p_output_stream == NULL)
+    {
+        printf("Datei zum Schreiben konnte nicht geoeffnet werden.\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    
+    memset(header, 0, DICTIONARY_HEADER_SIZE);
+    memcpy(header, DICTIONARY_MAGIC, 4);
+    header[4] = DICTIONARY_VERSION;
+    store_le(header + 6, ctx->symbol_count, 2);
+    store_le(header + 8, huff_dict_code_id(&code_table), DICTIONARY_ID_SIZE);
+    if (fwrite(header, sizeof(unsigned char), DICTIONARY_HEADER_SIZE,
+               p_output_stream) != DICTIONARY_HEADER_SIZE)
+    {
+        printf("Fehler beim schreiben des Woerterbuchs.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    /* Die Eintraege haben das Format der Symboltabelle eines Blocks. */
+    write_symbol_table(ctx, p_output_stream);
+    fclose(p_output_stream);
+    
+    printf("Woerterbuch aus %lu Zeichen erstellt, %.3f Bit je Zeichen, "
+           "laengster Code %u Bit.\n", ctx->read_char_count,
+           (ctx->read_char_count > 0) 
+                ? (double) bits / ctx->read_char_count : 0.0,
+           code_table.max_length);
+    
+    free_codes(ctx);
+    destroy_huffman_tree(p_huffman_tree);
+    allocator_free(&ctx->allocator, ctx->p_symbol_start);
+    ctx->p_symbol_start = NULL;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: load_dictionary
+ *  ------------------------------------------------------------------------ */
+extern void load_dictionary(HUFF_CTX *ctx)
+{
+    unsigned char *p_content;
+    unsigned long content_length;
+    FILE *p_input_stream;
+    
+    if (ctx->dictionary_loaded)
+    {
+        return;
+    }
+    
+    p_input_stream = fopen(ctx->dictionary_filename, "rb");
+    if (p_input_stream == NULL)
+    {
+        printf("Woerterbuch Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    p_content = read_payload(ctx, p_input_stream, (unsigned long) -1, 
+                             &content_length);
+    fclose(p_input_stream);
+    
+    /*
+     * Baum und Tabellen werden genau einmal aufgebaut und danach fuer jede
+     * Nachricht wiederverwendet.
+     */
+    if (!huff_dict_init(&ctx->dictionary, p_content, content_length))
+    {
+        printf("Die Datei %s ist kein gueltiges Woerterbuch.\n",
+               ctx->dictionary_filename);
+        exit(EXIT_FAILURE);
+    }
+    free(p_content);
+    ctx->dictionary_loaded = TRUE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: compress_message
+ *  ------------------------------------------------------------------------ */
+static void compress_message(HUFF_CTX *ctx,
+                             char *in_filename,
+                             char *out_filename)
+{
+    unsigned char *p_input;
+    unsigned char *p_output;
+    unsigned long input_length;
+    unsigned long output_capacity;
+    unsigned long output_length;
+    FILE *p_input_stream = fopen(in_filename, "rb");
+    FILE *p_output_stream;
+    
+    if (p_input_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    load_dictionary(ctx);
+    
+    p_input = read_payload(ctx, p_input_stream, (unsigned long) -1, 
+                           &input_length);
+    fclose(p_input_stream);
+    output_capacity = huff_dict_compress_bound(&ctx->dictionary, 
+                                               input_length);
+    p_output = malloc(output_capacity);
+    ENSURE_ENOUGH_MEMORY(p_output, "compress_message");
+    output_length = huff_dict_compress(&ctx->dictionary, p_input, 
+                                       input_length, p_output, 
+                                       output_capacity);
+    
+    p_output_stream = fopen(out_filename, "wb");
+    if (p_output_stream == NULL)
+    {
+        printf("Datei zum Schreiben konnte nicht geoeffnet werden.\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    if (fwrite(p_output, sizeof(unsigned char), output_length, 
+               p_output_stream) != output_length)
+    {
+        printf("Fehler beim schreiben des Huffman-Codes.\n");
+        exit(EXIT_FAILURE);
+    }
+    fclose(p_output_stream);
+    
+    if (ctx->debug_mode)
+    {
+        printf("\tNachricht: %lu Zeichen, %lu Byte, Woerterbuch %08lx\n", 
+               input_length, output_length, ctx->dictionary.id);
+    }
+    
+    free(p_input);
+    free(p_output);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decompress_message
+ *  ------------------------------------------------------------------------ */
+static void decompress_message(HUFF_CTX *ctx,
+                               char *in_filename,
+                               char *out_filename)
+{
+    unsigned char *p_input;
+    unsigned long input_length;
+    unsigned long char_count;
+    FILE *p_input_stream = fopen(in_filename, "rb");
+    
+    if (p_input_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    load_dictionary(ctx);
+    
+    p_input = read_payload(ctx, p_input_stream, (unsigned long) -1, 
+                           &input_length);
+    fclose(p_input_stream);
+    
+    /* Ein Container wird ohne Woerterbuch dekomprimiert. */
+    if (input_length >= 4 && memcmp(p_input, CONTAINER_MAGIC, 4) == 0)
+    {
+        printf("Die Datei ist keine Nachricht, sondern eine komprimierte "
+               "Datei und wird ohne --dict dekomprimiert.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (!huff_dict_matches(&ctx->dictionary, p_input, input_length))
+    {
+        printf("Die Nachricht wurde nicht mit dem Woerterbuch %s "
+               "komprimiert.\n", ctx->dictionary_filename);
+        exit(EXIT_FAILURE);
+    }
+    
+    char_count = huff_dict_decompressed_size(&ctx->dictionary, p_input, 
+                                             input_length);
+    ctx->p_decompressed_text_start = (char_count != HUFF_BUFFER_ERROR) 
+                                     ? malloc(char_count + 1) : NULL;
+    if (char_count == HUFF_BUFFER_ERROR
+            || (ctx->p_decompressed_text_start != NULL
+                && huff_dict_decompress(&ctx->dictionary, p_input, 
+                                        input_length, 
+                                        ctx->p_decompressed_text_start,
+                                        char_count) != char_count))
+    {
+        printf("Die komprimierte Datei ist beschaedigt.\n");
+        exit(EXIT_FAILURE);
+    }
+    ENSURE_ENOUGH_MEMORY(ctx->p_decompressed_text_start, "decompress_message");
+    free(p_input);
+    
+    if (ctx->test_mode)
+    {
+        printf("Test erfolgreich: %lu Zeichen dekodiert.\n", char_count);
+    }
+    else
+    {
+        write_decompressed_file(ctx, out_filename, char_count);
+    }
+    free(ctx->p_decompressed_text_start);
+    ctx->p_decompressed_text_start = NULL;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: benchmark
+ *  ------------------------------------------------------------------------ */
+extern void benchmark(HUFF_CTX *ctx, char *in_filename)
+{
+    FILE *p_input_stream = fopen(in_filename,"rb");
+    BINARY_HEAP* p_tree_heap;
+    BTREE* p_huffman_tree;
+    FSM_DECODER *p_fsm_decoder;
+    DECODE_TABLE decode_table;
+    CODE_TABLE code_table;
+    unsigned char *p_reference;
+    unsigned char *p_output;
+    unsigned char *p_payload;
+    unsigned char *p_encoded;
+    unsigned char *p_encoded_bmi2;
+    char *p_code;
+    unsigned long payload_length;
+    unsigned long encoded_length;
+    unsigned long encoded_length_bmi2;
+    long data_start;
+    clock_t start;
+    double seconds, best_seconds;
+    BOOL correct;
+    unsigned int run;
+    
+    if (p_input_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    
+    read_header(ctx, p_input_stream);
+    data_start = ftell(p_input_stream);
+    if (IS_BLOCK_FILE)
+    {
+        printf("Der Benchmark benoetigt eine Datei aus einem "
+               "Huffman-Block.\n");
+        fclose(p_input_stream);
+        return;
+    }
+    if (ctx->symbol_count == 0)
+    {
+        printf("Die Datei ist leer.\n");
+        fclose(p_input_stream);
+        return;
+    }
+    p_tree_heap = create_tree_heap(ctx);
+    p_huffman_tree = create_huffman_tree(p_tree_heap);
+    p_payload = read_payload(ctx, p_input_stream, CODE_LENGTH_LIMIT,
+                             &payload_length);
+    
+    p_output = calloc(ctx->read_char_count + 1, sizeof(unsigned char));
+    ENSURE_ENOUGH_MEMORY(p_output, "benchmark");
+    decode_table_init(&decode_table, btree_get_root(p_huffman_tree));
+    
+    printf("\n---------------- Benchmark Dekodierer ----------------\n\n");
+    printf("\tZeichen: %lu, Huffman-Code: %lu Byte\n\n",
+           ctx->read_char_count, payload_length);
+    
+    /*
+     * Baum-Dekodierer: liest Bit fuer Bit aus der Datei und dient als
+     * Referenz fuer alle anderen Dekodierer.
+     */
+    p_reference = calloc(ctx->read_char_count + 1, sizeof(unsigned char));
+    ENSURE_ENOUGH_MEMORY(p_reference, "benchmark");
+    ctx->p_decompressed_text_start = p_reference;
+    best_seconds = -1;
+    for (run = 0; run < BENCHMARK_RUNS; run++)
+    {
+        fseek(p_input_stream, data_start, SEEK_SET);
+        ctx->bit_buffer_index = 0;
+        start = clock();
+        create_decompressed_text(ctx, p_input_stream, 
+                                 btree_get_root(p_huffman_tree),
+                                 0, ctx->read_char_count);
+        seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+        if (best_seconds < 0 || seconds < best_seconds) best_seconds = seconds;
+    }
+    print_benchmark_result(ctx, "tree", best_seconds, TRUE);
+    
+    /*
+     * Automat: ein Tabelleneintrag je Byte des Huffman-Codes. Der Aufbau
+     * der Tabelle wird mitgemessen.
+     */
+    best_seconds = -1;
+    for (run = 0; run < BENCHMARK_RUNS; run++)
+    {
+        memset(p_output, 0, ctx->read_char_count);
+        start = clock();
+        p_fsm_decoder = fsm_decoder_new(&ctx->allocator, 
+                                        btree_get_root(p_huffman_tree));
+        fsm_decoder_decode(p_fsm_decoder, p_payload, payload_length,
+                           p_output, ctx->read_char_count);
+        fsm_decoder_destroy(p_fsm_decoder);
+        seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+        if (best_seconds < 0 || seconds < best_seconds) best_seconds = seconds;
+    }
+    correct = memcmp(p_output, p_reference, ctx->read_char_count) == 0;
+    print_benchmark_result(ctx, "fsm", best_seconds, correct);
+    
+    /*
+     * Tabellen-Dekodierer: portabler Kernel und, wenn der Prozessor es
+     * unterstuetzt, der BMI2-Kernel.
+     */
+    if (decode_table.max_length <= KERNEL_MAX_CODE_LENGTH)
+    {
+        best_seconds = benchmark_decode_kernel(ctx, decode_portable,
+                                               &decode_table,
+                                               p_payload, payload_length,
+                                               p_output);
+        correct = memcmp(p_output, p_reference, ctx->read_char_count) == 0;
+        print_benchmark_result(ctx, "table", best_seconds, correct);
+        
+        if (kernels_bmi2_available())
+        {
+            best_seconds = benchmark_decode_kernel(ctx, decode_bmi2,
+                                                   &decode_table,
+                                                   p_payload, payload_length,
+                                                   p_output);
+            correct = memcmp(p_output, p_reference, ctx->read_char_count) == 0;
+            print_benchmark_result(ctx, "table-bmi2", best_seconds, correct);
+        }
+        
+        /*
+         * Kodierkernel: der dekomprimierte Text wird erneut kodiert und muss
+         * Bit fuer Bit dem Huffman-Code der Datei entsprechen.
+         */
+        p_code = allocator_alloc(&ctx->allocator, (size_t) 
+                        btree_get_max_depth(btree_get_root(p_huffman_tree)) 
+                        + 1);
+        create_code_table(ctx, btree_get_root(p_huffman_tree), p_code, p_code,
+                          1);
+        code_table_init(&code_table, ctx->p_symbol_start, ctx->symbol_count);
+        allocator_free(&ctx->allocator, p_code);
+        
+        p_encoded = malloc(ctx->read_char_count / 8 * code_table.max_length
+                           + code_table.max_length + KERNEL_OUTPUT_SLACK);
+        p_encoded_bmi2 = malloc(ctx->read_char_count / 8 * code_table.max_length
+                                + code_table.max_length + KERNEL_OUTPUT_SLACK);
+        ENSURE_ENOUGH_MEMORY(p_encoded, "benchmark");
+        ENSURE_ENOUGH_MEMORY(p_encoded_bmi2, "benchmark");
+        
+        printf("\n");
+        best_seconds = benchmark_encode_kernel(ctx, encode_portable,
+                                               &code_table, p_reference,
+                                               p_encoded,
+                                               &encoded_length);
+        correct = encoded_length <= payload_length
+                && memcmp(p_encoded, p_payload, encoded_length) == 0;
+        print_benchmark_result(ctx, "encode", best_seconds, correct);
+        
+        if (kernels_bmi2_available())
+        {
+            best_seconds = benchmark_encode_kernel(ctx, encode_bmi2,
+                                                   &code_table, p_reference,
+                                                   p_encoded_bmi2,
+                                                   &encoded_length_bmi2);
+            correct = encoded_length_bmi2 == encoded_length
+                    && memcmp(p_encoded_bmi2, p_encoded, encoded_length) == 0;
+            print_benchmark_result(ctx, "encode-bmi2", best_seconds, correct);
+        }
+        
+        free(p_encoded);
+        free(p_encoded_bmi2);
+    }
+    
+    /**
+     * Speicherfreigabe
+     */
+    fclose(p_input_stream);
+    free(p_reference);
+    ctx->p_decompressed_text_start = NULL;
+    free(p_output);
+    free(p_payload);
+    heap_destroy(p_tree_heap);
+    destroy_huffman_tree(p_huffman_tree);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: benchmark_decode_kernel
+ *  ------------------------------------------------------------------------ */
+static double benchmark_decode_kernel(HUFF_CTX *ctx,
+                                      DECODE_KERNEL kernel,
+                                      DECODE_TABLE *p_decode_table,
+                                      unsigned char *p_payload,
+                                      unsigned long payload_length,
+                                      unsigned char *p_output)
+{
+    DECODE_STATE decode_state;
+    clock_t start;
+    double seconds, best_seconds = -1;
+    unsigned int run;
+    
+    for (run = 0; run < BENCHMARK_RUNS; run++)
+    {
+        memset(p_output, 0, ctx->read_char_count);
+        start = clock();
+        decode_state_init(&decode_state, p_payload, payload_length, 0);
+        kernel(p_decode_table, &decode_state, p_output, ctx->read_char_count);
+        seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+        if (best_seconds < 0 || seconds < best_seconds) best_seconds = seconds;
+    }
+    
+    return best_seconds;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: benchmark_encode_kernel
+ *  ------------------------------------------------------------------------ */
+static double benchmark_encode_kernel(HUFF_CTX *ctx,
+                                      ENCODE_KERNEL kernel,
+                                      CODE_TABLE *p_code_table,
+                                      unsigned char *p_text,
+                                      unsigned char *p_output,
+                                      unsigned long *p_length)
+{
+    ENCODE_STATE encode_state;
+    clock_t start;
+    double seconds, best_seconds = -1;
+    unsigned int run;
+    
+    for (run = 0; run < BENCHMARK_RUNS; run++)
+    {
+        start = clock();
+        encode_state_init(&encode_state);
+        *p_length = kernel(p_code_table, &encode_state, p_text,
+                           ctx->read_char_count, p_output);
+        *p_length += encode_state_flush(&encode_state, p_output + *p_length);
+        seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+        if (best_seconds < 0 || seconds < best_seconds) best_seconds = seconds;
+    }
+    
+    return best_seconds;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: print_benchmark_result
+ *  ------------------------------------------------------------------------ */
+static void print_benchmark_result(HUFF_CTX *ctx,
+                                   char *name,
+                                   double seconds,
+                                   BOOL correct)
+{
+    if (seconds > 0)
+    {
+        printf("\t%-12s %10.4f s %10.2f MB/s  %s\n", name, seconds,
+               (double) ctx->read_char_count / seconds / (1024.0 * 1024.0),
+               (correct) ? "OK" : "FEHLER");
+    }
+    else
+    {
+        printf("\t%-12s %10.4f s %10s MB/s  %s\n", name, seconds, "-",
+               (correct) ? "OK" : "FEHLER");
+    }
+    fflush(stdout);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: read_payload
+ *  ------------------------------------------------------------------------ */
+extern unsigned char *read_payload(HUFF_CTX *ctx,
+                                   FILE *p_input_stream,
+                                   unsigned long max_length,
+                                   unsigned long *p_length)
+{
+    long data_start = ftell(p_input_stream);
+    unsigned char *p_payload;
+    ASYNC_IO *p_reader;
+    
+    fseek(p_input_stream, 0, SEEK_END);
+    *p_length = (unsigned long) (ftell(p_input_stream) - data_start);
+    fseek(p_input_stream, data_start, SEEK_SET);
+    
+    if (*p_length > max_length)
+    {
+        *p_length = max_length;
+    }
+    
+    p_payload = malloc(*p_length + 1);
+    ENSURE_ENOUGH_MEMORY(p_payload, "read_payload");
+    
+    p_reader = async_io_open_reader(p_input_stream, *p_length, 
+                                    IO_MODE, ctx->io_depth);
+    if (async_io_read(p_reader, p_payload, *p_length) != *p_length)
+    {
+        printf("Fehler beim einlesen des Huffman-Codes.\n");
+        exit(EXIT_FAILURE);
+    }
+    async_io_close(p_reader);
+    
+    return p_payload;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_with_kernel
+ *  ------------------------------------------------------------------------ */
+static void decode_with_kernel(HUFF_CTX *ctx,
+                               FILE *p_input_stream,
+                               DECODE_TABLE *p_decode_table,
+                               unsigned int bit_offset,
+                               unsigned long skip_count,
+                               unsigned long char_count,
+                               unsigned char *p_output)
+{
+    DECODE_STATE decode_state;
+    unsigned char *p_payload;
+    unsigned char *p_skip_buffer;
+    unsigned long payload_length;
+    unsigned long max_length;
+    unsigned long chunk_length;
+    
+    /*
+     * Jedes Zeichen belegt hoechstens max_length Bits, mehr muss auch fuer
+     * einen Teilbereich nicht gelesen werden.
+     */
+    max_length = ((skip_count + char_count) * p_decode_table->max_length
+                  + bit_offset + 7) / 8;
+    p_payload = read_payload(ctx, p_input_stream, max_length, &payload_length);
+    decode_state_init(&decode_state, p_payload, payload_length, bit_offset);
+    
+    if (skip_count > 0)
+    {
+        p_skip_buffer = malloc(KERNEL_CHUNK_SIZE);
+        ENSURE_ENOUGH_MEMORY(p_skip_buffer, "decode_with_kernel");
+        
+        while (skip_count > 0)
+        {
+            chunk_length = (skip_count < KERNEL_CHUNK_SIZE) 
+                         ? skip_count : KERNEL_CHUNK_SIZE;
+            if (kernel_decode(p_decode_table, &decode_state, p_skip_buffer,
+                              chunk_length) != chunk_length)
+            {
+                printf("Die komprimierte Datei ist unvollstaendig.\n");
+                exit(EXIT_FAILURE);
+            }
+            skip_count -= chunk_length;
+        }
+        free(p_skip_buffer);
+    }
+    
+    if (kernel_decode(p_decode_table, &decode_state, 
+                      p_output, char_count) != char_count)
+    {
+        printf("Die komprimierte Datei ist unvollstaendig.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    free(p_payload);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: stream_with_kernel
+ *  ------------------------------------------------------------------------ */
+static unsigned long stream_with_kernel(HUFF_CTX *ctx,
+                                        FILE *p_input_stream,
+                                        DECODE_TABLE *p_decode_table,
+                                        unsigned int bit_offset,
+                                        unsigned long skip_count,
+                                        unsigned long char_count,
+                                        ASYNC_IO *p_writer)
+{
+    DECODE_STATE decode_state;
+    unsigned char *p_output = ctx->p_decompressed_text_start;
+    unsigned char *p_window;
+    unsigned long window_size;
+    unsigned long window_length;
+    unsigned long chunk_length;
+    unsigned long remaining = skip_count + char_count;
+    unsigned long bit_position = bit_offset;
+    unsigned long checksum = 0;
+    long code_start = ftell(p_input_stream);
+    IO_CACHE input_cache;
+    
+    async_io_cache_init(&input_cache, p_input_stream, FALSE, 
+                        ctx->no_cache_mode);
+    
+    /*
+     * Ein Abschnitt belegt hoechstens KERNEL_CHUNK_SIZE * max_length Bits
+     * ab einem beliebigen Bit seines ersten Bytes.
+     */
+    window_size = (KERNEL_CHUNK_SIZE * p_decode_table->max_length + 14) / 8;
+    p_window = malloc(window_size + 1);
+    ENSURE_ENOUGH_MEMORY(p_window, "stream_with_kernel");
+    
+    while (remaining > 0)
+    {
+        chunk_length = (remaining < KERNEL_CHUNK_SIZE) 
+                     ? remaining : KERNEL_CHUNK_SIZE;
+        fseek(p_input_stream, code_start + (long) (bit_position / 8), 
+              SEEK_SET);
+        window_length = (unsigned long) fread(p_window, sizeof(unsigned char), 
+                                              window_size, p_input_stream);
+        decode_state_init(&decode_state, p_window, window_length,
+                          (unsigned int) (bit_position % 8));
+        if (kernel_decode(p_decode_table, &decode_state, p_output,
+                          chunk_length) != chunk_length)
+        {
+            printf("Die komprimierte Datei ist unvollstaendig.\n");
+            exit(EXIT_FAILURE);
+        }
+        
+        /* Gelesene aber nicht verbrauchte Bits gehoeren zum naechsten. */
+        bit_position = (bit_position / 8 
+                        + (unsigned long) (decode_state.p_next - p_window)) * 8
+                     - decode_state.bit_count;
+        async_io_cache_release(&input_cache, 
+                               (unsigned long) code_start + bit_position / 8);
+        
+        /* Zeichen vor dem Bereich werden nur dekodiert. */
+        if (skip_count >= chunk_length)
+        {
+            skip_count -= chunk_length;
+        }
+        else
+        {
+            checksum = crc32c_update(checksum, p_output + skip_count,
+                                     chunk_length - skip_count);
+            if (p_writer != NULL)
+            {
+                async_io_write(p_writer, p_output + skip_count, 
+                               chunk_length - skip_count);
+            }
+            skip_count = 0;
+        }
+        remaining -= chunk_length;
+    }
+    
+    async_io_cache_finish(&input_cache);
+    free(p_window);
+    return checksum;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: get_count_from_tree
+ *  ------------------------------------------------------------------------ */
+static unsigned long get_count_from_tree(BTREE* tree)
+{
+    BTREE_NODE* root = btree_get_root(tree);
+    SYMBOL* symbol = btreenode_get_data(root);
+    
+    return symbol->count;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: create_code_table
+ *  ------------------------------------------------------------------------ */
+static void create_code_table(HUFF_CTX *ctx,
+                              BTREE_NODE *root,
+                                char *p_current_bit,
+                                char *p_start_bit,
+                                unsigned int depth)
+{
+    if (btreenode_is_leaf(root))
+    {
+        /*
+         * Es liegt ein Blatt vor terminiere die Zeichenkette des Codes.
+         */
+        *p_current_bit = '\0';
+        
+        ctx->p_symbol = ctx->p_symbol_start;
+        while (ctx->p_symbol->symbol 
+                != ((SYMBOL*)btreenode_get_data(root))->symbol)
+        {
+            ctx->p_symbol++;
+        }
+        
+        ctx->p_symbol->code = allocator_alloc(&ctx->allocator,
+                                              strlen(p_start_bit) + 1);
+        strcpy(ctx->p_symbol->code, p_start_bit);
+    }
+    else
+    {
+        /*
+         * Kein Blatt? Dann Baum weiter traversieren.
+         */
+        if (btreenode_get_left(root) != NULL)
+        {
+            *p_current_bit = '0';
+            create_code_table(ctx, btreenode_get_left(root),
+                              p_current_bit  + 1,
+                              p_start_bit,
+                              depth + 1);
+        }
+        if (btreenode_get_right(root) != NULL) 
+        {
+            *p_current_bit = '1';
+            create_code_table(ctx, btreenode_get_right(root),
+                              p_current_bit  + 1,
+                              p_start_bit,
+                              depth + 1);
+        }
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: create_decompressed_text
+ *  ------------------------------------------------------------------------ */
+static void create_decompressed_text(HUFF_CTX *ctx,
+                                     FILE *p_input_stream,
+                                     BTREE_NODE *root,
+                                     unsigned long skip_count,
+                                     unsigned long char_count)
+{
+    unsigned long i;
+    
+    ctx->p_decompressed_text = ctx->p_decompressed_text_start;
+    
+    for (i = 0; i < skip_count; i++)
+    {
+        get_symbol_from_tree(ctx, p_input_stream, root);
+    }
+    
+    for (i = 0; i < char_count; i++)
+    {
+        *ctx->p_decompressed_text = 
+                get_symbol_from_tree(ctx, p_input_stream, root);
+        ctx->p_decompressed_text++;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: get_next_bit
+ *  ------------------------------------------------------------------------ */
+static int get_next_bit(HUFF_CTX *ctx, FILE *p_input_stream)
+{
+    unsigned int i;
+    size_t read_byte;
+    unsigned char current_byte;
+    unsigned char checkmask = 1;
+    
+    /*
+     * Lesen eines Bytes wenn notwendig.
+     */
+    if (ctx->bit_buffer_index == 0)
+    {
+        read_byte = (unsigned int) fread(&ctx->read_bit_buffer, 
+                                         sizeof(unsigned char), 
+                                         1, 
+                                         p_input_stream);
+        /*
+         * Wenn nichts mehr gelesen wurde -1 zurueckgeben.
+         */
+        if (read_byte != 1) 
+        {
+            return -1;
+        }
+    }
+    
+    /*
+     * Nun das jeweilige Bit an das Ende verschieben (z.B. 10000000 -> 00000001)
+     * und mit 1 verunden. Sollte an der jeweiligen Stelle eine 0 stehen, wird
+     * aus der 1 mit der verundet wurde eine 0 -> false.
+     */
+    current_byte = ctx->read_bit_buffer;
+    
+    /*
+     * Wenn der Bitshift mal nicht funktioniert DIY ;-)
+     */
+    for (i = 0; i < (7 - ctx->bit_buffer_index); i++) 
+    {
+        current_byte /= 2;
+    }
+    
+    checkmask = current_byte & checkmask;
+    
+    /*
+     * Aktualisieren des bit_buffer_index.
+     */
+    ctx->bit_buffer_index = (ctx->bit_buffer_index + 1) % 8;
+    
+    return (int) checkmask;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: get_symbol_from_tree
+ *  ------------------------------------------------------------------------ */
+static unsigned char get_symbol_from_tree(HUFF_CTX *ctx,
+                                          FILE* p_input_stream,
+                                          BTREE_NODE *root)
+{
+    int read_bit;
+    BTREE_NODE *node = root;
+
+    /*
+     * Abstieg im Baum entsprechend der gelesenen Bits bis ein Blatt 
+     * erreicht wurde.
+     */
+    while (!btreenode_is_leaf(node))
+    {
+        read_bit = get_next_bit(ctx, p_input_stream);
+        if (read_bit == -1)
+        {
+            printf("Die komprimierte Datei ist unvollstaendig.\n");
+            exit(EXIT_FAILURE);
+        }
+        node = (read_bit) ? btreenode_get_right(node) 
+                          : btreenode_get_left(node);
+    }
+    
+    return ((SYMBOL*)btreenode_get_data(node))->symbol;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: find_seek_point
+ *  ------------------------------------------------------------------------ */
+static BOOL find_seek_point(HUFF_CTX *ctx,
+                            FILE *p_input_stream,
+                            unsigned long position,
+                            SEEK_POINT *p_seek_point,
+                            unsigned long *p_seek_position)
+{
+    unsigned char trailer[CONTAINER_SEEK_TRAILER_SIZE];
+    unsigned char point[CONTAINER_SEEK_POINT_SIZE];
+    unsigned long point_size = CONTAINER_SEEK_POINT_SIZE;
+    unsigned long trailer_size = CONTAINER_SEEK_TRAILER_SIZE;
+    unsigned long interval;
+    unsigned long seek_point_count;
+    unsigned long entry;
+    unsigned int value;
+    
+    if (ctx->legacy_format)
+    {
+        point_size = SEEK_POINT_SIZE;
+        trailer_size = SEEK_TRAILER_SIZE;
+    }
+    else if ((ctx->read_flags & CONTAINER_FLAG_SEEK_INDEX) == 0)
+    {
+        return FALSE;
+    }
+    
+    /*
+     * Abschluss des Seek-Index am Dateiende lesen und die Kennung pruefen.
+     */
+    if (fseek(p_input_stream, -(long) trailer_size, SEEK_END) != 0
+            || fread(trailer, sizeof(unsigned char), trailer_size,
+                     p_input_stream) != trailer_size
+            || memcmp(trailer + trailer_size - 4, SEEK_INDEX_MAGIC, 4) != 0)
+    {
+        return FALSE;
+    }
+    
+    if (ctx->legacy_format)
+    {
+        memcpy(&value, trailer, sizeof(unsigned int));
+        interval = value;
+        memcpy(&value, trailer + sizeof(unsigned int), sizeof(unsigned int));
+        seek_point_count = value;
+    }
+    else
+    {
+        interval = load_le(trailer, 8);
+        seek_point_count = load_le(trailer + 8, 8);
+    }
+    
+    if (interval == 0 || seek_point_count == 0)
+    {
+        return FALSE;
+    }
+    
+    /*
+     * Nur den benoetigten Eintrag lesen.
+     */
+    entry = position / interval;
+    if (entry >= seek_point_count)
+    {
+        entry = seek_point_count - 1;
+    }
+    
+    if (fseek(p_input_stream,
+              -(long) (trailer_size + (seek_point_count - entry) * point_size),
+              SEEK_END) != 0
+            || fread(point, sizeof(unsigned char), point_size, p_input_stream)
+                != point_size
+            || point[point_size - 1] > 7)
+    {
+        printf("Fehler beim einlesen des Seek-Index.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    if (ctx->legacy_format)
+    {
+        memcpy(&value, point, sizeof(unsigned int));
+        p_seek_point->byte_offset = value;
+    }
+    else
+    {
+        p_seek_point->byte_offset = load_le(point, 8);
+    }
+    p_seek_point->bit_offset = point[point_size - 1];
+    *p_seek_position = entry * interval;
+    
+    return TRUE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: seek_to_point
+ *  ------------------------------------------------------------------------ */
+static void seek_to_point(HUFF_CTX *ctx,
+                          FILE *p_input_stream,
+                          long data_start,
+                          SEEK_POINT *p_seek_point)
+{
+    fseek(p_input_stream, data_start + (long) p_seek_point->byte_offset,
+          SEEK_SET);
+    ctx->bit_buffer_index = 0;
+    
+    /*
+     * Beginnt der Sprungpunkt innerhalb eines Bytes, wird dieses bereits 
+     * gelesen, damit get_next_bit mit dem richtigen Bit fortfaehrt.
+     */
+    if (p_seek_point->bit_offset > 0)
+    {
+        if (fread(&ctx->read_bit_buffer, sizeof(unsigned char), 1,
+                  p_input_stream) != 1)
+        {
+            printf("Fehler beim einlesen des Seek-Index.\n");
+            exit(EXIT_FAILURE);
+        }
+        ctx->bit_buffer_index = p_seek_point->bit_offset;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: create_huffman_tree
+ *  ------------------------------------------------------------------------ */
+static BTREE* create_huffman_tree(BINARY_HEAP* p_tree_heap)
+{
+    BTREE* p_new_tree = NULL;
+    BTREE* p_tree1 = NULL;
+    BTREE* p_tree2 = NULL;
+    SYMBOL* p_symbol = NULL;
+    
+    while (p_tree_heap->count > 1)
+    {
+        /*
+         * Extrahiere die 2 Teilbaeume mit der kleinsten Haeufigkeit.
+         */
+        heap_extract_min(p_tree_heap, (void**)&p_tree1);
+        heap_extract_min(p_tree_heap, (void**)&p_tree2);
+        
+        p_symbol = allocator_alloc(p_tree_heap->allocator, sizeof(SYMBOL));
+        
+        p_symbol->symbol = 0;
+        p_symbol->count = p_tree_heap->get_value(p_tree1) 
+                          + p_tree_heap->get_value(p_tree2);
+        
+        p_new_tree = btree_merge(p_tree1, p_tree2, p_symbol);
+        
+        /* Die Knoten gehoeren jetzt dem neuen Baum. */
+        allocator_free(p_tree_heap->allocator, p_tree1);
+        allocator_free(p_tree_heap->allocator, p_tree2);
+        
+        heap_insert(p_tree_heap, p_new_tree);
+    }
+    
+    /*
+     * Wenn alles Erfolgreich ist, dann gebe den finalen Codebaum zurueck.
+     */
+    return (heap_extract_min(p_tree_heap,(void**) & p_new_tree)) 
+            ? p_new_tree : NULL;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: create_tree_heap
+ *  ------------------------------------------------------------------------ */
+static BINARY_HEAP* create_tree_heap(HUFF_CTX *ctx)
+{
+    unsigned int i;
+    BTREE* p_tree;
+    BINARY_HEAP* p_tree_heap = heap_init(&ctx->allocator,
+                                         (GET_VALUE)get_count_from_tree,
+                                         (PRINT_VALUE)btree_print, NULL);
+    
+    /* Beim Schreiben immer FALSE, beim Lesen je nach Version der Datei. */
+    p_tree_heap->legacy_order = ctx->legacy_tree_order;
+    for (i = 0; i < ctx->symbol_count; i++)
+    {
+        /*
+         * Erzeugen der einzelen Baeume aus den Haeufigkeiten.
+         */
+        p_tree = btree_new(&ctx->allocator, ctx->p_symbol_start+i, NULL, 
+                           (PRINT_FCT) print_symbol);
+
+        /*
+         * Einfuegen in den HEAP.
+         */
+        heap_insert(p_tree_heap, p_tree);
+    }
+    return p_tree_heap;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: build_symbol_map
+ *  ------------------------------------------------------------------------ */
+static void build_symbol_map(HUFF_CTX *ctx, char *in_filename)
+{
+    int symbol;
+    unsigned int i;
+    BOOL symbol_found;    
+    BOOL debug_mode_extra = FALSE;
+    unsigned long buffer_position = 0;
+    unsigned long buffer_length = 0;
+    unsigned char *p_buffer = NULL;
+    ASYNC_IO *p_reader = NULL;
+    FILE *p_input_stream = fopen(in_filename, "rb");
+    
+    ctx->symbol_count = 0;
+    ctx->read_char_count = 0;
+    
+    if (p_input_stream != NULL)
+    {
+        ctx->p_symbol_start = allocator_alloc(&ctx->allocator, 
+                                              ALLOC_ELEMENTS * sizeof(SYMBOL));
+        ctx->p_symbol = ctx->p_symbol_start;
+        
+        p_buffer = malloc(KERNEL_CHUNK_SIZE);
+        ENSURE_ENOUGH_MEMORY(p_buffer, "build_symbol_map");
+        p_reader = async_io_open_reader(p_input_stream, (unsigned long) -1,
+                                        IO_MODE, ctx->io_depth);
+        
+        /* 
          * Erstes Zeichen holen und so lange weitere Einlesen
          * bis Dateiende erreicht wurde.
          */
-        symbol = getc(p_input_stream);
+        symbol = read_symbol(p_reader, p_buffer, &buffer_position, 
+                             &buffer_length);
         while (symbol != EOF) 
         {
             
-            if (debug_mode_extra)
+            if (debug_mode_extra)
+            {
+                printf("Read  int: %d\tchar: %c\n", 
+                       symbol, (unsigned char) symbol);
+                fflush(stdout);
+            }
+            
+            symbol_found = FALSE;
+            ctx->read_char_count++;
+            
+            /* 
+             * Durchlaufen aller bishaerigen Eintraege der symbol_map 
+             * und Vergleichen mit dem momentan eingelesenen Zeichen.
+             */
+            for (i = 0; i < ctx->symbol_count; i++)
+            {
+                if (ctx->p_symbol->symbol == (unsigned char) symbol)
+                {
+                    ctx->p_symbol->count++;
+                    symbol_found = TRUE;
+                    break;
+                }
+                else
+                {
+                    ctx->p_symbol++;
+                }
+            }
+
+            /*
+             * Wenn das Zeichen in der symbol_map nicht gefunden wurde, wird
+             * entweder das Zeichen direkt in der symbol_map gespeichert oder
+             * vorher noch Speicher allokiert.
+             */
+            if (!symbol_found)
+            {
+                ctx->symbol_count++;
+                if ((ctx->symbol_count % ALLOC_ELEMENTS) > 0)
+                {
+                    ctx->p_symbol->symbol = (unsigned char) symbol;
+                    ctx->p_symbol->count = 1;
+                    
+                    if (debug_mode_extra) 
+                    {
+                        printf("Added int: %d\t char: %c\n", 
+                               symbol, ctx->p_symbol->symbol);
+                        printf("Check int: %d\t char: %c\n", 
+                               (int) ctx->p_symbol->symbol, 
+                               ctx->p_symbol->symbol);
+                        fflush(stdout);
+                    }
+                }
+                else
+                {
+                    /* Nicht genuegend Speicher allokiert, realloc folgt. */
+                    ctx->p_symbol_start = allocator_realloc(
+                                    &ctx->allocator, ctx->p_symbol_start,
+                                    ctx->symbol_count * sizeof(SYMBOL),
+                                    (ctx->symbol_count + ALLOC_ELEMENTS) *
+                                        sizeof(SYMBOL));
+                    memset(ctx->p_symbol_start + ctx->symbol_count, 0, 
+                           ALLOC_ELEMENTS * sizeof(SYMBOL));
+                    
+                    ctx->p_symbol = 
+                            ctx->p_symbol_start + ctx->symbol_count -1;
+                    ctx->p_symbol->symbol = (unsigned char) symbol;
+                    ctx->p_symbol->count = 1;
+                    
+                    if (debug_mode_extra)
+                    {
+                        printf("Added int: %d\t char: %c\n", 
+                               symbol, ctx->p_symbol->symbol);
+                        printf("Check int: %d\t char: %c\n", 
+                               (int) ctx->p_symbol->symbol, 
+                               ctx->p_symbol->symbol);     
+                        fflush(stdout);
+                    }
+                }
+            }
+            /* Zeiger zurueck auf den Startwert setzen. */
+            ctx->p_symbol = ctx->p_symbol_start;
+            symbol = read_symbol(p_reader, p_buffer, &buffer_position, 
+                                 &buffer_length);
+       }
+        async_io_close(p_reader);
+        free(p_buffer);
+    }
+    else
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    /* Schliessen des Eingabestroms und sortieren der symbol_map. */
+    fclose(p_input_stream);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: read_symbol
+ *  ------------------------------------------------------------------------ */
+static int read_symbol(ASYNC_IO *p_reader,
+                       unsigned char *p_buffer,
+                       unsigned long *p_position,
+                       unsigned long *p_length)
+{
+    if (*p_position == *p_length)
+    {
+        *p_length = async_io_read(p_reader, p_buffer, KERNEL_CHUNK_SIZE);
+        *p_position = 0;
+        if (*p_length == 0)
+        {
+            return EOF;
+        }
+    }
+    
+    return (int) p_buffer[(*p_position)++];
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: write_compressed_file
+ *  ------------------------------------------------------------------------ */
+static void write_compressed_file(HUFF_CTX *ctx,
+                                  char *out_filename,
+                                  char *in_filename,
+                                  BOOL stored)
+{
+    FILE *p_output_stream = fopen(out_filename, "wb");
+    
+    if (p_output_stream == NULL)
+    {
+        printf("Datei zum Schreiben konnte nicht geoeffnet werden.\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    
+    if (ctx->block_size > 0)
+    {
+        write_blocks(ctx, p_output_stream, in_filename);
+    }
+    else if (stored)
+    {
+        /* Gespeicherte Daten haben keinen Huffman-Code zum Anspringen. */
+        write_header(ctx, p_output_stream, WRITE_FLAGS, 0);
+        write_block_header(ctx, p_output_stream, BLOCK_TYPE_STORED,
+                           ctx->read_char_count, ctx->read_char_count, NULL);
+        write_stored_data(ctx, p_output_stream, in_filename);
+    }
+    else
+    {
+        write_header(ctx, p_output_stream, 
+                     ((ctx->seek_index_interval > 0) 
+                        ? CONTAINER_FLAG_SEEK_INDEX : 0)
+                        | WRITE_FLAGS,
+                     0);
+        write_block_header(ctx, p_output_stream, BLOCK_TYPE_HUFFMAN,
+                           ctx->read_char_count, 0, NULL);
+        write_huffman_code(ctx, p_output_stream, in_filename);
+    }
+    fclose(p_output_stream);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: write_blocks
+ *  ------------------------------------------------------------------------ */
+extern void write_blocks(HUFF_CTX *ctx,
+                         FILE *p_output_stream,
+                         char *in_filename)
+{
+    unsigned long block_bytes = ctx->block_size * 1024;
+    unsigned long counts[256];
+    unsigned long read_length;
+    unsigned long code_length;
+    unsigned long repeat_length;
+    unsigned long table_length;
+    unsigned long block_index = 0;
+    unsigned long i;
+    unsigned int type;
+    unsigned char *p_input_buffer = malloc(block_bytes);
+    unsigned char *p_output_buffer = NULL;
+    unsigned long output_size = 0;
+    unsigned long context_length = (unsigned long) -1;
+    unsigned long (*p_context_counts)[256] = NULL;
+    CODE_TABLE *p_context_tables = NULL;
+    CONTEXT_MODEL context_model;
+    unsigned long wide_length = (unsigned long) -1;
+    unsigned long wide_used = 0;
+    unsigned long *p_wide_counts = NULL;
+    unsigned char *p_wide_lengths = NULL;
+    WIDE_CODE *p_wide_code = NULL;
+    unsigned long rle_length = (unsigned long) -1;
+    unsigned long rle_used = 0;
+    unsigned char *p_rle_lengths = NULL;
+    CODE_TABLE code_table;
+    CODE_TABLE previous_table;
+    BOOL previous_symbols[256];
+    BOOL have_previous = FALSE;
+    ENCODE_STATE encode_state;
+    BTREE *p_huffman_tree;
+    ASYNC_IO *p_reader;
+    IO_CACHE output_cache;
+    ARENA_MARK block_mark;
+    FILE *p_input_stream = fopen(in_filename, "rb");
+    
+    if (p_input_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    ENSURE_ENOUGH_MEMORY(p_input_buffer, "write_blocks");
+    
+    if (ctx->context_mode)
+    {
+        p_context_counts = allocator_alloc(&ctx->allocator, 
+                               CONTEXT_COUNT * sizeof(p_context_counts[0]));
+        p_context_tables = allocator_alloc(&ctx->allocator, 
+                               CONTEXT_MAX_TABLES * sizeof(CODE_TABLE));
+    }
+    if (ctx->wide_mode || ctx->rle_mode)
+    {
+        p_wide_counts = allocator_alloc(&ctx->allocator, 
+                               WIDE_SYMBOL_COUNT * sizeof(unsigned long));
+        p_wide_lengths = allocator_alloc(&ctx->allocator, WIDE_SYMBOL_COUNT);
+        p_rle_lengths = allocator_alloc(&ctx->allocator, WIDE_SYMBOL_COUNT);
+        p_wide_code = allocator_alloc(&ctx->allocator, sizeof(WIDE_CODE));
+    }
+    
+    /* Die Laenge der Eingabe steht im Containerheader vor dem ersten Block. */
+    fseek(p_input_stream, 0, SEEK_END);
+    ctx->read_char_count = (unsigned long) ftell(p_input_stream);
+    fseek(p_input_stream, 0, SEEK_SET);
+    if (p_output_stream == NULL)
+    {
+        apply_sample_minimum(ctx, block_bytes);
+    }
+    if (p_output_stream != NULL)
+    {
+        write_header(ctx, p_output_stream, WRITE_FLAGS, block_bytes);
+        async_io_cache_init(&output_cache, p_output_stream, TRUE, 
+                            ctx->no_cache_mode);
+    }
+    
+    /* Mitglieder eines Archivs beginnen mit der gemeinsamen Codetabelle. */
+    if (ctx->shared_table_written)
+    {
+        previous_table = ctx->shared_code_table;
+        memcpy(previous_symbols, ctx->shared_symbols, sizeof(previous_symbols));
+        have_previous = TRUE;
+    }
+    
+    /* Die Schaetzung springt ueber Bloecke und liest deshalb mit fread. */
+    p_reader = async_io_open_reader(p_input_stream, (unsigned long) -1,
+                                    (p_output_stream != NULL) 
+                                        ? IO_MODE : IO_BACKEND_SYNC,
+                                    ctx->io_depth);
+    allocator_mark(&ctx->allocator, &block_mark);
+    read_length = async_io_read(p_reader, p_input_buffer, block_bytes);
+    while (read_length > 0)
+    {
+        /* Das Kontextmodell belegt die symbol_map nur voruebergehend. */
+        if (ctx->context_mode)
+        {
+            context_length = build_context_model(ctx, p_input_buffer, 
+                                                 read_length,
+                                                 p_context_counts,
+                                                 &context_model,
+                                                 p_context_tables);
+        }
+        
+        /* 16-Bit-Zeichen gibt es nur in Bloecken mit gerader Laenge. */
+        wide_length = (unsigned long) -1;
+        if (ctx->wide_mode && read_length % 2 == 0)
+        {
+            wide_count(p_input_buffer, read_length, p_wide_counts);
+            wide_used = wide_code_lengths(&ctx->allocator, p_wide_counts, 
+                                          p_wide_lengths);
+            wide_length = 0;
+            for (i = 0; i < WIDE_SYMBOL_COUNT; i++)
+            {
+                wide_length += p_wide_counts[i] * p_wide_lengths[i];
+            }
+            
+            /* Ein einzelnes Zeichen wird ohne Bits kodiert. */
+            wide_length = (wide_used > 1) ? (wide_length + 7) / 8 : 0;
+            wide_length += 4 + wide_used * WIDE_ENTRY_SIZE;
+        }
+        
+        /* Laufzeichen tragen ihre Anzahl in angehaengten Bits. */
+        rle_length = (unsigned long) -1;
+        if (ctx->rle_mode)
+        {
+            rle_length = rle_count(p_input_buffer, read_length, 
+                                   p_wide_counts);
+            rle_used = wide_code_lengths(&ctx->allocator, p_wide_counts, 
+                                         p_rle_lengths);
+            for (i = 0; i < RLE_SYMBOL_COUNT && rle_used > 1; i++)
             {
-                printf("Read  int: %d\tchar: %c\n", 
-                       symbol, (unsigned char) symbol);
-                fflush(stdout);
+                rle_length += p_wide_counts[i] * p_rle_lengths[i];
+            }
+            rle_length = (rle_length + 7) / 8 + 4 + rle_used * WIDE_ENTRY_SIZE;
+        }
+        
+        memset(counts, 0, sizeof(counts));
+        for (i = 0; i < read_length; i++)
+        {
+            counts[p_input_buffer[i]]++;
+        }
+        
+        p_huffman_tree = create_block_codes(ctx, counts);
+        code_table_init(&code_table, ctx->p_symbol_start, ctx->symbol_count);
+        code_length = estimate_code_length(ctx);
+        repeat_length = (have_previous) 
+                ? estimate_repeat_length(&previous_table, previous_symbols,
+                                         counts)
+                : (unsigned long) -1;
+        
+        /*
+         * Die Groesse des Huffman-Codes steht mit den Codelaengen schon vor
+         * dem Kodieren fest. Die vorherige Tabelle wird wiederverwendet,
+         * solange sie hoechstens REPEAT_TABLE_THRESHOLD Prozent mehr kostet
+         * als eine neue Tabelle samt Huffman-Code. Ist keiner der Codes
+         * kleiner als die Eingabe, wird der Block unveraendert gespeichert.
+         */
+        type = BLOCK_TYPE_HUFFMAN;
+        if (code_table.max_length > KERNEL_MAX_CODE_LENGTH)
+        {
+            code_length = (unsigned long) -1;
+        }
+        else
+        {
+            code_length += ctx->symbol_count * BLOCK_SYMBOL_SIZE;
+        }
+        if (repeat_length != (unsigned long) -1
+                && (code_length == (unsigned long) -1
+                    || repeat_length * 100 
+                        <= code_length * (100 + REPEAT_TABLE_THRESHOLD)))
+        {
+            type = BLOCK_TYPE_REPEAT;
+            code_length = repeat_length;
+        }
+        if (context_length < code_length)
+        {
+            type = BLOCK_TYPE_CONTEXT;
+            code_length = context_length;
+        }
+        if (wide_length < code_length)
+        {
+            type = BLOCK_TYPE_WIDE;
+            code_length = wide_length;
+        }
+        if (rle_length < code_length)
+        {
+            type = BLOCK_TYPE_RLE;
+            code_length = rle_length;
+        }
+        if (code_length >= read_length)
+        {
+            type = BLOCK_TYPE_STORED;
+        }
+        
+        ctx->sampled_char_count += read_length;
+        if (type == BLOCK_TYPE_STORED && p_output_stream == NULL)
+        {
+            ctx->estimated_header_size += BLOCK_HEADER_SIZE;
+            ctx->estimated_payload_size += read_length;
+        }
+        else if (type == BLOCK_TYPE_STORED)
+        {
+            write_block_header(ctx, p_output_stream, BLOCK_TYPE_STORED,
+                               read_length, read_length, NULL);
+            if (fwrite(p_input_buffer, sizeof(unsigned char), read_length,
+                       p_output_stream) != read_length)
+            {
+                printf("Fehler beim schreiben des Huffman-Codes.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        else
+        {
+            table_length = code_length;
+            if (type == BLOCK_TYPE_HUFFMAN)
+            {
+                code_length -= ctx->symbol_count * BLOCK_SYMBOL_SIZE;
+                previous_table = code_table;
+                for (i = 0; i < 256; i++)
+                {
+                    previous_symbols[i] = (counts[i] > 0) ? TRUE : FALSE;
+                }
+                have_previous = TRUE;
+            }
+            else if (type == BLOCK_TYPE_CONTEXT)
+            {
+                code_length -= CONTEXT_MODEL_SIZE(context_model.table_count);
+            }
+            else if (type == BLOCK_TYPE_WIDE)
+            {
+                code_length -= 4 + wide_used * WIDE_ENTRY_SIZE;
+            }
+            else if (type == BLOCK_TYPE_RLE)
+            {
+                code_length -= 4 + rle_used * WIDE_ENTRY_SIZE;
             }
             
-            symbol_found = FALSE;
-            read_char_count++;
+            table_length -= code_length;
             
-            /* 
-             * Durchlaufen aller bishaerigen Eintraege der symbol_map 
-             * und Vergleichen mit dem momentan eingelesenen Zeichen.
-             */
-            for (i = 0; i < symbol_count; i++)
+            /* Beim Schaetzen steht die Groesse mit den Codelaengen fest. */
+            if (p_output_stream == NULL)
             {
-                if (p_symbol->symbol == (unsigned char) symbol)
+                ctx->estimated_header_size += BLOCK_HEADER_SIZE + table_length;
+                ctx->estimated_payload_size += code_length;
+            }
+            else
+            {
+                if (code_length + KERNEL_OUTPUT_SLACK > output_size)
                 {
-                    p_symbol->count++;
-                    symbol_found = TRUE;
-                    break;
+                    output_size = code_length + KERNEL_OUTPUT_SLACK;
+                    free(p_output_buffer);
+                    p_output_buffer = malloc(output_size);
+                    ENSURE_ENOUGH_MEMORY(p_output_buffer, "write_blocks");
                 }
-                else
+            
+                encode_state_init(&encode_state);
+                if (type == BLOCK_TYPE_CONTEXT)
                 {
-                    p_symbol++;
+                    i = context_encode(p_context_tables, 
+                                       context_model.context_map, 
+                                       &encode_state,
+                                       p_input_buffer, read_length, 
+                                       p_output_buffer);
                 }
-            }
-
-            /*
-             * Wenn das Zeichen in der symbol_map nicht gefunden wurde, wird
-             * entweder das Zeichen direkt in der symbol_map gespeichert oder
-             * vorher noch Speicher allokiert.
-             */
-            if (!symbol_found)
-            {
-                symbol_count++;
-                if ((symbol_count % ALLOC_ELEMENTS) > 0)
+                else if (type == BLOCK_TYPE_WIDE)
                 {
-                    p_symbol->symbol = (unsigned char) symbol;
-                    p_symbol->count = 1;
-                    
-                    if (debug_mode_extra) 
-                    {
-                        printf("Added int: %d\t char: %c\n", 
-                               symbol, p_symbol->symbol);
-                        printf("Check int: %d\t char: %c\n", 
-                               (int) p_symbol->symbol, p_symbol->symbol);
-                        fflush(stdout);
-                    }
+                    wide_code_init(p_wide_code, p_wide_lengths);
+                    i = wide_encode(p_wide_code, &encode_state, p_input_buffer,
+                                    read_length, p_output_buffer);
+                }
+                else if (type == BLOCK_TYPE_RLE)
+                {
+                    wide_code_init(p_wide_code, p_rle_lengths);
+                    i = rle_encode(p_wide_code, &encode_state, p_input_buffer,
+                                   read_length, p_output_buffer);
                 }
                 else
                 {
-                    /* Nicht genuegend Speicher allokiert, realloc folgt. */
-                    p_symbol_start = realloc(p_symbol_start,
-                                            (symbol_count + ALLOC_ELEMENTS) *
-                                                sizeof(SYMBOL));
-                    memset(p_symbol_start + symbol_count, 0, ALLOC_ELEMENTS);
-                    
-                    if (p_symbol_start == NULL) {
-                        
-                        printf("Reallokierung fehlgeschlagen.\n");
-                        fflush(stdout);
-                        exit(EXIT_FAILURE);
-                        
-                    } else {
-                        
-                        p_symbol = p_symbol_start + symbol_count -1;
-                        p_symbol->symbol = (unsigned char) symbol;
-                        p_symbol->count = 1;
-                        
-                        if (debug_mode_extra)
-                        {
-                            printf("Added int: %d\t char: %c\n", 
-                                   symbol, p_symbol->symbol);
-                            printf("Check int: %d\t char: %c\n", 
-                                   (int) p_symbol->symbol, p_symbol->symbol);     
-                            fflush(stdout);
-                        }
-                    }
+                    i = kernel_encode(&previous_table, &encode_state, 
+                                      p_input_buffer, read_length, 
+                                      p_output_buffer);
+                }
+                i += encode_state_flush(&encode_state, p_output_buffer + i);
+            
+                write_block_header(ctx, p_output_stream, type, read_length, i,
+                                   &context_model);
+                if (type == BLOCK_TYPE_WIDE)
+                {
+                    write_wide_table(p_output_stream, p_wide_lengths, 
+                                     wide_used);
+                }
+                else if (type == BLOCK_TYPE_RLE)
+                {
+                    write_wide_table(p_output_stream, p_rle_lengths, 
+                                     rle_used);
+                }
+                if (fwrite(p_output_buffer, sizeof(unsigned char), i,
+                           p_output_stream) != i)
+                {
+                    printf("Fehler beim schreiben des Huffman-Codes.\n");
+                    exit(EXIT_FAILURE);
                 }
             }
-            /* Zeiger zurueck auf den Startwert setzen. */
-            p_symbol = p_symbol_start;
-            symbol = getc(p_input_stream);
-       }
+        }
+        
+        if (ctx->checksum_mode && p_output_stream == NULL)
+        {
+            ctx->estimated_header_size += CHECKSUM_SIZE;
+        }
+        else if (ctx->checksum_mode)
+        {
+            write_checksum(p_output_stream, 
+                           crc32c_update(0, p_input_buffer, read_length));
+        }
+        
+        /* Die Bloecke werden direkt geschrieben, nicht ueber ASYNC_IO. */
+        if (p_output_stream != NULL)
+        {
+            async_io_cache_release(&output_cache, 
+                                   (unsigned long) ftell(p_output_stream));
+        }
+        
+        if (ctx->debug_mode)
+        {
+            printf("\tBlock: %lu Zeichen, %lu Symbole, %s\n", read_length,
+                   (unsigned long) ctx->symbol_count,
+                   (type == BLOCK_TYPE_STORED) ? "gespeichert" 
+                   : (type == BLOCK_TYPE_REPEAT) ? "vorherige Tabelle" 
+                   : (type == BLOCK_TYPE_CONTEXT) ? "Kontext" 
+                   : (type == BLOCK_TYPE_WIDE) ? "16 Bit" 
+                   : (type == BLOCK_TYPE_RLE) ? "Laeufe" 
+                   : "Huffman");
+        }
+        
+        free_codes(ctx);
+        destroy_huffman_tree(p_huffman_tree);
+        allocator_free(&ctx->allocator, ctx->p_symbol_start);
+        ctx->p_symbol_start = NULL;
+        
+        /* Eine Arena haelt nur die Baeume und Codes des aktuellen Blocks. */
+        allocator_rewind(&ctx->allocator, &block_mark);
+        
+        /* Bloecke ausserhalb der Stichprobe werden nicht gelesen. */
+        block_index++;
+        while (p_output_stream == NULL && !is_sampled(ctx, block_index)
+                && block_index * block_bytes < ctx->read_char_count)
+        {
+            fseek(p_input_stream, (long) block_bytes, SEEK_CUR);
+            block_index++;
+        }
+        read_length = async_io_read(p_reader, p_input_buffer, block_bytes);
+    }
+    
+    async_io_close(p_reader);
+    fclose(p_input_stream);
+    if (p_output_stream != NULL)
+    {
+        async_io_cache_finish(&output_cache);
+    }
+    free(p_input_buffer);
+    free(p_output_buffer);
+    allocator_free(&ctx->allocator, p_context_counts);
+    allocator_free(&ctx->allocator, p_context_tables);
+    allocator_free(&ctx->allocator, p_wide_counts);
+    allocator_free(&ctx->allocator, p_wide_lengths);
+    allocator_free(&ctx->allocator, p_rle_lengths);
+    allocator_free(&ctx->allocator, p_wide_code);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: write_wide_table
+ *  ------------------------------------------------------------------------ */
+static void write_wide_table(FILE *p_output_stream,
+                             unsigned char *p_lengths,
+                             unsigned long used)
+{
+    unsigned long table_size = 4 + used * WIDE_ENTRY_SIZE;
+    unsigned char *p_table = malloc(table_size);
+    unsigned char *p_entry = p_table + 4;
+    unsigned long i;
+    
+    ENSURE_ENOUGH_MEMORY(p_table, "write_wide_table");
+    
+    store_le(p_table, used, 4);
+    for (i = 0; i < WIDE_SYMBOL_COUNT; i++)
+    {
+        if (p_lengths[i] > 0)
+        {
+            store_le(p_entry, i, 2);
+            p_entry[2] = p_lengths[i];
+            p_entry += WIDE_ENTRY_SIZE;
+        }
+    }
+    
+    if (fwrite(p_table, sizeof(unsigned char), table_size, p_output_stream)
+            != table_size)
+    {
+        printf("Fehler beim schreiben des Headers.\n");
+        exit(EXIT_FAILURE);
+    }
+    free(p_table);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: build_context_model
+ *  ------------------------------------------------------------------------ */
+static unsigned long build_context_model(HUFF_CTX *ctx,
+                                         unsigned char *p_input,
+                                         unsigned long input_length,
+                                         unsigned long (*p_counts)[256],
+                                         CONTEXT_MODEL *p_model,
+                                         CODE_TABLE *p_tables)
+{
+    unsigned long table_counts[CONTEXT_MAX_TABLES][256];
+    unsigned long bits = 0;
+    unsigned long i;
+    unsigned int previous = 0;
+    unsigned int table, length;
+    BOOL too_long = FALSE;
+    BTREE *p_huffman_tree;
+    
+    memset(p_counts, 0, CONTEXT_COUNT * sizeof(p_counts[0]));
+    for (i = 0; i < input_length; i++)
+    {
+        p_counts[previous][p_input[i]]++;
+        previous = p_input[i];
+    }
+    
+    context_cluster(p_counts, CONTEXT_MAX_TABLES, p_model, table_counts);
+    
+    /*
+     * Je Gruppe den Huffman-Baum wie fuer einen Block bauen. Uebernommen
+     * werden nur die Codelaengen, die Codes selbst sind kanonisch, damit
+     * der Blockheader ohne Haeufigkeiten auskommt.
+     */
+    memset(p_model->lengths, 0, sizeof(p_model->lengths));
+    for (table = 0; table < p_model->table_count; table++)
+    {
+        p_huffman_tree = create_block_codes(ctx, table_counts[table]);
+        for (i = 0; i < ctx->symbol_count; i++)
+        {
+            length = (unsigned int) strlen(ctx->p_symbol_start[i].code);
+            if (length > KERNEL_MAX_CODE_LENGTH)
+            {
+                too_long = TRUE;
+            }
+            bits += ctx->p_symbol_start[i].count * length;
+            
+            /* Ein einzelnes Zeichen hat den leeren Code. */
+            p_model->lengths[table][ctx->p_symbol_start[i].symbol] = 
+                    (unsigned char) ((length > 0) ? length : 1);
+        }
+        
+        free_codes(ctx);
+        destroy_huffman_tree(p_huffman_tree);
+        allocator_free(&ctx->allocator, ctx->p_symbol_start);
+        ctx->p_symbol_start = NULL;
+        
+        context_code_table_init(&p_tables[table], p_model->lengths[table]);
+    }
+    
+    if (too_long)
+    {
+        return (unsigned long) -1;
+    }
+    return (bits + 7) / 8 + CONTEXT_MODEL_SIZE(p_model->table_count);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: estimate_repeat_length
+ *  ------------------------------------------------------------------------ */
+static unsigned long estimate_repeat_length(CODE_TABLE *p_code_table,
+                                            BOOL *p_symbols,
+                                            unsigned long *p_counts)
+{
+    unsigned long bits = 0;
+    unsigned int i;
+    
+    for (i = 0; i < 256; i++)
+    {
+        if (p_counts[i] > 0)
+        {
+            /* Zeichen ohne Code koennen nicht kodiert werden. */
+            if (!p_symbols[i])
+            {
+                return (unsigned long) -1;
+            }
+            bits += p_counts[i] * p_code_table->entries[i].length;
+        }
+    }
+    
+    return (bits + 7) / 8;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: create_block_codes
+ *  ------------------------------------------------------------------------ */
+extern BTREE *create_block_codes(HUFF_CTX *ctx, unsigned long *p_counts)
+{
+    BINARY_HEAP *p_tree_heap;
+    BTREE *p_huffman_tree;
+    char *p_code;
+    unsigned int i;
+    
+    ctx->p_symbol_start = allocator_alloc(&ctx->allocator, 
+                                          256 * sizeof(SYMBOL));
+    
+    ctx->symbol_count = 0;
+    for (i = 0; i < 256; i++)
+    {
+        if (p_counts[i] > 0)
+        {
+            ctx->p_symbol_start[ctx->symbol_count].symbol = (unsigned char) i;
+            ctx->p_symbol_start[ctx->symbol_count].count = p_counts[i];
+            ctx->symbol_count++;
+        }
+    }
+    
+    p_tree_heap = create_tree_heap(ctx);
+    p_huffman_tree = create_huffman_tree(p_tree_heap);
+    heap_destroy(p_tree_heap);
+    
+    p_code = allocator_alloc(&ctx->allocator, (size_t) btree_get_max_depth(
+                                 btree_get_root(p_huffman_tree)) + 1);
+    create_code_table(ctx, btree_get_root(p_huffman_tree), p_code, p_code, 1);
+    allocator_free(&ctx->allocator, p_code);
+    
+    return p_huffman_tree;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: estimate_code_length
+ *  ------------------------------------------------------------------------ */
+static unsigned long estimate_code_length(HUFF_CTX *ctx)
+{
+    unsigned long bits = 0;
+    unsigned int i;
+    
+    for (i = 0; i < ctx->symbol_count; i++)
+    {
+        bits += ctx->p_symbol_start[i].count 
+              * strlen(ctx->p_symbol_start[i].code);
+    }
+    
+    return (bits + 7) / 8;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: free_codes
+ *  ------------------------------------------------------------------------ */
+extern void free_codes(HUFF_CTX *ctx)
+{
+    unsigned int i;
+    
+    for (i = 0; i < ctx->symbol_count; i++)
+    {
+        allocator_free(&ctx->allocator, ctx->p_symbol_start[i].code);
+        ctx->p_symbol_start[i].code = NULL;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: write_stored_data
+ *  ------------------------------------------------------------------------ */
+static void write_stored_data(HUFF_CTX *ctx,
+                              FILE *p_output_stream,
+                              char *in_filename)
+{
+    unsigned char *p_buffer = malloc(KERNEL_CHUNK_SIZE);
+    unsigned long read_length;
+    unsigned long checksum = 0;
+    ASYNC_IO *p_reader;
+    ASYNC_IO *p_writer;
+    FILE *p_input_stream = fopen(in_filename, "rb");
+    
+    if (p_input_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+    ENSURE_ENOUGH_MEMORY(p_buffer, "write_stored_data");
+    p_reader = async_io_open_reader(p_input_stream, (unsigned long) -1,
+                                    IO_MODE, ctx->io_depth);
+    p_writer = async_io_open_writer(p_output_stream, IO_MODE,
+                                    ctx->io_depth);
+    
+    do
+    {
+        read_length = async_io_read(p_reader, p_buffer, KERNEL_CHUNK_SIZE);
+        async_io_write(p_writer, p_buffer, read_length);
+        if (ctx->checksum_mode)
+        {
+            checksum = crc32c_update(checksum, p_buffer, read_length);
+        }
     }
-    else
+    while (read_length == KERNEL_CHUNK_SIZE);
+    async_io_close(p_writer);
+    async_io_close(p_reader);
+    
+    if (ctx->checksum_mode)
     {
-        printf("Datei Einlesen fehlgeschlagen!\n");
-        fflush(stdout);
-        exit(EXIT_FAILURE);
+        write_checksum(p_output_stream, checksum);
     }
-    /* Schliessen des Eingabestroms und sortieren der symbol_map. */
     fclose(p_input_stream);
+    free(p_buffer);
 }
 
 /** ---------------------------------------------------------------------------
- *  Funktion: write_compressed_file
+ *  Funktion: write_decompressed_file
  *  ------------------------------------------------------------------------ */
-static void write_compressed_file(char *out_filename, char *in_filename)
+static void write_decompressed_file(HUFF_CTX *ctx,
+                                    char *out_filename,
+                                    unsigned long char_count)
 {
+    ASYNC_IO *p_writer;
     FILE *p_output_stream = fopen(out_filename, "wb");
     
+    
     if (p_output_stream != NULL)
     {
-        write_header(p_output_stream);
-        write_huffman_code(p_output_stream, in_filename);
+        p_writer = async_io_open_writer(p_output_stream, IO_MODE,
+                                        ctx->io_depth);
+        async_io_write(p_writer, ctx->p_decompressed_text_start, char_count);
+        async_io_close(p_writer);
     }
     else
     {
@@ -627,116 +3978,254 @@ static void write_compressed_file(char *out_filename, char *in_filename)
         fflush(stdout);
         exit(EXIT_FAILURE);
     }
-    fclose(p_output_stream);
+    fclose(p_output_stream);   
 }
 
 /** ---------------------------------------------------------------------------
- *  Funktion: write_decompressed_file
+ *  Funktion: write_huffman_code
  *  ------------------------------------------------------------------------ */
-static void write_decompressed_file(char *out_filename)
+static void write_huffman_code(HUFF_CTX *ctx,
+                               FILE *p_output_stream,
+                               char *in_filename)
 {
-    FILE *p_output_stream = fopen(out_filename, "wb");
+    unsigned long interval = ctx->seek_index_interval * 1024;
+    SEEK_POINT *p_seek_points = NULL;
+    unsigned int seek_point_count = 0;
+    unsigned long checksum = 0;
+    CODE_TABLE code_table;
+    FILE *p_input_stream = fopen(in_filename, "rb");
     
+    if (p_input_stream == NULL)
+    {
+        printf("Datei Einlesen fehlgeschlagen!\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
     
-    if (p_output_stream != NULL)
+    if (interval > 0)
     {
-        /**
-         * TODO: Hier eine ueberpruefung der Architektur und nach
-         * Big Endian / Little Endian schreiben
-         */
-        fwrite(p_decompressed_text_start,
-               sizeof(unsigned char*),
-               read_char_count,
-               p_output_stream);
+        p_seek_points = calloc(ctx->read_char_count / interval + 1,
+                               sizeof(SEEK_POINT));
+        ENSURE_ENOUGH_MEMORY(p_seek_points, "write_huffman_code");
+    }
+    
+    /**
+     * Ab 2.Zeile: Huffman-Code schreiben.
+     */
+    code_table_init(&code_table, ctx->p_symbol_start, ctx->symbol_count);
+    if (code_table.max_length <= KERNEL_MAX_CODE_LENGTH)
+    {
+        seek_point_count = encode_with_kernel(ctx, p_input_stream, 
+                                              p_output_stream,
+                                              &code_table, p_seek_points,
+                                              interval, &checksum);
     }
     else
     {
-        printf("Datei zum Schreiben konnte nicht geoeffnet werden.\n");
-        fflush(stdout);
-        exit(EXIT_FAILURE);
+        seek_point_count = encode_with_bit_buffer(ctx, p_input_stream,
+                                                  p_output_stream,
+                                                  p_seek_points, interval,
+                                                  &checksum);
+    }
+    fclose(p_input_stream);
+    write_code_length(ctx, p_output_stream, CONTAINER_HEADER_SIZE);
+    if (ctx->checksum_mode)
+    {
+        write_checksum(p_output_stream, checksum);
+    }
+    
+    if (p_seek_points != NULL)
+    {
+        write_seek_index(ctx, p_output_stream, p_seek_points, seek_point_count,
+                         interval);
+        free(p_seek_points);
     }
-    fclose(p_output_stream);   
 }
 
 /** ---------------------------------------------------------------------------
- *  Funktion: write_huffman_code
+ *  Funktion: encode_with_kernel
+ *  ------------------------------------------------------------------------ */
+static unsigned int encode_with_kernel(HUFF_CTX *ctx,
+                                       FILE *p_input_stream,
+                                       FILE *p_output_stream,
+                                       CODE_TABLE *p_code_table,
+                                       SEEK_POINT *p_seek_points,
+                                       unsigned long interval,
+                                       unsigned long *p_checksum)
+{
+    ENCODE_STATE encode_state;
+    unsigned char *p_input_buffer = malloc(KERNEL_CHUNK_SIZE);
+    unsigned char *p_output_buffer = malloc(KERNEL_CHUNK_SIZE / 8 
+                                            * p_code_table->max_length
+                                            + KERNEL_OUTPUT_SLACK);
+    unsigned long position = 0;
+    unsigned long bytes_written = 0;
+    unsigned long chunk_length;
+    unsigned long read_length;
+    unsigned long output_length;
+    unsigned int seek_point_count = 0;
+    ASYNC_IO *p_reader;
+    ASYNC_IO *p_writer;
+    
+    ENSURE_ENOUGH_MEMORY(p_input_buffer, "encode_with_kernel");
+    ENSURE_ENOUGH_MEMORY(p_output_buffer, "encode_with_kernel");
+    encode_state_init(&encode_state);
+    
+    /* Mit --io laufen Lesen und Schreiben waehrend des Kodierens weiter. */
+    p_reader = async_io_open_reader(p_input_stream, (unsigned long) -1,
+                                    IO_MODE, ctx->io_depth);
+    p_writer = async_io_open_writer(p_output_stream, IO_MODE,
+                                    ctx->io_depth);
+    
+    do
+    {
+        /*
+         * Die Bloecke enden immer an einem Sprungpunkt, damit dort die
+         * aktuelle Bitposition gemerkt werden kann.
+         */
+        chunk_length = KERNEL_CHUNK_SIZE;
+        if (interval > 0)
+        {
+            if (position % interval == 0 && position < ctx->read_char_count)
+            {
+                p_seek_points[seek_point_count].byte_offset = bytes_written;
+                p_seek_points[seek_point_count].bit_offset = 
+                        encode_state.bit_count;
+                seek_point_count++;
+            }
+            if (interval - position % interval < chunk_length)
+            {
+                chunk_length = interval - position % interval;
+            }
+        }
+        
+        read_length = async_io_read(p_reader, p_input_buffer, chunk_length);
+        if (ctx->checksum_mode)
+        {
+            *p_checksum = crc32c_update(*p_checksum, p_input_buffer,
+                                        read_length);
+        }
+        output_length = kernel_encode(p_code_table, &encode_state,
+                                      p_input_buffer, read_length,
+                                      p_output_buffer);
+        async_io_write(p_writer, p_output_buffer, output_length);
+        bytes_written += output_length;
+        position += read_length;
+    }
+    while (read_length == chunk_length);
+    
+    /* Letztes angefangenes Byte mit 0 auffuellen und schreiben. */
+    output_length = encode_state_flush(&encode_state, p_output_buffer);
+    async_io_write(p_writer, p_output_buffer, output_length);
+    async_io_close(p_writer);
+    async_io_close(p_reader);
+    
+    free(p_input_buffer);
+    free(p_output_buffer);
+    
+    return seek_point_count;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: encode_with_bit_buffer
  *  ------------------------------------------------------------------------ */
-static void write_huffman_code(FILE *p_output_stream, char *in_filename)
+static unsigned int encode_with_bit_buffer(HUFF_CTX *ctx,
+                                           FILE *p_input_stream,
+                                           FILE *p_output_stream,
+                                           SEEK_POINT *p_seek_points,
+                                           unsigned long interval,
+                                           unsigned long *p_checksum)
 {
     unsigned int i;
     int char_read;
-    FILE *p_input_stream = fopen(in_filename, "rb");
-    p_symbol = p_symbol_start;    
+    unsigned char byte;
+    unsigned long position = 0;
+    unsigned int seek_point_count = 0;
+    BIT_BUFFER *bit_buffer = bit_buffer_init(&ctx->allocator, 
+                                             p_output_stream);
     
-    /**
-     * Ab 2.Zeile: Huffman-Code schreiben.
-     */
-    bit_buffer_init(p_output_stream);
-    if (p_input_stream != NULL)
+    char_read = fgetc(p_input_stream);
+    while (char_read != EOF)
     {
-        char_read = fgetc(p_input_stream);
-        while (char_read != EOF)
+        /**
+         * Alle interval Zeichen die aktuelle Bitposition merken.
+         */
+        if (interval > 0 && position % interval == 0)
+        {
+            bit_buffer_get_position(
+                    bit_buffer,
+                    &p_seek_points[seek_point_count].byte_offset,
+                    &p_seek_points[seek_point_count].bit_offset);
+            seek_point_count++;
+        }
+        position++;
+        
+        if (ctx->checksum_mode)
+        {
+            byte = (unsigned char) char_read;
+            *p_checksum = crc32c_update(*p_checksum, &byte, 1);
+        }
+
+        ctx->p_symbol = ctx->p_symbol_start;
+        for (i = 0; i < ctx->symbol_count; i++)
         {
-            p_symbol = p_symbol_start;
-            for (i = 0; i < symbol_count; i++)
+            /**
+             * Zeichen im Struct-Array gefunden: Code schreiben.
+             */
+            if (ctx->p_symbol->symbol == (unsigned char) char_read)
             {
-                /**
-                 * Zeichen im Struct-Array gefunden: Code schreiben.
-                 */
-                if (p_symbol->symbol == (unsigned char) char_read)
-                {
-                    bit_buffer_add_binary_string(p_symbol->code);
-                }
-                p_symbol++;
+                bit_buffer_add_binary_string(bit_buffer, ctx->p_symbol->code);
             }
-            char_read = fgetc(p_input_stream);
+            ctx->p_symbol++;
         }
+        char_read = fgetc(p_input_stream);
     }
-    fclose(p_input_stream);
-    bit_buffer_write_to_file(TRUE);
-    bit_buffer_destroy();
+    bit_buffer_write_to_file(bit_buffer, TRUE);
+    bit_buffer_destroy(bit_buffer);
+    
+    return seek_point_count;
 }
 
 /** ---------------------------------------------------------------------------
  *  Funktion: print_symbol_map
  *  ------------------------------------------------------------------------ */
-static void print_symbol_map(void) 
+static void print_symbol_map(HUFF_CTX *ctx) 
 {
     unsigned int i;
     
     /* Ausgabe der eingelesenen Zeichen mit ihrer Anzahl. */
-    p_symbol = p_symbol_start;
-    for (i = 0; i < symbol_count; i++)
+    ctx->p_symbol = ctx->p_symbol_start;
+    for (i = 0; i < ctx->symbol_count; i++)
     {
-        if (p_symbol->symbol == '\n')
+        if (ctx->p_symbol->symbol == '\n')
         {
-            printf("\tSymbol: \\n \tAnzahl:  %u\n", p_symbol->count);
+            printf("\tSymbol: \\n \tAnzahl:  %lu\n", ctx->p_symbol->count);
             fflush(stdout);
         }
-        else if (p_symbol->symbol == '\t')
+        else if (ctx->p_symbol->symbol == '\t')
         {
-            printf("\tSymbol: \\t \tAnzahl:  %u\n", p_symbol->count);
+            printf("\tSymbol: \\t \tAnzahl:  %lu\n", ctx->p_symbol->count);
             fflush(stdout);
         }
         else
         {
-            printf("\tSymbol:  %c \tAnzahl:  %u\n", 
-                   (char) p_symbol->symbol, p_symbol->count);
+            printf("\tSymbol:  %c \tAnzahl:  %lu\n", 
+                   (char) ctx->p_symbol->symbol, ctx->p_symbol->count);
             fflush(stdout);
         }
-        p_symbol++;
+        ctx->p_symbol++;
     }
 }
 
 /** ---------------------------------------------------------------------------
  *  Funktion: print_memory_info
  *  ------------------------------------------------------------------------ */
-static void print_memory_info(void)
+static void print_memory_info(HUFF_CTX *ctx)
 {
-    int bytes = (int) (symbol_count * sizeof(SYMBOL));
+    int bytes = (int) (ctx->symbol_count * sizeof(SYMBOL));
     printf("\n------------------ Memory Info -------------------\n\n");
-    printf("\tAnzahl Zeichen: \t%u\n", symbol_count);
-    printf("\tAnzahl gel. Zeichen: \t%u\n", read_char_count);
+    printf("\tAnzahl Zeichen: \t%u\n", ctx->symbol_count);
+    printf("\tAnzahl gel. Zeichen: \t%lu\n", ctx->read_char_count);
     printf("\tStruct Array: \t\t%d Byte (%d Bit)\n", bytes, bytes * 8);
     fflush(stdout);
 }
@@ -744,31 +4233,31 @@ static void print_memory_info(void)
 /** ---------------------------------------------------------------------------
  *  Funktion: print_code_table
  *  ------------------------------------------------------------------------ */
-static void print_code_table(void)
+static void print_code_table(HUFF_CTX *ctx)
 {
     unsigned int i;
-    p_symbol = p_symbol_start;
+    ctx->p_symbol = ctx->p_symbol_start;
     
     printf("\n------------------ Code Table -------------------\n\n");
-    for (i = 0; i < symbol_count; i++)
+    for (i = 0; i < ctx->symbol_count; i++)
     {
-        if (p_symbol->symbol == '\n')
+        if (ctx->p_symbol->symbol == '\n')
         {
-            printf("\tSymbol: \\n\t\tCode: %s\n", p_symbol->code);
+            printf("\tSymbol: \\n\t\tCode: %s\n", ctx->p_symbol->code);
             fflush(stdout);
         }
-        else if (p_symbol->symbol == '\t')
+        else if (ctx->p_symbol->symbol == '\t')
         {
-            printf("\tSymbol: \\t\t\tCode: %s\n", p_symbol->code);
+            printf("\tSymbol: \\t\t\tCode: %s\n", ctx->p_symbol->code);
             fflush(stdout);
         }
         else
         {
             printf("\tSymbol: %c\t\tCode: %s\n", 
-                   p_symbol->symbol, p_symbol->code);
+                   ctx->p_symbol->symbol, ctx->p_symbol->code);
             fflush(stdout);
         }
-        p_symbol++;
+        ctx->p_symbol++;
     }    
 }
 
@@ -782,12 +4271,12 @@ static void print_symbol(SYMBOL* symbol)
         
         if (symbol->symbol == '\n')
         {
-            printf("Char: \\n, Count: %u\n", symbol->count);
+            printf("Char: \\n, Count: %lu\n", symbol->count);
             fflush(stdout);
         } 
         else
         {
-            printf("Char: %c, Count: %u, \n", symbol->symbol, symbol->count);
+            printf("Char: %c, Count: %lu, \n", symbol->symbol, symbol->count);
             fflush(stdout);
         }
     }
@@ -796,99 +4285,464 @@ static void print_symbol(SYMBOL* symbol)
 /** ---------------------------------------------------------------------------
  *  Funktion: read_header
  *  ------------------------------------------------------------------------ */
-static void read_header(FILE *p_input_stream)
+static void read_header(HUFF_CTX *ctx, FILE *p_input_stream)
 {
-    unsigned int i = 0;
-    size_t bytes_read = 0;
+    unsigned char header[CONTAINER_HEADER_SIZE + BLOCK_HEADER_SIZE];
+    unsigned int version;
+    size_t items_read;
+    
+    ctx->container_start = ftell(p_input_stream);
+    /*
+     * Container- und Blockheader haben eine feste Groesse und werden mit
+     * einem einzigen fread gelesen. Im Altformat steht am Anfang die Anzahl
+     * der Symbole (hoechstens 256), die Kennung kann dort nicht vorkommen.
+     */
+    items_read = fread(header, sizeof(unsigned char), sizeof(header),
+                       p_input_stream);
+    if (items_read < CONTAINER_HEADER_SIZE 
+            || memcmp(header, CONTAINER_MAGIC, 4) != 0)
+    {
+        fseek(p_input_stream, ctx->container_start, SEEK_SET);
+        read_legacy_header(ctx, p_input_stream);
+        return;
+    }
     
-    bytes_read = fread(&symbol_count, sizeof(unsigned int), 1, p_input_stream);
+    ctx->legacy_format = FALSE;
+    version = header[4];
+    ctx->legacy_tree_order = (version < CONTAINER_VERSION_HEAP_ORDER) 
+                             ? TRUE : FALSE;
+    ctx->read_flags = header[5];
+    ctx->read_char_count = load_le(header + 8, 8);
+    ctx->read_block_size = load_le(header + 16, 8);
     
-    if (bytes_read == 0)
+    if (version > CONTAINER_VERSION 
+            || (ctx->read_flags & ~CONTAINER_KNOWN_FLAGS) != 0)
     {
-        printf("Fehler beim einlesen des Headers.\n");
+        printf("Die Datei hat Version %u mit Flags 0x%02x und wird von "
+               "dieser Version nicht unterstuetzt.\n", version, 
+               ctx->read_flags);
         exit(EXIT_FAILURE);
     }
     
-    if (debug_mode)
+    /* Ein Stream kennt seine Laenge erst beim Abschlussblock. */
+    if ((ctx->read_flags & CONTAINER_FLAG_STREAM) != 0 
+            && items_read == sizeof(header))
+    {
+        ctx->read_char_count = count_stream_chars(ctx, p_input_stream);
+    }
+    
+    /*
+     * Eine leere Datei im Blockmodus besteht nur aus dem Containerheader, im
+     * Archiv folgt dahinter schon das naechste Mitglied.
+     */
+    if (items_read < sizeof(header) || ctx->read_char_count == 0)
+    {
+        if (ctx->read_char_count > 0)
+        {
+            printf("Fehler beim einlesen des Headers.\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(header + CONTAINER_HEADER_SIZE, 0, BLOCK_HEADER_SIZE);
+    }
+    
+    if (ctx->debug_mode)
     {
         printf("------------------ Symbolmap erstellt -------------------\n\n");
-        printf("\tSymbol_count: %u\n", symbol_count);
+        printf("\tVersion: %u, Flags: 0x%02x, Blockgroesse: %lu\n", 
+               version, ctx->read_flags, ctx->read_block_size);
+        printf("\tRead_char_count: %lu\n\n", ctx->read_char_count);
         fflush(stdout);
     }
     
-    bytes_read = fread(&read_char_count, 
-                       sizeof(unsigned int), 
-                       1, 
-                       p_input_stream);
+    parse_block_header(ctx, header + CONTAINER_HEADER_SIZE);
+    if (ctx->read_block.type == BLOCK_TYPE_HUFFMAN)
+    {
+        read_symbol_table(ctx, p_input_stream, BLOCK_SYMBOL_SIZE);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: count_stream_chars
+ *  ------------------------------------------------------------------------ */
+static unsigned long count_stream_chars(HUFF_CTX *ctx, FILE *p_input_stream)
+{
+    long block_start = ctx->container_start + CONTAINER_HEADER_SIZE;
+    unsigned long char_count = 0;
+    
+    fseek(p_input_stream, block_start, SEEK_SET);
+    read_block_header(ctx, p_input_stream);
+    while (ctx->read_block.raw_length > 0)
+    {
+        char_count += ctx->read_block.raw_length;
+        block_start += BLOCK_HEADER_SIZE 
+                       + block_table_size(ctx, p_input_stream, 
+                                          block_start + BLOCK_HEADER_SIZE)
+                       + (long) ctx->read_block.code_length 
+                       + READ_CHECKSUM_SIZE;
+        fseek(p_input_stream, block_start, SEEK_SET);
+        read_block_header(ctx, p_input_stream);
+    }
+    
+    fseek(p_input_stream, ctx->container_start + CONTAINER_HEADER_SIZE 
+                              + BLOCK_HEADER_SIZE, SEEK_SET);
+    
+    return char_count;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: read_block_header
+ *  ------------------------------------------------------------------------ */
+extern void read_block_header(HUFF_CTX *ctx, FILE *p_input_stream)
+{
+    unsigned char header[BLOCK_HEADER_SIZE];
+    
+    if (fread(header, sizeof(unsigned char), BLOCK_HEADER_SIZE, 
+              p_input_stream) != BLOCK_HEADER_SIZE)
+    {
+        printf("Die komprimierte Datei ist unvollstaendig.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    parse_block_header(ctx, header);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: parse_block_header
+ *  ------------------------------------------------------------------------ */
+static void parse_block_header(HUFF_CTX *ctx, unsigned char *p_header)
+{
+    ctx->read_block.type = p_header[0];
+    ctx->symbol_count = (unsigned int) load_le(p_header + 1, 2);
+    ctx->read_block.raw_length = load_le(p_header + 3, 8);
+    ctx->read_block.code_length = load_le(p_header + 11, 8);
+    
+    if (ctx->read_block.type > BLOCK_TYPE_RLE || ctx->symbol_count > 256)
+    {
+        printf("Die Datei enthaelt einen unbekannten Blocktyp.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    if ((ctx->read_block.type == BLOCK_TYPE_HUFFMAN && ctx->symbol_count == 0
+                && ctx->read_block.raw_length > 0)
+            || (ctx->read_block.type == BLOCK_TYPE_STORED 
+                && ctx->read_block.code_length != ctx->read_block.raw_length)
+            || (ctx->read_block.type == BLOCK_TYPE_CONTEXT 
+                && (ctx->symbol_count == 0 
+                    || ctx->symbol_count > CONTEXT_MAX_TABLES))
+            || (ctx->read_block.type == BLOCK_TYPE_WIDE 
+                && ctx->read_block.raw_length % 2 != 0)
+            || ((ctx->read_block.type == BLOCK_TYPE_STORED 
+                    || ctx->read_block.type == BLOCK_TYPE_REPEAT
+                    || ctx->read_block.type == BLOCK_TYPE_WIDE
+                    || ctx->read_block.type == BLOCK_TYPE_RLE) 
+                && ctx->symbol_count > 0))
+    {
+        printf("Die komprimierte Datei ist beschaedigt.\n");
+        exit(EXIT_FAILURE);
+    }
+}
 
-    if (bytes_read == 0)
+/** ---------------------------------------------------------------------------
+ *  Funktion: read_legacy_header
+ *  ------------------------------------------------------------------------ */
+static void read_legacy_header(HUFF_CTX *ctx, FILE *p_input_stream)
+{
+    unsigned int value;
+    
+    ctx->legacy_format = TRUE;
+    ctx->legacy_tree_order = TRUE;
+    ctx->read_flags = 0;
+    ctx->read_block_size = 0;
+    ctx->read_block.type = BLOCK_TYPE_HUFFMAN;
+    
+    if (fread(&ctx->symbol_count, sizeof(unsigned int), 1, p_input_stream) != 1
+            || fread(&value, sizeof(unsigned int), 1, p_input_stream) != 1
+            || ctx->symbol_count > 256)
     {
         printf("Fehler beim einlesen des Headers.\n");
         exit(EXIT_FAILURE);
     }
+    ctx->read_char_count = value;
     
-    if (debug_mode)
+    if (ctx->debug_mode)
     {
-        printf("\tRead_char_count: %u\n\n", read_char_count);
+        printf("------------------ Symbolmap erstellt -------------------\n\n");
+        printf("\tAltformat\n");
+        printf("\tSymbol_count: %u\n", ctx->symbol_count);
+        printf("\tRead_char_count: %lu\n\n", ctx->read_char_count);
         fflush(stdout);
     }
     
+    read_symbol_table(ctx, p_input_stream, 
+                      sizeof(unsigned char) + sizeof(unsigned int));
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: read_symbol_table
+ *  ------------------------------------------------------------------------ */
+static void read_symbol_table(HUFF_CTX *ctx,
+                              FILE *p_input_stream,
+                              unsigned int entry_size)
+{
+    unsigned char *p_table;
+    unsigned char *p_entry;
+    unsigned int i;
+    unsigned int value;
+    
+    ctx->p_symbol_start = allocator_alloc(&ctx->allocator, 
+                              (ctx->symbol_count + 1) * sizeof(SYMBOL));
+    p_table = malloc(ctx->symbol_count * entry_size + 1);
+    ENSURE_ENOUGH_MEMORY(p_table, "read_symbol_table");
     
-    p_symbol_start = calloc(symbol_count, sizeof(SYMBOL));
-    p_symbol = p_symbol_start;
+    if (fread(p_table, entry_size, ctx->symbol_count, p_input_stream) 
+            != ctx->symbol_count)
+    {
+        printf("Fehler beim einlesen des Headers.\n");
+        exit(EXIT_FAILURE);
+    }
     
-    for (i = 0; i < symbol_count; i++)
+    ctx->p_symbol = ctx->p_symbol_start;
+    p_entry = p_table;
+    for (i = 0; i < ctx->symbol_count; i++)
     {
-        bytes_read =  fread(&p_symbol->symbol,
-                            sizeof(unsigned char), 1, p_input_stream);
-        bytes_read += fread(&p_symbol->count,
-                            sizeof(unsigned int), 1, p_input_stream);
-        if (bytes_read == 0)
+        ctx->p_symbol->symbol = p_entry[0];
+        if (entry_size == BLOCK_SYMBOL_SIZE)
         {
-            printf("Fehler beim einlesen des Headers.\n");
-            exit(EXIT_FAILURE);
-        }        
-        p_symbol++;
+            ctx->p_symbol->count = load_le(p_entry + 1, 8);
+        }
+        else
+        {
+            /* Altformat: native unsigned int ohne Ausrichtung. */
+            memcpy(&value, p_entry + 1, sizeof(unsigned int));
+            ctx->p_symbol->count = value;
+        }
+        p_entry += entry_size;
+        ctx->p_symbol++;
     }
+    free(p_table);
     
-    if (debug_mode)
+    if (ctx->debug_mode)
     {
-        print_symbol_map();
+        print_symbol_map(ctx);
     }
 }
 
 /** ---------------------------------------------------------------------------
  *  Funktion: write_header
  *  ------------------------------------------------------------------------ */
-static void write_header(FILE *p_output_stream)
+static void write_header(HUFF_CTX *ctx,
+                         FILE *p_output_stream,
+                         unsigned int flags,
+                         unsigned long block_bytes)
 {
-    size_t bytes_written = 0;
-    unsigned int i = 0;
-    p_symbol = p_symbol_start;
+    unsigned char header[CONTAINER_HEADER_SIZE];
     
-    bytes_written =  fwrite(&symbol_count,
-                            sizeof(unsigned int), 1, p_output_stream);
-    bytes_written += fwrite(&read_char_count,
-                            sizeof(unsigned int), 1, p_output_stream);
+    store_container_header(header, flags, ctx->read_char_count, block_bytes);
+    
+    if (fwrite(header, sizeof(unsigned char), CONTAINER_HEADER_SIZE,
+               p_output_stream) != CONTAINER_HEADER_SIZE)
+    {
+        printf("Fehler beim schreiben des Headers.\n");
+        exit(EXIT_FAILURE);
+    }
+}
 
-    if (bytes_written == 0)
+/** ---------------------------------------------------------------------------
+ *  Funktion: write_block_header
+ *  ------------------------------------------------------------------------ */
+extern void write_block_header(HUFF_CTX *ctx,
+                               FILE *p_output_stream,
+                               unsigned int type,
+                               unsigned long raw_length,
+                               unsigned long code_length,
+                               CONTEXT_MODEL *p_model)
+{
+    unsigned int table_count = 
+            (type == BLOCK_TYPE_HUFFMAN) ? ctx->symbol_count : 0;
+    unsigned long header_size = BLOCK_HEADER_SIZE 
+                              + table_count * BLOCK_SYMBOL_SIZE;
+    unsigned char *p_header;
+    
+    if (type == BLOCK_TYPE_CONTEXT)
+    {
+        table_count = p_model->table_count;
+        header_size = BLOCK_HEADER_SIZE + CONTEXT_MODEL_SIZE(table_count);
+    }
+    p_header = malloc(header_size);
+    ENSURE_ENOUGH_MEMORY(p_header, "write_block_header");
+    
+    p_header[0] = (unsigned char) type;
+    store_le(p_header + 1, table_count, 2);
+    store_le(p_header + 3, raw_length, 8);
+    store_le(p_header + 11, code_length, 8);
+    
+    if (type == BLOCK_TYPE_CONTEXT)
+    {
+        memcpy(p_header + BLOCK_HEADER_SIZE, p_model->context_map, 
+               CONTEXT_COUNT);
+        memcpy(p_header + BLOCK_HEADER_SIZE + CONTEXT_COUNT, p_model->lengths,
+               table_count * 256);
+    }
+    else if (table_count > 0)
+    {
+        fill_symbol_table(ctx, p_header + BLOCK_HEADER_SIZE);
+    }
+    
+    if (fwrite(p_header, sizeof(unsigned char), header_size, p_output_stream)
+            != header_size)
     {
         printf("Fehler beim schreiben des Headers.\n");
         exit(EXIT_FAILURE);
-    }    
+    }
+    free(p_header);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: write_checksum
+ *  ------------------------------------------------------------------------ */
+static void write_checksum(FILE *p_output_stream, unsigned long checksum)
+{
+    unsigned char bytes[CHECKSUM_SIZE];
     
-    for (i = 0; i < symbol_count; i++)
+    store_le(bytes, checksum, CHECKSUM_SIZE);
+    if (fwrite(bytes, sizeof(unsigned char), CHECKSUM_SIZE, p_output_stream)
+            != CHECKSUM_SIZE)
     {
-        bytes_written =  fwrite(&(p_symbol->symbol),
-                                sizeof(unsigned char), 1, p_output_stream);
-        bytes_written += fwrite(&(p_symbol->count),
-                                sizeof(unsigned int), 1, p_output_stream);
+        printf("Fehler beim schreiben der Pruefsumme.\n");
+        exit(EXIT_FAILURE);
+    }
+}
 
-        if (bytes_written == 0)
-        {
-            printf("Fehler beim schreiben des Headers.\n");
-            exit(EXIT_FAILURE);
-        }           
-        p_symbol++;
+/** ---------------------------------------------------------------------------
+ *  Funktion: verify_checksum
+ *  ------------------------------------------------------------------------ */
+static void verify_checksum(HUFF_CTX *ctx,
+                            FILE *p_input_stream,
+                            long position,
+                            unsigned long actual,
+                            unsigned long block_number)
+{
+    unsigned char bytes[CHECKSUM_SIZE];
+    unsigned long expected;
+    
+    if (fseek(p_input_stream, position, SEEK_SET) != 0
+            || fread(bytes, sizeof(unsigned char), CHECKSUM_SIZE,
+                     p_input_stream) != CHECKSUM_SIZE)
+    {
+        printf("Die komprimierte Datei ist unvollstaendig.\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    expected = load_le(bytes, CHECKSUM_SIZE);
+    if (expected != actual)
+    {
+        printf("Pruefsumme von Block %lu falsch: erwartet %08lx, "
+               "berechnet %08lx.\n", block_number, expected, actual);
+        exit(EXIT_FAILURE);
+    }
+    ctx->verified_checksums++;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: write_symbol_table
+ *  ------------------------------------------------------------------------ */
+static void write_symbol_table(HUFF_CTX *ctx, FILE *p_output_stream)
+{
+    unsigned long table_size = ctx->symbol_count * BLOCK_SYMBOL_SIZE;
+    unsigned char *p_table = malloc(table_size + 1);
+    
+    ENSURE_ENOUGH_MEMORY(p_table, "write_symbol_table");
+    fill_symbol_table(ctx, p_table);
+    
+    if (fwrite(p_table, sizeof(unsigned char), table_size, p_output_stream)
+            != table_size)
+    {
+        printf("Fehler beim schreiben der Symboltabelle.\n");
+        exit(EXIT_FAILURE);
+    }
+    free(p_table);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: fill_symbol_table
+ *  ------------------------------------------------------------------------ */
+static void fill_symbol_table(HUFF_CTX *ctx, unsigned char *p_entry)
+{
+    unsigned int i;
+    
+    ctx->p_symbol = ctx->p_symbol_start;
+    for (i = 0; i < ctx->symbol_count; i++)
+    {
+        p_entry[0] = ctx->p_symbol->symbol;
+        store_le(p_entry + 1, ctx->p_symbol->count, 8);
+        p_entry += BLOCK_SYMBOL_SIZE;
+        ctx->p_symbol++;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: write_code_length
+ *  ------------------------------------------------------------------------ */
+static void write_code_length(HUFF_CTX *ctx,
+                              FILE *p_output_stream,
+                              long block_start)
+{
+    unsigned char length[8];
+    long data_end = ftell(p_output_stream);
+    long data_start = block_start + BLOCK_HEADER_SIZE 
+                    + (long) (ctx->symbol_count * BLOCK_SYMBOL_SIZE);
+    
+    store_le(length, (unsigned long) (data_end - data_start), 8);
+    
+    if (fseek(p_output_stream, block_start + 11, SEEK_SET) != 0
+            || fwrite(length, sizeof(unsigned char), 8, p_output_stream) != 8
+            || fseek(p_output_stream, data_end, SEEK_SET) != 0)
+    {
+        printf("Fehler beim schreiben des Headers.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: write_seek_index
+ *  ------------------------------------------------------------------------ */
+static void write_seek_index(HUFF_CTX *ctx,
+                             FILE *p_output_stream,
+                             SEEK_POINT *p_seek_points,
+                             unsigned int seek_point_count,
+                             unsigned long interval)
+{
+    unsigned long index_size = seek_point_count * CONTAINER_SEEK_POINT_SIZE
+                             + CONTAINER_SEEK_TRAILER_SIZE;
+    unsigned char *p_index = malloc(index_size);
+    unsigned char *p_entry = p_index;
+    unsigned int i;
+    
+    ENSURE_ENOUGH_MEMORY(p_index, "write_seek_index");
+    
+    for (i = 0; i < seek_point_count; i++)
+    {
+        store_le(p_entry, p_seek_points[i].byte_offset, 8);
+        p_entry[8] = (unsigned char) p_seek_points[i].bit_offset;
+        p_entry += CONTAINER_SEEK_POINT_SIZE;
+    }
+    
+    store_le(p_entry, interval, 8);
+    store_le(p_entry + 8, seek_point_count, 8);
+    memcpy(p_entry + 16, SEEK_INDEX_MAGIC, 4);
+    
+    if (fwrite(p_index, sizeof(unsigned char), index_size, p_output_stream)
+            != index_size)
+    {
+        printf("Fehler beim schreiben des Seek-Index.\n");
+        exit(EXIT_FAILURE);
+    }
+    free(p_index);
+    
+    if (ctx->debug_mode)
+    {
+        printf("\tSeek-Index: %u Sprungpunkte alle %lu Zeichen\n",
+               seek_point_count, interval);
+        fflush(stdout);
     }
 }
@@ -25,6 +25,168 @@
 /** Anzahl Elemente fuer die Speicher allokiert werden soll. */
 #define ALLOC_ELEMENTS 10
 
+/** Kennung des Containerformats am Dateianfang. */
+#define CONTAINER_MAGIC "HUFC"
+
+/**
+ * Aktuelle Version des Containerformats. Seit Version 2 werden die
+ * Huffman-Baeume mit der korrigierten Heapreihenfolge aufgebaut, Dateien der
+ * Version 1 und des Altformats werden mit der alten gelesen.
+ */
+#define CONTAINER_VERSION 2
+
+/** Erste Containerversion mit der korrigierten Heapreihenfolge. */
+#define CONTAINER_VERSION_HEAP_ORDER 2
+
+/**
+ * Groesse des Containerheaders in Byte: Kennung, Version, Flags, 2 reservierte
+ * Bytes, Anzahl Zeichen (8 Byte), Blockgroesse (8 Byte). Alle Zahlen werden
+ * als Little-Endian gespeichert.
+ */
+#define CONTAINER_HEADER_SIZE 24
+
+/** Flag: am Dateiende folgt ein Seek-Index. */
+#define CONTAINER_FLAG_SEEK_INDEX 0x01
+
+/**
+ * Flag: hinter den Daten jedes Blocks folgt die CRC32C der unkomprimierten
+ * Zeichen des Blocks (4 Byte, Little Endian).
+ */
+#define CONTAINER_FLAG_CHECKSUM 0x02
+
+/**
+ * Flag: der Container ist ein Mitglied eines Archivs und BLOCK_TYPE_REPEAT
+ * Bloecke vor dem ersten BLOCK_TYPE_HUFFMAN Block verwenden die gemeinsame
+ * Codetabelle des Archivs.
+ */
+#define CONTAINER_FLAG_SHARED_TABLE 0x04
+
+/**
+ * Flag: der Container wurde als Stream geschrieben. Die Anzahl Zeichen im
+ * Header ist 0, die Bloecke enden mit einem Block ohne Zeichen.
+ */
+#define CONTAINER_FLAG_STREAM 0x08
+
+/** Von dieser Version verstandene Flags. */
+#define CONTAINER_KNOWN_FLAGS \
+    (CONTAINER_FLAG_SEEK_INDEX | CONTAINER_FLAG_CHECKSUM \
+        | CONTAINER_FLAG_SHARED_TABLE | CONTAINER_FLAG_STREAM)
+
+/**
+ * Groesse eines Blockheaders in Byte: Typ, Anzahl Symbole (2 Byte), Anzahl
+ * Zeichen (8 Byte), Laenge des Huffman-Codes (8 Byte).
+ */
+#define BLOCK_HEADER_SIZE 19
+
+/** Groesse eines Eintrags der Symboltabelle: Zeichen und Haeufigkeit. */
+#define BLOCK_SYMBOL_SIZE 9
+
+/** Blocktyp: Symboltabelle gefolgt vom Huffman-Code. */
+#define BLOCK_TYPE_HUFFMAN 0
+
+/** Blocktyp: unkomprimierte Zeichen ohne Symboltabelle. */
+#define BLOCK_TYPE_STORED 1
+
+/**
+ * Blocktyp: Huffman-Code ohne Symboltabelle, kodiert mit der Tabelle des
+ * letzten Blocks vom Typ BLOCK_TYPE_HUFFMAN.
+ */
+#define BLOCK_TYPE_REPEAT 2
+
+/**
+ * Blocktyp: Kontextmodell erster Ordnung. Die Anzahl Symbole im Blockheader
+ * ist die Anzahl der Codetabellen, danach folgen das Modell im Format
+ * CONTEXT_MODEL_SIZE und der Huffman-Code.
+ */
+#define BLOCK_TYPE_CONTEXT 3
+
+/**
+ * Blocktyp: Huffman-Code ueber Zeichen aus je zwei Byte (Little Endian) mit
+ * gerader Anzahl Zeichen. Die Anzahl Symbole im Blockheader ist 0, danach
+ * folgen die Anzahl der Codelaengen (4 Byte) und je vorkommendem Zeichen
+ * aufsteigend das Zeichen (2 Byte) und seine Codelaenge (1 Byte).
+ */
+#define BLOCK_TYPE_WIDE 4
+
+/**
+ * Blocktyp: Huffman-Code ueber Literale und Laufzeichen (RLE_SYMBOL_COUNT
+ * Zeichen), die Codelaengen im Format von BLOCK_TYPE_WIDE.
+ */
+#define BLOCK_TYPE_RLE 5
+
+/** Kennung eines Woerterbuchs. */
+#define DICTIONARY_MAGIC "HUFD"
+
+/**
+ * Aktuelle Version des Woerterbuchs. Woerterbuecher der Version 1 werden wie
+ * Container der Version 1 mit der alten Heapreihenfolge aufgebaut.
+ */
+#define DICTIONARY_VERSION 3
+
+/** Erste Woerterbuchversion mit der korrigierten Heapreihenfolge. */
+#define DICTIONARY_VERSION_HEAP_ORDER 2
+
+/**
+ * Erste Woerterbuchversion mit der ID der Codes im Header. Nachrichten
+ * dieser Woerterbuecher beginnen mit der ID.
+ */
+#define DICTIONARY_VERSION_ID 3
+
+/**
+ * Groesse des Woerterbuchheaders: Kennung (4), Version (1), reserviert (1),
+ * Anzahl Symbole (2), ID der Codes (4). Danach folgen die Symbole im Format
+ * BLOCK_SYMBOL_SIZE.
+ */
+#define DICTIONARY_HEADER_SIZE 12
+
+/** Groesse des Woerterbuchheaders vor DICTIONARY_VERSION_ID, ohne ID. */
+#define DICTIONARY_LEGACY_HEADER_SIZE 8
+
+/** Kennung des Seek-Index am Ende der komprimierten Datei. */
+#define SEEK_INDEX_MAGIC "HCSX"
+
+/** Groesse eines Eintrags im Seek-Index des Altformats in Byte. */
+#define SEEK_POINT_SIZE (sizeof(unsigned int) + sizeof(unsigned char))
+
+/** Groesse des Abschlusses des Seek-Index im Altformat. */
+#define SEEK_TRAILER_SIZE (2 * sizeof(unsigned int) + 4)
+
+/** Groesse eines Eintrags im Seek-Index des Containers (8 + 1 Byte). */
+#define CONTAINER_SEEK_POINT_SIZE 9
+
+/** Groesse des Abschlusses des Seek-Index im Container (8 + 8 + 4 Byte). */
+#define CONTAINER_SEEK_TRAILER_SIZE 20
+
+/** Struktur eines Sprungpunkts im Seek-Index. */
+typedef struct _SEEK_POINT
+{
+    /**
+     * Byte im Huffman-Code ab dem Header
+     */
+    unsigned long byte_offset;
+    /**
+     * Bit innerhalb des Bytes (0 - 7)
+     */
+    unsigned int bit_offset;
+} SEEK_POINT;
+
+/** Struktur eines gelesenen Blockheaders. */
+typedef struct _BLOCK_HEADER
+{
+    /**
+     * Blocktyp (BLOCK_TYPE_*)
+     */
+    unsigned int type;
+    /**
+     * Anzahl Zeichen des Blocks
+     */
+    unsigned long raw_length;
+    /**
+     * Laenge der Daten hinter der Symboltabelle in Byte
+     */
+    unsigned long code_length;
+} BLOCK_HEADER;
+
 /** Struktur eines Symbols. */
 typedef struct _SYMBOL
 {
@@ -35,53 +197,75 @@ typedef struct _SYMBOL
     /**
      * Die Haeufigkeit des Zeichens
      */
-    unsigned int count;
+    unsigned long count;
     /**
      * Binaerkodierung als String
      */
     char *code;
 } SYMBOL;
 
-/** Zeiger auf den Startpunkt des Speicherbereichs der symbol_map. */
-SYMBOL *p_symbol_start;
-
-/** Zeiger fuer das Durchlaufen des Speicherbereichs der symbol_map. */
-SYMBOL *p_symbol;
-
-/** Anzahl der Symbole in der symbol_map. */
-unsigned int symbol_count;
-
-/** Anzahl eingelesener Zeichen. */
-unsigned int read_char_count;
-
-/** Zeiger fuer den dekomprimierten Text. */
-unsigned char *p_decompressed_text;
-
-/** Zeiger fuer den Startpunkt des dekomprimierten Text. */
-unsigned char *p_decompressed_text_start;
-
-/** Buffer fuer das eingelesene Bit. */
-unsigned char read_bit_buffer;
-
-/** Index des Bit Buffers. */
-unsigned int  bit_buffer_index;
+/**
+ * Codec-Kontext mit den Optionen und dem Zustand eines Aufrufs, definiert in
+ * huff_ctx.h.
+ */
+typedef struct _HUFF_CTX HUFF_CTX;
 
 /**
  * Diese Funktion komprimiert den Inhalt einer Eingabedatei und schreibt den
  * komprimierten Inhalt in einer Ausgabedatei.
  * 
+ * @param ctx Codec-Kontext
  * @param in_filename Eingabedatei
  * @param out_filename Ausgabedatei
  */
-extern void compress(char *in_filename, char *out_filename);
+extern void compress(HUFF_CTX *ctx, char *in_filename, char *out_filename);
+
+/**
+ * Diese Funktion berechnet die Groesse, die compress mit den gleichen
+ * Optionen schreiben wuerde, und gibt sie aufgeteilt in Header mit Tabellen
+ * und Daten aus. Die Codelaengen stehen schon nach dem Zaehlen der Zeichen
+ * fest, es wird nichts kodiert und keine Datei geschrieben. Mit
+ * sample_percent < 100 werden nur gleichmaessig verteilte Abschnitte der
+ * Eingabe gelesen und die Groesse hochgerechnet.
+ * 
+ * @param ctx Codec-Kontext
+ * @param in_filename Eingabedatei
+ */
+extern void estimate(HUFF_CTX *ctx, char *in_filename);
 
 /**
  * Diese Funktion dekomprimiert dne Inhalt einer Eingabedatei und schreibt den
- * dekomprimierten Inhalt in eine Ausgabedatei.
+ * dekomprimierten Inhalt in eine Ausgabedatei. Ist range_mode gesetzt, wird
+ * nur der Bereich range_start bis range_start + range_length dekomprimiert.
+ * Enthaelt die Datei einen Seek-Index, beginnt die Dekomprimierung am 
+ * naechstgelegenen Sprungpunkt vor dem Bereich.
  * 
+ * @param ctx Codec-Kontext
  * @param in_filename Eingabedatei
  * @param out_filename Ausgabedatei
  */
-extern void decompress(char *in_filename, char *out_filename);
+extern void decompress(HUFF_CTX *ctx, char *in_filename, char *out_filename);
+
+/**
+ * Diese Funktion vergleicht die Dekodierer anhand einer komprimierten Datei.
+ * Jeder Dekodierer dekomprimiert den gesamten Inhalt mehrfach, das Ergebnis
+ * wird mit dem des Baum-Dekodierers verglichen und der Durchsatz der
+ * schnellsten Wiederholung ausgegeben. Es wird keine Datei geschrieben.
+ * 
+ * @param ctx Codec-Kontext
+ * @param in_filename Eingabedatei
+ */
+extern void benchmark(HUFF_CTX *ctx, char *in_filename);
+
+/**
+ * Diese Funktion erstellt aus den Haeufigkeiten eines Beispielkorpus ein
+ * Woerterbuch mit einer festen Codetabelle. Jedes Zeichen erhaelt einen
+ * Code, damit beliebige Nachrichten kodiert werden koennen.
+ * 
+ * @param ctx Codec-Kontext
+ * @param in_filename Beispielkorpus
+ * @param out_filename Ausgabedatei fuer das Woerterbuch
+ */
+extern void train(HUFF_CTX *ctx, char *in_filename, char *out_filename);
 
 #endif	/* HUFFMAN_H */
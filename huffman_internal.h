@@ -0,0 +1,148 @@
+/**
+ * File: huffman_internal.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HUFFMAN_INTERNAL_H
+
+#define	HUFFMAN_INTERNAL_H
+
+#include <stdio.h>
+#include "common.h"
+#include "huffman.h"
+#include "huff_ctx.h"
+#include "btree.h"
+#include "context_model.h"
+
+/*
+ * Bausteine von huffman.c, die die Archive in archive.c und die Messungen in
+ * benchmark.c verwenden.
+ */
+
+/** Anzahl Zeichen die die Kernel je Aufruf verarbeiten. */
+#define KERNEL_CHUNK_SIZE 65536
+
+/** Verfahren der Leser und Schreiber, mit --no-cache ohne Seitencache. */
+#define IO_MODE \
+    (ctx->io_backend | ((ctx->no_cache_mode) ? IO_NO_CACHE : 0))
+
+/**
+ * Diese Funktion erstellt aus den Haeufigkeiten eines Blocks die symbol_map,
+ * den Huffman-Baum und die Codes der Zeichen.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_counts Haeufigkeit je Zeichen
+ * @return Der Huffman-Baum, freizugeben mit destroy_huffman_tree
+ */
+extern BTREE *create_block_codes(HUFF_CTX *ctx, unsigned long *p_counts);
+
+/**
+ * Diese Funktion gibt die Codes der symbol_map frei.
+ * 
+ * @param ctx Codec-Kontext
+ */
+extern void free_codes(HUFF_CTX *ctx);
+
+/**
+ * Diese Funktion gibt einen Huffman-Baum mit den Symbolen seiner inneren
+ * Knoten frei. Die Symbole der Blaetter gehoeren zur symbol_map. Liegt der
+ * Baum in einer Arena, wird die Arena auf einmal freigegeben, der Heap des
+ * Baums muss dann schon freigegeben sein.
+ * 
+ * @param p_huffman_tree Freizugebender Huffman-Baum
+ */
+extern void destroy_huffman_tree(BTREE *p_huffman_tree);
+
+/**
+ * Diese Funktion liest den Huffman-Code ab der aktuellen Position bis zum
+ * Dateiende, hoechstens aber max_length Bytes, in den Speicher. Grosse
+ * Bereiche werden mit dem Verfahren aus --io gelesen.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom der zu dekompressierenden Datei
+ * @param max_length Maximale Anzahl zu lesender Bytes
+ * @param p_length Anzahl der gelesenen Bytes
+ * @return Neu allokierter Speicherbereich mit dem Huffman-Code
+ */
+extern unsigned char *read_payload(HUFF_CTX *ctx,
+                                   FILE *p_input_stream,
+                                   unsigned long max_length,
+                                   unsigned long *p_length);
+
+/**
+ * Diese Funktion schreibt die Eingabe in Bloecken von block_size KB. Jeder
+ * Block erhaelt eine eigene Symboltabelle und wird gespeichert, wenn der
+ * Huffman-Code nicht kleiner als die Eingabe waere.
+ * 
+ * Ist p_output_stream NULL, werden fuer --estimate nur die Groessen der
+ * Bloecke gezaehlt und Bloecke ausserhalb der Stichprobe uebersprungen.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_output_stream Ausgabestrom fuer die komprimierte Datei oder NULL
+ * @param in_filename Name der Eingabedatei
+ */
+extern void write_blocks(HUFF_CTX *ctx,
+                         FILE *p_output_stream,
+                         char *in_filename);
+
+/**
+ * Diese Funktion schreibt einen Blockheader und bei Huffman-Bloecken die
+ * Symboltabelle aus der symbol_map, bei Kontextbloecken das Modell, mit
+ * einem einzigen fwrite.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_output_stream Ausgabestrom fuer die komprimierte Datei
+ * @param type Blocktyp
+ * @param raw_length Anzahl Zeichen des Blocks
+ * @param code_length Laenge der Blockdaten in Byte
+ * @param p_model Modell eines Kontextblocks, sonst NULL
+ */
+extern void write_block_header(HUFF_CTX *ctx,
+                               FILE *p_output_stream,
+                               unsigned int type,
+                               unsigned long raw_length,
+                               unsigned long code_length,
+                               CONTEXT_MODEL *p_model);
+
+/**
+ * Diese Funktion liest einen Blockheader ohne die Symboltabelle.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, positioniert am Blockheader
+ */
+extern void read_block_header(HUFF_CTX *ctx, FILE *p_input_stream);
+
+/**
+ * Diese Funktion liest den Header eines Containers ab der aktuellen Position
+ * und dekomprimiert seinen Inhalt nach out_filename.
+ * 
+ * @param ctx Codec-Kontext
+ * @param p_input_stream Eingabestrom, positioniert am Containerheader
+ * @param out_filename Ausgabedatei
+ */
+extern void decompress_container(HUFF_CTX *ctx,
+                                 FILE *p_input_stream,
+                                 char *out_filename);
+
+/**
+ * Diese Funktion laedt beim ersten Aufruf das Woerterbuch dictionary_filename
+ * und baut daraus mit huff_dict_init die Code- und Dekodiertabelle auf.
+ * 
+ * @param ctx Codec-Kontext
+ */
+extern void load_dictionary(HUFF_CTX *ctx);
+
+#endif	/* HUFFMAN_INTERNAL_H */
@@ -21,7 +21,14 @@
 #include <string.h>
 #include "common.h"
 #include "huffman.h"
+#include "huff_ctx.h"
 #include "argument_checker.h"
+#include "codec_kernels.h"
+#include "checksum.h"
+#include "file_jobs.h"
+#include "mem_budget.h"
+#include "archive.h"
+#include "benchmark.h"
 
 /**
  * Diese Funktion startet das Programm.
@@ -34,17 +41,61 @@ int main(int argc, char** argv)
 {
     char *in_filename = NULL;
     char *out_filename = NULL;
+    HUFF_CTX ctx;
+    BOOL within_limit;
     
-    check_arguments(argc, argv, &in_filename, &out_filename);
+    huff_ctx_init(&ctx);
+    check_arguments(&ctx, argc, argv, &in_filename, &out_filename);
+    mem_budget_apply(&ctx);
+    kernels_init(ctx.debug_mode);
+    checksum_init(ctx.debug_mode);
     
-    if (compress_mode == TRUE)
+    if (ctx.archive_mode == TRUE)
     {
-        compress(in_filename, out_filename);
+        archive(&ctx, in_filename);
+    }
+    else if (ctx.extract_mode == TRUE)
+    {
+        extract(&ctx, in_filename);
+    }
+    else if (ctx.list_mode == TRUE)
+    {
+        list_archive(&ctx, in_filename);
+    }
+    else if (ctx.job_count > 0)
+    {
+        run_file_jobs(&ctx, in_filename);
+    }
+    else if (ctx.compress_mode == TRUE && ctx.estimate_mode == TRUE)
+    {
+        estimate(&ctx, in_filename);
+    }
+    else if (ctx.compress_mode == TRUE)
+    {
+        compress(&ctx, in_filename, out_filename);
+    }
+    else if (ctx.io_benchmark_mode == TRUE)
+    {
+        benchmark_io(&ctx, in_filename);
+    }
+    else if (ctx.message_benchmark_mode == TRUE)
+    {
+        benchmark_messages(&ctx, in_filename);
+    }
+    else if (ctx.benchmark_mode == TRUE)
+    {
+        benchmark(&ctx, in_filename);
+    }
+    else if (ctx.train_mode == TRUE)
+    {
+        train(&ctx, in_filename, out_filename);
     }
     else
     {
-        decompress(in_filename, out_filename);
+        decompress(&ctx, in_filename, out_filename);
     }
     
-    return (EXIT_SUCCESS);
+    within_limit = mem_budget_report(&ctx);
+    huff_ctx_destroy(&ctx);
+    return (within_limit) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
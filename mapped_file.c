@@ -0,0 +1,112 @@
+/**
+ * File: mapped_file.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "common.h"
+#include "mapped_file.h"
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: mapped_file_create
+ *  ------------------------------------------------------------------------ */
+extern MAPPED_FILE *mapped_file_create(char *filename,
+                                       unsigned long length,
+                                       BOOL no_cache)
+{
+    void *p_map;
+    MAPPED_FILE *file = calloc(1, sizeof(MAPPED_FILE));
+    ENSURE_ENOUGH_MEMORY(file, "mapped_file_create");
+
+    file->length = length;
+    file->no_cache = no_cache;
+    file->descriptor = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (file->descriptor < 0)
+    {
+        printf("Datei zum Schreiben konnte nicht geoeffnet werden.\n");
+        fflush(stdout);
+        exit(EXIT_FAILURE);
+    }
+
+    if (ftruncate(file->descriptor, (off_t) length) != 0)
+    {
+        printf("Die Groesse der Ausgabedatei konnte nicht gesetzt werden.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /*
+     * Eine leere Datei laesst sich nicht abbilden, es gibt dann aber auch
+     * nichts zu schreiben.
+     */
+    if (length > 0)
+    {
+        p_map = mmap(NULL, (size_t) length, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, file->descriptor, 0);
+        if (p_map == MAP_FAILED)
+        {
+            printf("Die Ausgabedatei konnte nicht abgebildet werden.\n");
+            exit(EXIT_FAILURE);
+        }
+        file->data = p_map;
+    }
+
+    return file;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: mapped_file_close
+ *  ------------------------------------------------------------------------ */
+extern void mapped_file_close(MAPPED_FILE *file)
+{
+    /*
+     * Nur saubere Seiten lassen sich verwerfen, die geaenderten Seiten der
+     * Abbildung werden deshalb vorher geschrieben.
+     */
+    if (file->no_cache && file->data != NULL
+            && msync(file->data, (size_t) file->length, MS_SYNC) != 0)
+    {
+        printf("Fehler beim schreiben der Ausgabedatei.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (file->data != NULL && munmap(file->data, (size_t) file->length) != 0)
+    {
+        printf("Fehler beim schreiben der Ausgabedatei.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Ohne Abbildung haengen die Seiten an keinem Prozess mehr. */
+    if (file->no_cache)
+    {
+        posix_fadvise(file->descriptor, 0, 0, POSIX_FADV_DONTNEED);
+    }
+
+    if (close(file->descriptor) != 0)
+    {
+        printf("Fehler beim schreiben der Ausgabedatei.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    free(file);
+}
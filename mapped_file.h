@@ -0,0 +1,74 @@
+/**
+ * File: mapped_file.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPPED_FILE_H
+
+#define	MAPPED_FILE_H
+
+#include "common.h"
+
+/**
+ * Struktur einer in den Speicher abgebildeten Ausgabedatei. Die Datei wird
+ * beim Erzeugen auf ihre endgueltige Groesse gebracht, alle Schreibzugriffe
+ * auf data landen ohne weitere Kopie in der Datei.
+ */
+typedef struct _MAPPED_FILE
+{
+    /**
+     * Dateideskriptor der Ausgabedatei
+     */
+    int descriptor;
+    /**
+     * Anfang der Abbildung, NULL bei einer leeren Datei
+     */
+    unsigned char *data;
+    /**
+     * Groesse der Datei in Byte
+     */
+    unsigned long length;
+    /**
+     * TRUE um die geschriebenen Seiten beim Schliessen aus dem Seitencache
+     * zu verwerfen (--no-cache)
+     */
+    BOOL no_cache;
+} MAPPED_FILE;
+
+/**
+ * Legt die Ausgabedatei an, setzt ihre Groesse mit ftruncate auf length Byte
+ * und bildet sie beschreibbar in den Speicher ab. Bei einem Fehler wird das
+ * Programm beendet.
+ *
+ * @param filename Name der Ausgabedatei
+ * @param length Groesse der Datei in Byte
+ * @param no_cache TRUE um die Seiten beim Schliessen zu verwerfen
+ * @return Die abgebildete Datei
+ */
+extern MAPPED_FILE *mapped_file_create(char *filename,
+                                       unsigned long length,
+                                       BOOL no_cache);
+
+/**
+ * Hebt die Abbildung auf, schliesst die Datei und gibt den Speicher der
+ * Struktur frei. Mit no_cache werden die Seiten vorher geschrieben und
+ * danach aus dem Seitencache verworfen.
+ *
+ * @param file Abgebildete Datei
+ */
+extern void mapped_file_close(MAPPED_FILE *file);
+
+#endif	/* MAPPED_FILE_H */
@@ -0,0 +1,226 @@
+/**
+ * File: mem_budget.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "huff_ctx.h"
+#include "async_io.h"
+#include "fsm_decoder.h"
+#include "context_model.h"
+#include "wide_huffman.h"
+#include "mem_budget.h"
+
+/**
+ * Diese Funktion gibt aus, dass eine Option wegen der Speichergrenze
+ * verkleinert wurde.
+ *
+ * @param option Name der Option
+ * @param old_value Angegebener Wert
+ * @param new_value Verwendeter Wert
+ */
+static void print_change(char *option,
+                         unsigned long old_value,
+                         unsigned long new_value);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: mem_budget_apply
+ *  ------------------------------------------------------------------------ */
+extern void mem_budget_apply(HUFF_CTX *ctx)
+{
+    unsigned long available;
+    unsigned long job_limit;
+    unsigned long max_depth;
+    unsigned long max_block;
+    unsigned long tables = 0;
+
+    if (ctx->mem_limit == 0)
+    {
+        return;
+    }
+
+    if (ctx->mem_limit < 2 * MEM_BUDGET_RESERVE)
+    {
+        printf("Geben Sie fuer --mem-limit mindestens %d KB an!\n",
+               2 * MEM_BUDGET_RESERVE);
+        exit(EXIT_FAILURE);
+    }
+    available = ctx->mem_limit - MEM_BUDGET_RESERVE;
+
+    /* Jeder Thread von -j bearbeitet seine Datei mit einem eigenen Anteil. */
+    if (ctx->job_count > 1)
+    {
+        job_limit = available / MEM_BUDGET_JOB_MIN;
+        if (job_limit == 0)
+        {
+            job_limit = 1;
+        }
+        if (ctx->job_count > job_limit)
+        {
+            print_change("-j", ctx->job_count, job_limit);
+            ctx->job_count = job_limit;
+        }
+        available /= ctx->job_count;
+    }
+    ctx->mem_available = available * 1024;
+
+    /* Ein Leser und ein Schreiber belegen zusammen hoechstens ein Viertel. */
+    if (ctx->io_backend != IO_BACKEND_SYNC)
+    {
+        max_depth = ctx->mem_available / 4 / (2 * IO_CHUNK_SIZE);
+        if (max_depth == 0)
+        {
+            printf("Wegen --mem-limit: --io sync statt %s.\n",
+                   async_io_backend_name(ctx->io_backend));
+            ctx->io_backend = IO_BACKEND_SYNC;
+        }
+        else if (ctx->io_depth > max_depth)
+        {
+            print_change("--io-depth", ctx->io_depth, max_depth);
+            ctx->io_depth = max_depth;
+        }
+    }
+
+    /*
+     * Beim Komprimieren liegen ein Block der Eingabe, sein Code und die
+     * Tabellen der Blockmodelle gleichzeitig im Speicher, zusammen
+     * hoechstens die Haelfte des Anteils.
+     */
+    if (ctx->context_mode)
+    {
+        tables += CONTEXT_COUNT * 256 * sizeof(unsigned long)
+                + CONTEXT_MAX_TABLES * sizeof(CODE_TABLE);
+    }
+    if (ctx->wide_mode || ctx->rle_mode)
+    {
+        tables += WIDE_SYMBOL_COUNT * (sizeof(unsigned long) + 2)
+                + sizeof(WIDE_CODE);
+    }
+    if (ctx->block_size > 0)
+    {
+        max_block = (ctx->mem_available / 2 > tables)
+                  ? (ctx->mem_available / 2 - tables) / 2 / 1024 : 0;
+        if (max_block == 0)
+        {
+            printf("Die Tabellen von --context, --wide und --rle passen "
+                   "nicht in --mem-limit!\n");
+            exit(EXIT_FAILURE);
+        }
+        if (ctx->block_size > max_block)
+        {
+            print_change("--block", ctx->block_size, max_block);
+            ctx->block_size = max_block;
+        }
+    }
+
+    /* Der Zustandsautomat hat eine Tabelle je innerem Knoten. */
+    if (ctx->decoder_type == DECODER_FSM
+            && !mem_budget_fits(ctx, 2 * 255 * FSM_TRANSITIONS
+                                    * sizeof(FSM_TRANSITION)))
+    {
+        printf("Wegen --mem-limit: --decoder table statt fsm.\n");
+        ctx->decoder_type = DECODER_TABLE;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: mem_budget_fits
+ *  ------------------------------------------------------------------------ */
+extern BOOL mem_budget_fits(HUFF_CTX *ctx, unsigned long bytes)
+{
+    return (ctx->mem_available == 0 || bytes <= ctx->mem_available)
+            ? TRUE : FALSE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: mem_budget_peak
+ *  ------------------------------------------------------------------------ */
+extern unsigned long mem_budget_peak(void)
+{
+    char line[128];
+    unsigned long peak = 0;
+    FILE *p_status;
+
+    /*
+     * VmHWM gilt nur fuer dieses Programm, ru_maxrss von getrusage
+     * uebernimmt nach execve die Spitze des aufrufenden Prozesses.
+     */
+    p_status = fopen("/proc/self/status", "r");
+    if (p_status == NULL)
+    {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), p_status) != NULL)
+    {
+        if (strncmp(line, "VmHWM:", 6) == 0)
+        {
+            peak = strtoul(line + 6, NULL, 10);
+            break;
+        }
+    }
+    fclose(p_status);
+
+    return peak;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: mem_budget_report
+ *  ------------------------------------------------------------------------ */
+extern BOOL mem_budget_report(HUFF_CTX *ctx)
+{
+    unsigned long peak;
+    BOOL within_limit = TRUE;
+
+    if (ctx->mem_limit == 0 && !ctx->debug_mode)
+    {
+        return TRUE;
+    }
+
+    peak = mem_budget_peak();
+    if (ctx->mem_limit > 0)
+    {
+        printf("Speicherspitze: %lu KB von %lu KB.\n", peak, ctx->mem_limit);
+        if (peak > ctx->mem_limit)
+        {
+            printf("Die Speichergrenze wurde ueberschritten.\n");
+            within_limit = FALSE;
+        }
+    }
+    else
+    {
+        printf("Speicherspitze: %lu KB.\n", peak);
+    }
+    fflush(stdout);
+    
+    return within_limit;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: print_change
+ *  ------------------------------------------------------------------------ */
+static void print_change(char *option,
+                         unsigned long old_value,
+                         unsigned long new_value)
+{
+    printf("Wegen --mem-limit: %s %lu statt %lu.\n", 
+           option, new_value, old_value);
+}
@@ -0,0 +1,68 @@
+/**
+ * File: mem_budget.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MEM_BUDGET_H
+
+#define	MEM_BUDGET_H
+
+#include "common.h"
+#include "huffman.h"
+
+/** Speicher fuer Programm, Bibliotheken und Stapel in KB. */
+#define MEM_BUDGET_RESERVE 2048
+
+/** Kleinster Speicher je Thread von -j in KB. */
+#define MEM_BUDGET_JOB_MIN 4096
+
+/**
+ * Passt die Optionen an die Speichergrenze --mem-limit an. Von der Grenze
+ * wird MEM_BUDGET_RESERVE abgezogen und der Rest auf die Threads von -j
+ * verteilt. Jeder Anteil begrenzt die Blockgroesse, die Puffer der Ein- und
+ * Ausgabe und die Wahl des Dekodierers. Jede Aenderung wird ausgegeben, ist
+ * die Grenze zu klein, wird das Programm beendet.
+ *
+ * @param ctx Codec-Kontext mit den Optionen des Aufrufs
+ */
+extern void mem_budget_apply(HUFF_CTX *ctx);
+
+/**
+ * Prueft ob ein Puffer in den Speicheranteil eines Aufrufs passt.
+ *
+ * @param ctx Codec-Kontext
+ * @param bytes Groesse des Puffers in Byte
+ * @return TRUE ohne Speichergrenze oder wenn der Puffer passt
+ */
+extern BOOL mem_budget_fits(HUFF_CTX *ctx, unsigned long bytes);
+
+/**
+ * Liefert den bisher groessten belegten Arbeitsspeicher des Prozesses aus
+ * VmHWM in /proc/self/status.
+ *
+ * @return Speicherspitze in KB, 0 wenn das System sie nicht liefert
+ */
+extern unsigned long mem_budget_peak(void);
+
+/**
+ * Gibt mit --mem-limit oder -debug die Speicherspitze des Prozesses aus.
+ *
+ * @param ctx Codec-Kontext mit den Optionen des Aufrufs
+ * @return FALSE wenn die Speicherspitze ueber --mem-limit liegt
+ */
+extern BOOL mem_budget_report(HUFF_CTX *ctx);
+
+#endif	/* MEM_BUDGET_H */
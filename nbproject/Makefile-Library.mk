@@ -0,0 +1,237 @@
+#
+# Generated Makefile - do not edit!
+#
+# Edit the Makefile in the project folder instead (../Makefile). Each target
+# has a -pre and a -post target defined where you can add customized code.
+#
+# This makefile implements configuration specific macros and targets.
+
+
+# Environment
+MKDIR=mkdir
+CP=cp
+GREP=grep
+NM=nm
+CCADMIN=CCadmin
+RANLIB=ranlib
+CC=gcc
+CCC=g++
+CXX=g++
+FC=gfortran
+AS=as
+AR=ar
+
+# Macros
+CND_PLATFORM=GNU-Linux-x86
+CND_DLIB_EXT=so
+CND_CONF=Library
+CND_DISTDIR=dist
+CND_BUILDDIR=build
+
+# Include project Makefile
+include Makefile
+
+# Object Directory
+OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
+
+# Object Files
+OBJECTFILES= \
+	${OBJECTDIR}/allocator.o \
+	${OBJECTDIR}/archive.o \
+	${OBJECTDIR}/async_io.o \
+	${OBJECTDIR}/benchmark.o \
+	${OBJECTDIR}/binary_heap.o \
+	${OBJECTDIR}/bit_buffer.o \
+	${OBJECTDIR}/btree.o \
+	${OBJECTDIR}/btreenode.o \
+	${OBJECTDIR}/byte_order.o \
+	${OBJECTDIR}/checksum.o \
+	${OBJECTDIR}/codec_kernels.o \
+	${OBJECTDIR}/context_model.o \
+	${OBJECTDIR}/file_jobs.o \
+	${OBJECTDIR}/fsm_decoder.o \
+	${OBJECTDIR}/huff_batch.o \
+	${OBJECTDIR}/huff_buffer.o \
+	${OBJECTDIR}/huff_ctx.o \
+	${OBJECTDIR}/huff_dict.o \
+	${OBJECTDIR}/huff_stream.o \
+	${OBJECTDIR}/huffman.o \
+	${OBJECTDIR}/mapped_file.o \
+	${OBJECTDIR}/mem_budget.o \
+	${OBJECTDIR}/parallel_decoder.o \
+	${OBJECTDIR}/rle.o \
+	${OBJECTDIR}/wide_huffman.o \
+	${OBJECTDIR}/work_pool.o
+
+
+# C Compiler Flags
+CFLAGS=
+
+# CC Compiler Flags
+CCFLAGS=
+CXXFLAGS=
+
+# Fortran Compiler Flags
+FFLAGS=
+
+# Assembler Flags
+ASFLAGS=
+
+# Link Libraries and Options
+LDLIBSOPTIONS=
+
+# Build Targets
+.build-conf: ${BUILD_SUBPROJECTS}
+	"${MAKE}"  -f nbproject/Makefile-${CND_CONF}.mk ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/libhuffman.a
+
+${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/libhuffman.a: ${OBJECTFILES}
+	${MKDIR} -p ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}
+	${RM} ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/libhuffman.a
+	${AR} -rv ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/libhuffman.a ${OBJECTFILES} 
+	$(RANLIB) ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/libhuffman.a
+
+${OBJECTDIR}/allocator.o: allocator.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/allocator.o allocator.c
+
+${OBJECTDIR}/archive.o: archive.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/archive.o archive.c
+
+${OBJECTDIR}/async_io.o: async_io.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/async_io.o async_io.c
+
+${OBJECTDIR}/benchmark.o: benchmark.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/benchmark.o benchmark.c
+
+${OBJECTDIR}/binary_heap.o: binary_heap.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/binary_heap.o binary_heap.c
+
+${OBJECTDIR}/bit_buffer.o: bit_buffer.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/bit_buffer.o bit_buffer.c
+
+${OBJECTDIR}/btree.o: btree.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/btree.o btree.c
+
+${OBJECTDIR}/btreenode.o: btreenode.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/btreenode.o btreenode.c
+
+${OBJECTDIR}/byte_order.o: byte_order.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/byte_order.o byte_order.c
+
+${OBJECTDIR}/checksum.o: checksum.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/checksum.o checksum.c
+
+${OBJECTDIR}/codec_kernels.o: codec_kernels.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/codec_kernels.o codec_kernels.c
+
+${OBJECTDIR}/context_model.o: context_model.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/context_model.o context_model.c
+
+${OBJECTDIR}/file_jobs.o: file_jobs.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/file_jobs.o file_jobs.c
+
+${OBJECTDIR}/fsm_decoder.o: fsm_decoder.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/fsm_decoder.o fsm_decoder.c
+
+${OBJECTDIR}/huff_batch.o: huff_batch.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/huff_batch.o huff_batch.c
+
+${OBJECTDIR}/huff_buffer.o: huff_buffer.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/huff_buffer.o huff_buffer.c
+
+${OBJECTDIR}/huff_ctx.o: huff_ctx.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/huff_ctx.o huff_ctx.c
+
+${OBJECTDIR}/huff_dict.o: huff_dict.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/huff_dict.o huff_dict.c
+
+${OBJECTDIR}/huff_stream.o: huff_stream.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/huff_stream.o huff_stream.c
+
+${OBJECTDIR}/huffman.o: huffman.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/huffman.o huffman.c
+
+${OBJECTDIR}/mapped_file.o: mapped_file.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/mapped_file.o mapped_file.c
+
+${OBJECTDIR}/mem_budget.o: mem_budget.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/mem_budget.o mem_budget.c
+
+${OBJECTDIR}/parallel_decoder.o: parallel_decoder.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/parallel_decoder.o parallel_decoder.c
+
+${OBJECTDIR}/rle.o: rle.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/rle.o rle.c
+
+${OBJECTDIR}/wide_huffman.o: wide_huffman.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/wide_huffman.o wide_huffman.c
+
+${OBJECTDIR}/work_pool.o: work_pool.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/work_pool.o work_pool.c
+
+# Subprojects
+.build-subprojects:
+
+# Clean Targets
+.clean-conf: ${CLEAN_SUBPROJECTS}
+	${RM} -r ${CND_BUILDDIR}/${CND_CONF}
+	${RM} ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/libhuffman.a
+
+# Subprojects
+.clean-subprojects:
+
+# Enable dependency checking
+.dep.inc: .depcheck-impl
+
+include .dep.inc
@@ -35,13 +35,34 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 
 # Object Files
 OBJECTFILES= \
+	${OBJECTDIR}/allocator.o \
+	${OBJECTDIR}/archive.o \
 	${OBJECTDIR}/argument_checker.o \
+	${OBJECTDIR}/async_io.o \
+	${OBJECTDIR}/benchmark.o \
 	${OBJECTDIR}/binary_heap.o \
 	${OBJECTDIR}/bit_buffer.o \
 	${OBJECTDIR}/btree.o \
 	${OBJECTDIR}/btreenode.o \
+	${OBJECTDIR}/byte_order.o \
+	${OBJECTDIR}/checksum.o \
+	${OBJECTDIR}/codec_kernels.o \
+	${OBJECTDIR}/context_model.o \
+	${OBJECTDIR}/file_jobs.o \
+	${OBJECTDIR}/fsm_decoder.o \
+	${OBJECTDIR}/huff_batch.o \
+	${OBJECTDIR}/huff_buffer.o \
+	${OBJECTDIR}/huff_ctx.o \
+	${OBJECTDIR}/huff_dict.o \
+	${OBJECTDIR}/huff_stream.o \
 	${OBJECTDIR}/huffman.o \
-	${OBJECTDIR}/main.o
+	${OBJECTDIR}/main.o \
+	${OBJECTDIR}/mapped_file.o \
+	${OBJECTDIR}/mem_budget.o \
+	${OBJECTDIR}/parallel_decoder.o \
+	${OBJECTDIR}/rle.o \
+	${OBJECTDIR}/wide_huffman.o \
+	${OBJECTDIR}/work_pool.o
 
 
 # C Compiler Flags
@@ -58,7 +79,7 @@ FFLAGS=
 ASFLAGS=
 
 # Link Libraries and Options
-LDLIBSOPTIONS=
+LDLIBSOPTIONS=-lpthread -lm
 
 # Build Targets
 .build-conf: ${BUILD_SUBPROJECTS}
@@ -68,11 +89,31 @@ ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/huffman: ${OBJECTFILES}
 	${MKDIR} -p ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}
 	${LINK.c} -o ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/huffman ${OBJECTFILES} ${LDLIBSOPTIONS}
 
+${OBJECTDIR}/allocator.o: allocator.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/allocator.o allocator.c
+
+${OBJECTDIR}/archive.o: archive.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/archive.o archive.c
+
 ${OBJECTDIR}/argument_checker.o: argument_checker.c 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/argument_checker.o argument_checker.c
 
+${OBJECTDIR}/async_io.o: async_io.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/async_io.o async_io.c
+
+${OBJECTDIR}/benchmark.o: benchmark.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/benchmark.o benchmark.c
+
 ${OBJECTDIR}/binary_heap.o: binary_heap.c 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -93,6 +134,61 @@ ${OBJECTDIR}/btreenode.o: btreenode.c
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/btreenode.o btreenode.c
 
+${OBJECTDIR}/byte_order.o: byte_order.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/byte_order.o byte_order.c
+
+${OBJECTDIR}/checksum.o: checksum.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/checksum.o checksum.c
+
+${OBJECTDIR}/codec_kernels.o: codec_kernels.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/codec_kernels.o codec_kernels.c
+
+${OBJECTDIR}/context_model.o: context_model.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/context_model.o context_model.c
+
+${OBJECTDIR}/file_jobs.o: file_jobs.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/file_jobs.o file_jobs.c
+
+${OBJECTDIR}/fsm_decoder.o: fsm_decoder.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/fsm_decoder.o fsm_decoder.c
+
+${OBJECTDIR}/huff_batch.o: huff_batch.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/huff_batch.o huff_batch.c
+
+${OBJECTDIR}/huff_buffer.o: huff_buffer.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/huff_buffer.o huff_buffer.c
+
+${OBJECTDIR}/huff_ctx.o: huff_ctx.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/huff_ctx.o huff_ctx.c
+
+${OBJECTDIR}/huff_dict.o: huff_dict.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/huff_dict.o huff_dict.c
+
+${OBJECTDIR}/huff_stream.o: huff_stream.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/huff_stream.o huff_stream.c
+
 ${OBJECTDIR}/huffman.o: huffman.c 
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -103,6 +199,36 @@ ${OBJECTDIR}/main.o: main.c
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/main.o main.c
 
+${OBJECTDIR}/mapped_file.o: mapped_file.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/mapped_file.o mapped_file.c
+
+${OBJECTDIR}/mem_budget.o: mem_budget.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/mem_budget.o mem_budget.c
+
+${OBJECTDIR}/parallel_decoder.o: parallel_decoder.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/parallel_decoder.o parallel_decoder.c
+
+${OBJECTDIR}/rle.o: rle.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/rle.o rle.c
+
+${OBJECTDIR}/wide_huffman.o: wide_huffman.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/wide_huffman.o wide_huffman.c
+
+${OBJECTDIR}/work_pool.o: work_pool.c 
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/work_pool.o work_pool.c
+
 # Subprojects
 .build-subprojects:
 
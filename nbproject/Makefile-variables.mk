@@ -22,6 +22,14 @@ CND_ARTIFACT_PATH_Release=dist/Release/GNU-Linux-x86/huffman
 CND_PACKAGE_DIR_Release=dist/Release/GNU-Linux-x86/package
 CND_PACKAGE_NAME_Release=huffman.tar
 CND_PACKAGE_PATH_Release=dist/Release/GNU-Linux-x86/package/huffman.tar
+# Library configuration
+CND_PLATFORM_Library=GNU-Linux-x86
+CND_ARTIFACT_DIR_Library=dist/Library/GNU-Linux-x86
+CND_ARTIFACT_NAME_Library=libhuffman.a
+CND_ARTIFACT_PATH_Library=dist/Library/GNU-Linux-x86/libhuffman.a
+CND_PACKAGE_DIR_Library=dist/Library/GNU-Linux-x86/package
+CND_PACKAGE_NAME_Library=huffman.tar
+CND_PACKAGE_PATH_Library=dist/Library/GNU-Linux-x86/package/huffman.tar
 #
 # include compiler specific variables
 #
@@ -0,0 +1,447 @@
+/**
+ * File: parallel_decoder.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "common.h"
+#include "codec_kernels.h"
+#include "parallel_decoder.h"
+
+/** Struktur eines Abschnitts, den ein Thread dekodiert. */
+typedef struct _SEGMENT
+{
+    /**
+     * Dekodiertabelle
+     */
+    DECODE_TABLE *table;
+    /**
+     * Gesamter Huffman-Code
+     */
+    unsigned char *p_input;
+    /**
+     * Laenge des Huffman-Codes in Bit
+     */
+    unsigned long input_bits;
+    /**
+     * Bitposition an der der Thread zu dekodieren beginnt
+     */
+    unsigned long start_bit;
+    /**
+     * Erstes Bit des naechsten Abschnitts
+     */
+    unsigned long end_bit;
+    /**
+     * Maximale Anzahl zu dekodierender Zeichen
+     */
+    unsigned long output_limit;
+    /**
+     * Dekodierte Zeichen
+     */
+    unsigned char *p_output;
+    /**
+     * Groesse von p_output
+     */
+    unsigned long output_capacity;
+    /**
+     * Anzahl dekodierter Zeichen
+     */
+    unsigned long output_count;
+    /**
+     * Startpositionen der Zeichen in den ersten PARALLEL_SYNC_BITS Bits,
+     * der Index entspricht dem Index in p_output
+     */
+    unsigned long *p_head_bits;
+    /**
+     * Anzahl Eintraege in p_head_bits
+     */
+    unsigned long head_count;
+    /**
+     * Startpositionen der Zeichen in den ersten PARALLEL_SYNC_BITS Bits des
+     * naechsten Abschnitts
+     */
+    unsigned long *p_tail_bits;
+    /**
+     * Anzahl Eintraege in p_tail_bits
+     */
+    unsigned long tail_count;
+    /**
+     * Index in p_output des ersten Zeichens in p_tail_bits
+     */
+    unsigned long tail_index;
+    /**
+     * Erstes gueltiges Zeichen nach der Synchronisation
+     */
+    unsigned long first;
+    /**
+     * Erstes nicht mehr gueltiges Zeichen
+     */
+    unsigned long last;
+} SEGMENT;
+
+/**
+ * Thread-Funktion: dekodiert einen Abschnitt und merkt sich die
+ * Zeichengrenzen am Anfang des Abschnitts und hinter dessen Ende.
+ *
+ * @param p_segment Zu dekodierender Abschnitt (SEGMENT*)
+ * @return NULL
+ */
+static void *decode_segment(void *p_segment);
+
+/**
+ * Dekodiert Zeichen einzeln und merkt sich deren Startposition, solange
+ * die Position vor until_bit liegt.
+ *
+ * @param segment Abschnitt
+ * @param state Zustand des Dekodierers
+ * @param until_bit Erste nicht mehr aufzuzeichnende Position
+ * @param p_bits Speicher fuer die Startpositionen
+ * @return Anzahl aufgezeichneter Zeichen
+ */
+static unsigned long decode_recorded(SEGMENT *segment,
+                                     DECODE_STATE *state,
+                                     unsigned long until_bit,
+                                     unsigned long *p_bits);
+
+/**
+ * Berechnet die aktuelle Bitposition des Dekodierers im Huffman-Code.
+ *
+ * @param segment Abschnitt
+ * @param state Zustand des Dekodierers
+ * @return Position des naechsten ungelesenen Bits
+ */
+static unsigned long get_bit_position(SEGMENT *segment, DECODE_STATE *state);
+
+/**
+ * Sucht die erste gemeinsame Zeichengrenze zweier aufeinanderfolgender
+ * Abschnitte.
+ *
+ * @param previous Vorgaenger, dessen Ergebnis korrekt ist
+ * @param next Spekulativ dekodierter Nachfolger
+ * @param p_previous_index Index der Grenze in p_tail_bits des Vorgaengers
+ * @param p_next_index Index der Grenze in p_head_bits des Nachfolgers
+ * @return TRUE wenn eine gemeinsame Grenze gefunden wurde
+ */
+static BOOL find_sync_point(SEGMENT *previous,
+                            SEGMENT *next,
+                            unsigned long *p_previous_index,
+                            unsigned long *p_next_index);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: parallel_decode
+ *  ------------------------------------------------------------------------ */
+extern unsigned long parallel_decode(DECODE_TABLE *table,
+                                     unsigned char *p_input,
+                                     unsigned long input_length,
+                                     unsigned char *p_output,
+                                     unsigned long output_length,
+                                     unsigned int thread_count,
+                                     BOOL verbose)
+{
+    SEGMENT *segments;
+    pthread_t *threads;
+    BOOL *p_started;
+    DECODE_STATE state;
+    unsigned long segment_bytes, previous_index, next_index;
+    unsigned long length, total = 0;
+    unsigned int i, count, segment_count;
+
+    /*
+     * Jeder Abschnitt muss deutlich groesser als das Synchronisationsfenster
+     * sein, sonst lohnt sich kein eigener Thread.
+     */
+    count = thread_count;
+    if (input_length / PARALLEL_MIN_SEGMENT_BYTES < count)
+    {
+        count = (unsigned int) (input_length / PARALLEL_MIN_SEGMENT_BYTES);
+    }
+
+    if (count <= 1 || table->single)
+    {
+        decode_state_init(&state, p_input, input_length, 0);
+        return kernel_decode(table, &state, p_output, output_length);
+    }
+
+    segment_count = count;
+    segments = calloc(count, sizeof(SEGMENT));
+    threads = calloc(count, sizeof(pthread_t));
+    p_started = calloc(count, sizeof(BOOL));
+    ENSURE_ENOUGH_MEMORY(segments, "parallel_decode");
+    ENSURE_ENOUGH_MEMORY(threads, "parallel_decode");
+    ENSURE_ENOUGH_MEMORY(p_started, "parallel_decode");
+
+    segment_bytes = input_length / count;
+    for (i = 0; i < count; i++)
+    {
+        segments[i].table = table;
+        segments[i].p_input = p_input;
+        segments[i].input_bits = input_length * 8;
+        segments[i].start_bit = i * segment_bytes * 8;
+        segments[i].end_bit = (i + 1 < count) ? (i + 1) * segment_bytes * 8
+                                              : input_length * 8;
+        segments[i].output_limit = output_length;
+    }
+
+    /* Abschnitt 0 dekodiert der aufrufende Thread selbst. */
+    for (i = 1; i < count; i++)
+    {
+        p_started[i] = (pthread_create(&threads[i], NULL, decode_segment,
+                                       &segments[i]) == 0) ? TRUE : FALSE;
+    }
+    decode_segment(&segments[0]);
+    for (i = 1; i < count; i++)
+    {
+        if (p_started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+        else
+        {
+            decode_segment(&segments[i]);
+        }
+    }
+
+    /*
+     * Zusammenfuegen: Abschnitt 0 ist korrekt. Jeder weitere Abschnitt
+     * wird ab der ersten Zeichengrenze uebernommen, die auch der korrekte
+     * Pfad des Vorgaengers trifft.
+     */
+    segments[0].first = 0;
+    for (i = 0; i + 1 < count; i++)
+    {
+        if (segments[i].tail_count == 0)
+        {
+            /* Der Vorgaenger hat bereits alle Zeichen dekodiert. */
+            segments[i].last = segments[i].output_count;
+            count = i + 1;
+            break;
+        }
+
+        if (find_sync_point(&segments[i], &segments[i + 1],
+                            &previous_index, &next_index))
+        {
+            if (verbose)
+            {
+                printf("\tAbschnitt %u: synchronisiert nach %lu Bit\n", i + 1,
+                       segments[i].p_tail_bits[previous_index]
+                       - segments[i + 1].start_bit);
+            }
+        }
+        else
+        {
+            /*
+             * Keine gemeinsame Grenze: den Nachfolger ab der ersten
+             * korrekten Grenze in seinem Abschnitt neu dekodieren.
+             */
+            if (verbose)
+            {
+                printf("\tAbschnitt %u: keine Synchronisation, "
+                       "dekodiere neu\n", i + 1);
+            }
+            free(segments[i + 1].p_output);
+            free(segments[i + 1].p_head_bits);
+            free(segments[i + 1].p_tail_bits);
+            segments[i + 1].start_bit = segments[i].p_tail_bits[0];
+            decode_segment(&segments[i + 1]);
+            previous_index = 0;
+            next_index = 0;
+        }
+
+        segments[i].last = segments[i].tail_index + previous_index;
+        segments[i + 1].first = next_index;
+    }
+    segments[count - 1].last = segments[count - 1].output_count;
+
+    for (i = 0; i < count && total < output_length; i++)
+    {
+        length = segments[i].last - segments[i].first;
+        if (length > output_length - total)
+        {
+            length = output_length - total;
+        }
+        memcpy(p_output + total, segments[i].p_output + segments[i].first,
+               length);
+        total += length;
+    }
+
+    for (i = 0; i < segment_count; i++)
+    {
+        free(segments[i].p_output);
+        free(segments[i].p_head_bits);
+        free(segments[i].p_tail_bits);
+    }
+    free(segments);
+    free(threads);
+    free(p_started);
+
+    return total;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_segment
+ *  ------------------------------------------------------------------------ */
+static void *decode_segment(void *p_segment)
+{
+    SEGMENT *segment = p_segment;
+    DECODE_STATE state;
+    unsigned long position, head_end, tail_end, request, decoded;
+    unsigned long start_byte = segment->start_bit / 8;
+
+    head_end = segment->start_bit + PARALLEL_SYNC_BITS;
+    if (head_end > segment->end_bit)
+    {
+        head_end = segment->end_bit;
+    }
+    tail_end = segment->end_bit + PARALLEL_SYNC_BITS;
+    if (tail_end > segment->input_bits)
+    {
+        tail_end = segment->input_bits;
+    }
+
+    /* Jedes Zeichen belegt mindestens ein Bit. */
+    segment->output_capacity = tail_end - segment->start_bit;
+    if (segment->output_capacity > segment->output_limit)
+    {
+        segment->output_capacity = segment->output_limit;
+    }
+    segment->output_count = 0;
+    segment->p_output = malloc(segment->output_capacity + 1);
+    segment->p_head_bits = malloc(PARALLEL_SYNC_BITS * sizeof(unsigned long));
+    segment->p_tail_bits = malloc(PARALLEL_SYNC_BITS * sizeof(unsigned long));
+    ENSURE_ENOUGH_MEMORY(segment->p_output, "decode_segment");
+    ENSURE_ENOUGH_MEMORY(segment->p_head_bits, "decode_segment");
+    ENSURE_ENOUGH_MEMORY(segment->p_tail_bits, "decode_segment");
+
+    decode_state_init(&state, segment->p_input + start_byte,
+                      segment->input_bits / 8 - start_byte,
+                      (unsigned int) (segment->start_bit % 8));
+
+    segment->head_count = decode_recorded(segment, &state, head_end,
+                                          segment->p_head_bits);
+
+    /*
+     * Bis zum Ende des Abschnitts blockweise dekodieren. Es werden nur so
+     * viele Zeichen angefordert, wie sicher vor end_bit beginnen.
+     */
+    position = get_bit_position(segment, &state);
+    while (position < segment->end_bit
+            && segment->output_count < segment->output_capacity)
+    {
+        request = (segment->end_bit - position) / segment->table->max_length;
+        if (request == 0)
+        {
+            request = 1;
+        }
+        if (request > segment->output_capacity - segment->output_count)
+        {
+            request = segment->output_capacity - segment->output_count;
+        }
+
+        decoded = kernel_decode(segment->table, &state,
+                                segment->p_output + segment->output_count,
+                                request);
+        segment->output_count += decoded;
+        if (decoded < request)
+        {
+            break;
+        }
+        position = get_bit_position(segment, &state);
+    }
+
+    segment->tail_index = segment->output_count;
+    segment->tail_count = decode_recorded(segment, &state, tail_end,
+                                          segment->p_tail_bits);
+
+    return NULL;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: decode_recorded
+ *  ------------------------------------------------------------------------ */
+static unsigned long decode_recorded(SEGMENT *segment,
+                                     DECODE_STATE *state,
+                                     unsigned long until_bit,
+                                     unsigned long *p_bits)
+{
+    unsigned long count = 0;
+    unsigned long position = get_bit_position(segment, state);
+
+    /*
+     * Das erste Zeichen wird immer aufgezeichnet, auch wenn das letzte
+     * Zeichen davor bereits ueber until_bit hinausreicht.
+     */
+    while ((position < until_bit || count == 0) && count < PARALLEL_SYNC_BITS
+            && segment->output_count < segment->output_capacity)
+    {
+        if (kernel_decode(segment->table, state,
+                          segment->p_output + segment->output_count, 1) != 1)
+        {
+            break;
+        }
+        p_bits[count++] = position;
+        segment->output_count++;
+        position = get_bit_position(segment, state);
+    }
+
+    return count;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: get_bit_position
+ *  ------------------------------------------------------------------------ */
+static unsigned long get_bit_position(SEGMENT *segment, DECODE_STATE *state)
+{
+    return (unsigned long) (state->p_next - segment->p_input) * 8
+            - state->bit_count;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: find_sync_point
+ *  ------------------------------------------------------------------------ */
+static BOOL find_sync_point(SEGMENT *previous,
+                            SEGMENT *next,
+                            unsigned long *p_previous_index,
+                            unsigned long *p_next_index)
+{
+    unsigned long i = 0, j = 0;
+
+    /* Beide Listen sind aufsteigend sortiert. */
+    while (i < previous->tail_count && j < next->head_count)
+    {
+        if (previous->p_tail_bits[i] == next->p_head_bits[j])
+        {
+            *p_previous_index = i;
+            *p_next_index = j;
+            return TRUE;
+        }
+
+        if (previous->p_tail_bits[i] < next->p_head_bits[j])
+        {
+            i++;
+        }
+        else
+        {
+            j++;
+        }
+    }
+
+    return FALSE;
+}
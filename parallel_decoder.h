@@ -0,0 +1,62 @@
+/**
+ * File: parallel_decoder.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARALLEL_DECODER_H
+
+#define	PARALLEL_DECODER_H
+
+#include "common.h"
+#include "codec_kernels.h"
+
+/**
+ * Anzahl Bits am Anfang jedes Abschnitts, in denen sich ein spekulativ
+ * gestarteter Thread mit dem wahren Dekodierpfad synchronisieren muss.
+ */
+#define PARALLEL_SYNC_BITS 4096
+
+/** Minimale Groesse eines Abschnitts je Thread in Byte. */
+#define PARALLEL_MIN_SEGMENT_BYTES 65536
+
+/**
+ * Dekodiert einen Huffman-Code ohne Blockgrenzen mit mehreren Threads. Der
+ * Code wird in gleich grosse Abschnitte geteilt, jeder Thread beginnt
+ * spekulativ am Anfang seines Abschnitts. Da Huffman-Codes sich nach wenigen
+ * Zeichen selbst synchronisieren, laeuft der Pfad des Vorgaengers nach
+ * kurzer Zeit auf eine Zeichengrenze des Threads; ab dort ist dessen
+ * Ergebnis korrekt und wird angehaengt. Findet sich innerhalb von
+ * PARALLEL_SYNC_BITS keine gemeinsame Grenze, wird der Abschnitt vom Ende des
+ * Vorgaengers aus erneut dekodiert.
+ *
+ * @param table Dekodiertabelle (max_length <= KERNEL_MAX_CODE_LENGTH)
+ * @param p_input Huffman-Code ab dem ersten Bit
+ * @param input_length Laenge des Huffman-Codes in Byte
+ * @param p_output Puffer fuer die dekodierten Zeichen
+ * @param output_length Anzahl der zu dekodierenden Zeichen
+ * @param thread_count Maximale Anzahl Threads
+ * @param verbose TRUE um die Synchronisation der Abschnitte auszugeben
+ * @return Anzahl der dekodierten Zeichen
+ */
+extern unsigned long parallel_decode(DECODE_TABLE *table,
+                                     unsigned char *p_input,
+                                     unsigned long input_length,
+                                     unsigned char *p_output,
+                                     unsigned long output_length,
+                                     unsigned int thread_count,
+                                     BOOL verbose);
+
+#endif	/* PARALLEL_DECODER_H */
@@ -0,0 +1,331 @@
+/**
+ * File: rle.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "codec_kernels.h"
+#include "wide_huffman.h"
+#include "rle.h"
+
+/** Maske eines Fensters von WIDE_MAX_CODE_LENGTH Bits. */
+#define RLE_WINDOW_MASK ((1UL << WIDE_MAX_CODE_LENGTH) - 1)
+
+/** Groesste Anzahl Wiederholungen eines einzelnen Laufzeichens. */
+#define RLE_MAX_REPEAT ((1UL << RLE_MAX_CLASS) * 2 - 1)
+
+/**
+ * Diese Funktion zaehlt, wie oft das Zeichen ab p_input wiederholt wird.
+ * Verglichen wird wortweise, der Rest byteweise.
+ *
+ * @param p_input Erstes zu pruefendes Byte
+ * @param p_input_end Ende der Eingabe
+ * @param symbol Wiederholtes Zeichen
+ * @return Anzahl der Wiederholungen
+ */
+static unsigned long run_length(unsigned char *p_input,
+                                unsigned char *p_input_end,
+                                unsigned char symbol);
+
+/**
+ * Diese Funktion bestimmt die Laengenklasse einer Anzahl Wiederholungen.
+ *
+ * @param repeat Anzahl der Wiederholungen (1 - RLE_MAX_REPEAT)
+ * @return Klasse k mit 2^k <= repeat < 2^(k + 1)
+ */
+static unsigned int run_class(unsigned long repeat);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: rle_count
+ *  ------------------------------------------------------------------------ */
+extern unsigned long rle_count(unsigned char *p_input,
+                               unsigned long input_length,
+                               unsigned long *p_counts)
+{
+    unsigned char *p_input_end = p_input + input_length;
+    unsigned long extra_bits = 0;
+    unsigned long repeat, chunk;
+    unsigned int run;
+
+    memset(p_counts, 0, WIDE_SYMBOL_COUNT * sizeof(unsigned long));
+    while (p_input < p_input_end)
+    {
+        p_counts[*p_input]++;
+        repeat = run_length(p_input + 1, p_input_end, *p_input);
+        p_input += 1 + repeat;
+
+        /* Kurze Laeufe bleiben Literale. */
+        while (repeat >= RLE_MIN_REPEAT)
+        {
+            chunk = (repeat < RLE_MAX_REPEAT) ? repeat : RLE_MAX_REPEAT;
+            run = run_class(chunk);
+            p_counts[RLE_RUN_SYMBOL + run]++;
+            extra_bits += run;
+            repeat -= chunk;
+        }
+        p_counts[*(p_input - 1)] += repeat;
+    }
+
+    return extra_bits;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: rle_encode
+ *  ------------------------------------------------------------------------ */
+extern unsigned long rle_encode(WIDE_CODE *p_code,
+                                ENCODE_STATE *state,
+                                unsigned char *p_input,
+                                unsigned long input_length,
+                                unsigned char *p_output)
+{
+    unsigned char *p_input_end = p_input + input_length;
+    unsigned char *p_output_start = p_output;
+    unsigned long bits = state->bits;
+    unsigned int bit_count = state->bit_count;
+    unsigned long repeat, chunk, literals;
+    unsigned int entry, run;
+    unsigned char symbol;
+
+    while (p_input < p_input_end)
+    {
+        symbol = *p_input;
+        repeat = run_length(p_input + 1, p_input_end, symbol);
+        p_input += 1 + repeat;
+        literals = 0;
+        if (repeat < RLE_MIN_REPEAT)
+        {
+            literals = repeat + 1;
+            repeat = 0;
+        }
+        else
+        {
+            entry = p_code->codes[symbol];
+            bits = (bits << (entry & 0xFF)) | (entry >> 8);
+            bit_count += entry & 0xFF;
+            while (bit_count >= 8)
+            {
+                bit_count -= 8;
+                *p_output++ = (unsigned char) (bits >> bit_count);
+            }
+        }
+
+        /*
+         * Laufzeichen mit angehaengten Bits der Anzahl; Code, Bits und der
+         * Rest des letzten Bytes passen zusammen in den Bitspeicher.
+         */
+        while (repeat >= RLE_MIN_REPEAT)
+        {
+            chunk = (repeat < RLE_MAX_REPEAT) ? repeat : RLE_MAX_REPEAT;
+            run = run_class(chunk);
+            entry = p_code->codes[RLE_RUN_SYMBOL + run];
+            bits = (bits << (entry & 0xFF)) | (entry >> 8);
+            bits = (bits << run) | (chunk - (1UL << run));
+            bit_count += (entry & 0xFF) + run;
+            repeat -= chunk;
+            while (bit_count >= 8)
+            {
+                bit_count -= 8;
+                *p_output++ = (unsigned char) (bits >> bit_count);
+            }
+        }
+
+        /* Literale, auch der Rest eines sehr langen Laufs. */
+        literals += repeat;
+        entry = p_code->codes[symbol];
+        while (literals > 0)
+        {
+            bits = (bits << (entry & 0xFF)) | (entry >> 8);
+            bit_count += entry & 0xFF;
+            literals--;
+            while (bit_count >= 8)
+            {
+                bit_count -= 8;
+                *p_output++ = (unsigned char) (bits >> bit_count);
+            }
+        }
+    }
+
+    state->bits = bits;
+    state->bit_count = bit_count;
+
+    return (unsigned long) (p_output - p_output_start);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: run_length
+ *  ------------------------------------------------------------------------ */
+static unsigned long run_length(unsigned char *p_input,
+                                unsigned char *p_input_end,
+                                unsigned char symbol)
+{
+    unsigned char *p_start = p_input;
+    unsigned long pattern = symbol * (~0UL / 255);
+    unsigned long word;
+
+    while ((unsigned long) (p_input_end - p_input) >= sizeof(unsigned long))
+    {
+        memcpy(&word, p_input, sizeof(unsigned long));
+        if (word != pattern)
+        {
+            break;
+        }
+        p_input += sizeof(unsigned long);
+    }
+    while (p_input < p_input_end && *p_input == symbol)
+    {
+        p_input++;
+    }
+
+    return (unsigned long) (p_input - p_start);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: run_class
+ *  ------------------------------------------------------------------------ */
+static unsigned int run_class(unsigned long repeat)
+{
+    unsigned int run = 0;
+
+    while (repeat > 1)
+    {
+        repeat >>= 1;
+        run++;
+    }
+
+    return run;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: rle_state_init
+ *  ------------------------------------------------------------------------ */
+extern void rle_state_init(RLE_STATE *p_rle_state)
+{
+    p_rle_state->pending = 0;
+    p_rle_state->previous = 0;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: rle_decode
+ *  ------------------------------------------------------------------------ */
+extern unsigned long rle_decode(WIDE_DECODER *p_decoder,
+                                DECODE_STATE *state,
+                                RLE_STATE *p_rle_state,
+                                unsigned char *p_output,
+                                unsigned long output_length)
+{
+    unsigned char *p_output_start = p_output;
+    unsigned char *p_output_end = p_output + output_length;
+    unsigned char *p_next = state->p_next;
+    unsigned long bits = state->bits;
+    unsigned int bit_count = state->bit_count;
+    unsigned long window, chunk;
+    unsigned int entry, length, symbol, run;
+
+    while (p_output < p_output_end)
+    {
+        /* Laeufe mit einem memset statt Byte fuer Byte ausgeben. */
+        if (p_rle_state->pending > 0)
+        {
+            chunk = (unsigned long) (p_output_end - p_output);
+            if (chunk > p_rle_state->pending)
+            {
+                chunk = p_rle_state->pending;
+            }
+            memset(p_output, p_rle_state->previous, chunk);
+            p_output += chunk;
+            p_rle_state->pending -= chunk;
+            continue;
+        }
+
+        /* Bitspeicher byteweise auffuellen. */
+        while (bit_count <= KERNEL_WORD_BITS - 8 && p_next < state->p_end)
+        {
+            bits = (bits << 8) | *p_next++;
+            bit_count += 8;
+        }
+
+        if (p_decoder->single)
+        {
+            symbol = p_decoder->symbols[0];
+            length = 0;
+        }
+        else
+        {
+            /* Fehlende Bits am Ende der Eingabe mit 0 auffuellen. */
+            if (bit_count >= WIDE_MAX_CODE_LENGTH)
+            {
+                window = (bits >> (bit_count - WIDE_MAX_CODE_LENGTH)) 
+                         & RLE_WINDOW_MASK;
+            }
+            else
+            {
+                window = (bits << (WIDE_MAX_CODE_LENGTH - bit_count)) 
+                         & RLE_WINDOW_MASK;
+            }
+
+            entry = p_decoder->entries[window >> (WIDE_MAX_CODE_LENGTH 
+                                                  - WIDE_TABLE_BITS)];
+            length = entry & 0xFF;
+            if (length > 0)
+            {
+                symbol = entry >> 8;
+            }
+            else
+            {
+                length = WIDE_TABLE_BITS + 1;
+                while (window >= p_decoder->limits[length])
+                {
+                    length++;
+                }
+                symbol = p_decoder->symbols[p_decoder->offsets[length] 
+                        + ((window >> (WIDE_MAX_CODE_LENGTH - length)) 
+                           - p_decoder->first_codes[length])];
+            }
+        }
+
+        if (symbol < RLE_RUN_SYMBOL)
+        {
+            if (length > bit_count)
+            {
+                break;
+            }
+            bit_count -= length;
+            p_rle_state->previous = (unsigned char) symbol;
+            *p_output++ = (unsigned char) symbol;
+        }
+        else
+        {
+            /* Code und angehaengte Bits muessen vollstaendig vorliegen. */
+            run = symbol - RLE_RUN_SYMBOL;
+            if (length + run > bit_count)
+            {
+                break;
+            }
+            bit_count -= length + run;
+            p_rle_state->pending = (1UL << run) 
+                    | ((bits >> bit_count) & ((1UL << run) - 1));
+        }
+    }
+
+    state->p_next = p_next;
+    state->bits = bits;
+    state->bit_count = bit_count;
+
+    return (unsigned long) (p_output - p_output_start);
+}
@@ -0,0 +1,118 @@
+/**
+ * File: rle.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLE_H
+
+#define	RLE_H
+
+#include "common.h"
+#include "codec_kernels.h"
+#include "wide_huffman.h"
+
+/**
+ * Anzahl der Zeichen des erweiterten Alphabets: 256 Literale und je
+ * Laengenklasse k ein Laufzeichen 256 + k.
+ */
+#define RLE_SYMBOL_COUNT 288
+
+/** Erstes Laufzeichen. */
+#define RLE_RUN_SYMBOL 256
+
+/**
+ * Minimale Anzahl Wiederholungen fuer ein Laufzeichen. Kuerzere Laeufe
+ * bleiben Literale.
+ */
+#define RLE_MIN_REPEAT 4
+
+/**
+ * Groesste Laengenklasse. Ein Lauf der Klasse k wiederholt 2^k bis
+ * 2^(k + 1) - 1 mal und haengt k Bits an den Code an.
+ */
+#define RLE_MAX_CLASS 31
+
+/** Zustand des Dekodierers zwischen zwei Aufrufen. */
+typedef struct _RLE_STATE
+{
+    /**
+     * Noch nicht ausgegebene Wiederholungen des letzten Laufs
+     */
+    unsigned long pending;
+    /**
+     * Zuletzt ausgegebenes Zeichen, vor dem ersten Literal 0
+     */
+    unsigned char previous;
+} RLE_STATE;
+
+/**
+ * Zaehlt die Zeichen des erweiterten Alphabets, die rle_encode fuer die
+ * Eingabe erzeugt.
+ *
+ * @param p_input Eingabe
+ * @param input_length Laenge der Eingabe
+ * @param p_counts Haeufigkeit je Zeichen (WIDE_SYMBOL_COUNT Eintraege)
+ * @return Anzahl der an Laufzeichen angehaengten Bits
+ */
+extern unsigned long rle_count(unsigned char *p_input,
+                               unsigned long input_length,
+                               unsigned long *p_counts);
+
+/**
+ * Kodiert die Eingabe als Literale und Laufzeichen. Der Ausgabepuffer muss
+ * so gross sein, wie es die Haeufigkeiten aus rle_count mit den Codelaengen
+ * ergeben, zuzueglich KERNEL_OUTPUT_SLACK.
+ *
+ * @param p_code Codetabelle des erweiterten Alphabets
+ * @param state Zustand des Kodierers
+ * @param p_input Eingabe
+ * @param input_length Laenge der Eingabe
+ * @param p_output Ausgabe
+ * @return Anzahl geschriebener Bytes
+ */
+extern unsigned long rle_encode(WIDE_CODE *p_code,
+                                ENCODE_STATE *state,
+                                unsigned char *p_input,
+                                unsigned long input_length,
+                                unsigned char *p_output);
+
+/**
+ * Initialisiert den Zustand des Dekodierers.
+ *
+ * @param p_rle_state Zustand
+ */
+extern void rle_state_init(RLE_STATE *p_rle_state);
+
+/**
+ * Dekodiert bis zu output_length Bytes. Laeufe werden mit einem memset
+ * ausgegeben und duerfen ueber das Ende der Ausgabe hinausreichen, der Rest
+ * wird beim naechsten Aufruf ausgegeben.
+ *
+ * @param p_decoder Dekodierer des erweiterten Alphabets
+ * @param state Zustand des Dekodierers
+ * @param p_rle_state Zustand der Laeufe
+ * @param p_output Ausgabe
+ * @param output_length Anzahl der zu dekodierenden Bytes
+ * @return Anzahl dekodierter Bytes, kleiner als output_length nur wenn die
+ *         Eingabe nicht ausreicht
+ */
+extern unsigned long rle_decode(WIDE_DECODER *p_decoder,
+                                DECODE_STATE *state,
+                                RLE_STATE *p_rle_state,
+                                unsigned char *p_output,
+                                unsigned long output_length);
+
+#endif	/* RLE_H */
@@ -0,0 +1,530 @@
+/**
+ * File: wide_huffman.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "codec_kernels.h"
+#include "wide_huffman.h"
+
+/** Maske eines Fensters von WIDE_MAX_CODE_LENGTH Bits. */
+#define WIDE_WINDOW_MASK ((1UL << WIDE_MAX_CODE_LENGTH) - 1)
+
+/** Zeichen mit Haeufigkeit zum Sortieren. */
+typedef struct _WIDE_WEIGHT
+{
+    /**
+     * Haeufigkeit, nach dem Zusammenfassen Index bzw. Codelaenge
+     */
+    unsigned long count;
+    /**
+     * Zeichen
+     */
+    unsigned int symbol;
+} WIDE_WEIGHT;
+
+/**
+ * Diese Funktion vergleicht zwei Zeichen nach Haeufigkeit und bei gleicher
+ * Haeufigkeit nach dem Zeichen, fuer qsort.
+ *
+ * @param p_left Erstes Zeichen
+ * @param p_right Zweites Zeichen
+ * @return < 0, 0 oder > 0
+ */
+static int compare_weights(const void *p_left, const void *p_right);
+
+/**
+ * Diese Funktion berechnet die Codelaengen der aufsteigend sortierten
+ * Haeufigkeiten an Ort und Stelle (Moffat und Katajainen, 1995). Danach
+ * enthaelt jedes Feld die Codelaenge, das haeufigste Zeichen steht am Ende.
+ *
+ * @param p_weights Sortierte Zeichen
+ * @param count Anzahl der Zeichen (mindestens 2)
+ */
+static void minimum_redundancy(WIDE_WEIGHT *p_weights, unsigned long count);
+
+/**
+ * Diese Funktion kuerzt die Codelaengen auf WIDE_MAX_CODE_LENGTH. Zu lange
+ * Codes werden gekuerzt und danach so lange Codes der groessten kuerzeren
+ * Laenge verlaengert, bis die Kraft-Summe wieder genau 1 ist.
+ *
+ * @param p_length_counts Anzahl Codes je Laenge (Index bis 64)
+ */
+static void limit_lengths(unsigned long *p_length_counts);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: wide_count
+ *  ------------------------------------------------------------------------ */
+extern void wide_count(unsigned char *p_input,
+                       unsigned long input_length,
+                       unsigned long *p_counts)
+{
+    unsigned char *p_input_end = p_input + input_length;
+
+    memset(p_counts, 0, WIDE_SYMBOL_COUNT * sizeof(unsigned long));
+    while (p_input < p_input_end)
+    {
+        p_counts[p_input[0] | (p_input[1] << 8)]++;
+        p_input += 2;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: wide_code_lengths
+ *  ------------------------------------------------------------------------ */
+extern unsigned long wide_code_lengths(ALLOCATOR *allocator,
+                                       unsigned long *p_counts,
+                                       unsigned char *p_lengths)
+{
+    unsigned long length_counts[65];
+    unsigned long used = 0;
+    unsigned long i;
+    unsigned int length;
+    WIDE_WEIGHT *p_weights;
+
+    memset(p_lengths, 0, WIDE_SYMBOL_COUNT);
+    for (i = 0; i < WIDE_SYMBOL_COUNT; i++)
+    {
+        if (p_counts[i] > 0)
+        {
+            used++;
+        }
+    }
+    if (used == 0)
+    {
+        return 0;
+    }
+
+    p_weights = allocator_alloc(allocator, used * sizeof(WIDE_WEIGHT));
+    used = 0;
+    for (i = 0; i < WIDE_SYMBOL_COUNT; i++)
+    {
+        if (p_counts[i] > 0)
+        {
+            p_weights[used].count = p_counts[i];
+            p_weights[used].symbol = (unsigned int) i;
+            used++;
+        }
+    }
+
+    /* Ein einzelnes Zeichen erhaelt die Laenge 1 und wird ohne Bits kodiert. */
+    if (used == 1)
+    {
+        p_lengths[p_weights[0].symbol] = 1;
+        allocator_free(allocator, p_weights);
+        return used;
+    }
+
+    qsort(p_weights, used, sizeof(WIDE_WEIGHT), compare_weights);
+    minimum_redundancy(p_weights, used);
+
+    memset(length_counts, 0, sizeof(length_counts));
+    for (i = 0; i < used; i++)
+    {
+        length_counts[(p_weights[i].count < 64) ? p_weights[i].count : 64]++;
+    }
+    limit_lengths(length_counts);
+
+    /* Die kuerzesten Laengen gehen an die haeufigsten Zeichen am Ende. */
+    i = used;
+    for (length = 1; length <= WIDE_MAX_CODE_LENGTH; length++)
+    {
+        while (length_counts[length] > 0)
+        {
+            i--;
+            p_lengths[p_weights[i].symbol] = (unsigned char) length;
+            length_counts[length]--;
+        }
+    }
+
+    allocator_free(allocator, p_weights);
+    return used;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: compare_weights
+ *  ------------------------------------------------------------------------ */
+static int compare_weights(const void *p_left, const void *p_right)
+{
+    const WIDE_WEIGHT *p_left_weight = (const WIDE_WEIGHT *) p_left;
+    const WIDE_WEIGHT *p_right_weight = (const WIDE_WEIGHT *) p_right;
+
+    if (p_left_weight->count != p_right_weight->count)
+    {
+        return (p_left_weight->count < p_right_weight->count) ? -1 : 1;
+    }
+    return (p_left_weight->symbol < p_right_weight->symbol) ? -1 : 1;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: minimum_redundancy
+ *  ------------------------------------------------------------------------ */
+static void minimum_redundancy(WIDE_WEIGHT *p_weights, unsigned long count)
+{
+    unsigned long root, leaf, next, available, used, depth;
+
+    /*
+     * Erster Durchlauf: Paare zusammenfassen, innere Knoten speichern den
+     * Index ihres Elternknotens.
+     */
+    p_weights[0].count += p_weights[1].count;
+    root = 0;
+    leaf = 2;
+    for (next = 1; next < count - 1; next++)
+    {
+        if (leaf >= count || p_weights[root].count < p_weights[leaf].count)
+        {
+            p_weights[next].count = p_weights[root].count;
+            p_weights[root++].count = next;
+        }
+        else
+        {
+            p_weights[next].count = p_weights[leaf++].count;
+        }
+
+        if (leaf >= count || (root < next 
+                && p_weights[root].count < p_weights[leaf].count))
+        {
+            p_weights[next].count += p_weights[root].count;
+            p_weights[root++].count = next;
+        }
+        else
+        {
+            p_weights[next].count += p_weights[leaf++].count;
+        }
+    }
+
+    /* Zweiter Durchlauf: Tiefe der inneren Knoten. */
+    p_weights[count - 2].count = 0;
+    for (next = count - 2; next > 0; next--)
+    {
+        p_weights[next - 1].count = p_weights[p_weights[next - 1].count].count
+                                  + 1;
+    }
+
+    /* Dritter Durchlauf: Tiefe der Blaetter. */
+    available = 1;
+    used = 0;
+    depth = 0;
+    root = count - 1;
+    next = count;
+    while (available > 0)
+    {
+        while (root > 0 && p_weights[root - 1].count == depth)
+        {
+            used++;
+            root--;
+        }
+        while (available > used)
+        {
+            p_weights[--next].count = depth;
+            available--;
+        }
+        available = 2 * used;
+        depth++;
+        used = 0;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: limit_lengths
+ *  ------------------------------------------------------------------------ */
+static void limit_lengths(unsigned long *p_length_counts)
+{
+    unsigned long total = 0;
+    unsigned int length;
+
+    for (length = WIDE_MAX_CODE_LENGTH + 1; length <= 64; length++)
+    {
+        p_length_counts[WIDE_MAX_CODE_LENGTH] += p_length_counts[length];
+        p_length_counts[length] = 0;
+    }
+    for (length = 1; length <= WIDE_MAX_CODE_LENGTH; length++)
+    {
+        total += p_length_counts[length] << (WIDE_MAX_CODE_LENGTH - length);
+    }
+
+    /*
+     * Je Schritt wird ein Code der Maximallaenge entfernt und ein Blatt der
+     * groessten kuerzeren Laenge durch zwei Blaetter eine Stufe tiefer
+     * ersetzt. Die Summe sinkt dabei um genau einen Code der Maximallaenge.
+     */
+    while (total > (1UL << WIDE_MAX_CODE_LENGTH))
+    {
+        p_length_counts[WIDE_MAX_CODE_LENGTH]--;
+        for (length = WIDE_MAX_CODE_LENGTH - 1; length > 0; length--)
+        {
+            if (p_length_counts[length] > 0)
+            {
+                p_length_counts[length]--;
+                p_length_counts[length + 1] += 2;
+                break;
+            }
+        }
+        total--;
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: wide_code_init
+ *  ------------------------------------------------------------------------ */
+extern void wide_code_init(WIDE_CODE *p_code, unsigned char *p_lengths)
+{
+    unsigned long next_codes[WIDE_MAX_CODE_LENGTH + 2];
+    unsigned long length_counts[WIDE_MAX_CODE_LENGTH + 1];
+    unsigned long code = 0;
+    unsigned long used = 0;
+    unsigned long i;
+    unsigned int length;
+
+    memset(p_code->codes, 0, sizeof(p_code->codes));
+    memset(length_counts, 0, sizeof(length_counts));
+    for (i = 0; i < WIDE_SYMBOL_COUNT; i++)
+    {
+        if (p_lengths[i] > 0)
+        {
+            length_counts[p_lengths[i]]++;
+            used++;
+        }
+    }
+    if (used <= 1)
+    {
+        return;
+    }
+
+    /* Kanonische Codes: je Laenge aufsteigend in der Reihenfolge der Zeichen. */
+    for (length = 1; length <= WIDE_MAX_CODE_LENGTH; length++)
+    {
+        next_codes[length] = code;
+        code = (code + length_counts[length]) << 1;
+    }
+    for (i = 0; i < WIDE_SYMBOL_COUNT; i++)
+    {
+        if (p_lengths[i] > 0)
+        {
+            p_code->codes[i] = (unsigned int) 
+                    ((next_codes[p_lengths[i]]++ << 8) | p_lengths[i]);
+        }
+    }
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: wide_decoder_init
+ *  ------------------------------------------------------------------------ */
+extern BOOL wide_decoder_init(WIDE_DECODER *p_decoder,
+                              unsigned char *p_lengths)
+{
+    unsigned long length_counts[WIDE_MAX_CODE_LENGTH + 1];
+    unsigned int positions[WIDE_MAX_CODE_LENGTH + 1];
+    unsigned long code = 0;
+    unsigned long total = 0;
+    unsigned long used = 0;
+    unsigned long i, first, last;
+    unsigned int length, index;
+
+    memset(p_decoder->entries, 0, sizeof(p_decoder->entries));
+    memset(length_counts, 0, sizeof(length_counts));
+    p_decoder->single = FALSE;
+    for (i = 0; i < WIDE_SYMBOL_COUNT; i++)
+    {
+        if (p_lengths[i] > WIDE_MAX_CODE_LENGTH)
+        {
+            return FALSE;
+        }
+        if (p_lengths[i] > 0)
+        {
+            length_counts[p_lengths[i]]++;
+            total += 1UL << (WIDE_MAX_CODE_LENGTH - p_lengths[i]);
+            used++;
+        }
+    }
+
+    if (used == 1 && length_counts[1] == 1)
+    {
+        p_decoder->single = TRUE;
+        for (i = 0; p_lengths[i] == 0; i++)
+        {
+        }
+        p_decoder->symbols[0] = (unsigned short) i;
+        return TRUE;
+    }
+    if (total != (1UL << WIDE_MAX_CODE_LENGTH))
+    {
+        return FALSE;
+    }
+
+    /* Grenzen und Positionen der kanonischen Codes je Laenge. */
+    index = 0;
+    for (length = 1; length <= WIDE_MAX_CODE_LENGTH; length++)
+    {
+        p_decoder->first_codes[length] = code;
+        p_decoder->offsets[length] = index;
+        positions[length] = index;
+        index += (unsigned int) length_counts[length];
+        code += length_counts[length];
+        p_decoder->limits[length] = code << (WIDE_MAX_CODE_LENGTH - length);
+        code <<= 1;
+    }
+
+    for (i = 0; i < WIDE_SYMBOL_COUNT; i++)
+    {
+        length = p_lengths[i];
+        if (length == 0)
+        {
+            continue;
+        }
+        p_decoder->symbols[positions[length]++] = (unsigned short) i;
+
+        /* Kurze Codes belegen alle Tabelleneintraege mit ihrem Praefix. */
+        if (length <= WIDE_TABLE_BITS)
+        {
+            code = p_decoder->first_codes[length] 
+                   + (positions[length] - 1 - p_decoder->offsets[length]);
+            first = code << (WIDE_TABLE_BITS - length);
+            last = first + (1UL << (WIDE_TABLE_BITS - length));
+            while (first < last)
+            {
+                p_decoder->entries[first++] = (unsigned int) ((i << 8) 
+                                                              | length);
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: wide_encode
+ *  ------------------------------------------------------------------------ */
+extern unsigned long wide_encode(WIDE_CODE *p_code,
+                                 ENCODE_STATE *state,
+                                 unsigned char *p_input,
+                                 unsigned long input_length,
+                                 unsigned char *p_output)
+{
+    unsigned char *p_input_end = p_input + input_length;
+    unsigned char *p_output_start = p_output;
+    unsigned long bits = state->bits;
+    unsigned int bit_count = state->bit_count;
+    unsigned int entry, length;
+
+    while (p_input < p_input_end)
+    {
+        entry = p_code->codes[p_input[0] | (p_input[1] << 8)];
+        p_input += 2;
+        length = entry & 0xFF;
+        bits = (bits << length) | (entry >> 8);
+        bit_count += length;
+
+        /* Alle vollstaendigen Bytes schreiben. */
+        while (bit_count >= 8)
+        {
+            bit_count -= 8;
+            *p_output++ = (unsigned char) (bits >> bit_count);
+        }
+    }
+
+    state->bits = bits;
+    state->bit_count = bit_count;
+
+    return (unsigned long) (p_output - p_output_start);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: wide_decode
+ *  ------------------------------------------------------------------------ */
+extern unsigned long wide_decode(WIDE_DECODER *p_decoder,
+                                 DECODE_STATE *state,
+                                 unsigned char *p_output,
+                                 unsigned long symbol_count)
+{
+    unsigned char *p_next = state->p_next;
+    unsigned long bits = state->bits;
+    unsigned int bit_count = state->bit_count;
+    unsigned long decoded = 0;
+    unsigned long window;
+    unsigned int entry, length, symbol;
+
+    if (p_decoder->single)
+    {
+        for (decoded = 0; decoded < symbol_count; decoded++)
+        {
+            *p_output++ = (unsigned char) p_decoder->symbols[0];
+            *p_output++ = (unsigned char) (p_decoder->symbols[0] >> 8);
+        }
+        return symbol_count;
+    }
+
+    while (decoded < symbol_count)
+    {
+        /* Bitspeicher byteweise auffuellen. */
+        while (bit_count <= KERNEL_WORD_BITS - 8 && p_next < state->p_end)
+        {
+            bits = (bits << 8) | *p_next++;
+            bit_count += 8;
+        }
+
+        /* Fehlende Bits am Ende der Eingabe mit 0 auffuellen. */
+        if (bit_count >= WIDE_MAX_CODE_LENGTH)
+        {
+            window = (bits >> (bit_count - WIDE_MAX_CODE_LENGTH)) 
+                     & WIDE_WINDOW_MASK;
+        }
+        else
+        {
+            window = (bits << (WIDE_MAX_CODE_LENGTH - bit_count)) 
+                     & WIDE_WINDOW_MASK;
+        }
+
+        entry = p_decoder->entries[window 
+                                   >> (WIDE_MAX_CODE_LENGTH - WIDE_TABLE_BITS)];
+        length = entry & 0xFF;
+        if (length > 0)
+        {
+            symbol = entry >> 8;
+        }
+        else
+        {
+            /* Lange Codes: erste Laenge, deren Grenze ueber dem Fenster liegt. */
+            length = WIDE_TABLE_BITS + 1;
+            while (window >= p_decoder->limits[length])
+            {
+                length++;
+            }
+            symbol = p_decoder->symbols[p_decoder->offsets[length] 
+                    + ((window >> (WIDE_MAX_CODE_LENGTH - length)) 
+                       - p_decoder->first_codes[length])];
+        }
+
+        if (length > bit_count)
+        {
+            break;
+        }
+        bit_count -= length;
+        *p_output++ = (unsigned char) symbol;
+        *p_output++ = (unsigned char) (symbol >> 8);
+        decoded++;
+    }
+
+    state->p_next = p_next;
+    state->bits = bits;
+    state->bit_count = bit_count;
+
+    return decoded;
+}
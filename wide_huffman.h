@@ -0,0 +1,168 @@
+/**
+ * File: wide_huffman.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WIDE_HUFFMAN_H
+
+#define	WIDE_HUFFMAN_H
+
+#include "common.h"
+#include "allocator.h"
+#include "codec_kernels.h"
+
+/** Anzahl der Zeichen des 16-Bit-Alphabets. */
+#define WIDE_SYMBOL_COUNT 65536
+
+/**
+ * Maximale Codelaenge im 16-Bit-Alphabet. Laengere Codes werden beim Bauen
+ * gekuerzt, damit ein Code immer in einem Zugriff auf den Bitspeicher liegt.
+ */
+#define WIDE_MAX_CODE_LENGTH 24
+
+/**
+ * Anzahl Bits der ersten Dekodierstufe. Mit 4 Byte je Eintrag bleibt die
+ * Tabelle mit 16 KB im L1-Cache.
+ */
+#define WIDE_TABLE_BITS 12
+
+/** Groesse eines Eintrags der Codelaengen im Blockheader: Zeichen, Laenge. */
+#define WIDE_ENTRY_SIZE 3
+
+/**
+ * Codetabelle des Kodierers. Je Zeichen liegen Code und Laenge gepackt in
+ * 4 Byte, damit die gesamte Tabelle 256 KB nicht ueberschreitet.
+ */
+typedef struct _WIDE_CODE
+{
+    /**
+     * Code << 8 | Laenge je Zeichen, Laenge 0 fuer nicht vorkommende
+     */
+    unsigned int codes[WIDE_SYMBOL_COUNT];
+} WIDE_CODE;
+
+/**
+ * Dekodierer fuer kanonische Codes. Kurze Codes loest die Tabelle mit einem
+ * Zugriff auf, laengere ueber die Grenzen der kanonischen Codes je Laenge.
+ */
+typedef struct _WIDE_DECODER
+{
+    /**
+     * Zeichen << 8 | Laenge, adressiert mit den naechsten WIDE_TABLE_BITS
+     * Bits; Laenge 0 fuer laengere Codes
+     */
+    unsigned int entries[1 << WIDE_TABLE_BITS];
+    /**
+     * Erster Code je Laenge, linksbuendig auf WIDE_MAX_CODE_LENGTH Bits
+     * erweitert ist er die Grenze der kuerzeren Codes
+     */
+    unsigned long limits[WIDE_MAX_CODE_LENGTH + 1];
+    /**
+     * Erster Code je Laenge
+     */
+    unsigned long first_codes[WIDE_MAX_CODE_LENGTH + 1];
+    /**
+     * Index des ersten Zeichens je Laenge in symbols
+     */
+    unsigned int offsets[WIDE_MAX_CODE_LENGTH + 1];
+    /**
+     * Zeichen in kanonischer Reihenfolge (Laenge, Zeichen)
+     */
+    unsigned short symbols[WIDE_SYMBOL_COUNT];
+    /**
+     * TRUE wenn nur ein Zeichen vorkommt, es wird ohne Bits kodiert
+     */
+    BOOL single;
+} WIDE_DECODER;
+
+/**
+ * Zaehlt die Zeichen aus je zwei Byte (Little Endian).
+ *
+ * @param p_input Eingabe
+ * @param input_length Laenge der Eingabe in Byte, gerade
+ * @param p_counts Haeufigkeit je Zeichen (WIDE_SYMBOL_COUNT Eintraege)
+ */
+extern void wide_count(unsigned char *p_input,
+                       unsigned long input_length,
+                       unsigned long *p_counts);
+
+/**
+ * Berechnet die Codelaengen eines Huffman-Codes ohne Baum aus Knoten: die
+ * nach Haeufigkeit sortierten Zeichen werden in einem Feld zusammengefasst
+ * (Moffat und Katajainen) und Laengen ueber WIDE_MAX_CODE_LENGTH danach
+ * gekuerzt.
+ *
+ * @param allocator Allokator fuer das Sortierfeld, NULL fuer calloc
+ * @param p_counts Haeufigkeit je Zeichen
+ * @param p_lengths Codelaenge je Zeichen, 0 fuer nicht vorkommende
+ * @return Anzahl der vorkommenden Zeichen
+ */
+extern unsigned long wide_code_lengths(ALLOCATOR *allocator,
+                                       unsigned long *p_counts,
+                                       unsigned char *p_lengths);
+
+/**
+ * Erzeugt die kanonischen Codes aus den Codelaengen. Ein einzelnes Zeichen
+ * wird ohne Bits kodiert.
+ *
+ * @param p_code Zu fuellende Codetabelle
+ * @param p_lengths Codelaenge je Zeichen
+ */
+extern void wide_code_init(WIDE_CODE *p_code, unsigned char *p_lengths);
+
+/**
+ * Erzeugt den Dekodierer aus den Codelaengen.
+ *
+ * @param p_decoder Zu fuellender Dekodierer
+ * @param p_lengths Codelaenge je Zeichen
+ * @return FALSE wenn die Laengen keinen vollstaendigen Code ergeben
+ */
+extern BOOL wide_decoder_init(WIDE_DECODER *p_decoder,
+                              unsigned char *p_lengths);
+
+/**
+ * Kodiert input_length / 2 Zeichen. Der Ausgabepuffer muss
+ * input_length / 2 * WIDE_MAX_CODE_LENGTH / 8 + KERNEL_OUTPUT_SLACK Byte
+ * gross sein.
+ *
+ * @param p_code Codetabelle
+ * @param state Zustand des Kodierers
+ * @param p_input Eingabe
+ * @param input_length Laenge der Eingabe in Byte, gerade
+ * @param p_output Ausgabe
+ * @return Anzahl geschriebener Bytes
+ */
+extern unsigned long wide_encode(WIDE_CODE *p_code,
+                                 ENCODE_STATE *state,
+                                 unsigned char *p_input,
+                                 unsigned long input_length,
+                                 unsigned char *p_output);
+
+/**
+ * Dekodiert bis zu symbol_count Zeichen nach p_output (je zwei Byte).
+ *
+ * @param p_decoder Dekodierer
+ * @param state Zustand des Dekodierers
+ * @param p_output Ausgabe mit 2 * symbol_count Byte
+ * @param symbol_count Anzahl der Zeichen
+ * @return Anzahl dekodierter Zeichen
+ */
+extern unsigned long wide_decode(WIDE_DECODER *p_decoder,
+                                 DECODE_STATE *state,
+                                 unsigned char *p_output,
+                                 unsigned long symbol_count);
+
+#endif	/* WIDE_HUFFMAN_H */
@@ -0,0 +1,299 @@
+/**
+ * File: work_pool.c
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "common.h"
+#include "work_pool.h"
+
+/** Anfangsgroesse einer Warteschlange. */
+#define WORK_QUEUE_CAPACITY 16
+
+/** Argument eines Threads des Pools. */
+typedef struct _WORK_WORKER
+{
+    /**
+     * Pool
+     */
+    WORK_POOL *pool;
+    /**
+     * Index des Threads und seiner Warteschlange
+     */
+    unsigned int index;
+} WORK_WORKER;
+
+/**
+ * Thread-Funktion: fuehrt Aufgaben aus der eigenen Warteschlange oder
+ * gestohlene Aufgaben aus, bis keine Aufgabe mehr aussteht.
+ *
+ * @param p_worker Argument des Threads (WORK_WORKER*)
+ * @return NULL
+ */
+static void *run_worker(void *p_worker);
+
+/**
+ * Diese Funktion entnimmt die naechste Aufgabe fuer einen Thread: zuerst die
+ * neueste der eigenen Warteschlange, sonst die aelteste eines anderen.
+ *
+ * @param pool Pool
+ * @param index Index des Threads
+ * @param p_task Entnommene Aufgabe
+ * @return FALSE wenn alle Warteschlangen leer sind
+ */
+static BOOL take_task(WORK_POOL *pool, unsigned int index, WORK_TASK *p_task);
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: work_pool_init
+ *  ------------------------------------------------------------------------ */
+extern void work_pool_init(WORK_POOL *pool, unsigned int worker_count)
+{
+    unsigned int i;
+
+    memset(pool, 0, sizeof(WORK_POOL));
+    pool->worker_count = (worker_count > 0) ? worker_count : 1;
+    pool->queues = calloc(pool->worker_count, sizeof(WORK_QUEUE));
+    ENSURE_ENOUGH_MEMORY(pool->queues, "work_pool_init");
+
+    for (i = 0; i < pool->worker_count; i++)
+    {
+        pool->queues[i].capacity = WORK_QUEUE_CAPACITY;
+        pool->queues[i].p_tasks = malloc(WORK_QUEUE_CAPACITY
+                                         * sizeof(WORK_TASK));
+        ENSURE_ENOUGH_MEMORY(pool->queues[i].p_tasks, "work_pool_init");
+        pthread_mutex_init(&pool->queues[i].lock, NULL);
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->changed, NULL);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: work_pool_submit
+ *  ------------------------------------------------------------------------ */
+extern void work_pool_submit(WORK_POOL *pool,
+                             unsigned int worker,
+                             WORK_FUNCTION function,
+                             void *p_arg)
+{
+    WORK_QUEUE *queue = &pool->queues[worker % pool->worker_count];
+    WORK_TASK *p_tasks;
+    unsigned long i;
+
+    /*
+     * Die Aufgabe wird vor dem Einstellen gezaehlt. Sonst kann ein anderer
+     * Thread sie entnehmen und beenden, bevor pending erhoeht ist, und
+     * pending faellt unter 0 oder vorzeitig auf 0.
+     */
+    pthread_mutex_lock(&pool->lock);
+    pool->pending++;
+    pthread_mutex_unlock(&pool->lock);
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count == queue->capacity)
+    {
+        /* Der Ringpuffer wird beim Vergroessern wieder ab 0 angeordnet. */
+        p_tasks = malloc(queue->capacity * 2 * sizeof(WORK_TASK));
+        ENSURE_ENOUGH_MEMORY(p_tasks, "work_pool_submit");
+        for (i = 0; i < queue->count; i++)
+        {
+            p_tasks[i] = queue->p_tasks[(queue->first + i) % queue->capacity];
+        }
+        free(queue->p_tasks);
+        queue->p_tasks = p_tasks;
+        queue->first = 0;
+        queue->capacity *= 2;
+    }
+    p_tasks = &queue->p_tasks[(queue->first + queue->count)
+                              % queue->capacity];
+    p_tasks->function = function;
+    p_tasks->p_arg = p_arg;
+    queue->count++;
+    pthread_mutex_unlock(&queue->lock);
+
+    /*
+     * submitted wird erst erhoeht, wenn die Aufgabe in der Warteschlange
+     * steht. Ein Thread, der sie bei seiner Suche verpasst hat, sieht danach
+     * einen neuen Stand und sucht erneut.
+     */
+    pthread_mutex_lock(&pool->lock);
+    pool->submitted++;
+    pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: work_pool_run
+ *  ------------------------------------------------------------------------ */
+extern void work_pool_run(WORK_POOL *pool)
+{
+    WORK_WORKER *workers;
+    pthread_t *threads;
+    BOOL *p_started;
+    unsigned int i;
+
+    workers = calloc(pool->worker_count, sizeof(WORK_WORKER));
+    threads = calloc(pool->worker_count, sizeof(pthread_t));
+    p_started = calloc(pool->worker_count, sizeof(BOOL));
+    ENSURE_ENOUGH_MEMORY(workers, "work_pool_run");
+    ENSURE_ENOUGH_MEMORY(threads, "work_pool_run");
+    ENSURE_ENOUGH_MEMORY(p_started, "work_pool_run");
+
+    for (i = 0; i < pool->worker_count; i++)
+    {
+        workers[i].pool = pool;
+        workers[i].index = i;
+    }
+
+    /*
+     * Die Warteschlange eines nicht gestarteten Threads wird von den anderen
+     * leergestohlen.
+     */
+    for (i = 1; i < pool->worker_count; i++)
+    {
+        p_started[i] = (pthread_create(&threads[i], NULL, run_worker,
+                                       &workers[i]) == 0) ? TRUE : FALSE;
+    }
+    run_worker(&workers[0]);
+    for (i = 1; i < pool->worker_count; i++)
+    {
+        if (p_started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    free(workers);
+    free(threads);
+    free(p_started);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: work_pool_destroy
+ *  ------------------------------------------------------------------------ */
+extern void work_pool_destroy(WORK_POOL *pool)
+{
+    unsigned int i;
+
+    for (i = 0; i < pool->worker_count; i++)
+    {
+        free(pool->queues[i].p_tasks);
+        pthread_mutex_destroy(&pool->queues[i].lock);
+    }
+    free(pool->queues);
+    pool->queues = NULL;
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->changed);
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: run_worker
+ *  ------------------------------------------------------------------------ */
+static void *run_worker(void *p_worker)
+{
+    WORK_WORKER *worker = (WORK_WORKER*) p_worker;
+    WORK_POOL *pool = worker->pool;
+    WORK_TASK task;
+    unsigned long submitted;
+    BOOL finished = FALSE;
+
+    while (!finished)
+    {
+        /*
+         * Der Stand von submitted vor der Suche zeigt an, ob waehrend der
+         * Suche eine Aufgabe dazugekommen ist, die sie verpasst haben kann.
+         */
+        pthread_mutex_lock(&pool->lock);
+        submitted = pool->submitted;
+        pthread_mutex_unlock(&pool->lock);
+
+        if (take_task(pool, worker->index, &task))
+        {
+            task.function(pool, worker->index, task.p_arg);
+
+            pthread_mutex_lock(&pool->lock);
+            pool->pending--;
+            if (pool->pending == 0)
+            {
+                pthread_cond_broadcast(&pool->changed);
+            }
+            pthread_mutex_unlock(&pool->lock);
+        }
+        else
+        {
+            pthread_mutex_lock(&pool->lock);
+            while (pool->pending > 0 && pool->submitted == submitted)
+            {
+                pthread_cond_wait(&pool->changed, &pool->lock);
+            }
+            finished = (pool->pending == 0) ? TRUE : FALSE;
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+
+    return NULL;
+}
+
+/** ---------------------------------------------------------------------------
+ *  Funktion: take_task
+ *  ------------------------------------------------------------------------ */
+static BOOL take_task(WORK_POOL *pool, unsigned int index, WORK_TASK *p_task)
+{
+    WORK_QUEUE *queue = &pool->queues[index];
+    unsigned int i;
+    BOOL found = FALSE;
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count > 0)
+    {
+        queue->count--;
+        *p_task = queue->p_tasks[(queue->first + queue->count)
+                                 % queue->capacity];
+        found = TRUE;
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    /*
+     * Gestohlen wird vorne: die aelteste Aufgabe ist meist die groesste,
+     * etwa eine ganze Datei statt eines ihrer Bloecke.
+     */
+    for (i = 1; i < pool->worker_count && !found; i++)
+    {
+        queue = &pool->queues[(index + i) % pool->worker_count];
+        pthread_mutex_lock(&queue->lock);
+        if (queue->count > 0)
+        {
+            *p_task = queue->p_tasks[queue->first];
+            queue->first = (queue->first + 1) % queue->capacity;
+            queue->count--;
+            found = TRUE;
+        }
+        pthread_mutex_unlock(&queue->lock);
+
+        if (found)
+        {
+            pthread_mutex_lock(&pool->lock);
+            pool->stolen++;
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,149 @@
+/**
+ * File: work_pool.h
+ * Copyright (C) 2014 - Tim F. Rieck
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORK_POOL_H
+
+#define	WORK_POOL_H
+
+#include <pthread.h>
+#include "common.h"
+
+typedef struct _WORK_POOL WORK_POOL;
+
+/**
+ * Funktion einer Aufgabe. worker ist der Index des ausfuehrenden Threads und
+ * wird fuer work_pool_submit von Teilaufgaben verwendet.
+ */
+typedef void (*WORK_FUNCTION)(WORK_POOL *pool,
+                              unsigned int worker,
+                              void *p_arg);
+
+/** Aufgabe in einer Warteschlange. */
+typedef struct _WORK_TASK
+{
+    /**
+     * Auszufuehrende Funktion
+     */
+    WORK_FUNCTION function;
+    /**
+     * Argument der Funktion
+     */
+    void *p_arg;
+} WORK_TASK;
+
+/**
+ * Warteschlange eines Threads als Ringpuffer. Der Thread selbst entnimmt
+ * hinten die zuletzt eingestellte Aufgabe, andere Threads stehlen vorne die
+ * aelteste.
+ */
+typedef struct _WORK_QUEUE
+{
+    /**
+     * Aufgaben
+     */
+    WORK_TASK *p_tasks;
+    /**
+     * Index der aeltesten Aufgabe
+     */
+    unsigned long first;
+    /**
+     * Anzahl der Aufgaben
+     */
+    unsigned long count;
+    /**
+     * Groesse von p_tasks
+     */
+    unsigned long capacity;
+    /**
+     * Schuetzt die Warteschlange
+     */
+    pthread_mutex_t lock;
+} WORK_QUEUE;
+
+/** Thread-Pool mit einer Warteschlange je Thread. */
+struct _WORK_POOL
+{
+    /**
+     * Warteschlange je Thread
+     */
+    WORK_QUEUE *queues;
+    /**
+     * Anzahl der Threads einschliesslich des aufrufenden
+     */
+    unsigned int worker_count;
+    /**
+     * Eingestellte und noch nicht beendete Aufgaben
+     */
+    unsigned long pending;
+    /**
+     * Anzahl aller eingestellten Aufgaben, weckt wartende Threads
+     */
+    unsigned long submitted;
+    /**
+     * Anzahl der von anderen Threads gestohlenen Aufgaben
+     */
+    unsigned long stolen;
+    /**
+     * Schuetzt pending, submitted und stolen
+     */
+    pthread_mutex_t lock;
+    /**
+     * Signalisiert neue Aufgaben und das Ende aller Aufgaben
+     */
+    pthread_cond_t changed;
+};
+
+/**
+ * Initialisiert einen Pool mit leeren Warteschlangen.
+ *
+ * @param pool Pool
+ * @param worker_count Anzahl der Threads (mindestens 1)
+ */
+extern void work_pool_init(WORK_POOL *pool, unsigned int worker_count);
+
+/**
+ * Stellt eine Aufgabe hinten in die Warteschlange eines Threads. Darf vor
+ * work_pool_run oder aus einer laufenden Aufgabe aufgerufen werden.
+ *
+ * @param pool Pool
+ * @param worker Thread, in dessen Warteschlange die Aufgabe kommt
+ * @param function Funktion der Aufgabe
+ * @param p_arg Argument der Funktion
+ */
+extern void work_pool_submit(WORK_POOL *pool,
+                             unsigned int worker,
+                             WORK_FUNCTION function,
+                             void *p_arg);
+
+/**
+ * Fuehrt alle Aufgaben einschliesslich ihrer Teilaufgaben aus. Der
+ * aufrufende Thread arbeitet als Thread 0 mit. Ein Thread ohne eigene
+ * Aufgaben stiehlt die aelteste Aufgabe eines anderen.
+ *
+ * @param pool Pool
+ */
+extern void work_pool_run(WORK_POOL *pool);
+
+/**
+ * Gibt die Warteschlangen des Pools frei.
+ *
+ * @param pool Pool
+ */
+extern void work_pool_destroy(WORK_POOL *pool);
+
+#endif	/* WORK_POOL_H */